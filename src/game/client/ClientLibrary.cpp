@@ -27,6 +27,8 @@
 #include "ProjectInfoSystem.h"
 #include "view.h"
 
+#include "models/BspLoader.h"
+
 #include "networking/ClientUserMessages.h"
 #include "networking/NetworkDataSystem.h"
 
@@ -36,6 +38,7 @@
 #include "sound/IGameSoundSystem.h"
 #include "sound/IMusicSystem.h"
 #include "sound/ISoundSystem.h"
+#include "sound/MaterialSystem.h"
 
 #include "ui/hud/HudSpriteConfigSystem.h"
 #include "ui/vgui/CampaignSelectSystem.h"
@@ -251,6 +254,16 @@ Check the console for more information.)",
 			return;
 		}
 
+		// Map textures are used by player movement prediction to find materials without looking up names.
+		if (auto bspData = BspLoader::Load(gEngfuncs.pfnGetLevelName()); bspData)
+		{
+			g_MaterialSystem.SetMapTextures(std::move(bspData->TextureNames));
+		}
+		else
+		{
+			g_MaterialSystem.SetMapTextures({});
+		}
+
 		gHUD.VidInit();
 	}
 }
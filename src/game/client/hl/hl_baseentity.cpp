@@ -279,7 +279,7 @@ ItemAddResult CBasePlayer::AddPlayerWeapon(CBasePlayerWeapon* weapon) { return I
 bool CBasePlayer::RemovePlayerWeapon(CBasePlayerWeapon* weapon) { return false; }
 void CBasePlayer::ItemPreFrame() {}
 void CBasePlayer::ItemPostFrame() {}
-void CBasePlayer::SendAmmoUpdate() {}
+void CBasePlayer::SendAmmoUpdate(HudDelta& delta) {}
 void CBasePlayer::UpdateClientData() {}
 bool CBasePlayer::FBecomeProne() { return true; }
 void CBasePlayer::BarnacleVictimBitten(CBaseEntity* pevBarnacle) {}
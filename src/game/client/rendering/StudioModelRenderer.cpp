@@ -96,6 +96,9 @@ CStudioModelRenderer::CStudioModelRenderer()
 	m_pbonetransform = nullptr;
 	m_plighttransform = nullptr;
 	m_pStudioHeader = nullptr;
+	m_szCachedBonesModelName[0] = '\0';
+	m_nCachedBonesModelLength = 0;
+	m_nCachedBones = 0;
 	m_pBodyPart = nullptr;
 	m_pSubModel = nullptr;
 	m_pPlayerInfo = nullptr;
@@ -1023,6 +1026,9 @@ void CStudioModelRenderer::StudioSaveBones()
 	mstudiobone_t* pbones;
 	pbones = (mstudiobone_t*)((byte*)m_pStudioHeader + m_pStudioHeader->boneindex);
 
+	strncpy(m_szCachedBonesModelName, m_pStudioHeader->name, sizeof(m_szCachedBonesModelName) - 1);
+	m_szCachedBonesModelName[sizeof(m_szCachedBonesModelName) - 1] = '\0';
+	m_nCachedBonesModelLength = m_pStudioHeader->length;
 	m_nCachedBones = m_pStudioHeader->numbones;
 
 	for (i = 0; i < m_pStudioHeader->numbones; i++)
@@ -1034,6 +1040,61 @@ void CStudioModelRenderer::StudioSaveBones()
 }
 
 
+/*
+====================
+StudioGetBoneMergeMap
+
+Matching bones by name is quadratic in the number of bones, so it's only
+done the first time a model is merged with a given parent.
+====================
+*/
+const int* CStudioModelRenderer::StudioGetBoneMergeMap()
+{
+	// Enough for every attachment in a typical scene, cleared when full so it doesn't grow with every model ever drawn
+	constexpr std::size_t MaxBoneMergeMaps = 64;
+
+	for (const auto& mergeMap : m_BoneMergeMaps)
+	{
+		if (mergeMap.ChildLength == m_pStudioHeader->length && mergeMap.ParentLength == m_nCachedBonesModelLength && strncmp(mergeMap.ChildName, m_pStudioHeader->name, sizeof(mergeMap.ChildName)) == 0 && strncmp(mergeMap.ParentName, m_szCachedBonesModelName, sizeof(mergeMap.ParentName)) == 0)
+		{
+			return mergeMap.ParentBones.data();
+		}
+	}
+
+	if (m_BoneMergeMaps.size() >= MaxBoneMergeMaps)
+	{
+		m_BoneMergeMaps.clear();
+	}
+
+	auto& mergeMap = m_BoneMergeMaps.emplace_back();
+
+	strncpy(mergeMap.ChildName, m_pStudioHeader->name, sizeof(mergeMap.ChildName) - 1);
+	mergeMap.ChildName[sizeof(mergeMap.ChildName) - 1] = '\0';
+	strncpy(mergeMap.ParentName, m_szCachedBonesModelName, sizeof(mergeMap.ParentName));
+	mergeMap.ChildLength = m_pStudioHeader->length;
+	mergeMap.ParentLength = m_nCachedBonesModelLength;
+
+	const auto childBones = (const mstudiobone_t*)((const byte*)m_pStudioHeader + m_pStudioHeader->boneindex);
+
+	// Match against the cached names, the parent's model data may no longer be valid
+	for (int i = 0; i < m_pStudioHeader->numbones; i++)
+	{
+		mergeMap.ParentBones[i] = -1;
+
+		for (int j = 0; j < m_nCachedBones; j++)
+		{
+			if (stricmp(childBones[i].name, m_nCachedBoneNames[j]) == 0)
+			{
+				mergeMap.ParentBones[i] = j;
+				break;
+			}
+		}
+	}
+
+	return mergeMap.ParentBones.data();
+}
+
+
 /*
 ====================
 StudioMergeBones
@@ -1073,18 +1134,19 @@ void CStudioModelRenderer::StudioMergeBones(model_t* subModel)
 	pbones = (mstudiobone_t*)((byte*)m_pStudioHeader + m_pStudioHeader->boneindex);
 
 
+	const int* parentBones = StudioGetBoneMergeMap();
+
 	for (i = 0; i < m_pStudioHeader->numbones; i++)
 	{
-		for (j = 0; j < m_nCachedBones; j++)
+		j = parentBones[i];
+
+		if (j != -1)
 		{
-			if (stricmp(pbones[i].name, m_nCachedBoneNames[j]) == 0)
-			{
-				MatrixCopy(m_rgCachedBoneTransform[j], (*m_pbonetransform)[i]);
-				MatrixCopy(m_rgCachedLightTransform[j], (*m_plighttransform)[i]);
-				break;
-			}
+			// Whole matrix copies, which the compiler can vectorize
+			memcpy((*m_pbonetransform)[i], m_rgCachedBoneTransform[j], sizeof(m_rgCachedBoneTransform[j]));
+			memcpy((*m_plighttransform)[i], m_rgCachedLightTransform[j], sizeof(m_rgCachedLightTransform[j]));
 		}
-		if (j >= m_nCachedBones)
+		else
 		{
 			QuaternionMatrix(q[i], bonematrix);
 
@@ -7,6 +7,9 @@
 
 #pragma once
 
+#include <array>
+#include <vector>
+
 /*
 ====================
 CStudioModelRenderer
@@ -50,6 +53,9 @@ public:
 	// Merge cached bones with current bones for model
 	virtual void StudioMergeBones(model_t* subModel);
 
+	// For each bone of the current model, the cached bone it merges with
+	virtual const int* StudioGetBoneMergeMap();
+
 	// Determine interpolation fraction
 	virtual float StudioEstimateInterpolant();
 
@@ -155,6 +161,24 @@ public:
 	// Cached bone & light transformation matrices
 	float m_rgCachedBoneTransform[MAXSTUDIOBONES][3][4];
 	float m_rgCachedLightTransform[MAXSTUDIOBONES][3][4];
+	// Model whose bones are cached. Copied since the model data can be moved or freed before the bones are merged
+	char m_szCachedBonesModelName[64];
+	int m_nCachedBonesModelLength;
+
+	// Bone merge maps for each child and parent model that were merged recently
+	struct BoneMergeMap
+	{
+		// Models can be reloaded under the same name, the lengths help tell whether it's still the same model
+		char ChildName[64];
+		char ParentName[64];
+		int ChildLength;
+		int ParentLength;
+
+		// Index of the cached bone with the same name, -1 if there is none
+		std::array<int, MAXSTUDIOBONES> ParentBones;
+	};
+
+	std::vector<BoneMergeMap> m_BoneMergeMaps;
 
 	// Software renderer scale factors
 	float m_fSoftwareXScale, m_fSoftwareYScale;
@@ -36,6 +36,8 @@ struct DummyGameSoundSystem final : public IGameSoundSystem
 	void StopAllSounds() override {}
 
 	void MsgFunc_EmitSound(const char* pszName, BufferReader& reader) override {}
+
+	void MsgFunc_AmbientModulation(const char* pszName, BufferReader& reader) override {}
 };
 
 struct DummyMusicSystem final : public IMusicSystem
@@ -312,6 +312,8 @@ void GameSoundSystem::Update()
 		SetVolume();
 	}
 
+	UpdateAmbientModulations();
+
 	UpdateSounds();
 
 	UpdateRoomEffect();
@@ -485,6 +487,7 @@ void GameSoundSystem::StartSound(int entityIndex, int channelIndex, SoundData&&
 void GameSoundSystem::StopAllSounds()
 {
 	m_Channels.clear();
+	m_AmbientModulations.clear();
 }
 
 void GameSoundSystem::MsgFunc_EmitSound(const char* pszName, BufferReader& reader)
@@ -544,6 +547,58 @@ void GameSoundSystem::MsgFunc_EmitSound(const char* pszName, BufferReader& reade
 	}
 }
 
+void GameSoundSystem::MsgFunc_AmbientModulation(const char* pszName, BufferReader& reader)
+{
+	const int entityIndex = reader.ReadShort();
+	const bool active = reader.ReadByte() != 0;
+
+	auto modulation = std::find_if(m_AmbientModulations.begin(), m_AmbientModulations.end(), [&](const auto& candidate)
+		{ return candidate.EntityIndex == entityIndex; });
+
+	if (!active)
+	{
+		if (modulation != m_AmbientModulations.end())
+		{
+			m_AmbientModulations.erase(modulation);
+		}
+
+		return;
+	}
+
+	if (modulation == m_AmbientModulations.end())
+	{
+		modulation = m_AmbientModulations.insert(m_AmbientModulations.end(), AmbientModulation{.EntityIndex = entityIndex});
+	}
+
+	modulation->NextUpdateTime = gEngfuncs.GetClientTime() + reader.ReadByte() / 100.f;
+
+	auto& dpv = modulation->Parameters;
+
+	dpv.pitchrun = reader.ReadByte();
+	dpv.pitchstart = reader.ReadByte();
+	dpv.spinup = reader.ReadShort();
+	dpv.spindown = reader.ReadShort();
+
+	dpv.volrun = reader.ReadByte();
+	dpv.volstart = reader.ReadByte();
+	dpv.fadein = reader.ReadShort();
+	dpv.fadeout = reader.ReadShort();
+
+	dpv.lfotype = reader.ReadByte();
+	dpv.lforate = reader.ReadLong();
+	dpv.lfomodpitch = reader.ReadByte();
+	dpv.lfomodvol = reader.ReadByte();
+
+	dpv.pitch = reader.ReadByte();
+	dpv.vol = reader.ReadByte();
+	dpv.pitchfrac = reader.ReadLong();
+	dpv.volfrac = reader.ReadLong();
+	dpv.lfofrac = reader.ReadLong();
+	dpv.lfomult = reader.ReadByte();
+
+	m_Logger->trace("Syncing ambient modulation for entity {}", entityIndex);
+}
+
 bool GameSoundSystem::MakeCurrent()
 {
 	if (ALC_FALSE == alcMakeContextCurrent(m_Context.get()))
@@ -907,25 +962,93 @@ bool GameSoundSystem::AlterChannel(int entityIndex, int channelIndex, const Soun
 		return false;
 	}
 
-	auto& channelToAlter = *existingChannel;
+	ApplyChannelChange(*existingChannel, volume, pitch, flags);
+
+	return true;
+}
 
+void GameSoundSystem::ApplyChannelChange(Channel& channel, float volume, int pitch, int flags)
+{
 	if ((flags & SND_CHANGE_VOL) != 0)
 	{
-		alSourcef(channelToAlter.Source.Id, AL_GAIN, volume);
+		alSourcef(channel.Source.Id, AL_GAIN, volume);
 	}
 
 	if ((flags & SND_CHANGE_PITCH) != 0)
 	{
-		channelToAlter.Pitch = pitch;
-		alSourcef(channelToAlter.Source.Id, AL_PITCH, pitch / 100.f);
+		channel.Pitch = pitch;
+		alSourcef(channel.Source.Id, AL_PITCH, pitch / 100.f);
 	}
 
 	if ((flags & SND_STOP) != 0)
 	{
-		RemoveChannel(channelToAlter);
+		RemoveChannel(channel);
 	}
+}
 
-	return true;
+void GameSoundSystem::UpdateAmbientModulations()
+{
+	if (m_AmbientModulations.empty())
+	{
+		return;
+	}
+
+	const float time = gEngfuncs.GetClientTime();
+
+	for (auto it = m_AmbientModulations.begin(); it != m_AmbientModulations.end();)
+	{
+		auto& modulation = *it;
+		bool finished = false;
+
+		// Catch up on every step that elapsed since the last frame so the curves match the server's.
+		while (modulation.NextUpdateTime <= time)
+		{
+			if (!IsAmbientModulated(modulation.Parameters))
+			{
+				finished = true;
+				break;
+			}
+
+			const auto result = UpdateAmbientModulation(modulation.Parameters);
+
+			modulation.NextUpdateTime += AmbientModulationInterval;
+
+			if (result.Stopped)
+			{
+				AlterAmbientChannel(modulation.EntityIndex, 0, 0, SND_STOP);
+				finished = true;
+				break;
+			}
+
+			if (0 != result.Flags && result.Changed)
+			{
+				AlterAmbientChannel(modulation.EntityIndex, result.Volume * 0.01f, result.Pitch, result.Flags);
+			}
+		}
+
+		if (finished)
+		{
+			it = m_AmbientModulations.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
+
+void GameSoundSystem::AlterAmbientChannel(int entityIndex, float volume, int pitch, int flags)
+{
+	// Ambient sounds only play on the static channel, and only one at a time.
+	auto channel = std::find_if(m_Channels.begin(), m_Channels.end(), [&](const auto& candidate)
+		{ return candidate.EntityIndex == entityIndex && candidate.ChannelIndex == CHAN_STATIC; });
+
+	if (channel == m_Channels.end())
+	{
+		return;
+	}
+
+	ApplyChannelChange(*channel, volume, pitch, flags);
 }
 
 void GameSoundSystem::UpdateRoomEffect()
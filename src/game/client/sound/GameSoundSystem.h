@@ -28,6 +28,7 @@
 #include "SoundCache.h"
 #include "SoundDefs.h"
 #include "OpenALUtils.h"
+#include "sound/AmbientModulation.h"
 
 struct cvar_t;
 
@@ -64,7 +65,19 @@ public:
 
 	void MsgFunc_EmitSound(const char* pszName, BufferReader& reader) override;
 
+	void MsgFunc_AmbientModulation(const char* pszName, BufferReader& reader) override;
+
 private:
+	/**
+	 *	@brief Pitch and volume ramps and LFO of an ambient_generic, evaluated locally instead of on the server.
+	 */
+	struct AmbientModulation
+	{
+		int EntityIndex{0};
+		dynpitchvol_t Parameters{};
+		float NextUpdateTime{0};
+	};
+
 	bool MakeCurrent();
 
 	void PrintHRTFImplementations();
@@ -93,6 +106,11 @@ private:
 
 	bool AlterChannel(int entityIndex, int channelIndex, const SoundData& sound, float volume, int pitch, int flags);
 
+	/**
+	 *	@brief Applies the volume, pitch and stop flags of a sound change to a channel.
+	 */
+	void ApplyChannelChange(Channel& channel, float volume, int pitch, int flags);
+
 	void UpdateRoomEffect();
 
 	void UpdateSourceEffect(OpenALSource& source);
@@ -103,6 +121,13 @@ private:
 
 	void Spatialize(Channel& channel, int messagenum);
 
+	/**
+	 *	@brief Steps all ambient modulations at the same rate as the server would.
+	 */
+	void UpdateAmbientModulations();
+
+	void AlterAmbientChannel(int entityIndex, float volume, int pitch, int flags);
+
 private:
 	std::shared_ptr<spdlog::logger> m_Logger;
 	std::shared_ptr<spdlog::logger> m_CacheLogger;
@@ -138,6 +163,7 @@ private:
 	std::unique_ptr<SoundCache> m_SoundCache;
 	std::unique_ptr<SentencesSystem> m_Sentences;
 	std::vector<Channel> m_Channels;
+	std::vector<AmbientModulation> m_AmbientModulations;
 
 	bool m_Blocked{false};
 	bool m_Paused{false};
@@ -37,5 +37,7 @@ struct IGameSoundSystem : public INetworkDataBlockHandler
 	virtual void StopAllSounds() = 0;
 
 	virtual void MsgFunc_EmitSound(const char* pszName, BufferReader& reader) = 0;
+
+	virtual void MsgFunc_AmbientModulation(const char* pszName, BufferReader& reader) = 0;
 };
 }
@@ -188,6 +188,7 @@ void CreateSoundSystem()
 	}();
 
 	g_ClientUserMessages.RegisterHandler("EmitSound", &IGameSoundSystem::MsgFunc_EmitSound, g_SoundSystem->GetGameSoundSystem());
+	g_ClientUserMessages.RegisterHandler("AmbientMod", &IGameSoundSystem::MsgFunc_AmbientModulation, g_SoundSystem->GetGameSoundSystem());
 
 	g_ConCommands.CreateCommand("snd_playstatic", &S_PlayStaticSound);
 	g_ConCommands.CreateCommand("snd_playdynamic", &S_PlayDynamicSound);
@@ -78,9 +78,13 @@ bool CHudFlashlight::VidInit()
 
 void CHudFlashlight::MsgFunc_FlashBat(const char* pszName, BufferReader& reader)
 {
-	int x = reader.ReadByte();
-	m_iBat = x;
-	m_flBat = ((float)x) / 100.0;
+	SetBattery(reader.ReadByte());
+}
+
+void CHudFlashlight::SetBattery(int battery)
+{
+	m_iBat = battery;
+	m_flBat = ((float)battery) / 100.0;
 }
 
 void CHudFlashlight::MsgFunc_Flashlight(const char* pszName, BufferReader& reader)
@@ -112,42 +112,53 @@ bool CHudHealth::VidInit()
 void CHudHealth::MsgFunc_Health(const char* pszName, BufferReader& reader)
 {
 	// TODO: update local health data
-	int x = reader.ReadShort();
+	SetHealth(reader.ReadShort());
+}
+
+void CHudHealth::MsgFunc_Battery(const char* pszName, BufferReader& reader)
+{
+	SetBattery(reader.ReadShort());
+}
+
+void CHudHealth::MsgFunc_Damage(const char* pszName, BufferReader& reader)
+{
+	int armor = reader.ReadByte();		 // armor
+	int damageTaken = reader.ReadByte(); // health
+	long bitsDamage = reader.ReadLong(); // damage bits
+
+	Vector vecFrom;
+
+	for (int i = 0; i < 3; i++)
+		vecFrom[i] = reader.ReadCoord();
 
+	OnDamage(armor, damageTaken, bitsDamage, vecFrom);
+}
+
+void CHudHealth::SetHealth(int health)
+{
 	m_iFlags |= HUD_ACTIVE;
 
 	// Only update the fade if we've changed health
-	if (x != m_iHealth)
+	if (health != m_iHealth)
 	{
 		m_HealthFade = FADE_TIME;
-		m_iHealth = x;
+		m_iHealth = health;
 	}
 }
 
-void CHudHealth::MsgFunc_Battery(const char* pszName, BufferReader& reader)
+void CHudHealth::SetBattery(int battery)
 {
 	m_iFlags |= HUD_ACTIVE;
 
-	int x = reader.ReadShort();
-
-	if (x != m_iBat)
+	if (battery != m_iBat)
 	{
 		m_ArmorFade = FADE_TIME;
-		m_iBat = x;
+		m_iBat = battery;
 	}
 }
 
-void CHudHealth::MsgFunc_Damage(const char* pszName, BufferReader& reader)
+void CHudHealth::OnDamage(int armor, int damageTaken, long bitsDamage, const Vector& vecFrom)
 {
-	int armor = reader.ReadByte();		 // armor
-	int damageTaken = reader.ReadByte(); // health
-	long bitsDamage = reader.ReadLong(); // damage bits
-
-	Vector vecFrom;
-
-	for (int i = 0; i < 3; i++)
-		vecFrom[i] = reader.ReadCoord();
-
 	UpdateTiles(gHUD.m_flTime, bitsDamage);
 
 	// Actually took damage?
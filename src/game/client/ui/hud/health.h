@@ -42,6 +42,9 @@ public:
 	void MsgFunc_Health(const char* pszName, BufferReader& reader);
 	void MsgFunc_Battery(const char* pszName, BufferReader& reader);
 	void MsgFunc_Damage(const char* pszName, BufferReader& reader);
+	void SetHealth(int health);
+	void SetBattery(int battery);
+	void OnDamage(int armor, int damageTaken, long bitsDamage, const Vector& vecFrom);
 	int m_iHealth;
 	int m_HUD_cross;
 	float m_fAttackFront, m_fAttackRear, m_fAttackLeft, m_fAttackRight;
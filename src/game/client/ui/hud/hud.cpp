@@ -104,6 +104,7 @@ void CHud::Init()
 	g_ClientUserMessages.RegisterHandler("Concuss", &CHud::MsgFunc_Concuss, this);
 	g_ClientUserMessages.RegisterHandler("Weapons", &CHud::MsgFunc_Weapons, this);
 	g_ClientUserMessages.RegisterHandler("Fog", &CHud::MsgFunc_Fog, this);
+	g_ClientUserMessages.RegisterHandler("HudDelta", &CHud::MsgFunc_HudDelta, this);
 
 	CVAR_CREATE("hud_classautokill", "1", FCVAR_ARCHIVE | FCVAR_USERINFO); // controls whether or not to suicide immediately on TF class switch
 	CVAR_CREATE("hud_takesshots", "0", FCVAR_ARCHIVE);					   // controls whether or not to automatically take screenshots at the end of a round
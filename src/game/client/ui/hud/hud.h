@@ -196,6 +196,7 @@ public:
 	bool VidInit() override;
 	bool Draw(float flTime) override;
 	void MsgFunc_Train(const char* pszName, BufferReader& reader);
+	void SetPosition(int position);
 
 private:
 	HSPRITE m_hSprite;
@@ -367,6 +368,7 @@ public:
 	void Reset() override;
 	void MsgFunc_Flashlight(const char* pszName, BufferReader& reader);
 	void MsgFunc_FlashBat(const char* pszName, BufferReader& reader);
+	void SetBattery(int battery);
 
 private:
 	LightData* GetLightData()
@@ -842,6 +844,7 @@ public:
 	void MsgFunc_Concuss(const char* pszName, BufferReader& reader);
 	void MsgFunc_Weapons(const char* pszName, BufferReader& reader);
 	void MsgFunc_Fog(const char* pszName, BufferReader& reader);
+	void MsgFunc_HudDelta(const char* pszName, BufferReader& reader);
 
 	// Screen information
 	SCREENINFO m_scrinfo;
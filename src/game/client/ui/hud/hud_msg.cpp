@@ -17,7 +17,9 @@
 //
 
 #include "hud.h"
+#include "ammohistory.h"
 #include "r_efx.h"
+#include "networking/HudDelta.h"
 
 #include "vgui_TeamFortressViewport.h"
 #include "vgui_ScorePanel.h"
@@ -138,6 +140,61 @@ void CHud::MsgFunc_Weapons(const char* pszName, BufferReader& reader)
 	m_iWeaponBits = (lowerBits & 0XFFFFFFFF) | ((upperBits & 0XFFFFFFFF) << 32ULL);
 }
 
+void CHud::MsgFunc_HudDelta(const char* pszName, BufferReader& reader)
+{
+	std::array<std::byte, HudDelta::MaxMessageSize> buffer;
+	std::size_t size = 0;
+
+	while (reader.GetRemaining() > 0 && size < buffer.size())
+	{
+		buffer[size++] = static_cast<std::byte>(reader.ReadByte());
+	}
+
+	HudDelta delta;
+
+	if (!delta.Read({buffer.data(), size}))
+	{
+		gEngfuncs.Con_DPrintf("Truncated HudDelta message\n");
+		return;
+	}
+
+	// Apply in the order the individual messages used to be sent in.
+	if ((delta.Fields & HudDelta::Health) != 0)
+	{
+		m_Health.SetHealth(delta.HealthValue);
+	}
+
+	if ((delta.Fields & HudDelta::Battery) != 0)
+	{
+		m_Health.SetBattery(delta.BatteryValue);
+	}
+
+	if ((delta.Fields & HudDelta::Weapons) != 0)
+	{
+		m_iWeaponBits = delta.WeaponBits;
+	}
+
+	if ((delta.Fields & HudDelta::Damage) != 0)
+	{
+		m_Health.OnDamage(delta.DamageSave, delta.DamageTake, delta.DamageBits, delta.DamageOrigin);
+	}
+
+	if ((delta.Fields & HudDelta::FlashBattery) != 0)
+	{
+		m_Flash.SetBattery(delta.FlashBatteryValue);
+	}
+
+	if ((delta.Fields & HudDelta::Train) != 0)
+	{
+		m_Train.SetPosition(delta.TrainValue);
+	}
+
+	for (int i = 0; i < delta.AmmoSlotCount; ++i)
+	{
+		gWR.SetAmmo(delta.AmmoSlots[i].Index, delta.AmmoSlots[i].Count);
+	}
+}
+
 void CHud::MsgFunc_Fog(const char* pszName, BufferReader& reader)
 {
 	g_FogSkybox = 0;
@@ -58,7 +58,12 @@ bool CHudTrain::Draw(float fTime)
 void CHudTrain::MsgFunc_Train(const char* pszName, BufferReader& reader)
 {
 	// update Train data
-	m_iPos = reader.ReadByte();
+	SetPosition(reader.ReadByte());
+}
+
+void CHudTrain::SetPosition(int position)
+{
+	m_iPos = position;
 
 	if (0 != m_iPos)
 		m_iFlags |= HUD_ACTIVE;
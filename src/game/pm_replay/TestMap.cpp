@@ -0,0 +1,223 @@
+/***
+ *
+ *	Copyright (c) 1996-2002, Valve LLC. All rights reserved.
+ *
+ *	This product contains software technology licensed from Id
+ *	Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *	All Rights Reserved.
+ *
+ *   Use, distribution, and modification of this source code and/or resulting
+ *   object code is restricted to non-commercial enhancements to products from
+ *   Valve LLC.  All other use, distribution, or modification is prohibited
+ *   without written permission from Valve LLC.
+ *
+ ****/
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <iterator>
+
+#include "Platform.h"
+#include "mathlib.h"
+#include "TestMap.h"
+
+#define vec3_t Vector
+
+// Pull in tools header for definitions. Don't call any of its functions!
+#include "../../utils/common/bspfile.h"
+
+namespace
+{
+// Player hull sizes, in BSP hull order.
+constexpr float HullMins[MAX_MAP_HULLS][3] = {{0, 0, 0}, {-16, -16, -36}, {-32, -32, -32}, {-16, -16, -18}};
+constexpr float HullMaxs[MAX_MAP_HULLS][3] = {{0, 0, 0}, {16, 16, 36}, {32, 32, 32}, {16, 16, 18}};
+
+// Leafs used by hull 0. Leaf 0 is always the solid leaf.
+constexpr int SolidLeaf = 0;
+constexpr int EmptyLeaf = 1;
+constexpr int WaterLeaf = 2;
+
+/**
+ *	@brief Builds the nodes of one hull. A child is either a node index or contents.
+ */
+class HullBuilder final
+{
+public:
+	HullBuilder(std::vector<dplane_t>& planes, int hull)
+		: m_Planes(planes),
+		  m_Hull(hull)
+	{
+	}
+
+	/**
+	 *	@brief Adds a chain of nodes for the inside of @p box.
+	 *	@details Points inside the box end up in @p inside, points outside of it in @p outside.
+	 *	@param expand Whether the box grows by the hull size, as solids do, or shrinks, as the room does.
+	 */
+	void AddBox(const TestMapBox& box, bool expand, int inside, int outside)
+	{
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			const float low = box.Mins[axis] - (expand ? HullMaxs[m_Hull][axis] : HullMins[m_Hull][axis]);
+			const float high = box.Maxs[axis] - (expand ? HullMins[m_Hull][axis] : HullMaxs[m_Hull][axis]);
+
+			// Front of the plane is children[0]. Each node continues to the one added after it.
+			AddNode(axis, low, Next() + 1, outside);
+			AddNode(axis, high, outside, axis == 2 ? inside : Next() + 1);
+		}
+	}
+
+	/**
+	 *	@brief Index of the next node to be added, relative to the first node in this hull.
+	 */
+	int Next() const { return static_cast<int>(m_Nodes.size()); }
+
+	const std::vector<std::array<int, 3>>& GetNodes() const { return m_Nodes; }
+
+private:
+	void AddNode(int axis, float distance, int front, int back)
+	{
+		dplane_t plane{};
+		plane.normal[axis] = 1;
+		plane.dist = distance;
+		plane.type = axis;
+
+		m_Nodes.push_back({static_cast<int>(m_Planes.size()), front, back});
+		m_Planes.push_back(plane);
+	}
+
+private:
+	std::vector<dplane_t>& m_Planes;
+	const int m_Hull;
+
+	// Plane index and children.
+	std::vector<std::array<int, 3>> m_Nodes;
+};
+
+template <typename T>
+void AddLump(std::vector<std::byte>& file, int lumpIndex, const std::vector<T>& data)
+{
+	// Lumps are 4 byte aligned.
+	file.resize((file.size() + 3) & ~std::size_t{3});
+
+	lump_t lump{static_cast<int>(file.size()), static_cast<int>(data.size() * sizeof(T))};
+	std::memcpy(file.data() + offsetof(dheader_t, lumps) + sizeof(lump_t) * lumpIndex, &lump, sizeof(lump));
+
+	const auto bytes = reinterpret_cast<const std::byte*>(data.data());
+	file.insert(file.end(), bytes, bytes + lump.filelen);
+}
+}
+
+std::vector<std::byte> BuildTestMap(const TestMapBox& room, const std::vector<TestMapBox>& boxes)
+{
+	std::vector<dplane_t> planes;
+	std::vector<dnode_t> nodes;
+	std::vector<dclipnode_t> clipNodes;
+
+	dmodel_t world{};
+
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		world.mins[axis] = room.Mins[axis];
+		world.maxs[axis] = room.Maxs[axis];
+	}
+
+	for (int hull = 0; hull < MAX_MAP_HULLS; ++hull)
+	{
+		// Hull 0 children refer to leafs, the other hulls use contents.
+		const auto contents = [&](int leaf, int hullContents)
+		{
+			return hull == 0 ? -1 - leaf : hullContents;
+		};
+
+		const int solid = contents(SolidLeaf, CONTENTS_SOLID);
+		const int empty = contents(EmptyLeaf, CONTENTS_EMPTY);
+		const int water = contents(WaterLeaf, CONTENTS_WATER);
+
+		std::vector<TestMapBox> hullBoxes;
+
+		// Water only exists in the point hull.
+		std::copy_if(boxes.begin(), boxes.end(), std::back_inserter(hullBoxes), [&](const auto& box)
+			{ return hull == 0 || !box.Water; });
+
+		HullBuilder builder{planes, hull};
+
+		// Every box adds 6 nodes, so the next box starts 6 nodes after this one.
+		builder.AddBox(room, false, hullBoxes.empty() ? empty : builder.Next() + 6, solid);
+
+		for (std::size_t i = 0; i < hullBoxes.size(); ++i)
+		{
+			const auto& box = hullBoxes[i];
+			const bool last = i + 1 == hullBoxes.size();
+
+			builder.AddBox(box, true, box.Water ? water : solid, last ? empty : builder.Next() + 6);
+		}
+
+		const int firstNode = hull == 0 ? static_cast<int>(nodes.size()) : static_cast<int>(clipNodes.size());
+
+		world.headnode[hull] = firstNode;
+
+		for (const auto& node : builder.GetNodes())
+		{
+			const auto child = [&](int index)
+			{
+				return static_cast<short>(node[index] >= 0 ? firstNode + node[index] : node[index]);
+			};
+
+			if (hull == 0)
+			{
+				dnode_t& added = nodes.emplace_back();
+				added.planenum = node[0];
+				added.children[0] = child(1);
+				added.children[1] = child(2);
+			}
+			else
+			{
+				clipNodes.push_back({node[0], {child(1), child(2)}});
+			}
+		}
+	}
+
+	std::vector<dleaf_t> leafs(3);
+	leafs[SolidLeaf].contents = CONTENTS_SOLID;
+	leafs[EmptyLeaf].contents = CONTENTS_EMPTY;
+	leafs[WaterLeaf].contents = CONTENTS_WATER;
+
+	for (auto& leaf : leafs)
+	{
+		leaf.visofs = -1;
+	}
+
+	std::vector<std::byte> file(sizeof(dheader_t));
+
+	const int version = BSPVERSION;
+	std::memcpy(file.data() + offsetof(dheader_t, version), &version, sizeof(version));
+
+	for (int lump = 0; lump < HEADER_LUMPS; ++lump)
+	{
+		switch (lump)
+		{
+		case LUMP_PLANES:
+			AddLump(file, lump, planes);
+			break;
+		case LUMP_NODES:
+			AddLump(file, lump, nodes);
+			break;
+		case LUMP_CLIPNODES:
+			AddLump(file, lump, clipNodes);
+			break;
+		case LUMP_LEAFS:
+			AddLump(file, lump, leafs);
+			break;
+		case LUMP_MODELS:
+			AddLump(file, lump, std::vector<dmodel_t>{world});
+			break;
+		default:
+			AddLump(file, lump, std::vector<std::byte>{});
+			break;
+		}
+	}
+
+	return file;
+}
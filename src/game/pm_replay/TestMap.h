@@ -0,0 +1,38 @@
+/***
+ *
+ *	Copyright (c) 1996-2002, Valve LLC. All rights reserved.
+ *
+ *	This product contains software technology licensed from Id
+ *	Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *	All Rights Reserved.
+ *
+ *   Use, distribution, and modification of this source code and/or resulting
+ *   object code is restricted to non-commercial enhancements to products from
+ *   Valve LLC.  All other use, distribution, or modification is prohibited
+ *   without written permission from Valve LLC.
+ *
+ ****/
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/**
+ *	@brief Axis aligned box in the test map.
+ */
+struct TestMapBox
+{
+	float Mins[3];
+	float Maxs[3];
+
+	// Solid boxes are in all hulls, water only in the point hull.
+	bool Water = false;
+};
+
+/**
+ *	@brief Builds the file contents of a BSP containing only collision data for a closed room with boxes in it.
+ *	@details Used to test the movement code without needing maps made with the map compile tools.
+ *	Boxes must not overlap each other or the room's walls.
+ */
+std::vector<std::byte> BuildTestMap(const TestMapBox& room, const std::vector<TestMapBox>& boxes);
@@ -0,0 +1,591 @@
+/***
+ *
+ *	Copyright (c) 1996-2002, Valve LLC. All rights reserved.
+ *
+ *	This product contains software technology licensed from Id
+ *	Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *	All Rights Reserved.
+ *
+ *   Use, distribution, and modification of this source code and/or resulting
+ *   object code is restricted to non-commercial enhancements to products from
+ *   Valve LLC.  All other use, distribution, or modification is prohibited
+ *   without written permission from Valve LLC.
+ *
+ ****/
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+#include "WorldCollision.h"
+#include "cdll_dll.h"
+#include "pm_shared.h"
+
+// 1/32 epsilon to keep floating point happy
+constexpr float DIST_EPSILON = 0.03125f;
+
+// Hull of the world used for each player hull number, matches the engine.
+constexpr int WorldHullForPlayerHull[4] = {1, 3, 0, 2};
+
+static WorldCollision* g_Collision = nullptr;
+static const model_t* g_WorldModel = nullptr;
+
+static Vector ToVector(const float* v)
+{
+	return {v[0], v[1], v[2]};
+}
+
+static int HullPointContents(const hull_t* hull, int num, const Vector& p)
+{
+	while (num >= 0)
+	{
+		const dclipnode_t* node = hull->clipnodes + num;
+		const mplane_t* plane = hull->planes + node->planenum;
+
+		float d;
+
+		if (plane->type < 3)
+		{
+			d = p[plane->type] - plane->dist;
+		}
+		else
+		{
+			d = DotProduct(plane->normal, p) - plane->dist;
+		}
+
+		num = d < 0 ? node->children[1] : node->children[0];
+	}
+
+	return num;
+}
+
+/**
+ *	@brief Traces a line through a hull. Same algorithm as the engine.
+ *	@return Whether the line didn't hit anything.
+ */
+static bool RecursiveHullCheck(const hull_t* hull, int num, float p1f, float p2f, const Vector& p1, const Vector& p2, pmtrace_t* trace)
+{
+	// Check for empty
+	if (num < 0)
+	{
+		if (num != CONTENTS_SOLID)
+		{
+			trace->allsolid = 0;
+
+			if (num == CONTENTS_EMPTY)
+			{
+				trace->inopen = 1;
+			}
+			else
+			{
+				trace->inwater = 1;
+			}
+		}
+		else
+		{
+			trace->startsolid = 1;
+		}
+
+		return true;
+	}
+
+	const dclipnode_t* node = hull->clipnodes + num;
+	const mplane_t* plane = hull->planes + node->planenum;
+
+	float t1, t2;
+
+	if (plane->type < 3)
+	{
+		t1 = p1[plane->type] - plane->dist;
+		t2 = p2[plane->type] - plane->dist;
+	}
+	else
+	{
+		t1 = DotProduct(plane->normal, p1) - plane->dist;
+		t2 = DotProduct(plane->normal, p2) - plane->dist;
+	}
+
+	if (t1 >= 0 && t2 >= 0)
+	{
+		return RecursiveHullCheck(hull, node->children[0], p1f, p2f, p1, p2, trace);
+	}
+
+	if (t1 < 0 && t2 < 0)
+	{
+		return RecursiveHullCheck(hull, node->children[1], p1f, p2f, p1, p2, trace);
+	}
+
+	// Put the crosspoint DIST_EPSILON pixels on the near side
+	float frac = t1 < 0 ? (t1 + DIST_EPSILON) / (t1 - t2) : (t1 - DIST_EPSILON) / (t1 - t2);
+
+	frac = std::clamp(frac, 0.f, 1.f);
+
+	float midf = p1f + (p2f - p1f) * frac;
+	Vector mid = p1 + (p2 - p1) * frac;
+
+	const int side = t1 < 0 ? 1 : 0;
+
+	// Move up to the node
+	if (!RecursiveHullCheck(hull, node->children[side], p1f, midf, p1, mid, trace))
+	{
+		return false;
+	}
+
+	if (HullPointContents(hull, node->children[side ^ 1], mid) != CONTENTS_SOLID)
+	{
+		// Go past the node
+		return RecursiveHullCheck(hull, node->children[side ^ 1], midf, p2f, mid, p2, trace);
+	}
+
+	if (0 != trace->allsolid)
+	{
+		// Never got out of the solid area
+		return false;
+	}
+
+	// The other side of the node is solid, this is the impact point
+	if (0 == side)
+	{
+		trace->plane.normal = plane->normal;
+		trace->plane.dist = plane->dist;
+	}
+	else
+	{
+		trace->plane.normal = -plane->normal;
+		trace->plane.dist = -plane->dist;
+	}
+
+	while (HullPointContents(hull, hull->firstclipnode, mid) == CONTENTS_SOLID)
+	{
+		// Shouldn't really happen, but does occasionally
+		frac -= 0.1f;
+
+		if (frac < 0)
+		{
+			trace->fraction = midf;
+			trace->endpos = mid;
+			return false;
+		}
+
+		midf = p1f + (p2f - p1f) * frac;
+		mid = p1 + (p2 - p1) * frac;
+	}
+
+	trace->fraction = midf;
+	trace->endpos = mid;
+
+	return false;
+}
+
+static bool ShouldCollide(int index, int traceFlags, int ignore_pe, int (*pfnIgnore)(physent_t* pe))
+{
+	physent_t* pe = &pmove->physents[index];
+
+	if (index == ignore_pe || pe->model != g_WorldModel)
+	{
+		return false;
+	}
+
+	if (index > 0 && (traceFlags & PM_WORLD_ONLY) != 0)
+	{
+		return false;
+	}
+
+	return !pfnIgnore || 0 == pfnIgnore(pe);
+}
+
+static pmtrace_t PlayerTrace(const Vector& start, const Vector& end, int traceFlags, int ignore_pe, int (*pfnIgnore)(physent_t* pe))
+{
+	pmtrace_t total{};
+	total.fraction = 1;
+	total.ent = -1;
+	total.endpos = end;
+
+	for (int i = 0; i < pmove->numphysent; ++i)
+	{
+		if (!ShouldCollide(i, traceFlags, ignore_pe, pfnIgnore))
+		{
+			continue;
+		}
+
+		const physent_t* pe = &pmove->physents[i];
+		const hull_t* hull = g_Collision->GetHull(pmove->usehull);
+
+		pmtrace_t trace{};
+		trace.fraction = 1;
+		trace.allsolid = 1;
+		trace.endpos = end;
+
+		RecursiveHullCheck(hull, hull->firstclipnode, 0, 1, start - pe->origin, end - pe->origin, &trace);
+
+		if (0 != trace.allsolid)
+		{
+			trace.startsolid = 1;
+		}
+
+		if (0 != trace.startsolid)
+		{
+			trace.fraction = 0;
+		}
+
+		// Did we clip the move?
+		if (trace.fraction < total.fraction)
+		{
+			trace.endpos = trace.endpos + pe->origin;
+			total = trace;
+			total.ent = i;
+		}
+	}
+
+	return total;
+}
+
+static int TestPlayerPosition(const Vector& pos, pmtrace_t* ptrace, int (*pfnIgnore)(physent_t* pe))
+{
+	if (ptrace)
+	{
+		*ptrace = PlayerTrace(pos, pos, PM_NORMAL, -1, pfnIgnore);
+	}
+
+	for (int i = 0; i < pmove->numphysent; ++i)
+	{
+		if (!ShouldCollide(i, PM_NORMAL, -1, pfnIgnore))
+		{
+			continue;
+		}
+
+		const hull_t* hull = g_Collision->GetHull(pmove->usehull);
+
+		if (HullPointContents(hull, hull->firstclipnode, pos - pmove->physents[i].origin) == CONTENTS_SOLID)
+		{
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+static int TruePointContents(const Vector& p)
+{
+	const hull_t* hull = g_Collision->GetHull(2);
+	return HullPointContents(hull, hull->firstclipnode, p);
+}
+
+static const char* World_Info_ValueForKey(const char* s, const char* key)
+{
+	// Same format as the engine's info strings: \key\value\key\value
+	static char value[MAX_PHYSINFO_STRING];
+
+	const std::size_t keyLength = std::strlen(key);
+
+	while (*s == '\\')
+	{
+		++s;
+
+		const char* keyEnd = std::strchr(s, '\\');
+
+		if (!keyEnd)
+		{
+			break;
+		}
+
+		const char* valueStart = keyEnd + 1;
+		const char* valueEnd = std::strchr(valueStart, '\\');
+
+		if (!valueEnd)
+		{
+			valueEnd = valueStart + std::strlen(valueStart);
+		}
+
+		if (static_cast<std::size_t>(keyEnd - s) == keyLength && 0 == std::strncmp(s, key, keyLength))
+		{
+			const std::size_t length = std::min(static_cast<std::size_t>(valueEnd - valueStart), sizeof(value) - 1);
+			std::memcpy(value, valueStart, length);
+			value[length] = '\0';
+			return value;
+		}
+
+		s = valueEnd;
+	}
+
+	return "";
+}
+
+static void World_Particle(float* origin, int color, float life, int zpos, int zvel)
+{
+}
+
+static int World_TestPlayerPosition(float* pos, pmtrace_t* ptrace)
+{
+	return TestPlayerPosition(ToVector(pos), ptrace, nullptr);
+}
+
+static int World_TestPlayerPositionEx(float* pos, pmtrace_t* ptrace, int (*pfnIgnore)(physent_t* pe))
+{
+	return TestPlayerPosition(ToVector(pos), ptrace, pfnIgnore);
+}
+
+static void World_Con_NPrintf(int idx, const char* fmt, ...)
+{
+}
+
+static void World_Con_DPrintf(const char* fmt, ...)
+{
+}
+
+static void World_Con_Printf(const char* fmt, ...)
+{
+	va_list list;
+	va_start(list, fmt);
+	std::vprintf(fmt, list);
+	va_end(list);
+}
+
+static double World_Sys_FloatTime()
+{
+	return 0;
+}
+
+static void World_StuckTouch(int hitent, pmtrace_t* ptraceresult)
+{
+}
+
+static int World_PointContents(float* p, int* truecontents)
+{
+	int contents = TruePointContents(ToVector(p));
+
+	if (truecontents)
+	{
+		*truecontents = contents;
+	}
+
+	if (contents <= CONTENTS_CURRENT_0 && contents >= CONTENTS_CURRENT_DOWN)
+	{
+		contents = CONTENTS_WATER;
+	}
+
+	return contents;
+}
+
+static int World_TruePointContents(float* p)
+{
+	return TruePointContents(ToVector(p));
+}
+
+static int World_HullPointContents(hull_t* hull, int num, float* p)
+{
+	return HullPointContents(hull, num, ToVector(p));
+}
+
+static pmtrace_t World_PlayerTrace(float* start, float* end, int traceFlags, int ignore_pe)
+{
+	return PlayerTrace(ToVector(start), ToVector(end), traceFlags, ignore_pe, nullptr);
+}
+
+static pmtrace_t World_PlayerTraceEx(float* start, float* end, int traceFlags, int (*pfnIgnore)(physent_t* pe))
+{
+	return PlayerTrace(ToVector(start), ToVector(end), traceFlags, -1, pfnIgnore);
+}
+
+static pmtrace_t* TraceLine(float* start, float* end, int flags, int usehull, int ignore_pe, int (*pfnIgnore)(physent_t* pe))
+{
+	static pmtrace_t trace;
+
+	const int oldHull = pmove->usehull;
+
+	pmove->usehull = usehull;
+
+	trace = PlayerTrace(ToVector(start), ToVector(end), PM_NORMAL, ignore_pe, pfnIgnore);
+
+	pmove->usehull = oldHull;
+
+	return &trace;
+}
+
+static pmtrace_t* World_TraceLine(float* start, float* end, int flags, int usehull, int ignore_pe)
+{
+	return TraceLine(start, end, flags, usehull, ignore_pe, nullptr);
+}
+
+static pmtrace_t* World_TraceLineEx(float* start, float* end, int flags, int usehull, int (*pfnIgnore)(physent_t* pe))
+{
+	return TraceLine(start, end, flags, usehull, -1, pfnIgnore);
+}
+
+static int32 World_RandomLong(int32 lLow, int32 lHigh)
+{
+	return lLow;
+}
+
+static float World_RandomFloat(float flLow, float flHigh)
+{
+	return flLow;
+}
+
+static int World_GetModelType(model_t* mod)
+{
+	return mod->type;
+}
+
+static void World_GetModelBounds(model_t* mod, float* mins, float* maxs)
+{
+	mod->mins.CopyToArray(mins);
+	mod->maxs.CopyToArray(maxs);
+}
+
+static void* World_HullForBsp(physent_t* pe, float* offset)
+{
+	pe->origin.CopyToArray(offset);
+	return g_Collision->GetHull(pmove->usehull);
+}
+
+static float World_TraceModel(physent_t* pEnt, const float* start, const float* end, trace_t* trace)
+{
+	const hull_t* hull = g_Collision->GetHull(2);
+
+	pmtrace_t pmtrace{};
+	pmtrace.fraction = 1;
+	pmtrace.allsolid = 1;
+	pmtrace.endpos = ToVector(end);
+
+	RecursiveHullCheck(hull, hull->firstclipnode, 0, 1, ToVector(start) - pEnt->origin, ToVector(end) - pEnt->origin, &pmtrace);
+
+	trace->allsolid = pmtrace.allsolid;
+	trace->startsolid = pmtrace.startsolid;
+	trace->inopen = pmtrace.inopen;
+	trace->inwater = pmtrace.inwater;
+	trace->fraction = pmtrace.fraction;
+	trace->endpos = pmtrace.endpos + pEnt->origin;
+	trace->plane.normal = pmtrace.plane.normal;
+	trace->plane.dist = pmtrace.plane.dist;
+	trace->ent = nullptr;
+	trace->hitgroup = 0;
+
+	return trace->fraction;
+}
+
+static void World_PlaySound(int channel, const char* sample, float volume, float attenuation, int fFlags, int pitch)
+{
+}
+
+static const char* World_TraceTexture(int ground, float* vstart, float* vend)
+{
+	return nullptr;
+}
+
+static void World_PlaybackEventFull(int flags, int clientindex, unsigned short eventindex, float delay, float* origin, float* angles,
+	float fparam1, float fparam2, int iparam1, int iparam2, int bparam1, int bparam2)
+{
+}
+
+WorldCollision::WorldCollision(const BspData& data)
+{
+	m_Planes.reserve(data.Planes.size());
+
+	for (const auto& plane : data.Planes)
+	{
+		mplane_t& converted = m_Planes.emplace_back();
+		converted.normal = ToVector(plane.Normal);
+		converted.dist = plane.Distance;
+		converted.type = static_cast<byte>(plane.Type);
+	}
+
+	const auto convert = [](const std::vector<BspClipNode>& nodes, std::vector<dclipnode_t>& converted)
+	{
+		converted.reserve(nodes.size());
+
+		for (const auto& node : nodes)
+		{
+			converted.push_back({node.PlaneIndex, {node.Children[0], node.Children[1]}});
+		}
+	};
+
+	convert(data.PointHullClipNodes, m_PointHullClipNodes);
+	convert(data.ClipNodes, m_ClipNodes);
+
+	std::strncpy(m_World.name, "world", sizeof(m_World.name) - 1);
+	m_World.type = mod_brush;
+
+	for (int i = 0; i < MAX_MAP_HULLS; ++i)
+	{
+		auto& hull = m_World.hulls[i];
+		auto& clipNodes = i == 0 ? m_PointHullClipNodes : m_ClipNodes;
+
+		hull.clipnodes = clipNodes.data();
+		hull.planes = m_Planes.data();
+		hull.firstclipnode = data.WorldHeadNodes[i];
+		hull.lastclipnode = static_cast<int>(clipNodes.size()) - 1;
+	}
+
+	m_World.hulls[1].clip_mins = VEC_HULL_MIN;
+	m_World.hulls[1].clip_maxs = VEC_HULL_MAX;
+	m_World.hulls[2].clip_mins = Vector(-32, -32, -32);
+	m_World.hulls[2].clip_maxs = Vector(32, 32, 32);
+	m_World.hulls[3].clip_mins = VEC_DUCK_HULL_MIN;
+	m_World.hulls[3].clip_maxs = VEC_DUCK_HULL_MAX;
+}
+
+WorldCollision::~WorldCollision()
+{
+	if (g_Collision == this)
+	{
+		g_Collision = nullptr;
+		g_WorldModel = nullptr;
+	}
+}
+
+void WorldCollision::Install(playermove_t& ppmove)
+{
+	g_Collision = this;
+	g_WorldModel = &m_World;
+
+	physent_t& world = ppmove.physents[0];
+
+	world = {};
+	std::strncpy(world.name, "world", sizeof(world.name) - 1);
+	world.model = &m_World;
+	world.solid = SOLID_BSP;
+	world.movetype = MOVETYPE_PUSH;
+
+	ppmove.numphysent = 1;
+	ppmove.numvisent = 1;
+	ppmove.visents[0] = world;
+	ppmove.nummoveent = 0;
+
+	ppmove.PM_Info_ValueForKey = World_Info_ValueForKey;
+	ppmove.PM_Particle = World_Particle;
+	ppmove.PM_TestPlayerPosition = World_TestPlayerPosition;
+	ppmove.Con_NPrintf = World_Con_NPrintf;
+	ppmove.Con_DPrintf = World_Con_DPrintf;
+	ppmove.Con_Printf = World_Con_Printf;
+	ppmove.Sys_FloatTime = World_Sys_FloatTime;
+	ppmove.PM_StuckTouch = World_StuckTouch;
+	ppmove.PM_PointContents = World_PointContents;
+	ppmove.PM_TruePointContents = World_TruePointContents;
+	ppmove.PM_HullPointContents = World_HullPointContents;
+	ppmove.PM_PlayerTrace = World_PlayerTrace;
+	ppmove.PM_TraceLine = World_TraceLine;
+	ppmove.RandomLong = World_RandomLong;
+	ppmove.RandomFloat = World_RandomFloat;
+	ppmove.PM_GetModelType = World_GetModelType;
+	ppmove.PM_GetModelBounds = World_GetModelBounds;
+	ppmove.PM_HullForBsp = World_HullForBsp;
+	ppmove.PM_TraceModel = World_TraceModel;
+	ppmove.COM_FileSize = nullptr;
+	ppmove.COM_LoadFile = nullptr;
+	ppmove.COM_FreeFile = nullptr;
+	ppmove.memfgets = nullptr;
+	ppmove.runfuncs = 1;
+	ppmove.PM_PlaySound = World_PlaySound;
+	ppmove.PM_TraceTexture = World_TraceTexture;
+	ppmove.PM_PlaybackEventFull = World_PlaybackEventFull;
+	ppmove.PM_PlayerTraceEx = World_PlayerTraceEx;
+	ppmove.PM_TestPlayerPositionEx = World_TestPlayerPositionEx;
+	ppmove.PM_TraceLineEx = World_TraceLineEx;
+}
+
+hull_t* WorldCollision::GetHull(int usehull)
+{
+	return &m_World.hulls[WorldHullForPlayerHull[std::clamp(usehull, 0, 3)]];
+}
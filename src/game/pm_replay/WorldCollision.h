@@ -0,0 +1,58 @@
+/***
+ *
+ *	Copyright (c) 1996-2002, Valve LLC. All rights reserved.
+ *
+ *	This product contains software technology licensed from Id
+ *	Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *	All Rights Reserved.
+ *
+ *   Use, distribution, and modification of this source code and/or resulting
+ *   object code is restricted to non-commercial enhancements to products from
+ *   Valve LLC.  All other use, distribution, or modification is prohibited
+ *   without written permission from Valve LLC.
+ *
+ ****/
+
+#pragma once
+
+#include <vector>
+
+#include "Platform.h"
+#include "mathlib.h"
+#include "const.h"
+#include "com_model.h"
+#include "pm_defs.h"
+
+#include "BspLoader.h"
+
+/**
+ *	@brief Collides players with the clipping hulls of a map's world, the way the engine does.
+ *	@details Only the world is supported, which is all replays collide with.
+ *	Textures are not loaded, so @c PM_TraceTexture never finds a texture.
+ */
+class WorldCollision final
+{
+public:
+	explicit WorldCollision(const BspData& data);
+	~WorldCollision();
+
+	WorldCollision(const WorldCollision&) = delete;
+	WorldCollision& operator=(const WorldCollision&) = delete;
+
+	/**
+	 *	@brief Makes the world physics entity 0 of @p ppmove and points its engine callbacks to this object.
+	 */
+	void Install(playermove_t& ppmove);
+
+	/**
+	 *	@brief Gets the hull used by the world for a player hull number.
+	 */
+	hull_t* GetHull(int usehull);
+
+private:
+	std::vector<mplane_t> m_Planes;
+	std::vector<dclipnode_t> m_PointHullClipNodes;
+	std::vector<dclipnode_t> m_ClipNodes;
+
+	model_t m_World{};
+};
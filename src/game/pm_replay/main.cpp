@@ -0,0 +1,346 @@
+/***
+ *
+ *	Copyright (c) 1996-2002, Valve LLC. All rights reserved.
+ *
+ *	This product contains software technology licensed from Id
+ *	Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *	All Rights Reserved.
+ *
+ *   Use, distribution, and modification of this source code and/or resulting
+ *   object code is restricted to non-commercial enhancements to products from
+ *   Valve LLC.  All other use, distribution, or modification is prohibited
+ *   without written permission from Valve LLC.
+ *
+ ****/
+
+/**
+ *	@file
+ *	Replays player movement recordings made with @c pm_record without the engine.
+ *	Usage:
+ *	pm_replay --test [iterations]: replays generated movement in a generated map and checks the results against known good ones.
+ *	pm_replay <map.bsp> <recording.pmr> [iterations] [--expect <checksum>]: replays a recording against the map it was made on.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "Platform.h"
+#include "mathlib.h"
+#include "const.h"
+#include "cdll_dll.h"
+#include "in_buttons.h"
+#include "pm_defs.h"
+#include "pm_movevars.h"
+#include "pm_replay.h"
+#include "pm_shared.h"
+
+#include "BspLoader.h"
+#include "TestMap.h"
+#include "WorldCollision.h"
+
+// Time between commands in the generated recording, in milliseconds.
+constexpr int TestFrameTime = 10;
+
+// Checksum of the generated recording replayed in the generated map.
+// Update this only when a change is meant to change how players move, and say so in the commit message.
+constexpr std::uint32_t TestChecksum = 0x84e27a39;
+
+static std::optional<std::vector<std::byte>> LoadFile(const char* fileName)
+{
+	std::ifstream file{fileName, std::ios::binary};
+
+	if (!file)
+	{
+		return {};
+	}
+
+	std::vector<char> contents{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+
+	std::vector<std::byte> bytes(contents.size());
+	std::memcpy(bytes.data(), contents.data(), contents.size());
+
+	return bytes;
+}
+
+/**
+ *	@brief Creates a player with the movement code's dependencies set up to collide with @p collision.
+ */
+static std::unique_ptr<playermove_t> CreatePlayerMove(WorldCollision& collision)
+{
+	auto ppmove = std::make_unique<playermove_t>();
+
+	PM_CreateCommands();
+	PM_Init(ppmove.get());
+
+	collision.Install(*ppmove);
+
+	return ppmove;
+}
+
+static void PrintResult(const PlayerMovementRecording& recording, const PlayerMovementReplayResult& result, int iterations)
+{
+	std::printf("Replayed %zu commands %d times on \"%s\"\n", recording.Commands.size(), iterations, recording.MapName.c_str());
+	std::printf("  Time: %.1f ns/command\n", result.NsPerCommand);
+	std::printf("  Player traces: %.2f/command\n", result.PlayerTracesPerCommand);
+	std::printf("  Line traces: %.2f/command\n", result.LineTracesPerCommand);
+	std::printf("  Position tests: %.2f/command\n", result.PositionTestsPerCommand);
+	std::printf("  Point contents: %.2f/command\n", result.PointContentsPerCommand);
+	std::printf("  Checksum: %08x (%s)\n", result.Checksum, result.Deterministic ? "deterministic" : "NOT deterministic");
+	std::printf("  End origin: %.2f %.2f %.2f\n", result.EndOrigin.x, result.EndOrigin.y, result.EndOrigin.z);
+}
+
+/**
+ *	@brief Builds a recording that walks, jumps and ducks through the test map and ends up in the water.
+ */
+static std::unique_ptr<PlayerMovementRecording> CreateTestRecording(playermove_t& ppmove)
+{
+	auto recording = std::make_unique<PlayerMovementRecording>();
+	recording->MapName = "pm_replay_test";
+
+	movevars_t moveVars{};
+	moveVars.gravity = 800;
+	moveVars.stopspeed = 100;
+	moveVars.maxspeed = 320;
+	moveVars.spectatormaxspeed = 500;
+	moveVars.accelerate = 10;
+	moveVars.airaccelerate = 10;
+	moveVars.wateraccelerate = 10;
+	moveVars.friction = 4;
+	moveVars.edgefriction = 2;
+	moveVars.waterfriction = 1;
+	moveVars.entgravity = 1;
+	moveVars.bounce = 1;
+	moveVars.stepsize = 18;
+	moveVars.maxvelocity = 2000;
+	moveVars.footsteps = 1;
+
+	ppmove.movevars = &moveVars;
+	ppmove.origin = Vector(-256, 0, 36);
+	ppmove.view_ofs = VEC_VIEW;
+	ppmove.movetype = MOVETYPE_WALK;
+	ppmove.onground = -1;
+	ppmove.waterlevel = 0;
+	ppmove.watertype = CONTENTS_EMPTY;
+	ppmove.usehull = 0;
+	ppmove.gravity = 1;
+	ppmove.friction = 1;
+	ppmove.maxspeed = 320;
+	ppmove.clientmaxspeed = 320;
+
+	PM_RecordPlayerState(*recording, ppmove);
+
+	ppmove.movevars = nullptr;
+
+	int time = 0;
+	float yaw = 0;
+
+	const auto addCommands = [&](int count, float forwardmove, float sidemove, int buttons, float yawSpeed = 0)
+	{
+		for (int i = 0; i < count; ++i)
+		{
+			const Vector oldAngles{0, yaw, 0};
+
+			yaw += yawSpeed;
+			time += TestFrameTime;
+
+			RecordedPlayerMove& move = recording->Commands.emplace_back();
+			move.Time = time;
+			move.FrameTime = TestFrameTime / 1000.f;
+			move.Cmd = {};
+			move.Cmd.msec = TestFrameTime;
+			move.Cmd.viewangles = Vector(0, yaw, 0);
+			move.Cmd.forwardmove = forwardmove;
+			move.Cmd.sidemove = sidemove;
+			move.Cmd.buttons = buttons;
+			move.Angles = move.Cmd.viewangles;
+			move.OldAngles = oldAngles;
+			move.MaxSpeed = 320;
+			move.ClientMaxSpeed = 320;
+			move.Gravity = 1;
+			move.Friction = 1;
+		}
+	};
+
+	// Land, then run over the step into the pillar.
+	addCommands(100, 0, 0, 0);
+	addCommands(250, 320, 0, IN_FORWARD);
+
+	// Slide along the pillar, then jump and duck in the open.
+	addCommands(100, 320, 320, IN_FORWARD | IN_MOVERIGHT);
+	addCommands(50, 320, 0, IN_FORWARD | IN_JUMP);
+	addCommands(100, 0, 0, 0);
+	addCommands(100, 320, 0, IN_FORWARD | IN_DUCK);
+	addCommands(100, 0, 0, IN_JUMP | IN_DUCK);
+
+	// Turn around and run into the corner with the water.
+	addCommands(100, 0, 0, 0, 2.25f);
+	addCommands(400, 320, 0, IN_FORWARD);
+	addCommands(100, 0, 0, 0);
+
+	return recording;
+}
+
+static int RunTest(int iterations)
+{
+	// The room is open at the top so jumps don't hit the ceiling.
+	const TestMapBox room{{-512, -512, 0}, {512, 512, 256}};
+
+	const std::vector<TestMapBox> boxes{
+		// Step
+		{{-128, -128, 0}, {0, 128, 16}},
+		// Pillar
+		{{192, -64, 0}, {256, 64, 128}},
+		// Water
+		{{-512, -512, 0}, {-256, -256, 64}, true}};
+
+	const auto map = BspLoader::LoadFromMemory(BuildTestMap(room, boxes), true);
+
+	if (!map)
+	{
+		std::printf("Could not load the generated test map\n");
+		return EXIT_FAILURE;
+	}
+
+	WorldCollision collision{*map};
+
+	auto ppmove = CreatePlayerMove(collision);
+
+	const auto recording = CreateTestRecording(*ppmove);
+
+	const auto result = PM_ReplayRecording(*ppmove, *recording, iterations);
+
+	PrintResult(*recording, result, iterations);
+
+	bool success = true;
+
+	const auto check = [&](bool condition, const char* description)
+	{
+		if (!condition)
+		{
+			std::printf("FAILED: %s\n", description);
+			success = false;
+		}
+	};
+
+	check(result.Deterministic, "replay is deterministic");
+
+	if (result.Checksum != TestChecksum)
+	{
+		std::printf("FAILED: expected checksum %08x, movement results have changed\n", TestChecksum);
+		success = false;
+	}
+
+	Vector endOrigin = result.EndOrigin;
+
+	ppmove->usehull = 0;
+	check(ppmove->PM_TestPlayerPosition(endOrigin, nullptr) == -1, "player ends up outside of solids");
+
+	check(ppmove->PM_PointContents(endOrigin, nullptr) == CONTENTS_WATER, "player ends up in the water");
+
+	if (success)
+	{
+		std::printf("All checks passed\n");
+	}
+
+	return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static int Replay(const char* mapFileName, const char* recordingFileName, int iterations, std::optional<std::uint32_t> expectedChecksum)
+{
+	const auto mapContents = LoadFile(mapFileName);
+
+	if (!mapContents)
+	{
+		std::printf("Could not open map \"%s\"\n", mapFileName);
+		return EXIT_FAILURE;
+	}
+
+	const auto map = BspLoader::LoadFromMemory(*mapContents, true);
+
+	if (!map)
+	{
+		std::printf("\"%s\" is not a valid map\n", mapFileName);
+		return EXIT_FAILURE;
+	}
+
+	const auto recordingContents = LoadFile(recordingFileName);
+
+	if (!recordingContents)
+	{
+		std::printf("Could not open player movement recording \"%s\"\n", recordingFileName);
+		return EXIT_FAILURE;
+	}
+
+	std::string error;
+
+	const auto recording = PM_DeserializeRecording(*recordingContents, error);
+
+	if (!recording)
+	{
+		std::printf("\"%s\" is not a valid player movement recording: %s\n", recordingFileName, error.c_str());
+		return EXIT_FAILURE;
+	}
+
+	WorldCollision collision{*map};
+
+	auto ppmove = CreatePlayerMove(collision);
+
+	const auto result = PM_ReplayRecording(*ppmove, *recording, iterations);
+
+	PrintResult(*recording, result, iterations);
+
+	std::printf("  End origin is %.2f units from the recorded end origin\n", (result.EndOrigin - recording->EndOrigin).Length());
+
+	if (!result.Deterministic)
+	{
+		return EXIT_FAILURE;
+	}
+
+	if (expectedChecksum && *expectedChecksum != result.Checksum)
+	{
+		std::printf("FAILED: expected checksum %08x\n", *expectedChecksum);
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc >= 2 && 0 == std::strcmp(argv[1], "--test"))
+	{
+		return RunTest(argc >= 3 ? std::max(1, std::atoi(argv[2])) : 10);
+	}
+
+	if (argc < 3)
+	{
+		std::printf("Usage: %s --test [iterations]\n", argv[0]);
+		std::printf("       %s <map.bsp> <recording.pmr> [iterations] [--expect <checksum>]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	int iterations = 10;
+	std::optional<std::uint32_t> expectedChecksum;
+
+	for (int i = 3; i < argc; ++i)
+	{
+		if (0 == std::strcmp(argv[i], "--expect") && i + 1 < argc)
+		{
+			expectedChecksum = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 16));
+		}
+		else
+		{
+			iterations = std::max(1, std::atoi(argv[i]));
+		}
+	}
+
+	return Replay(argv[1], argv[2], iterations, expectedChecksum);
+}
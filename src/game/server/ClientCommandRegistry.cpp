@@ -2,12 +2,7 @@
 
 const ClientCommand* ClientCommandRegistry::Find(std::string_view name) const
 {
-	if (auto it = m_Commands.find(name); it != m_Commands.end())
-	{
-		return it->second.get();
-	}
-
-	return {};
+	return m_CommandLookup.Find(name);
 }
 
 const ClientCommand* ClientCommandRegistry::Create(
@@ -26,10 +21,20 @@ const ClientCommand* ClientCommandRegistry::Create(
 		return {};
 	}
 
-	auto command = std::make_unique<ClientCommand>(name, arguments.Flags, std::move(function));
+	auto stats = m_Stats.find(name);
+
+	if (stats == m_Stats.end())
+	{
+		stats = m_Stats.emplace(std::string{name}, CommandStats{}).first;
+	}
+
+	// Point the command's name at the stats key so the name outlives the caller's string.
+	auto command = std::make_unique<ClientCommand>(stats->first, arguments.Flags, std::move(function), stats->second);
 
 	const auto result = m_Commands.emplace(command->Name, std::move(command));
 
+	RebuildLookup();
+
 	return result.first->second.get();
 }
 
@@ -47,9 +52,36 @@ void ClientCommandRegistry::Remove(const ClientCommand* command)
 		it != m_Commands.end())
 	{
 		m_Commands.erase(it);
+		RebuildLookup();
 	}
 	else
 	{
 		ASSERT(!"Tried to delete a command that has already been deleted");
 	}
 }
+
+void ClientCommandRegistry::PrintStats()
+{
+	std::vector<std::pair<std::string_view, CommandStats*>> commands;
+	commands.reserve(m_Stats.size());
+
+	for (auto& [name, stats] : m_Stats)
+	{
+		commands.emplace_back(name, &stats);
+	}
+
+	PrintCommandStats(commands);
+}
+
+void ClientCommandRegistry::RebuildLookup()
+{
+	std::vector<PerfectHashTable<const ClientCommand*>::Entry> entries;
+	entries.reserve(m_Commands.size());
+
+	for (const auto& [name, command] : m_Commands)
+	{
+		entries.emplace_back(name, command.get());
+	}
+
+	m_CommandLookup.Rebuild(entries);
+}
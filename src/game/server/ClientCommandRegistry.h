@@ -3,11 +3,14 @@
 #include <algorithm>
 #include <functional>
 #include <memory>
+#include <string>
 #include <string_view>
 #include <unordered_map>
 
 #include "cbase.h"
 #include "ConCommandSystem.h"
+#include "heterogeneous_lookup.h"
+#include "PerfectHashTable.h"
 
 class CBasePlayer;
 class ClientCommandRegistry;
@@ -34,16 +37,23 @@ enum ClientCommandFlag
 class ClientCommand final
 {
 public:
-	ClientCommand(std::string_view name, ClientCommandFlags flags, std::function<void(CBasePlayer*, const CommandArgs&)>&& function)
+	ClientCommand(std::string_view name, ClientCommandFlags flags, std::function<void(CBasePlayer*, const CommandArgs&)>&& function,
+		CommandStats& stats)
 		: Name(name),
 		  Flags(flags),
-		  Function(std::move(function))
+		  Function(std::move(function)),
+		  Stats(stats)
 	{
 	}
 
 	const std::string_view Name;
 	const ClientCommandFlags Flags;
 	const std::function<void(CBasePlayer*, const CommandArgs&)> Function;
+
+	/**
+	 *	@brief Owned by the registry so stats are kept when the command is removed and created again.
+	 */
+	CommandStats& Stats;
 };
 
 /**
@@ -109,8 +119,21 @@ public:
 
 	void Remove(const ClientCommand* command);
 
+	/**
+	 *	@brief Prints how often each client command was executed and how long it took, then resets the stats.
+	 */
+	void PrintStats();
+
+private:
+	void RebuildLookup();
+
 private:
 	std::unordered_map<std::string_view, std::unique_ptr<const ClientCommand>> m_Commands;
+
+	// Rebuilt whenever a command is added or removed.
+	PerfectHashTable<const ClientCommand*> m_CommandLookup;
+
+	std::unordered_map<std::string, CommandStats, TransparentStringHash, TransparentEqual> m_Stats;
 };
 
 inline ClientCommandRegistry g_ClientCommands;
@@ -0,0 +1,487 @@
+/***
+ *
+ *	Copyright (c) 1996-2001, Valve LLC. All rights reserved.
+ *
+ *	This product contains software technology licensed from Id
+ *	Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *	All Rights Reserved.
+ *
+ *   Use, distribution, and modification of this source code and/or resulting
+ *   object code is restricted to non-commercial enhancements to products from
+ *   Valve LLC.  All other use, distribution, or modification is prohibited
+ *   without written permission from Valve LLC.
+ *
+ ****/
+
+#include <algorithm>
+#include <thread>
+
+#include "cbase.h"
+#include "com_model.h"
+#include "FullPackSnapshot.h"
+
+void FillEntityState(entity_state_t& state, int e, const edict_t* ent, bool player, const edict_t* firstEdict, int weaponModel)
+{
+	auto entity = reinterpret_cast<const CBaseEntity*>(ent->pvPrivateData);
+
+	memset(&state, 0, sizeof(state));
+
+	// Assign index so we can track this entity from frame to frame and
+	//  delta from it.
+	state.number = e;
+	state.entityType = ENTITY_NORMAL;
+
+	// Flag custom entities.
+	if ((ent->v.flags & FL_CUSTOMENTITY) != 0)
+	{
+		state.entityType = ENTITY_BEAM;
+	}
+
+	//
+	// Copy state data
+	//
+
+	// Round animtime to nearest millisecond
+	state.animtime = (int)(1000.0 * ent->v.animtime) / 1000.0;
+
+	memcpy(state.origin, ent->v.origin, 3 * sizeof(float));
+	memcpy(state.angles, ent->v.angles, 3 * sizeof(float));
+	memcpy(state.mins, ent->v.mins, 3 * sizeof(float));
+	memcpy(state.maxs, ent->v.maxs, 3 * sizeof(float));
+
+	memcpy(state.startpos, ent->v.startpos, 3 * sizeof(float));
+	memcpy(state.endpos, ent->v.endpos, 3 * sizeof(float));
+
+	state.impacttime = ent->v.impacttime;
+	state.starttime = ent->v.starttime;
+
+	state.modelindex = ent->v.modelindex;
+
+	state.frame = ent->v.frame;
+
+	state.skin = ent->v.skin;
+	state.effects = ent->v.effects;
+
+	if ((ent->v.flags & FL_FLY) != 0)
+	{
+		state.eflags |= EFLAG_SLERP;
+	}
+	else
+	{
+		state.eflags &= ~EFLAG_SLERP;
+	}
+
+	state.eflags |= entity->m_EFlags;
+
+	state.scale = ent->v.scale;
+	state.solid = ent->v.solid;
+	state.colormap = ent->v.colormap;
+
+	state.movetype = ent->v.movetype;
+	state.sequence = ent->v.sequence;
+	state.framerate = ent->v.framerate;
+	state.body = ent->v.body;
+
+	for (int i = 0; i < 4; i++)
+	{
+		state.controller[i] = ent->v.controller[i];
+	}
+
+	for (int i = 0; i < 2; i++)
+	{
+		state.blending[i] = ent->v.blending[i];
+	}
+
+	state.rendermode = ent->v.rendermode;
+	state.renderamt = ent->v.renderamt;
+	state.renderfx = ent->v.renderfx;
+	state.rendercolor.r = ent->v.rendercolor.x;
+	state.rendercolor.g = ent->v.rendercolor.y;
+	state.rendercolor.b = ent->v.rendercolor.z;
+
+	state.aiment = 0;
+	if (ent->v.aiment)
+	{
+		state.aiment = static_cast<int>(ent->v.aiment - firstEdict);
+	}
+
+	state.owner = 0;
+	if (ent->v.owner)
+	{
+		const int owner = static_cast<int>(ent->v.owner - firstEdict);
+
+		// Only care if owned by a player
+		if (owner >= 1 && owner <= gpGlobals->maxClients)
+		{
+			state.owner = owner;
+		}
+	}
+
+	// HACK:  Somewhat...
+	// Class is overridden for non-players to signify a breakable glass object ( sort of a class? )
+	if (!player)
+	{
+		state.playerclass = ent->v.playerclass;
+	}
+
+	// Special stuff for players only
+	if (player)
+	{
+		memcpy(state.basevelocity, ent->v.basevelocity, 3 * sizeof(float));
+
+		state.weaponmodel = weaponModel;
+		state.gaitsequence = ent->v.gaitsequence;
+		state.spectator = ent->v.flags & FL_SPECTATOR;
+		state.friction = ent->v.friction;
+
+		state.gravity = ent->v.gravity;
+		//		state.team			= ent->v.team;
+		//
+		state.usehull = (ent->v.flags & FL_DUCKING) != 0 ? 1 : 0;
+		state.health = ent->v.health;
+	}
+}
+
+Vector GetVisibilityOrigin(const edict_t* view)
+{
+	Vector org = view->v.origin + view->v.view_ofs;
+
+	if ((view->v.flags & FL_DUCKING) != 0)
+	{
+		org = org + (VEC_HULL_MIN - VEC_DUCK_HULL_MIN);
+	}
+
+	return org;
+}
+
+PackDecision DecidePack(const edict_t* ent, const edict_t* host, const unsigned char* pSet, std::size_t setBytes)
+{
+	// don't send if flagged for NODRAW and it's not the host getting the message
+	if ((ent->v.effects & EF_NODRAW) != 0 &&
+		(ent != host))
+		return PackDecision::Skip;
+
+	// Ignore ents without valid / visible models
+	if (0 == ent->v.modelindex || !STRING(ent->v.model))
+		return PackDecision::Skip;
+
+	// Don't send spectators to other players
+	if ((ent->v.flags & FL_SPECTATOR) != 0 && (ent != host))
+	{
+		return PackDecision::Skip;
+	}
+
+	// Only send entities that share a group with the host.
+	// This used to go through UTIL_SetGroupTrace, which also changed the engine's trace group mask
+	// and left it set for entities that were filtered out.
+	if (0 != host->v.groupinfo && 0 != ent->v.groupinfo)
+	{
+		if ((ent->v.groupinfo & host->v.groupinfo) == 0)
+			return PackDecision::Skip;
+	}
+
+	// Ignore if not the host and not touching a PVS/PAS leaf
+	// If pSet is nullptr, then the test will always succeed and the entity will be added to the update
+	if (ent == host || !pSet)
+	{
+		return PackDecision::Send;
+	}
+
+	// Entities that are too big to list their leafs are tested by walking the BSP tree.
+	if (ent->headnode >= 0)
+	{
+		return PackDecision::CheckVisibility;
+	}
+
+	// Same test as the engine's.
+	for (int i = 0; i < ent->num_leafs && i < MAX_ENT_LEAFS; ++i)
+	{
+		const int leaf = ent->leafnums[i];
+
+		if (leaf < 0 || static_cast<std::size_t>(leaf >> 3) >= setBytes)
+		{
+			return PackDecision::CheckVisibility;
+		}
+
+		if ((pSet[leaf >> 3] & (1 << (leaf & 7))) != 0)
+		{
+			return PackDecision::Send;
+		}
+	}
+
+	return PackDecision::Skip;
+}
+
+bool FullPackSnapshot::Initialize()
+{
+	m_Mode = g_ConCommands.CreateCVar("fullpack_snapshot", "1");
+	return true;
+}
+
+void FullPackSnapshot::Shutdown()
+{
+	m_Pool.Stop();
+}
+
+void FullPackSnapshot::RunFrame()
+{
+	NewPhase();
+	m_LastClientIndex = 0;
+}
+
+void FullPackSnapshot::SetWorldVisLeafCount(std::size_t count)
+{
+	// The engine's PVS and PAS buffers are this big no matter how many leafs the map has.
+	constexpr std::size_t EngineVisBufferSize = 1024;
+
+	m_VisBytes = std::min((count + 31) >> 3, EngineVisBufferSize);
+
+	// Update times from the previous map don't say anything about the clients in this one.
+	m_Clients = {};
+	m_CurrentClient = nullptr;
+}
+
+void FullPackSnapshot::BeginClient(const edict_t* client, const edict_t* view)
+{
+	// Clients are updated in index order, so going back to a lower index means a new send phase started.
+	// This happens when the game is paused, since RunFrame isn't called then.
+	const int index = ENTINDEX(client);
+
+	if (index <= m_LastClientIndex)
+	{
+		NewPhase();
+	}
+
+	m_LastClientIndex = index;
+	m_CurrentClient = nullptr;
+
+	if (index < 1 || index > MAX_PLAYERS)
+	{
+		return;
+	}
+
+	const auto now = Clock::now();
+
+	if (m_Mode->value >= 2 && m_PrecomputedPhase != m_Phase)
+	{
+		m_PrecomputedPhase = m_Phase;
+		PrecomputeSendPhase(now);
+	}
+
+	auto& visibility = m_Clients[index - 1];
+
+	if (visibility.LastUpdateTime != Clock::time_point{})
+	{
+		visibility.UpdateInterval = now - visibility.LastUpdateTime;
+	}
+
+	visibility.LastUpdateTime = now;
+
+	// If the view changed since the send phase started, the decisions were made for the wrong PVS.
+	if (visibility.Precomputed && visibility.View == view)
+	{
+		m_CurrentClient = &visibility;
+	}
+
+	visibility.View = view;
+}
+
+bool FullPackSnapshot::GetPrecomputedVisibility(const Vector& origin, unsigned char** pvs, unsigned char** pas)
+{
+	if (!m_CurrentClient)
+	{
+		return false;
+	}
+
+	if (m_CurrentClient->Origin != origin)
+	{
+		m_CurrentClient = nullptr;
+		return false;
+	}
+
+	*pvs = m_CurrentClient->Pvs.data();
+	*pas = m_CurrentClient->Pas.data();
+
+	return true;
+}
+
+PackDecision FullPackSnapshot::GetPackDecision(int e, const edict_t* ent, const edict_t* host, const unsigned char* pSet) const
+{
+	if (m_CurrentClient && pSet && pSet == m_CurrentClient->Pvs.data() &&
+		e >= 0 && static_cast<std::size_t>(e) < m_CurrentClient->Decisions.size())
+	{
+		return m_CurrentClient->Decisions[e];
+	}
+
+	// Without a copy of the set its size isn't known, so let the engine test visibility.
+	return DecidePack(ent, host, pSet, 0);
+}
+
+const entity_state_t* FullPackSnapshot::GetEntityState(int e, const edict_t* ent, bool player)
+{
+	if (m_Mode->value <= 0)
+	{
+		return nullptr;
+	}
+
+	if (e < 0 || e >= MAX_EDICTS)
+	{
+		return nullptr;
+	}
+
+	if (m_Entries.size() <= static_cast<std::size_t>(e))
+	{
+		m_Entries.resize(std::max(static_cast<std::size_t>(e) + 1, static_cast<std::size_t>(gpGlobals->maxEntities)));
+	}
+
+	auto& entry = m_Entries[e];
+
+	if (entry.Phase != m_Phase)
+	{
+		FillEntityState(entry.State, e, ent, player, INDEXENT(0),
+			player ? MODEL_INDEX(STRING(ent->v.weaponmodel)) : 0);
+		entry.Phase = m_Phase;
+	}
+
+	return &entry.State;
+}
+
+void FullPackSnapshot::NewPhase()
+{
+	++m_Phase;
+
+	// Entries stamped with a phase from before the wrap would look up to date again.
+	if (m_Phase == 0)
+	{
+		for (auto& entry : m_Entries)
+		{
+			entry.Phase = 0;
+		}
+
+		m_Phase = 1;
+		m_PrecomputedPhase = 0;
+	}
+
+	for (auto& visibility : m_Clients)
+	{
+		visibility.Precomputed = false;
+	}
+
+	m_CurrentClient = nullptr;
+}
+
+void FullPackSnapshot::PrecomputeSendPhase(Clock::time_point now)
+{
+	if (m_LastPrecomputeTime != Clock::time_point{})
+	{
+		m_FrameInterval = now - m_LastPrecomputeTime;
+	}
+
+	m_LastPrecomputeTime = now;
+
+	if (m_VisBytes == 0)
+	{
+		return;
+	}
+
+	const edict_t* firstEdict = INDEXENT(0);
+	const int maxClients = std::min(gpGlobals->maxClients, MAX_PLAYERS);
+	const std::size_t entityCount = std::min(gpGlobals->maxEntities, MAX_EDICTS);
+
+	if (m_Entries.size() < entityCount)
+	{
+		m_Entries.resize(entityCount);
+	}
+
+	// Everything that needs the engine is done here, before the workers start.
+	m_DueClients.clear();
+
+	for (int i = 1; i <= maxClients; ++i)
+	{
+		const edict_t* client = firstEdict + i;
+
+		m_WeaponModels[i] = !client->free ? MODEL_INDEX(STRING(client->v.weaponmodel)) : 0;
+
+		auto& visibility = m_Clients[i - 1];
+
+		// The engine doesn't send updates to bots, and proxies see everything so there is nothing to copy.
+		if (client->free || !client->pvPrivateData ||
+			(client->v.flags & FL_CLIENT) == 0 || (client->v.flags & (FL_FAKECLIENT | FL_PROXY)) != 0 ||
+			!IsUpdateDue(visibility, now))
+		{
+			continue;
+		}
+
+		const edict_t* view = visibility.View && !visibility.View->free ? visibility.View : client;
+
+		visibility.View = view;
+		visibility.Origin = GetVisibilityOrigin(view);
+
+		const auto pvs = ENGINE_SET_PVS(visibility.Origin);
+		visibility.Pvs.assign(pvs, pvs + m_VisBytes);
+
+		const auto pas = ENGINE_SET_PAS(visibility.Origin);
+		visibility.Pas.assign(pas, pas + m_VisBytes);
+
+		visibility.Decisions.resize(entityCount);
+		visibility.Precomputed = true;
+
+		m_DueClients.push_back(i);
+	}
+
+	if (!m_Pool.IsRunning())
+	{
+		m_Pool.Start(std::clamp(std::thread::hardware_concurrency(), 2u, 8u) - 1);
+	}
+
+	const std::size_t entityJobs = (entityCount + EntitiesPerJob - 1) / EntitiesPerJob;
+
+	m_Pool.Run(entityJobs + m_DueClients.size(), [&](std::size_t job)
+		{
+			if (job < entityJobs)
+			{
+				const std::size_t end = std::min((job + 1) * EntitiesPerJob, entityCount);
+
+				for (std::size_t e = job * EntitiesPerJob; e < end; ++e)
+				{
+					const edict_t* ent = firstEdict + e;
+
+					if (ent->free || !ent->pvPrivateData || 0 == ent->v.modelindex)
+					{
+						continue;
+					}
+
+					const bool player = e >= 1 && e <= static_cast<std::size_t>(maxClients);
+
+					auto& entry = m_Entries[e];
+					FillEntityState(entry.State, static_cast<int>(e), ent, player, firstEdict, player ? m_WeaponModels[e] : 0);
+					entry.Phase = m_Phase;
+				}
+			}
+			else
+			{
+				const int index = m_DueClients[job - entityJobs];
+				const edict_t* host = firstEdict + index;
+				auto& visibility = m_Clients[index - 1];
+
+				visibility.Decisions[0] = PackDecision::Skip;
+
+				for (std::size_t e = 1; e < entityCount; ++e)
+				{
+					visibility.Decisions[e] = DecidePack(firstEdict + e, host, visibility.Pvs.data(), m_VisBytes);
+				}
+			}
+		});
+}
+
+bool FullPackSnapshot::IsUpdateDue(const ClientVisibility& client, Clock::time_point now) const
+{
+	// Clients that haven't been updated yet may be due, better to do the work for nothing than to miss it.
+	if (client.LastUpdateTime == Clock::time_point{} || client.UpdateInterval == Clock::duration{})
+	{
+		return true;
+	}
+
+	// The engine's clock doesn't tick at the same time as this one, so allow for half a frame either way.
+	return now - client.LastUpdateTime + m_FrameInterval / 2 >= client.UpdateInterval;
+}
@@ -0,0 +1,179 @@
+/***
+ *
+ *	Copyright (c) 1996-2001, Valve LLC. All rights reserved.
+ *
+ *	This product contains software technology licensed from Id
+ *	Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *	All Rights Reserved.
+ *
+ *   Use, distribution, and modification of this source code and/or resulting
+ *   object code is restricted to non-commercial enhancements to products from
+ *   Valve LLC.  All other use, distribution, or modification is prohibited
+ *   without written permission from Valve LLC.
+ *
+ ****/
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "cbase.h"
+#include "entity_state.h"
+#include "GameSystem.h"
+#include "WorkerPool.h"
+
+/**
+ *	@brief Fills in the parts of an entity's network state that are the same for every client.
+ *	@details Only reads the entity, so it can be used on worker threads.
+ *	@param firstEdict The world's edict, used to convert edict pointers to indices.
+ *	@param weaponModel Model index of the entity's weapon model, only used for players.
+ */
+void FillEntityState(entity_state_t& state, int e, const edict_t* ent, bool player, const edict_t* firstEdict, int weaponModel);
+
+/**
+ *	@brief Gets the eye position of a view entity, used to set up a client's PVS and PAS.
+ */
+Vector GetVisibilityOrigin(const edict_t* view);
+
+enum class PackDecision : std::uint8_t
+{
+	Skip,
+	Send,
+
+	// Send only if the engine says the entity is in the PVS or PAS.
+	CheckVisibility
+};
+
+/**
+ *	@brief Runs the @c AddToFullPack filters that only depend on the entity, the host and the PVS or PAS.
+ *	@details Only reads the entities and @p pSet, so it can be used on worker threads.
+ *	Visibility tests that can't be done with the first @p setBytes bytes of @p pSet are left to the engine.
+ *	@param pSet The host's PVS or PAS, or @c nullptr if the host sees everything.
+ */
+PackDecision DecidePack(const edict_t* ent, const edict_t* host, const unsigned char* pSet, std::size_t setBytes);
+
+/**
+ *	@brief Builds the network state of each entity once per send phase instead of once for every client that sees it.
+ *	@details The engine sends updates to each client in turn, calling @c AddToFullPack for every entity the client could see.
+ *	No game code runs while updates are being sent, so the state of each entity is the same for every client.
+ *	An entity's state is built the first time a client sees it in a send phase and copied after that,
+ *	so this never does more work than building it for each client.
+ *
+ *	In parallel mode, all of the work that doesn't need the engine is done on a worker pool when the send phase starts:
+ *	the state of every entity and, for every client that is due an update, which entities pass the @c AddToFullPack filters.
+ *	The engine only updates clients whose update interval has elapsed, so which clients are due is predicted from
+ *	the times at which they were updated before. Their PVS and PAS are copied so they can be tested on worker threads.
+ *	A client that turns out not to be due only costs some wasted work, and a client that is due without being predicted,
+ *	or whose view changed, is handled the same way as in the other modes.
+ */
+class FullPackSnapshot final : public IGameSystem
+{
+public:
+	const char* GetName() const override { return "FullPackSnapshot"; }
+
+	bool Initialize() override;
+
+	void PostInitialize() override {}
+
+	void Shutdown() override;
+
+	/**
+	 *	@brief Invalidates the snapshot. Call once per frame before entities think.
+	 */
+	void RunFrame();
+
+	/**
+	 *	@brief Sets the number of world leafs with visibility data in the current map.
+	 */
+	void SetWorldVisLeafCount(std::size_t count);
+
+	/**
+	 *	@brief Called when the engine starts building an update for a client.
+	 *	@param view The entity the client sees from.
+	 */
+	void BeginClient(const edict_t* client, const edict_t* view);
+
+	/**
+	 *	@brief Gets the PVS and PAS copied for the current client if its pack decisions were made in advance.
+	 *	@return @c false if the engine has to set up the client's PVS and PAS.
+	 */
+	bool GetPrecomputedVisibility(const Vector& origin, unsigned char** pvs, unsigned char** pas);
+
+	/**
+	 *	@brief Gets the decision made in advance for an entity, or runs the filters if there is none.
+	 */
+	PackDecision GetPackDecision(int e, const edict_t* ent, const edict_t* host, const unsigned char* pSet) const;
+
+	/**
+	 *	@brief Gets the state of an entity for this send phase, building it if this is the first request for it.
+	 *	@return The state, or @c nullptr if the snapshot is disabled.
+	 */
+	const entity_state_t* GetEntityState(int e, const edict_t* ent, bool player);
+
+private:
+	struct Entry
+	{
+		// Send phase the state was built in.
+		unsigned int Phase = 0;
+		entity_state_t State;
+	};
+
+	using Clock = std::chrono::steady_clock;
+
+	struct ClientVisibility
+	{
+		// Time and view of the last update the engine built for this client.
+		Clock::time_point LastUpdateTime;
+		Clock::duration UpdateInterval{};
+		const edict_t* View{};
+
+		// Whether pack decisions were made for this client in the current send phase.
+		bool Precomputed = false;
+		Vector Origin;
+		std::vector<unsigned char> Pvs;
+		std::vector<unsigned char> Pas;
+		std::vector<PackDecision> Decisions;
+	};
+
+	void NewPhase();
+
+	/**
+	 *	@brief Copies the PVS and PAS of every client that is due an update and makes all entity states and pack decisions.
+	 */
+	void PrecomputeSendPhase(Clock::time_point now);
+
+	bool IsUpdateDue(const ClientVisibility& client, Clock::time_point now) const;
+
+private:
+	// Entities handled by each job in parallel mode.
+	static constexpr std::size_t EntitiesPerJob = 64;
+
+	cvar_t* m_Mode{};
+
+	unsigned int m_Phase = 1;
+	int m_LastClientIndex = 0;
+
+	std::vector<Entry> m_Entries;
+
+	std::size_t m_VisBytes = 0;
+
+	unsigned int m_PrecomputedPhase = 0;
+	Clock::time_point m_LastPrecomputeTime;
+	Clock::duration m_FrameInterval{};
+
+	std::array<ClientVisibility, MAX_PLAYERS> m_Clients;
+
+	// Client whose update is being built, if its pack decisions were made in advance.
+	ClientVisibility* m_CurrentClient{};
+
+	std::vector<int> m_DueClients;
+	std::array<int, MAX_PLAYERS + 1> m_WeaponModels{};
+
+	WorkerPool m_Pool;
+};
+
+inline FullPackSnapshot g_FullPackSnapshot;
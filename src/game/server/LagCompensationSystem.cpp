@@ -0,0 +1,445 @@
+/***
+ *
+ *	Copyright (c) 1996-2001, Valve LLC. All rights reserved.
+ *
+ *	This product contains software technology licensed from Id
+ *	Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *	All Rights Reserved.
+ *
+ *   Use, distribution, and modification of this source code and/or resulting
+ *   object code is restricted to non-commercial enhancements to products from
+ *   Valve LLC.  All other use, distribution, or modification is prohibited
+ *   without written permission from Valve LLC.
+ *
+ ****/
+
+#include <algorithm>
+
+#include "cbase.h"
+#include "LagCompensationSystem.h"
+
+/**
+ *	@brief Minimum time between snapshots, so the history covers about a second regardless of the server frame rate.
+ */
+constexpr float LagCompensationRecordInterval = 1.f / 64;
+
+/**
+ *	@brief Maximum number of entities that have a history at any time.
+ */
+constexpr std::size_t LagCompensationMaxEntities = 512;
+
+// Don't bother rewinding if the player is seeing the world as it is now.
+constexpr float LagCompensationMinLatency = 0.005f;
+
+static double ToMilliseconds(std::chrono::steady_clock::duration time)
+{
+	return std::chrono::duration<double, std::milli>(time).count();
+}
+
+bool LagCompensationSystem::Initialize()
+{
+	m_Enabled = g_ConCommands.CreateCVar("lagcomp_npc", "1");
+
+	g_ConCommands.CreateCommand("lagcomp_npc_stats", [this](const auto&)
+		{ PrintStats(); });
+
+	m_Histories.resize(LagCompensationMaxEntities);
+
+	m_FreeSlots.reserve(LagCompensationMaxEntities);
+
+	// Hand out low slots first.
+	for (int i = LagCompensationMaxEntities - 1; i >= 0; --i)
+	{
+		m_FreeSlots.push_back(i);
+	}
+
+	return true;
+}
+
+void LagCompensationSystem::RunFrame()
+{
+	// Handle level changes.
+	if (gpGlobals->time < m_LastUpdateTime)
+	{
+		ReleaseAllSlots();
+		m_PlayerInterpolation.fill(0);
+	}
+
+	m_LastUpdateTime = gpGlobals->time;
+
+	++m_FrameNumber;
+
+	if (m_CurrentFrameTime != std::chrono::steady_clock::duration::zero())
+	{
+		++m_Stats.Frames;
+		m_Stats.Time += m_CurrentFrameTime;
+		m_Stats.MaxFrameTime = std::max(m_Stats.MaxFrameTime, m_CurrentFrameTime);
+		m_CurrentFrameTime = {};
+	}
+
+	if (m_Enabled->value == 0 || !g_pGameRules->IsMultiplayer())
+	{
+		// Histories would have a gap if this is enabled again, so interpolating across it would be wrong.
+		ReleaseAllSlots();
+		return;
+	}
+
+	m_SlotByEntity.resize(gpGlobals->maxEntities, -1);
+
+	auto edicts = g_engfuncs.pfnPEntityOfEntIndexAllEntities(0);
+
+	// Players are lag compensated by the engine.
+	for (int index = gpGlobals->maxClients + 1; index < gpGlobals->maxEntities; ++index)
+	{
+		if (0 != edicts[index].free)
+		{
+			continue;
+		}
+
+		auto entity = static_cast<CBaseEntity*>(GET_PRIVATE(&edicts[index]));
+
+		if (!entity || !ShouldTrack(entity))
+		{
+			continue;
+		}
+
+		int slot = m_SlotByEntity[index];
+
+		if (slot != -1 && m_Histories[slot].Entity.Get() != entity)
+		{
+			// The edict was reused by another entity.
+			ReleaseSlot(index);
+			slot = -1;
+		}
+
+		if (slot == -1)
+		{
+			if (m_FreeSlots.empty())
+			{
+				continue;
+			}
+
+			slot = m_FreeSlots.back();
+			m_FreeSlots.pop_back();
+
+			m_SlotByEntity[index] = slot;
+
+			auto& history = m_Histories[slot];
+			history.Entity = entity;
+			history.Count = 0;
+			history.Head = 0;
+		}
+
+		auto& history = m_Histories[slot];
+
+		history.LastRecordedFrame = m_FrameNumber;
+
+		if (history.Count > 0 && gpGlobals->time - history.Snapshots[history.Head].Time < LagCompensationRecordInterval)
+		{
+			continue;
+		}
+
+		history.Head = (history.Head + 1) % HistorySize;
+		history.Snapshots[history.Head] = TakeSnapshot(entity, gpGlobals->time);
+		history.Count = std::min(history.Count + 1, HistorySize);
+	}
+
+	// Free the histories of entities that were removed or can no longer be hit.
+	for (std::size_t index = 0; index < m_SlotByEntity.size(); ++index)
+	{
+		if (const int slot = m_SlotByEntity[index]; slot != -1 && m_Histories[slot].LastRecordedFrame != m_FrameNumber)
+		{
+			ReleaseSlot(index);
+		}
+	}
+}
+
+void LagCompensationSystem::SetPlayerInterpolation(CBasePlayer* player, int lerpMsec)
+{
+	m_PlayerInterpolation[player->entindex()] = std::max(0, lerpMsec) / 1000.f;
+}
+
+void LagCompensationSystem::StartLagCompensation(CBasePlayer* player, float range)
+{
+	// Nested calls keep the existing rewind until the outermost call finishes.
+	if (m_RewindDepth++ > 0)
+	{
+		return;
+	}
+
+	m_RewoundEntities.clear();
+
+	if (!player || m_Enabled->value == 0 || !g_pGameRules->IsMultiplayer() || player->IsBot())
+	{
+		return;
+	}
+
+	// Respect the client's choice to disable lag compensation.
+	if (atoi(g_engfuncs.pfnInfoKeyValue(g_engfuncs.pfnGetInfoKeyBuffer(player->edict()), "cl_lc")) == 0)
+	{
+		return;
+	}
+
+	int ping, packetLoss;
+	PLAYER_CNX_STATS(player->edict(), &ping, &packetLoss);
+
+	const float maxUnlag = CVAR_GET_FLOAT("sv_maxunlag");
+
+	const float latency = std::clamp(ping / 1000.f + m_PlayerInterpolation[player->entindex()], 0.f, maxUnlag);
+
+	if (latency < LagCompensationMinLatency)
+	{
+		return;
+	}
+
+	const auto startTime = std::chrono::steady_clock::now();
+
+	const float targetTime = gpGlobals->time - latency;
+	const Vector eyes = player->EyePosition();
+
+	for (std::size_t index = 0; index < m_SlotByEntity.size(); ++index)
+	{
+		const int slot = m_SlotByEntity[index];
+
+		if (slot == -1)
+		{
+			continue;
+		}
+
+		const auto& history = m_Histories[slot];
+		auto entity = history.Entity.Get();
+
+		if (!entity || entity == player)
+		{
+			continue;
+		}
+
+		Snapshot rewound;
+
+		if (!FindSnapshot(history, targetTime, rewound))
+		{
+			continue;
+		}
+
+		// Only rewind entities the attack could reach.
+		// Measured from the center of the bounds since monster origins are at their feet and brush entity origins can be anywhere.
+		const Vector center = rewound.Origin + (rewound.Mins + rewound.Maxs) * 0.5f;
+		const float radius = (rewound.Maxs - rewound.Mins).Length() * 0.5f;
+
+		if ((center - eyes).Length() > range + radius)
+		{
+			continue;
+		}
+
+		auto& rewoundEntity = m_RewoundEntities.emplace_back();
+		rewoundEntity.Entity = entity;
+		rewoundEntity.Original = TakeSnapshot(entity, gpGlobals->time);
+		rewoundEntity.Rewound = rewound;
+
+		ApplySnapshot(entity, rewound);
+	}
+
+	++m_Stats.Rewinds;
+	m_Stats.EntitiesRewound += m_RewoundEntities.size();
+
+	m_CurrentFrameTime += std::chrono::steady_clock::now() - startTime;
+}
+
+void LagCompensationSystem::FinishLagCompensation()
+{
+	if (m_RewindDepth == 0)
+	{
+		return;
+	}
+
+	if (--m_RewindDepth > 0)
+	{
+		return;
+	}
+
+	if (m_RewoundEntities.empty())
+	{
+		return;
+	}
+
+	const auto startTime = std::chrono::steady_clock::now();
+
+	// Restore in reverse order in case an entity was rewound more than once.
+	for (auto it = m_RewoundEntities.rbegin(); it != m_RewoundEntities.rend(); ++it)
+	{
+		auto entity = it->Entity.Get();
+
+		if (!entity)
+		{
+			continue;
+		}
+
+		// Attacks can change an entity's state, for example when it dies. Only restore what is still rewound.
+		auto restored = TakeSnapshot(entity, gpGlobals->time);
+
+		if (restored.Origin == it->Rewound.Origin)
+			restored.Origin = it->Original.Origin;
+
+		if (restored.Angles == it->Rewound.Angles)
+			restored.Angles = it->Original.Angles;
+
+		if (restored.Mins == it->Rewound.Mins && restored.Maxs == it->Rewound.Maxs)
+		{
+			restored.Mins = it->Original.Mins;
+			restored.Maxs = it->Original.Maxs;
+		}
+
+		if (restored.Sequence == it->Rewound.Sequence && restored.Frame == it->Rewound.Frame)
+		{
+			restored.Sequence = it->Original.Sequence;
+			restored.Frame = it->Original.Frame;
+		}
+
+		ApplySnapshot(entity, restored);
+	}
+
+	m_RewoundEntities.clear();
+
+	m_CurrentFrameTime += std::chrono::steady_clock::now() - startTime;
+}
+
+bool LagCompensationSystem::ShouldTrack(CBaseEntity* entity)
+{
+	if (entity->pev->takedamage == DAMAGE_NO || entity->pev->solid == SOLID_NOT || entity->pev->solid == SOLID_TRIGGER)
+	{
+		return false;
+	}
+
+	if ((entity->pev->flags & FL_MONSTER) != 0)
+	{
+		return true;
+	}
+
+	// Doors, trains and other pushers can't be moved without moving what they carry.
+	return entity->pev->movetype != MOVETYPE_NONE && entity->pev->movetype != MOVETYPE_PUSH;
+}
+
+LagCompensationSystem::Snapshot LagCompensationSystem::TakeSnapshot(CBaseEntity* entity, float time)
+{
+	return {
+		.Time = time,
+		.Origin = entity->pev->origin,
+		.Angles = entity->pev->angles,
+		.Mins = entity->pev->mins,
+		.Maxs = entity->pev->maxs,
+		.Sequence = entity->pev->sequence,
+		.Frame = entity->pev->frame};
+}
+
+void LagCompensationSystem::ApplySnapshot(CBaseEntity* entity, const Snapshot& snapshot)
+{
+	entity->pev->angles = snapshot.Angles;
+	entity->pev->sequence = snapshot.Sequence;
+	entity->pev->frame = snapshot.Frame;
+
+	// Relinks the entity so traces see the new bounds.
+	entity->SetSize(snapshot.Mins, snapshot.Maxs);
+	entity->SetOrigin(snapshot.Origin);
+}
+
+bool LagCompensationSystem::FindSnapshot(const History& history, float time, Snapshot& result)
+{
+	if (history.Count == 0)
+	{
+		return false;
+	}
+
+	const auto& newest = history.Snapshots[history.Head];
+
+	// Already up to date.
+	if (time >= newest.Time)
+	{
+		return false;
+	}
+
+	// Walk back from the newest snapshot until we find the one right before the target time.
+	const Snapshot* newer = &newest;
+
+	for (std::size_t i = 1; i < history.Count; ++i)
+	{
+		const auto& older = history.Snapshots[(history.Head + HistorySize - i) % HistorySize];
+
+		if (older.Time <= time)
+		{
+			const float fraction = (time - older.Time) / (newer->Time - older.Time);
+
+			result = older;
+			result.Time = time;
+			result.Origin = older.Origin + (newer->Origin - older.Origin) * fraction;
+			result.Mins = older.Mins + (newer->Mins - older.Mins) * fraction;
+			result.Maxs = older.Maxs + (newer->Maxs - older.Maxs) * fraction;
+
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				result.Angles[axis] = older.Angles[axis] + UTIL_AngleDistance(newer->Angles[axis], older.Angles[axis]) * fraction;
+			}
+
+			// Can't blend between sequences.
+			if (older.Sequence == newer->Sequence && newer->Frame >= older.Frame)
+			{
+				result.Frame = older.Frame + (newer->Frame - older.Frame) * fraction;
+			}
+
+			return true;
+		}
+
+		newer = &older;
+	}
+
+	// Older than the history, use the oldest state we have.
+	result = *newer;
+	return true;
+}
+
+void LagCompensationSystem::ReleaseSlot(int entityIndex)
+{
+	const int slot = m_SlotByEntity[entityIndex];
+
+	m_Histories[slot].Entity = nullptr;
+	m_FreeSlots.push_back(slot);
+
+	m_SlotByEntity[entityIndex] = -1;
+}
+
+void LagCompensationSystem::ReleaseAllSlots()
+{
+	if (m_FreeSlots.size() == m_Histories.size())
+	{
+		return;
+	}
+
+	for (std::size_t i = 0; i < m_SlotByEntity.size(); ++i)
+	{
+		if (m_SlotByEntity[i] != -1)
+		{
+			ReleaseSlot(i);
+		}
+	}
+}
+
+void LagCompensationSystem::PrintStats()
+{
+	const std::size_t trackedCount = m_Histories.size() - m_FreeSlots.size();
+
+	Con_Printf("NPC lag compensation: %s, %zu/%zu entities tracked\n",
+		m_Enabled->value != 0 ? "enabled" : "disabled", trackedCount, m_Histories.size());
+
+	if (m_Stats.Frames > 0)
+	{
+		Con_Printf("%d rewinds over %d frames with rewinds (%d entities rewound)\n",
+			m_Stats.Rewinds, m_Stats.Frames, m_Stats.EntitiesRewound);
+		Con_Printf("Cost per frame: %.3f ms average, %.3f ms max\n",
+			ToMilliseconds(m_Stats.Time) / m_Stats.Frames, ToMilliseconds(m_Stats.MaxFrameTime));
+	}
+	else
+	{
+		Con_Printf("No rewinds since the last report\n");
+	}
+
+	m_Stats = {};
+}
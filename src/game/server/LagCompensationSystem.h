@@ -0,0 +1,139 @@
+/***
+ *
+ *	Copyright (c) 1996-2001, Valve LLC. All rights reserved.
+ *
+ *	This product contains software technology licensed from Id
+ *	Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *	All Rights Reserved.
+ *
+ *   Use, distribution, and modification of this source code and/or resulting
+ *   object code is restricted to non-commercial enhancements to products from
+ *   Valve LLC.  All other use, distribution, or modification is prohibited
+ *   without written permission from Valve LLC.
+ *
+ ****/
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <vector>
+
+#include "cbase.h"
+#include "GameSystem.h"
+
+class CBasePlayer;
+
+/**
+ *	@brief Rewinds NPCs and other damageable non-player entities to where a player saw them when they attacked.
+ *	@details The engine only lag compensates players. This system records a short history of every entity that can be hit
+ *	so bullet and melee traces can be done against the positions the attacking player was seeing.
+ */
+class LagCompensationSystem final : public IGameSystem
+{
+public:
+	const char* GetName() const override { return "LagCompensation"; }
+
+	bool Initialize() override;
+
+	void PostInitialize() override {}
+
+	void Shutdown() override {}
+
+	/**
+	 *	@brief Records the current state of all tracked entities. Call once per frame.
+	 */
+	void RunFrame();
+
+	/**
+	 *	@brief Stores the player's interpolation time, sent with each user command.
+	 */
+	void SetPlayerInterpolation(CBasePlayer* player, int lerpMsec);
+
+	/**
+	 *	@brief Moves entities within @p range of the player back to where the player saw them.
+	 *	Must be followed by a call to FinishLagCompensation.
+	 *	Calls can be nested, entities are restored when the outermost call finishes.
+	 */
+	void StartLagCompensation(CBasePlayer* player, float range);
+
+	/**
+	 *	@brief Moves entities moved by StartLagCompensation back to their current state.
+	 */
+	void FinishLagCompensation();
+
+private:
+	struct Snapshot
+	{
+		float Time;
+		Vector Origin;
+		Vector Angles;
+		Vector Mins;
+		Vector Maxs;
+		int Sequence;
+		float Frame;
+	};
+
+	// Enough to cover about a second.
+	static constexpr std::size_t HistorySize = 64;
+
+	struct History
+	{
+		EHANDLE Entity;
+		int LastRecordedFrame = 0;
+		std::size_t Count = 0;
+		std::size_t Head = 0; //!< Index of the newest snapshot
+		std::array<Snapshot, HistorySize> Snapshots;
+	};
+
+	struct RewoundEntity
+	{
+		EHANDLE Entity;
+		Snapshot Original;
+		Snapshot Rewound;
+	};
+
+	struct Stats
+	{
+		int Frames = 0;
+		int Rewinds = 0;
+		int EntitiesRewound = 0;
+		std::chrono::steady_clock::duration Time{};
+		std::chrono::steady_clock::duration MaxFrameTime{};
+	};
+
+	static bool ShouldTrack(CBaseEntity* entity);
+
+	static Snapshot TakeSnapshot(CBaseEntity* entity, float time);
+
+	static void ApplySnapshot(CBaseEntity* entity, const Snapshot& snapshot);
+
+	static bool FindSnapshot(const History& history, float time, Snapshot& result);
+
+	void ReleaseSlot(int entityIndex);
+
+	void ReleaseAllSlots();
+
+	void PrintStats();
+
+private:
+	cvar_t* m_Enabled{};
+
+	int m_FrameNumber = 0;
+	float m_LastUpdateTime = 0;
+
+	// Histories are preallocated so recording never allocates; the maximum number of tracked entities is bounded.
+	std::vector<History> m_Histories;
+	std::vector<int> m_FreeSlots;
+	std::vector<int> m_SlotByEntity;
+
+	std::array<float, MAX_PLAYERS + 1> m_PlayerInterpolation{};
+
+	std::vector<RewoundEntity> m_RewoundEntities;
+	int m_RewindDepth = 0;
+
+	Stats m_Stats;
+	std::chrono::steady_clock::duration m_CurrentFrameTime{};
+};
+
+inline LagCompensationSystem g_LagCompensation;
@@ -0,0 +1,253 @@
+/***
+ *
+ *	Copyright (c) 1996-2001, Valve LLC. All rights reserved.
+ *
+ *	This product contains software technology licensed from Id
+ *	Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *	All Rights Reserved.
+ *
+ *   Use, distribution, and modification of this source code and/or resulting
+ *   object code is restricted to non-commercial enhancements to products from
+ *   Valve LLC.  All other use, distribution, or modification is prohibited
+ *   without written permission from Valve LLC.
+ *
+ ****/
+
+#include <algorithm>
+
+#include <fmt/format.h>
+
+#include <nlohmann/json.hpp>
+
+#include "cbase.h"
+#include "pm_shared.h"
+#include "PlayerMovementBenchmark.h"
+#include "ServerLibrary.h"
+
+constexpr std::string_view PlayerMovementDirectory{"profiles/movement"};
+
+bool PlayerMovementBenchmark::Initialize()
+{
+	g_ConCommands.CreateCommand("pm_record", [this](const auto& args)
+		{
+			if (args.Count() < 2)
+			{
+				Con_Printf("Usage: %s <name> [player_index]\n", args.Argument(0));
+				return;
+			}
+
+			StartRecording(args.Argument(1), args.Count() >= 3 ? atoi(args.Argument(2)) : 1); });
+
+	g_ConCommands.CreateCommand("pm_record_stop", [this](const auto&)
+		{ StopRecording(); });
+
+	g_ConCommands.CreateCommand("pm_benchmark", [this](const auto& args)
+		{
+			if (args.Count() < 2)
+			{
+				Con_Printf("Usage: %s <name> [iterations]\n", args.Argument(0));
+				return;
+			}
+
+			Benchmark(args.Argument(1), args.Count() >= 3 ? atoi(args.Argument(2)) : 10); });
+
+	return true;
+}
+
+void PlayerMovementBenchmark::RunPlayerMove(playermove_t* ppmove, qboolean server)
+{
+	if (m_Recording && m_RecordingSpawnCount != g_Server.GetSpawnCount())
+	{
+		StopRecording();
+	}
+
+	const bool record = m_Recording && ppmove->player_index == m_Recording->PlayerIndex;
+
+	if (record)
+	{
+		if (m_Recording->Commands.empty())
+		{
+			PM_RecordPlayerState(*m_Recording, *ppmove);
+		}
+
+		PM_RecordPlayerMove(*m_Recording, *ppmove);
+	}
+
+	PM_Move(ppmove, server);
+
+	if (record)
+	{
+		m_Recording->EndOrigin = ppmove->origin;
+
+		if (m_Recording->Commands.size() >= PlayerMovementMaxCommands)
+		{
+			Con_Printf("Player movement recording reached the maximum of %zu commands\n", PlayerMovementMaxCommands);
+			StopRecording();
+		}
+	}
+}
+
+void PlayerMovementBenchmark::StartRecording(std::string_view name, int playerIndex)
+{
+	if (m_Recording)
+	{
+		Con_Printf("Already recording \"%s\"\n", m_RecordingName.c_str());
+		return;
+	}
+
+	if (!UTIL_PlayerByIndex(playerIndex))
+	{
+		Con_Printf("No player with index %d\n", playerIndex);
+		return;
+	}
+
+	m_RecordingName = name;
+	m_RecordingSpawnCount = g_Server.GetSpawnCount();
+	m_Recording = std::make_unique<PlayerMovementRecording>();
+	m_Recording->MapName = STRING(gpGlobals->mapname);
+	m_Recording->PlayerIndex = playerIndex - 1;
+
+	Con_Printf("Recording player movement to \"%s\"\n", GetFileName(name).c_str());
+}
+
+void PlayerMovementBenchmark::StopRecording()
+{
+	if (!m_Recording)
+	{
+		return;
+	}
+
+	const auto recording = std::move(m_Recording);
+
+	// The map has changed since recording started, so the recording can't be replayed.
+	if (m_RecordingSpawnCount != g_Server.GetSpawnCount())
+	{
+		Con_Printf("Map changed while recording player movement, discarding recording\n");
+		return;
+	}
+
+	if (recording->Commands.empty())
+	{
+		Con_Printf("No commands recorded\n");
+		return;
+	}
+
+	const auto fileName = GetFileName(m_RecordingName);
+
+	if (!WriteRecording(*recording, fileName))
+	{
+		Con_Printf("Could not write player movement recording \"%s\"\n", fileName.c_str());
+		return;
+	}
+
+	Con_Printf("Recorded %zu commands to \"%s\"\n", recording->Commands.size(), fileName.c_str());
+}
+
+void PlayerMovementBenchmark::Benchmark(std::string_view name, int iterations)
+{
+	if (m_Recording)
+	{
+		Con_Printf("Stop recording before running a benchmark\n");
+		return;
+	}
+
+	// The world physent is set up by the engine the first time it runs player movement.
+	if (!pmove || pmove->numphysent < 1)
+	{
+		Con_Printf("Player movement has not been run on this map yet\n");
+		return;
+	}
+
+	const auto fileName = GetFileName(name);
+	const auto recording = LoadRecording(fileName);
+
+	if (!recording)
+	{
+		Con_Printf("Could not load player movement recording \"%s\"\n", fileName.c_str());
+		return;
+	}
+
+	if (recording->MapName != STRING(gpGlobals->mapname))
+	{
+		Con_Printf("Recording \"%s\" was made on map \"%s\"\n", fileName.c_str(), recording->MapName.c_str());
+		return;
+	}
+
+	iterations = std::max(1, iterations);
+
+	const auto result = PM_ReplayRecording(*pmove, *recording, iterations);
+
+	const double endDistance = (result.EndOrigin - recording->EndOrigin).Length();
+
+	Con_Printf("Replayed %zu commands %d times on \"%s\"\n", recording->Commands.size(), iterations, recording->MapName.c_str());
+	Con_Printf("  Time: %.1f ns/command\n", result.NsPerCommand);
+	Con_Printf("  Player traces: %.2f/command\n", result.PlayerTracesPerCommand);
+	Con_Printf("  Line traces: %.2f/command\n", result.LineTracesPerCommand);
+	Con_Printf("  Position tests: %.2f/command\n", result.PositionTestsPerCommand);
+	Con_Printf("  Point contents: %.2f/command\n", result.PointContentsPerCommand);
+	Con_Printf("  Checksum: %08x (%s)\n", result.Checksum, result.Deterministic ? "deterministic" : "NOT deterministic");
+	Con_Printf("  End origin is %.2f units from the recorded end origin\n", endDistance);
+
+	const json report{
+		{"Name", std::string{name}},
+		{"Map", recording->MapName},
+		{"Commands", recording->Commands.size()},
+		{"Iterations", iterations},
+		{"NsPerCommand", result.NsPerCommand},
+		{"PlayerTracesPerCommand", result.PlayerTracesPerCommand},
+		{"LineTracesPerCommand", result.LineTracesPerCommand},
+		{"PositionTestsPerCommand", result.PositionTestsPerCommand},
+		{"PointContentsPerCommand", result.PointContentsPerCommand},
+		{"Checksum", fmt::format("{:08x}", result.Checksum)},
+		{"Deterministic", result.Deterministic},
+		{"EndOriginDistance", endDistance}};
+
+	const auto resultFileName = fmt::format("{}/{}.json", PlayerMovementDirectory, name);
+
+	if (!FileSystem_WriteTextToFile(resultFileName.c_str(), report.dump(1, '\t').c_str(), "GAMECONFIG"))
+	{
+		Con_Printf("Could not write benchmark results to \"%s\"\n", resultFileName.c_str());
+	}
+}
+
+bool PlayerMovementBenchmark::WriteRecording(const PlayerMovementRecording& recording, const std::string& fileName) const
+{
+	const auto buffer = PM_SerializeRecording(recording);
+
+	g_pFileSystem->CreateDirHierarchy(std::string{PlayerMovementDirectory}.c_str(), "GAMECONFIG");
+
+	FSFile file{fileName.c_str(), "wb", "GAMECONFIG"};
+
+	if (!file.IsOpen())
+	{
+		return false;
+	}
+
+	return static_cast<std::size_t>(file.Write(buffer.data(), buffer.size())) == buffer.size();
+}
+
+std::unique_ptr<PlayerMovementRecording> PlayerMovementBenchmark::LoadRecording(const std::string& fileName) const
+{
+	const auto buffer = FileSystem_LoadFileIntoBuffer(fileName.c_str(), FileContentFormat::Binary, "GAMECONFIG");
+
+	if (buffer.empty())
+	{
+		return {};
+	}
+
+	std::string error;
+
+	auto recording = PM_DeserializeRecording(buffer, error);
+
+	if (!recording)
+	{
+		Con_Printf("\"%s\" is not a valid player movement recording: %s\n", fileName.c_str(), error.c_str());
+	}
+
+	return recording;
+}
+
+std::string PlayerMovementBenchmark::GetFileName(std::string_view name) const
+{
+	return fmt::format("{}/{}.pmr", PlayerMovementDirectory, name);
+}
@@ -0,0 +1,68 @@
+/***
+ *
+ *	Copyright (c) 1996-2001, Valve LLC. All rights reserved.
+ *
+ *	This product contains software technology licensed from Id
+ *	Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *	All Rights Reserved.
+ *
+ *   Use, distribution, and modification of this source code and/or resulting
+ *   object code is restricted to non-commercial enhancements to products from
+ *   Valve LLC.  All other use, distribution, or modification is prohibited
+ *   without written permission from Valve LLC.
+ *
+ ****/
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "cbase.h"
+#include "GameSystem.h"
+#include "pm_defs.h"
+#include "pm_replay.h"
+
+/**
+ *	@brief Records the user commands a player sends and replays them through the shared player movement code.
+ *	@details Replays are deterministic: only the world is collided with,
+ *	and the clock and random number generator used by the movement code are replaced during the replay.
+ *	This allows measuring the cost of @c PM_Move and checking that changes to it don't change the results.
+ */
+class PlayerMovementBenchmark final : public IGameSystem
+{
+public:
+	const char* GetName() const override { return "PlayerMovementBenchmark"; }
+
+	bool Initialize() override;
+
+	void PostInitialize() override {}
+
+	void Shutdown() override {}
+
+	/**
+	 *	@brief Called by the engine to run a user command. Records the command if the player is being recorded.
+	 */
+	void RunPlayerMove(playermove_t* ppmove, qboolean server);
+
+private:
+	void StartRecording(std::string_view name, int playerIndex);
+
+	void StopRecording();
+
+	void Benchmark(std::string_view name, int iterations);
+
+	bool WriteRecording(const PlayerMovementRecording& recording, const std::string& fileName) const;
+
+	std::unique_ptr<PlayerMovementRecording> LoadRecording(const std::string& fileName) const;
+
+	std::string GetFileName(std::string_view name) const;
+
+private:
+	std::string m_RecordingName;
+	int m_RecordingSpawnCount = 0;
+	std::unique_ptr<PlayerMovementRecording> m_Recording;
+};
+
+inline PlayerMovementBenchmark g_PlayerMovementBenchmark;
@@ -23,15 +23,20 @@
 
 #include "cbase.h"
 #include "CClientFog.h"
+#include "ClientCommandRegistry.h"
 #include "client.h"
 #include "EntityTemplateSystem.h"
+#include "FullPackSnapshot.h"
+#include "LagCompensationSystem.h"
 #include "MapState.h"
 #include "nodes.h"
+#include "PlayerMovementBenchmark.h"
 #include "ProjectInfoSystem.h"
 #include "scripted.h"
 #include "ServerConfigContext.h"
 #include "ServerLibrary.h"
 #include "skill.h"
+#include "squadmonster.h"
 #include "UserMessages.h"
 #include "voice_gamemgr.h"
 
@@ -63,13 +68,19 @@
 #include "networking/NetworkDataSystem.h"
 
 #include "sound/MaterialSystem.h"
+#include "sound/RoomTypeSystem.h"
 #include "sound/SentencesSystem.h"
 #include "sound/ServerSoundSystem.h"
 
 #include "ui/hud/HudReplacementSystem.h"
 
+#include "utils/LoadProfiler.h"
+
 constexpr char DefaultMapConfigFileName[] = "cfg/DefaultMapConfig.json";
 
+// Node graphs are built a second after the map starts, so keep profiling until after that.
+constexpr float LoadProfileEndTime = 3;
+
 cvar_t servercfgfile = {"sv_servercfgfile", "cfg/server/server.json", FCVAR_NOEXTRAWHITEPACE | FCVAR_ISPATH};
 cvar_t mp_gamemode = {"mp_gamemode", "", FCVAR_SERVER};
 cvar_t mp_createserver_gamemode = {"mp_createserver_gamemode", "", FCVAR_SERVER};
@@ -96,6 +107,8 @@ bool ServerLibrary::Initialize()
 	m_SendResources = g_ConCommands.GetCVar("sv_send_resources");
 	m_AllowDLFile = g_ConCommands.GetCVar("sv_allow_dlfile");
 
+	m_LoadProfile = g_ConCommands.CreateCVar("load_profile", COM_HasParam("-load_profile") ? "1" : "0");
+
 	g_PrecacheLogger = g_Logging.CreateLogger("precache");
 	CBaseEntity::IOLogger = g_Logging.CreateLogger("ent.io");
 	CBaseMonster::AILogger = g_Logging.CreateLogger("ent.ai");
@@ -124,9 +137,40 @@ bool ServerLibrary::Initialize()
 	g_ConCommands.CreateCommand("load_all_maps", [this](const auto& args)
 		{ LoadAllMaps(args); });
 
+	g_ConCommands.CreateCommand("profile_all_maps", [this](const auto& args)
+		{
+			if (!m_MapsToLoad.empty())
+			{
+				LoadAllMaps(args);
+				return;
+			}
+
+			m_ProfileAllMaps = true;
+			m_MapLoadTimes.clear();
+
+			if (!LoadAllMaps(args))
+			{
+				m_ProfileAllMaps = false;
+			} });
+
 	// Escape hatch in case the command is executed in error.
 	g_ConCommands.CreateCommand("stop_loading_all_maps", [this](const auto&)
-		{ m_MapsToLoad.clear(); });
+		{
+			m_MapsToLoad.clear();
+			m_ProfileAllMaps = false; });
+
+	g_ConCommands.CreateCommand(
+		"ent_memstats", [](const auto&)
+		{ g_EntityAllocator.PrintStats(); },
+		CommandLibraryPrefix::No);
+
+	g_ConCommands.CreateCommand(
+		"squad_stats", [](const auto&)
+		{ PrintSquadStats(); },
+		CommandLibraryPrefix::No);
+
+	g_ConCommands.CreateCommand("client_command_stats", [](const auto&)
+		{ g_ClientCommands.PrintStats(); });
 
 	g_ConCommands.RegisterChangeCallback(&sv_allowbunnyhopping, [](const auto& state)
 		{
@@ -201,6 +245,17 @@ void ServerLibrary::RunFrame()
 
 	g_Bots.RunFrame();
 
+	sound::g_RoomTypes.RunFrame();
+
+	g_LagCompensation.RunFrame();
+
+	g_FullPackSnapshot.RunFrame();
+
+	if (g_LoadProfiler.IsActive() && gpGlobals->time >= LoadProfileEndTime)
+	{
+		FinishLoadProfile();
+	}
+
 	// If we're loading all maps then change maps after 3 seconds (time starts at 1)
 	// to give the game time to generate files.
 	if (!m_MapsToLoad.empty() && gpGlobals->time > 4)
@@ -224,6 +279,19 @@ void ServerLibrary::ShutdownServer(spdlog::format_string_t<Args...> fmt, Args&&.
 
 void ServerLibrary::NewMapStarted(bool loadGame)
 {
+	// The previous map didn't run long enough to finish its profile.
+	if (g_LoadProfiler.IsActive())
+	{
+		FinishLoadProfile();
+	}
+
+	if (m_ProfileAllMaps || m_LoadProfile->value != 0)
+	{
+		g_LoadProfiler.Begin(STRING(gpGlobals->mapname));
+	}
+
+	const ScopedLoadTimer timer{"NewMapStarted"};
+
 	m_IsCurrentMapLoadedFromSaveGame = loadGame;
 
 	++m_SpawnCount;
@@ -302,6 +370,9 @@ void ServerLibrary::NewMapStarted(bool loadGame)
 		{
 			g_ModelPrecache->AddUnchecked(STRING(ALLOC_STRING(fmt::format("*{}", subModel).c_str())));
 		}
+
+		g_MaterialSystem.SetMapTextures(std::move(bspData->TextureNames));
+		g_FullPackSnapshot.SetWorldVisLeafCount(bspData->WorldVisLeafCount);
 	}
 	else
 	{
@@ -309,7 +380,10 @@ void ServerLibrary::NewMapStarted(bool loadGame)
 	}
 
 	// Load the config files, which will initialize the map state as needed
-	LoadServerConfigFiles();
+	{
+		const ScopedLoadTimer configTimer{"ServerConfig", "LoadServerConfigFiles"};
+		LoadServerConfigFiles();
+	}
 
 	g_PersistentInventory.NewMapStarted();
 
@@ -331,6 +405,8 @@ void ServerLibrary::PostMapActivate()
 		ShutdownServer("Shutting down server due to fatal error writing network data file");
 	}
 
+	g_LoadProfiler.MarkLoaded();
+
 	if (g_PrecacheLogger->should_log(spdlog::level::debug))
 	{
 		for (auto list : {g_ModelPrecache.get(), g_SoundPrecache.get(), g_GenericPrecache.get()})
@@ -387,10 +463,14 @@ void ServerLibrary::AddGameSystems()
 	g_GameSystems.Add(&g_ConditionEvaluator);
 	g_GameSystems.Add(&g_GameConfigSystem);
 	g_GameSystems.Add(&sound::g_ServerSound);
+	g_GameSystems.Add(&sound::g_RoomTypes);
 	g_GameSystems.Add(&sentences::g_Sentences);
 	g_GameSystems.Add(&g_MapCycleSystem);
 	g_GameSystems.Add(&g_EntityTemplates);
 	g_GameSystems.Add(&g_Bots);
+	g_GameSystems.Add(&g_LagCompensation);
+	g_GameSystems.Add(&g_PlayerMovementBenchmark);
+	g_GameSystems.Add(&g_FullPackSnapshot);
 }
 
 void ServerLibrary::SetEntLogLevels(spdlog::level::level_enum level)
@@ -592,9 +672,25 @@ void ServerLibrary::LoadServerConfigFiles()
 		mapConfig->Parse(context);
 	}
 
-	sentences::g_Sentences.LoadSentences(context.SentencesFiles);
-	g_MaterialSystem.LoadMaterials(context.MaterialsFiles);
-	g_Skill.LoadSkillConfigFiles(context.SkillFiles);
+	{
+		const ScopedLoadTimer timer{"ServerConfig", "PreloadServerDataFiles"};
+		PreloadServerDataFiles(context);
+	}
+
+	{
+		const ScopedLoadTimer timer{"ServerConfig", "Sentences"};
+		sentences::g_Sentences.LoadSentences(context.SentencesFiles);
+	}
+
+	{
+		const ScopedLoadTimer timer{"ServerConfig", "Materials"};
+		g_MaterialSystem.LoadMaterials(context.MaterialsFiles);
+	}
+
+	{
+		const ScopedLoadTimer timer{"ServerConfig", "Skill"};
+		g_Skill.LoadSkillConfigFiles(context.SkillFiles);
+	}
 
 	// Override skill vars with cvars if they are enabled only.
 	if (sv_infinite_ammo.value != 0)
@@ -607,18 +703,28 @@ void ServerLibrary::LoadServerConfigFiles()
 		g_Skill.SetValue("bottomless_magazines", sv_bottomless_magazines.value);
 	}
 
-	m_MapState->m_GlobalModelReplacement = g_ReplacementMaps.LoadMultiple(
-		context.GlobalModelReplacementFiles, {.CaseSensitive = false});
-	m_MapState->m_GlobalSentenceReplacement = g_ReplacementMaps.LoadMultiple(
-		context.GlobalSentenceReplacementFiles, {.CaseSensitive = true});
-	m_MapState->m_GlobalSoundReplacement = g_ReplacementMaps.LoadMultiple(
-		context.GlobalSoundReplacementFiles, {.CaseSensitive = false});
+	{
+		const ScopedLoadTimer timer{"ServerConfig", "ReplacementMaps"};
+
+		m_MapState->m_GlobalModelReplacement = g_ReplacementMaps.LoadMultiple(
+			context.GlobalModelReplacementFiles, {.CaseSensitive = false});
+		m_MapState->m_GlobalSentenceReplacement = g_ReplacementMaps.LoadMultiple(
+			context.GlobalSentenceReplacementFiles, {.CaseSensitive = true});
+		m_MapState->m_GlobalSoundReplacement = g_ReplacementMaps.LoadMultiple(
+			context.GlobalSoundReplacementFiles, {.CaseSensitive = false});
+	}
 
 	g_SpawnInventory.SetInventory(std::move(context.SpawnInventory));
 
-	g_EntityClassifications.Load(context.EntityClassificationsFileName);
+	{
+		const ScopedLoadTimer timer{"ServerConfig", "EntityClassifications"};
+		g_EntityClassifications.Load(context.EntityClassificationsFileName);
+	}
 
-	g_EntityTemplates.LoadTemplates(context.EntityTemplates);
+	{
+		const ScopedLoadTimer timer{"ServerConfig", "EntityTemplates"};
+		g_EntityTemplates.LoadTemplates(context.EntityTemplates);
+	}
 
 	// Register the weapons so we can then set the replacement filenames.
 	Weapon_RegisterWeaponData();
@@ -630,6 +736,41 @@ void ServerLibrary::LoadServerConfigFiles()
 
 	g_GameLogger->trace("Server configurations loaded in {}ms",
 		std::chrono::duration_cast<std::chrono::milliseconds>(timeElapsed).count());
+
+	g_JSON.LogFileCacheStatistics();
+}
+
+void ServerLibrary::PreloadServerDataFiles(const ServerConfigContext& context)
+{
+	// These files don't depend on each other, so they can be parsed in parallel before the systems that use them load them.
+	// The schema names and path IDs must match the ones used by those systems.
+	std::vector<JSONPreloadFile> files;
+
+	for (const auto& fileName : context.SentencesFiles)
+	{
+		files.push_back({.FileName = fileName, .SchemaName = sentences::SentencesSchemaName});
+	}
+
+	for (const auto& fileName : context.MaterialsFiles)
+	{
+		files.push_back({.FileName = fileName, .SchemaName = MaterialsConfigSchemaName});
+	}
+
+	for (const auto& fileName : context.SkillFiles)
+	{
+		files.push_back({.FileName = fileName, .SchemaName = SkillConfigSchemaName, .PathID = "GAMECONFIG"});
+	}
+
+	for (const auto& replacementFiles : {
+			 &context.GlobalModelReplacementFiles, &context.GlobalSentenceReplacementFiles, &context.GlobalSoundReplacementFiles})
+	{
+		for (const auto& fileName : *replacementFiles)
+		{
+			files.push_back({.FileName = fileName, .SchemaName = ReplacementMapSchemaName, .PathID = "GAMECONFIG"});
+		}
+	}
+
+	g_JSON.PreloadJSONFiles(files);
 }
 
 void ServerLibrary::SendFogMessage(CBasePlayer* player)
@@ -665,13 +806,13 @@ void ServerLibrary::SendFogMessage(CBasePlayer* player)
 	MESSAGE_END();
 }
 
-void ServerLibrary::LoadAllMaps(const CommandArgs& args)
+bool ServerLibrary::LoadAllMaps(const CommandArgs& args)
 {
 	if (!m_MapsToLoad.empty())
 	{
 		Con_Printf("Already loading all maps (%u remaining)\nUse sv_stop_loading_all_maps to stop\n",
 			m_MapsToLoad.size());
-		return;
+		return false;
 	}
 
 	FileFindHandle_t handle = FILESYSTEM_INVALID_FIND_HANDLE;
@@ -725,10 +866,60 @@ void ServerLibrary::LoadAllMaps(const CommandArgs& args)
 
 		// Load the first map right now.
 		LoadNextMap();
+		return true;
 	}
 	else
 	{
 		Con_Printf("No maps to load\n");
+		return false;
+	}
+}
+
+void ServerLibrary::FinishLoadProfile()
+{
+	g_LoadProfiler.End();
+
+	const auto& mapName = g_LoadProfiler.GetName();
+
+	g_LoadProfiler.PrintTable(LoadProfileConsoleEntries);
+
+	if (const auto fileName = fmt::format("{}/{}.json", LoadProfileDirectory, mapName);
+		g_LoadProfiler.WriteToFile(fileName))
+	{
+		Con_Printf("Wrote load profile to \"%s\"\n", fileName.c_str());
+	}
+
+	if (!m_ProfileAllMaps)
+	{
+		return;
+	}
+
+	m_MapLoadTimes.emplace_back(mapName, std::chrono::duration<double, std::milli>(g_LoadProfiler.GetTotalTime()).count());
+
+	// The last map has been profiled, write a summary so the total load time of each map can be compared between builds.
+	if (m_MapsToLoad.empty())
+	{
+		m_ProfileAllMaps = false;
+
+		auto maps = json::array();
+		double totalTime = 0;
+
+		for (const auto& [name, time] : m_MapLoadTimes)
+		{
+			maps.push_back({{"Name", name}, {"TotalTimeMs", time}});
+			totalTime += time;
+		}
+
+		const json summary{{"TotalTimeMs", totalTime}, {"Maps", std::move(maps)}};
+
+		const auto fileName = fmt::format("{}/summary.json", LoadProfileDirectory);
+
+		if (FileSystem_WriteTextToFile(fileName.c_str(), summary.dump(1, '\t').c_str(), "GAMECONFIG"))
+		{
+			Con_Printf("Profiled %zu maps in %.2f ms, wrote summary to \"%s\"\n", m_MapLoadTimes.size(), totalTime, fileName.c_str());
+		}
+
+		m_MapLoadTimes.clear();
 	}
 }
 
@@ -115,16 +115,30 @@ private:
 
 	void LoadServerConfigFiles();
 
+	/**
+	 *	@brief Parses the data files listed in the context on worker threads so the systems that load them use the cached result.
+	 */
+	void PreloadServerDataFiles(const ServerConfigContext& context);
+
 	void SendFogMessage(CBasePlayer* player);
 
-	void LoadAllMaps(const CommandArgs& args);
+	/**
+	 *	@return @c true if the first map is being loaded.
+	 */
+	bool LoadAllMaps(const CommandArgs& args);
 
 	void LoadNextMap();
 
+	/**
+	 *	@brief Ends the map load profile, prints it and writes it to a file.
+	 */
+	void FinishLoadProfile();
+
 private:
 	cvar_t* m_AllowDownload{};
 	cvar_t* m_SendResources{};
 	cvar_t* m_AllowDLFile{};
+	cvar_t* m_LoadProfile{};
 
 	std::shared_ptr<const GameConfigDefinition<ServerConfigContext>> m_ServerConfigDefinition;
 	std::shared_ptr<const GameConfigDefinition<ServerConfigContext>> m_MapConfigDefinition;
@@ -140,6 +154,10 @@ private:
 	std::unique_ptr<MapState> m_MapState;
 
 	std::vector<std::string> m_MapsToLoad;
+
+	// Whether to profile each map loaded by profile_all_maps and write a summary after the last one.
+	bool m_ProfileAllMaps = false;
+	std::vector<std::pair<std::string, double>> m_MapLoadTimes;
 };
 
 inline ServerLibrary g_Server;
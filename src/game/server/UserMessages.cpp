@@ -78,9 +78,11 @@ void LinkUserMessages()
 	gmsgTeamFull = g_engfuncs.pfnRegUserMsg("TeamFull", 1);
 	gmsgCustomIcon = g_engfuncs.pfnRegUserMsg("CustomIcon", -1);
 	gmsgWeapons = REG_USER_MSG("Weapons", 8);
+	gmsgHudDelta = REG_USER_MSG("HudDelta", -1);
 
 	gmsgEntityInfo = REG_USER_MSG("EntityInfo", -1);
 	gmsgEmitSound = REG_USER_MSG("EmitSound", -1);
+	gmsgAmbientModulation = REG_USER_MSG("AmbientMod", -1);
 	gmsgTempEntity = REG_USER_MSG("TempEntity", -1);
 	gmsgSkillVars = REG_USER_MSG("SkillVars", -1);
 
@@ -69,10 +69,12 @@ inline int gmsgStatsPlayer = 0;
 inline int gmsgTeamFull = 0;
 inline int gmsgCustomIcon = 0;
 inline int gmsgWeapons = 0;
+inline int gmsgHudDelta = 0;
 
 inline int gmsgEntityInfo = 0;
 
 inline int gmsgEmitSound = 0;
+inline int gmsgAmbientModulation = 0;
 
 inline int gmsgTempEntity = 0;
 
@@ -0,0 +1,124 @@
+/***
+ *
+ *	Copyright (c) 1996-2001, Valve LLC. All rights reserved.
+ *
+ *	This product contains software technology licensed from Id
+ *	Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *	All Rights Reserved.
+ *
+ *   Use, distribution, and modification of this source code and/or resulting
+ *   object code is restricted to non-commercial enhancements to products from
+ *   Valve LLC.  All other use, distribution, or modification is prohibited
+ *   without written permission from Valve LLC.
+ *
+ ****/
+
+#include "WorkerPool.h"
+
+WorkerPool::~WorkerPool()
+{
+	Stop();
+}
+
+void WorkerPool::Start(unsigned int threadCount)
+{
+	if (IsRunning())
+	{
+		return;
+	}
+
+	m_Stopping = false;
+
+	m_Threads.reserve(threadCount);
+
+	// New threads must not mistake the last batch for new work.
+	for (unsigned int i = 0; i < threadCount; ++i)
+	{
+		m_Threads.emplace_back(&WorkerPool::WorkerThread, this, m_Batch);
+	}
+}
+
+void WorkerPool::Stop()
+{
+	if (!IsRunning())
+	{
+		return;
+	}
+
+	{
+		std::lock_guard lock{m_Mutex};
+		m_Stopping = true;
+	}
+
+	m_WorkAvailable.notify_all();
+
+	for (auto& thread : m_Threads)
+	{
+		thread.join();
+	}
+
+	m_Threads.clear();
+}
+
+void WorkerPool::Run(std::size_t count, const std::function<void(std::size_t)>& job)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	m_Job = &job;
+	m_JobCount = count;
+	m_NextJob.store(0, std::memory_order_relaxed);
+
+	{
+		std::lock_guard lock{m_Mutex};
+		m_BusyWorkers = static_cast<unsigned int>(m_Threads.size());
+		++m_Batch;
+	}
+
+	m_WorkAvailable.notify_all();
+
+	RunJobs();
+
+	std::unique_lock lock{m_Mutex};
+	m_WorkDone.wait(lock, [this]
+		{ return m_BusyWorkers == 0; });
+
+	m_Job = nullptr;
+}
+
+void WorkerPool::WorkerThread(std::uint64_t lastBatch)
+{
+	std::unique_lock lock{m_Mutex};
+
+	while (true)
+	{
+		m_WorkAvailable.wait(lock, [&]
+			{ return m_Stopping || m_Batch != lastBatch; });
+
+		if (m_Stopping)
+		{
+			return;
+		}
+
+		lastBatch = m_Batch;
+
+		lock.unlock();
+		RunJobs();
+		lock.lock();
+
+		if (--m_BusyWorkers == 0)
+		{
+			m_WorkDone.notify_one();
+		}
+	}
+}
+
+void WorkerPool::RunJobs()
+{
+	for (std::size_t index; (index = m_NextJob.fetch_add(1, std::memory_order_relaxed)) < m_JobCount;)
+	{
+		(*m_Job)(index);
+	}
+}
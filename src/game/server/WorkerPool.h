@@ -0,0 +1,81 @@
+/***
+ *
+ *	Copyright (c) 1996-2001, Valve LLC. All rights reserved.
+ *
+ *	This product contains software technology licensed from Id
+ *	Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *	All Rights Reserved.
+ *
+ *   Use, distribution, and modification of this source code and/or resulting
+ *   object code is restricted to non-commercial enhancements to products from
+ *   Valve LLC.  All other use, distribution, or modification is prohibited
+ *   without written permission from Valve LLC.
+ *
+ ****/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ *	@brief A fixed set of threads that run batches of jobs.
+ *	@details The threads are started once and sleep between batches, so running a batch only costs waking them up.
+ *	Jobs must not call into the engine.
+ */
+class WorkerPool final
+{
+public:
+	WorkerPool() = default;
+	~WorkerPool();
+
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+
+	bool IsRunning() const { return !m_Threads.empty(); }
+
+	/**
+	 *	@brief Starts @p threadCount threads. Does nothing if the pool is already running.
+	 */
+	void Start(unsigned int threadCount);
+
+	/**
+	 *	@brief Waits for the threads to finish and stops them.
+	 */
+	void Stop();
+
+	/**
+	 *	@brief Calls @p job for every index in <tt>[0, count)</tt> and waits for all calls to return.
+	 *	@details The calling thread runs jobs as well. Jobs must not throw exceptions.
+	 */
+	void Run(std::size_t count, const std::function<void(std::size_t)>& job);
+
+private:
+	void WorkerThread(std::uint64_t lastBatch);
+
+	void RunJobs();
+
+private:
+	std::vector<std::thread> m_Threads;
+
+	std::mutex m_Mutex;
+	std::condition_variable m_WorkAvailable;
+	std::condition_variable m_WorkDone;
+
+	// Guarded by m_Mutex.
+	std::uint64_t m_Batch = 0;
+	unsigned int m_BusyWorkers = 0;
+	bool m_Stopping = false;
+
+	// Set before a batch is started and not changed until all workers are done with it.
+	const std::function<void(std::size_t)>* m_Job{};
+	std::size_t m_JobCount = 0;
+
+	std::atomic<std::size_t> m_NextJob{0};
+};
@@ -24,6 +24,7 @@
 */
 
 #include <algorithm>
+#include <chrono>
 #include <optional>
 
 #include "cbase.h"
@@ -38,6 +39,8 @@
 #include "pm_shared.h"
 #include "UserMessages.h"
 #include "ClientCommandRegistry.h"
+#include "FullPackSnapshot.h"
+#include "LagCompensationSystem.h"
 #include "ServerLibrary.h"
 
 #include "ctf/ctf_goals.h"
@@ -1032,7 +1035,14 @@ void ExecuteClientCommand(edict_t* pEntity)
 	{
 		if ((clientCommand->Flags & ClientCommandFlag::Cheat) == 0 || UTIL_CheatsAllowed(player, clientCommand->Name))
 		{
+			// The command may remove itself, the stats are owned by the registry.
+			auto& stats = clientCommand->Stats;
+
+			const auto startTime = std::chrono::steady_clock::now();
+
 			clientCommand->Function(player, CommandArgs{});
+
+			stats.Add(std::chrono::steady_clock::now() - startTime);
 		}
 	}
 	else
@@ -1414,6 +1424,8 @@ void SetupVisibility(edict_t* pViewEntity, edict_t* pClient, unsigned char** pvs
 		pView = pViewEntity;
 	}
 
+	g_FullPackSnapshot.BeginClient(pClient, pView);
+
 	if ((pClient->v.flags & FL_PROXY) != 0)
 	{
 		*pvs = nullptr; // the spectator proxy sees
@@ -1421,10 +1433,11 @@ void SetupVisibility(edict_t* pViewEntity, edict_t* pClient, unsigned char** pvs
 		return;
 	}
 
-	org = pView->v.origin + pView->v.view_ofs;
-	if ((pView->v.flags & FL_DUCKING) != 0)
+	org = GetVisibilityOrigin(pView);
+
+	if (g_FullPackSnapshot.GetPrecomputedVisibility(org, pvs, pas))
 	{
-		org = org + (VEC_HULL_MIN - VEC_DUCK_HULL_MIN);
+		return;
 	}
 
 	*pvs = ENGINE_SET_PVS(org);
@@ -1459,35 +1472,22 @@ int AddToFullPack(entity_state_t* state, int e, edict_t* ent, edict_t* host, int
 		return 0;
 	}
 
-	int i;
-
-	auto entity = reinterpret_cast<CBaseEntity*>(GET_PRIVATE(ent));
-
-	// don't send if flagged for NODRAW and it's not the host getting the message
-	if ((ent->v.effects & EF_NODRAW) != 0 &&
-		(ent != host))
-		return 0;
-
-	// Ignore ents without valid / visible models
-	if (0 == ent->v.modelindex || !STRING(ent->v.model))
-		return 0;
-
-	// Don't send spectators to other players
-	if ((ent->v.flags & FL_SPECTATOR) != 0 && (ent != host))
+	switch (g_FullPackSnapshot.GetPackDecision(e, ent, host, pSet))
 	{
+	case PackDecision::Skip:
 		return 0;
-	}
 
-	// Ignore if not the host and not touching a PVS/PAS leaf
-	// If pSet is nullptr, then the test will always succeed and the entity will be added to the update
-	if (ent != host)
-	{
+	case PackDecision::CheckVisibility:
+		// Ignore if not touching a PVS/PAS leaf
 		if (!ENGINE_CHECK_VISIBILITY((const edict_t*)ent, pSet))
 		{
 			return 0;
 		}
-	}
+		break;
 
+	default:
+		break;
+	}
 
 	// Don't send entity to local client if the client says it's predicting the entity itself.
 	if ((ent->v.flags & FL_SKIPLOCALHOST) != 0)
@@ -1496,164 +1496,22 @@ int AddToFullPack(entity_state_t* state, int e, edict_t* ent, edict_t* host, int
 			return 0;
 	}
 
-	if (0 != host->v.groupinfo)
+	if (auto snapshot = g_FullPackSnapshot.GetEntityState(e, ent, 0 != player); snapshot)
 	{
-		UTIL_SetGroupTrace(host->v.groupinfo, GROUP_OP_AND);
-
-		// Should always be set, of course
-		if (0 != ent->v.groupinfo)
-		{
-			if (g_groupop == GROUP_OP_AND)
-			{
-				if ((ent->v.groupinfo & host->v.groupinfo) == 0)
-					return 0;
-			}
-			else if (g_groupop == GROUP_OP_NAND)
-			{
-				if ((ent->v.groupinfo & host->v.groupinfo) != 0)
-					return 0;
-			}
-		}
-
-		UTIL_UnsetGroupTrace();
+		*state = *snapshot;
 	}
-
-	memset(state, 0, sizeof(*state));
-
-	// Assign index so we can track this entity from frame to frame and
-	//  delta from it.
-	state->number = e;
-	state->entityType = ENTITY_NORMAL;
-
-	// Flag custom entities.
-	if ((ent->v.flags & FL_CUSTOMENTITY) != 0)
+	else
 	{
-		state->entityType = ENTITY_BEAM;
+		FillEntityState(*state, e, ent, 0 != player, INDEXENT(0),
+			0 != player ? MODEL_INDEX(STRING(ent->v.weaponmodel)) : 0);
 	}
 
-	//
-	// Copy state data
-	//
-
-	// Round animtime to nearest millisecond
-	state->animtime = (int)(1000.0 * ent->v.animtime) / 1000.0;
-
-	memcpy(state->origin, ent->v.origin, 3 * sizeof(float));
-	memcpy(state->angles, ent->v.angles, 3 * sizeof(float));
-	memcpy(state->mins, ent->v.mins, 3 * sizeof(float));
-	memcpy(state->maxs, ent->v.maxs, 3 * sizeof(float));
-
-	memcpy(state->startpos, ent->v.startpos, 3 * sizeof(float));
-	memcpy(state->endpos, ent->v.endpos, 3 * sizeof(float));
-
-	state->impacttime = ent->v.impacttime;
-	state->starttime = ent->v.starttime;
-
-	state->modelindex = ent->v.modelindex;
-
-	state->frame = ent->v.frame;
-
-	state->skin = ent->v.skin;
-	state->effects = ent->v.effects;
-
 	// Remove the night vision illumination effect so other players don't see it
 	if (0 != player && host != ent)
 	{
 		state->effects &= ~EF_BRIGHTLIGHT;
 	}
 
-	// This non-player entity is being moved by the game .dll and not the physics simulation system
-	//  make sure that we interpolate it's position on the client if it moves
-	/*
-	if (0 == player &&
-		0 != ent->v.animtime &&
-		ent->v.velocity[0] == 0 &&
-		ent->v.velocity[1] == 0 &&
-		ent->v.velocity[2] == 0)
-	{
-		state->eflags |= EFLAG_SLERP;
-	}
-	*/
-
-	if ((ent->v.flags & FL_FLY) != 0)
-	{
-		state->eflags |= EFLAG_SLERP;
-	}
-	else
-	{
-		state->eflags &= ~EFLAG_SLERP;
-	}
-
-	state->eflags |= entity->m_EFlags;
-
-	state->scale = ent->v.scale;
-	state->solid = ent->v.solid;
-	state->colormap = ent->v.colormap;
-
-	state->movetype = ent->v.movetype;
-	state->sequence = ent->v.sequence;
-	state->framerate = ent->v.framerate;
-	state->body = ent->v.body;
-
-	for (i = 0; i < 4; i++)
-	{
-		state->controller[i] = ent->v.controller[i];
-	}
-
-	for (i = 0; i < 2; i++)
-	{
-		state->blending[i] = ent->v.blending[i];
-	}
-
-	state->rendermode = ent->v.rendermode;
-	state->renderamt = ent->v.renderamt;
-	state->renderfx = ent->v.renderfx;
-	state->rendercolor.r = ent->v.rendercolor.x;
-	state->rendercolor.g = ent->v.rendercolor.y;
-	state->rendercolor.b = ent->v.rendercolor.z;
-
-	state->aiment = 0;
-	if (ent->v.aiment)
-	{
-		state->aiment = ENTINDEX(ent->v.aiment);
-	}
-
-	state->owner = 0;
-	if (ent->v.owner)
-	{
-		int owner = ENTINDEX(ent->v.owner);
-
-		// Only care if owned by a player
-		if (owner >= 1 && owner <= gpGlobals->maxClients)
-		{
-			state->owner = owner;
-		}
-	}
-
-	// HACK:  Somewhat...
-	// Class is overridden for non-players to signify a breakable glass object ( sort of a class? )
-	if (0 == player)
-	{
-		state->playerclass = ent->v.playerclass;
-	}
-
-	// Special stuff for players only
-	if (0 != player)
-	{
-		memcpy(state->basevelocity, ent->v.basevelocity, 3 * sizeof(float));
-
-		state->weaponmodel = MODEL_INDEX(STRING(ent->v.weaponmodel));
-		state->gaitsequence = ent->v.gaitsequence;
-		state->spectator = ent->v.flags & FL_SPECTATOR;
-		state->friction = ent->v.friction;
-
-		state->gravity = ent->v.gravity;
-		//		state->team			= ent->v.team;
-		//
-		state->usehull = (ent->v.flags & FL_DUCKING) != 0 ? 1 : 0;
-		state->health = ent->v.health;
-	}
-
 	return 1;
 }
 
@@ -2134,6 +1992,8 @@ void CmdStart(const edict_t* player, const usercmd_t* cmd, unsigned int random_s
 	}
 
 	pl->random_seed = random_seed;
+
+	g_LagCompensation.SetPlayerInterpolation(pl, cmd->lerp_msec);
 }
 
 /**
@@ -23,6 +23,7 @@
 #include "extdll.h"
 #include "util.h"
 #include "DataMap.h"
+#include "EntityAllocator.h"
 #include "EntityClassificationSystem.h"
 #include "skill.h"
 
@@ -367,16 +368,14 @@ public:
 
 	void* operator new(size_t stAllocateBlock)
 	{
-		// Allocate zero-initialized memory.
-		auto memory = ::operator new(stAllocateBlock);
-		std::memset(memory, 0, stAllocateBlock);
-		return memory;
+		// Allocates zero-initialized memory.
+		return g_EntityAllocator.Allocate(stAllocateBlock);
 	}
 
 	// Don't call delete on entities directly, tell the engine to delete it instead.
 	void operator delete(void* pMem)
 	{
-		::operator delete(pMem);
+		g_EntityAllocator.Free(pMem);
 	}
 
 	/**
@@ -580,6 +579,11 @@ public:
 		return g_Skill.GetValue(name);
 	}
 
+	static float GetSkillFloat(const SkillVarHandle& handle)
+	{
+		return g_Skill.GetValue(handle);
+	}
+
 	// Sound playback.
 	void EmitSound(int channel, const char* sample, float volume, float attenuation);
 	void EmitSoundDyn(int channel, const char* sample, float volume, float attenuation, int flags, int pitch);
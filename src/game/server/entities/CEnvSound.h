@@ -0,0 +1,46 @@
+/***
+ *
+ *	Copyright (c) 1996-2001, Valve LLC. All rights reserved.
+ *
+ *	This product contains software technology licensed from Id
+ *	Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *	All Rights Reserved.
+ *
+ *   Use, distribution, and modification of this source code and/or resulting
+ *   object code is restricted to non-commercial enhancements to products from
+ *   Valve LLC.  All other use, distribution, or modification is prohibited
+ *   without written permission from Valve LLC.
+ *
+ ****/
+
+#pragma once
+
+#include "cbase.h"
+
+/**
+ *	@brief A sound entity that will set player roomtype when player moves in range and sight.
+ *	@details A client that is visible and in range of a sound entity will have its room_type set by that sound entity.
+ *	If two or more sound entities are contending for a client,
+ *	then the nearest sound entity to the client will set the client's room_type.
+ *	A client's room_type will remain set to its prior value until a new in-range,
+ *	visible sound entity resets a new room_type.
+ *	The checks are performed by sound::RoomTypeSystem for all env_sound entities at once.
+ */
+class CEnvSound : public CPointEntity
+{
+	DECLARE_CLASS(CEnvSound, CPointEntity);
+	DECLARE_DATAMAP();
+
+public:
+	void OnCreate() override;
+	void OnDestroy() override;
+	bool KeyValue(KeyValueData* pkvd) override;
+
+	float m_flRadius;
+	int m_Roomtype;
+};
+
+/**
+ *	@brief returns true if the given sound entity (pSound) is in range and can see the given player entity (target)
+ */
+bool FEnvSoundInRange(CEnvSound* pSound, CBaseEntity* target, float& flRange);
@@ -262,6 +262,12 @@ public:
 	 *	@param iDistance distance ( in units ) that the monster can see.
 	 */
 	virtual void Look(int iDistance); //!< basic sight function for monsters
+
+	/**
+	 *	@brief Whether @c Look can see @p pSightEnt, once it's in range and in the view cone.
+	 */
+	virtual bool FLookVisible(CBaseEntity* pSightEnt) { return FVisible(pSightEnt); }
+
 	virtual void RunAI();			  //!< core ai function!
 
 	/**
@@ -22,6 +22,7 @@
 
 #include "cbase.h"
 #include "func_break.h"
+#include "LagCompensationSystem.h"
 #include "UserMessages.h"
 
 BEGIN_DATAMAP(CGib)
@@ -1458,6 +1459,9 @@ Vector CBaseEntity::FireBulletsPlayer(unsigned int cShots, Vector vecSrc, Vector
 	ClearMultiDamage();
 	gMultiDamage.type = DMG_BULLET | DMG_NEVERGIB;
 
+	// Trace against NPCs where the player saw them.
+	g_LagCompensation.StartLagCompensation(ToBasePlayer(this), flDistance);
+
 	for (unsigned int iShot = 1; iShot <= cShots; iShot++)
 	{
 		// Use player's random seed.
@@ -1569,6 +1573,9 @@ Vector CBaseEntity::FireBulletsPlayer(unsigned int cShots, Vector vecSrc, Vector
 		// make bullet trails
 		UTIL_BubbleTrail(vecSrc, tr.vecEndPos, (flDistance * tr.flFraction) / 64.0);
 	}
+
+	g_LagCompensation.FinishLagCompensation();
+
 	ApplyMultiDamage(this, attacker);
 
 	return Vector(x * vecSpread.x, y * vecSpread.y, 0.0);
@@ -106,6 +106,23 @@ void COFSquadTalkMonster::Killed(CBaseEntity* attacker, int iGib)
 	CTalkMonster::Killed(attacker, iGib);
 }
 
+void COFSquadTalkMonster::Look(int iDistance)
+{
+	++m_iLookCount;
+
+	CTalkMonster::Look(iDistance);
+}
+
+bool COFSquadTalkMonster::FLookVisible(CBaseEntity* pSightEnt)
+{
+	if (!InSquad())
+	{
+		return CTalkMonster::FLookVisible(pSightEnt);
+	}
+
+	return MySquadLeader()->m_SquadPerception.IsVisible(this, MySquadIndex(), SquadCount(), m_iLookCount, pSightEnt);
+}
+
 void COFSquadTalkMonster::SquadRemove(COFSquadTalkMonster* pRemove)
 {
 	ASSERT(pRemove != nullptr);
@@ -142,6 +159,8 @@ void COFSquadTalkMonster::SquadRemove(COFSquadTalkMonster* pRemove)
 	}
 
 	pRemove->m_hSquadLeader = nullptr;
+
+	m_SquadPerception.Clear();
 }
 
 bool COFSquadTalkMonster::SquadAdd(COFSquadTalkMonster* pAdd)
@@ -156,6 +175,7 @@ bool COFSquadTalkMonster::SquadAdd(COFSquadTalkMonster* pAdd)
 		{
 			m_hSquadMember[i] = pAdd;
 			pAdd->m_hSquadLeader = this;
+			m_SquadPerception.Clear();
 			return true;
 		}
 	}
@@ -167,14 +187,25 @@ void COFSquadTalkMonster::SquadPasteEnemyInfo()
 {
 	COFSquadTalkMonster* pSquadLeader = MySquadLeader();
 	if (pSquadLeader)
+	{
 		pSquadLeader->m_vecEnemyLKP = m_vecEnemyLKP;
+		pSquadLeader->m_SquadPerception.EnemyInfoTime = gpGlobals->time;
+	}
 }
 
 void COFSquadTalkMonster::SquadCopyEnemyInfo()
 {
 	COFSquadTalkMonster* pSquadLeader = MySquadLeader();
 	if (pSquadLeader)
+	{
 		m_vecEnemyLKP = pSquadLeader->m_vecEnemyLKP;
+
+		// squad members fighting something else may still have seen it since
+		auto known = pSquadLeader->m_SquadPerception.Find(m_hEnemy);
+
+		if (known && known->LastSeenTime > pSquadLeader->m_SquadPerception.EnemyInfoTime)
+			m_vecEnemyLKP = known->LastSeenPosition;
+	}
 }
 
 void COFSquadTalkMonster::SquadMakeEnemy(CBaseEntity* pEnemy)
@@ -299,6 +330,19 @@ int COFSquadTalkMonster::SquadCount()
 	return squadCount;
 }
 
+int COFSquadTalkMonster::MySquadIndex()
+{
+	COFSquadTalkMonster* pSquadLeader = MySquadLeader();
+
+	for (int i = 0; i < MAX_SQUAD_MEMBERS - 1; i++)
+	{
+		if (pSquadLeader->m_hSquadMember[i] == this)
+			return i;
+	}
+
+	return MAX_SQUAD_MEMBERS - 1;
+}
+
 int COFSquadTalkMonster::SquadRecruit(int searchRadius, int maxMembers)
 {
 	int squadCount;
@@ -39,11 +39,16 @@ public:
 	// squad member info
 	int m_iMySlot; //!< this is the behaviour slot that the monster currently holds in the squad.
 
+	SquadPerception m_SquadPerception; //!< valid only for leader
+	int m_iLookCount = 0;
+
 	bool CheckEnemy(CBaseEntity* pEnemy) override;
 	void StartMonster() override;
 	void VacateSlot();
 	void ScheduleChange() override;
 	void Killed(CBaseEntity* attacker, int iGib) override;
+	void Look(int iDistance) override;
+	bool FLookVisible(CBaseEntity* pSightEnt) override;
 
 	/**
 	 *	@brief if any slots of the passed slots are available, the monster will be assigned to one.
@@ -72,6 +77,11 @@ public:
 		else
 			return m_hSquadMember[i];
 	}
+
+	/**
+	 *	@brief Index of this monster in its squad, as passed to MySquadMember.
+	 */
+	int MySquadIndex();
 	bool InSquad() { return m_hSquadLeader != nullptr; }
 	bool IsLeader() { return m_hSquadLeader == this; }
 
@@ -112,6 +122,7 @@ public:
 	 *	@brief called by squad members who don't have current info on the enemy.
 	 *	Reads from the same fields in the leader's data that other squad members write to,
 	 *	so the most recent data is always available here.
+	 *	If any squad member has seen the enemy more recently, that's used instead.
 	 */
 	void SquadCopyEnemyInfo();
 
@@ -267,7 +267,7 @@ void CBaseMonster::Look(int iDistance)
 				if (IRelationship(pSightEnt) != Relationship::None &&
 					FInViewCone(pSightEnt) &&
 					!FBitSet(pSightEnt->pev->flags, FL_NOTARGET) &&
-					FVisible(pSightEnt))
+					FLookVisible(pSightEnt))
 				{
 					if (pSightEnt->IsPlayer())
 					{
@@ -13,10 +13,14 @@
  *
  ****/
 
+#include <algorithm>
+#include <iterator>
+
 #include "cbase.h"
 #include "squadmonster.h"
 #include "plane.h"
 #include "military/hgrunt.h"
+#include "military/COFSquadTalkMonster.h"
 
 BEGIN_DATAMAP(CSquadMonster)
 DEFINE_FIELD(m_hSquadLeader, FIELD_EHANDLE),
@@ -29,6 +33,132 @@ DEFINE_FIELD(m_hSquadLeader, FIELD_EHANDLE),
 	DEFINE_FIELD(m_iMySlot, FIELD_INTEGER),
 	END_DATAMAP();
 
+void SquadPerception::Clear()
+{
+	for (auto& known : Entities)
+	{
+		known = {};
+	}
+}
+
+SquadPerception::KnownEntity* SquadPerception::Find(CBaseEntity* entity)
+{
+	if (!entity)
+	{
+		return nullptr;
+	}
+
+	for (auto& known : Entities)
+	{
+		if (known.Entity.Get() == entity)
+		{
+			return &known;
+		}
+	}
+
+	return nullptr;
+}
+
+SquadPerception::KnownEntity& SquadPerception::FindOrAdd(CBaseEntity* entity)
+{
+	KnownEntity* oldest = nullptr;
+	float oldestTime = 0;
+
+	for (auto& known : Entities)
+	{
+		CBaseEntity* knownEntity = known.Entity;
+
+		if (knownEntity == entity)
+		{
+			return known;
+		}
+
+		// Entries for removed entities go first
+		const float traceTime = knownEntity ? *std::max_element(std::begin(known.TraceTime), std::end(known.TraceTime)) : -1;
+
+		if (!oldest || traceTime < oldestTime)
+		{
+			oldest = &known;
+			oldestTime = traceTime;
+		}
+	}
+
+	*oldest = {};
+	oldest->Entity = entity;
+
+	return *oldest;
+}
+
+bool SquadPerception::IsVisible(CBaseMonster* looker, int memberIndex, int squadCount, int lookCount, CBaseEntity* entity)
+{
+	auto& known = FindOrAdd(entity);
+	const int memberBit = 1 << memberIndex;
+	const float traceTime = known.TraceTime[memberIndex];
+
+	const bool mustTrace = entity == looker->m_hEnemy ||
+						   traceTime == 0 ||
+						   gpGlobals->time - traceTime > MaxTraceAge ||
+						   (entity->entindex() + lookCount) % std::max(1, squadCount) == 0;
+
+	if (!mustTrace)
+	{
+		++LookTracesSaved;
+		return (known.VisibleTo & memberBit) != 0;
+	}
+
+	++LookTraces;
+	known.TraceTime[memberIndex] = gpGlobals->time;
+
+	if (!looker->FVisible(entity))
+	{
+		known.VisibleTo &= ~memberBit;
+		return false;
+	}
+
+	known.VisibleTo |= memberBit;
+	known.LastSeenPosition = entity->pev->origin;
+	known.LastSeenTime = gpGlobals->time;
+
+	return true;
+}
+
+static void PrintSquad(CBaseMonster* leader, int squadCount, const SquadPerception& perception)
+{
+	const int total = perception.LookTraces + perception.LookTracesSaved;
+
+	int knownCount = 0;
+
+	for (const auto& known : perception.Entities)
+	{
+		if (known.Entity.Get())
+		{
+			++knownCount;
+		}
+	}
+
+	Con_Printf("%-24s %5d %7d %8d %8d %5.1f%% %5d\n",
+		STRING(leader->pev->classname), leader->entindex(), squadCount,
+		perception.LookTraces, perception.LookTracesSaved,
+		total > 0 ? (perception.LookTracesSaved * 100.f) / total : 0.f, knownCount);
+}
+
+void PrintSquadStats()
+{
+	Con_Printf("%-24s %5s %7s %8s %8s %6s %5s\n", "leader", "index", "members", "traces", "saved", "", "known");
+
+	for (auto entity : UTIL_FindEntities())
+	{
+		if (auto squadMonster = entity->MySquadMonsterPointer(); squadMonster && squadMonster->IsLeader())
+		{
+			PrintSquad(squadMonster, squadMonster->SquadCount(), squadMonster->m_SquadPerception);
+		}
+		else if (auto squadTalkMonster = entity->MySquadTalkMonsterPointer(); squadTalkMonster && squadTalkMonster->IsLeader())
+		{
+			PrintSquad(squadTalkMonster, squadTalkMonster->SquadCount(), squadTalkMonster->m_SquadPerception);
+		}
+	}
+}
+
 bool CSquadMonster::OccupySlot(int iDesiredSlots)
 {
 	int i;
@@ -105,6 +235,23 @@ void CSquadMonster::Killed(CBaseEntity* attacker, int iGib)
 	CBaseMonster::Killed(attacker, iGib);
 }
 
+void CSquadMonster::Look(int iDistance)
+{
+	++m_iLookCount;
+
+	CBaseMonster::Look(iDistance);
+}
+
+bool CSquadMonster::FLookVisible(CBaseEntity* pSightEnt)
+{
+	if (!InSquad())
+	{
+		return CBaseMonster::FLookVisible(pSightEnt);
+	}
+
+	return MySquadLeader()->m_SquadPerception.IsVisible(this, MySquadIndex(), SquadCount(), m_iLookCount, pSightEnt);
+}
+
 // These functions are still awaiting conversion to CSquadMonster
 
 void CSquadMonster::SquadRemove(CSquadMonster* pRemove)
@@ -143,6 +290,8 @@ void CSquadMonster::SquadRemove(CSquadMonster* pRemove)
 	}
 
 	pRemove->m_hSquadLeader = nullptr;
+
+	m_SquadPerception.Clear();
 }
 
 bool CSquadMonster::SquadAdd(CSquadMonster* pAdd)
@@ -157,6 +306,7 @@ bool CSquadMonster::SquadAdd(CSquadMonster* pAdd)
 		{
 			m_hSquadMember[i] = pAdd;
 			pAdd->m_hSquadLeader = this;
+			m_SquadPerception.Clear();
 			return true;
 		}
 	}
@@ -168,14 +318,25 @@ void CSquadMonster::SquadPasteEnemyInfo()
 {
 	CSquadMonster* pSquadLeader = MySquadLeader();
 	if (pSquadLeader)
+	{
 		pSquadLeader->m_vecEnemyLKP = m_vecEnemyLKP;
+		pSquadLeader->m_SquadPerception.EnemyInfoTime = gpGlobals->time;
+	}
 }
 
 void CSquadMonster::SquadCopyEnemyInfo()
 {
 	CSquadMonster* pSquadLeader = MySquadLeader();
 	if (pSquadLeader)
+	{
 		m_vecEnemyLKP = pSquadLeader->m_vecEnemyLKP;
+
+		// squad members fighting something else may still have seen it since
+		auto known = pSquadLeader->m_SquadPerception.Find(m_hEnemy);
+
+		if (known && known->LastSeenTime > pSquadLeader->m_SquadPerception.EnemyInfoTime)
+			m_vecEnemyLKP = known->LastSeenPosition;
+	}
 }
 
 void CSquadMonster::SquadMakeEnemy(CBaseEntity* pEnemy)
@@ -228,6 +389,19 @@ int CSquadMonster::SquadCount()
 	return squadCount;
 }
 
+int CSquadMonster::MySquadIndex()
+{
+	CSquadMonster* pSquadLeader = MySquadLeader();
+
+	for (int i = 0; i < MAX_SQUAD_MEMBERS - 1; i++)
+	{
+		if (pSquadLeader->m_hSquadMember[i] == this)
+			return i;
+	}
+
+	return MAX_SQUAD_MEMBERS - 1;
+}
+
 int CSquadMonster::SquadRecruit(int searchRadius, int maxMembers)
 {
 	int squadCount;
@@ -47,6 +47,61 @@
 
 #define MAX_SQUAD_MEMBERS 5
 
+/**
+ *	@brief What a squad's members have seen, kept by the squad leader.
+ *	@details Members take turns tracing the entities in their view, so each one only traces a fraction of them
+ *	every think and reuses its last result for the rest.
+ *	Not saved, it's rebuilt by the members' next looks.
+ */
+struct SquadPerception
+{
+	/**
+	 *	@brief How long a member may go without tracing an entity before it has to trace it again.
+	 */
+	static constexpr float MaxTraceAge = 1;
+
+	struct KnownEntity
+	{
+		EntityHandle<CBaseEntity> Entity;
+		Vector LastSeenPosition;
+		float LastSeenTime = 0;
+
+		int VisibleTo = 0; //!< Bit per squad member index, from that member's last trace
+		float TraceTime[MAX_SQUAD_MEMBERS]{};
+	};
+
+	KnownEntity Entities[32];
+
+	float EnemyInfoTime = 0; //!< When a member last pasted enemy info to the leader
+
+	int LookTraces = 0;
+	int LookTracesSaved = 0;
+
+	/**
+	 *	@brief Forgets all entities, for when the squad's members change.
+	 */
+	void Clear();
+
+	KnownEntity* Find(CBaseEntity* entity);
+
+	/**
+	 *	@brief Finds the entry for @p entity, replacing the least recently traced entry if it has none.
+	 */
+	KnownEntity& FindOrAdd(CBaseEntity* entity);
+
+	/**
+	 *	@brief Sight check for @c Look made by squad member @p memberIndex.
+	 *	@details The looker's enemy is traced every time. Other entities are traced by each member
+	 *	on every @p squadCount th look, the rest of the time the member's last result is used.
+	 */
+	bool IsVisible(CBaseMonster* looker, int memberIndex, int squadCount, int lookCount, CBaseEntity* entity);
+};
+
+/**
+ *	@brief Prints how many sight traces each squad in the map has made and saved.
+ */
+void PrintSquadStats();
+
 /**
  *	@brief for any monster that forms squads.
  */
@@ -66,11 +121,16 @@ public:
 	// squad member info
 	int m_iMySlot; //!< this is the behaviour slot that the monster currently holds in the squad.
 
+	SquadPerception m_SquadPerception; //!< valid only for leader
+	int m_iLookCount = 0;
+
 	bool CheckEnemy(CBaseEntity* pEnemy) override;
 	void StartMonster() override;
 	void VacateSlot();
 	void ScheduleChange() override;
 	void Killed(CBaseEntity* attacker, int iGib) override;
+	void Look(int iDistance) override;
+	bool FLookVisible(CBaseEntity* pSightEnt) override;
 
 	/**
 	 *	@brief if any slots of the passed slots are available, the monster will be assigned to one.
@@ -99,6 +159,11 @@ public:
 		else
 			return m_hSquadMember[i];
 	}
+
+	/**
+	 *	@brief Index of this monster in its squad, as passed to MySquadMember.
+	 */
+	int MySquadIndex();
 	bool InSquad() { return m_hSquadLeader != nullptr; }
 	bool IsLeader() { return m_hSquadLeader == this; }
 
@@ -137,6 +202,7 @@ public:
 	 *	@brief called by squad members who don't have current info on the enemy.
 	 *	Reads from the same fields in the leader's data that other squad members write to,
 	 *	so the most recent data is always available here.
+	 *	If any squad member has seen the enemy more recently, that's used instead.
 	 */
 	void SquadCopyEnemyInfo();
 
@@ -20,6 +20,7 @@
 #include "pm_shared.h"
 #include "world.h"
 #include "sound/ServerSoundSystem.h"
+#include "utils/LoadProfiler.h"
 #include "utils/ReplacementMaps.h"
 
 static void SetObjectCollisionBox(entvars_t* pev);
@@ -30,6 +31,8 @@ int DispatchSpawn(edict_t* pent)
 
 	if (pEntity)
 	{
+		const ScopedEntitySpawnTimer spawnTimer{STRING(pEntity->pev->classname)};
+
 		// Initialize these or entities who don't link to the world won't have anything in here
 		pEntity->pev->absmin = pEntity->pev->origin - Vector(1, 1, 1);
 		pEntity->pev->absmax = pEntity->pev->origin + Vector(1, 1, 1);
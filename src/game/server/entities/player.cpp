@@ -18,6 +18,7 @@
  */
 
 #include <limits>
+#include <vector>
 
 #include <EASTL/fixed_string.h>
 
@@ -37,6 +38,7 @@
 #include "ctf/CHUDIconTrigger.h"
 #include "pm_shared.h"
 #include "hltv.h"
+#include "networking/HudDelta.h"
 #include "UserMessages.h"
 #include "client.h"
 #include "ServerLibrary.h"
@@ -3772,11 +3774,25 @@ void CBasePlayer::ItemPostFrame()
 	m_pActiveWeapon->ItemPostFrame();
 }
 
-void CBasePlayer::SendAmmoUpdate()
+void CBasePlayer::SendAmmoUpdate(HudDelta& delta)
 {
+	// This can be called before the client has finished connecting, so ignore the request.
+	if (!IsConnected())
+	{
+		return;
+	}
+
 	for (int i = 0; i < MAX_AMMO_TYPES; i++)
 	{
-		InternalSendSingleAmmoUpdate(i, true);
+		if (m_rgAmmo[i] != m_rgAmmoLast[i])
+		{
+			m_rgAmmoLast[i] = m_rgAmmo[i];
+
+			ASSERT(m_rgAmmo[i] >= 0);
+			ASSERT(m_rgAmmo[i] < 255);
+
+			delta.AddAmmo(i, m_rgAmmo[i]);
+		}
 	}
 }
 
@@ -3922,6 +3938,9 @@ void CBasePlayer::UpdateClientData()
 		g_DisplayTitleName.clear();
 	}
 
+	// HUD state changes are collected and sent in a single message after the ammo update.
+	HudDelta hudDelta;
+
 	if (pev->health != m_iClientHealth)
 	{
 		// make sure that no negative health values are sent
@@ -3929,10 +3948,7 @@ void CBasePlayer::UpdateClientData()
 		if (pev->health > 0.0f && pev->health <= 1.0f)
 			iHealth = 1;
 
-		// send "health" update message
-		MESSAGE_BEGIN(MSG_ONE, gmsgHealth, nullptr, this);
-		WRITE_SHORT(iHealth);
-		MESSAGE_END();
+		hudDelta.SetHealth(iHealth);
 
 		m_iClientHealth = pev->health;
 	}
@@ -3942,24 +3958,14 @@ void CBasePlayer::UpdateClientData()
 	{
 		m_iClientBattery = pev->armorvalue;
 
-		ASSERT(gmsgBattery > 0);
-		// send "health" update message
-		MESSAGE_BEGIN(MSG_ONE, gmsgBattery, nullptr, this);
-		WRITE_SHORT((int)pev->armorvalue);
-		MESSAGE_END();
+		hudDelta.SetBattery((int)pev->armorvalue);
 	}
 
 	if (m_WeaponBits != m_ClientWeaponBits)
 	{
 		m_ClientWeaponBits = m_WeaponBits;
 
-		const int lowerBits = m_WeaponBits & 0xFFFFFFFF;
-		const int upperBits = (m_WeaponBits >> 32) & 0xFFFFFFFF;
-
-		MESSAGE_BEGIN(MSG_ONE, gmsgWeapons, nullptr, this);
-		WRITE_LONG(lowerBits);
-		WRITE_LONG(upperBits);
-		MESSAGE_END();
+		hudDelta.SetWeapons(m_WeaponBits);
 	}
 
 	if (0 != pev->dmg_take || 0 != pev->dmg_save || m_bitsHUDDamage != m_bitsDamageType)
@@ -3979,14 +3985,7 @@ void CBasePlayer::UpdateClientData()
 		// only send down damage type that have hud art
 		int visibleDamageBits = m_bitsDamageType & DMG_SHOWNHUD;
 
-		MESSAGE_BEGIN(MSG_ONE, gmsgDamage, nullptr, this);
-		WRITE_BYTE(pev->dmg_save);
-		WRITE_BYTE(pev->dmg_take);
-		WRITE_LONG(visibleDamageBits);
-		WRITE_COORD(damageOrigin.x);
-		WRITE_COORD(damageOrigin.y);
-		WRITE_COORD(damageOrigin.z);
-		MESSAGE_END();
+		hudDelta.SetDamage(pev->dmg_save, pev->dmg_take, visibleDamageBits, damageOrigin);
 
 		pev->dmg_take = 0;
 		pev->dmg_save = 0;
@@ -3999,9 +3998,7 @@ void CBasePlayer::UpdateClientData()
 	if (fullHUDInitRequired || m_bRestored)
 	{
 		// Always tell client about battery state
-		MESSAGE_BEGIN(MSG_ONE, gmsgFlashBattery, nullptr, this);
-		WRITE_BYTE(m_iFlashBattery);
-		MESSAGE_END();
+		hudDelta.SetFlashBattery(m_iFlashBattery);
 
 		// Sync up client flashlight state.
 		UpdateFlashlight(this, FlashlightIsOn());
@@ -4039,24 +4036,34 @@ void CBasePlayer::UpdateClientData()
 				m_flFlashLightTime = 0;
 		}
 
-		MESSAGE_BEGIN(MSG_ONE, gmsgFlashBattery, nullptr, this);
-		WRITE_BYTE(m_iFlashBattery);
-		MESSAGE_END();
+		hudDelta.SetFlashBattery(m_iFlashBattery);
 	}
 
 
 	if ((m_iTrain & TRAIN_NEW) != 0)
 	{
-		ASSERT(gmsgTrain > 0);
-		// send "health" update message
-		MESSAGE_BEGIN(MSG_ONE, gmsgTrain, nullptr, this);
-		WRITE_BYTE(m_iTrain & 0xF);
-		MESSAGE_END();
+		hudDelta.SetTrain(m_iTrain);
 
 		m_iTrain &= ~TRAIN_NEW;
 	}
 
-	SendAmmoUpdate();
+	SendAmmoUpdate(hudDelta);
+
+	// Must arrive before the weapon updates so the client knows which weapons it has.
+	if (!hudDelta.IsEmpty())
+	{
+		std::array<std::byte, HudDelta::MaxMessageSize> buffer;
+		const std::size_t size = hudDelta.Write(buffer);
+
+		MESSAGE_BEGIN(MSG_ONE, gmsgHudDelta, nullptr, this);
+
+		for (std::size_t i = 0; i < size; ++i)
+		{
+			WRITE_BYTE(static_cast<int>(buffer[i]));
+		}
+
+		MESSAGE_END();
+	}
 
 	// Update all the items
 	for (int i = 0; i < MAX_WEAPON_SLOTS; i++)
@@ -4349,9 +4356,107 @@ Vector CBasePlayer::GetAutoaimVectorFromPoint(const Vector& vecSrc, float flDelt
 	return gpGlobals->v_forward;
 }
 
+/**
+ *	@brief Entities that can be autoaimed at, gathered once per server frame and shared by all players.
+ */
+struct AutoaimCandidates
+{
+	float FrameTime = -1;
+	const edict_t* EntityList = nullptr;
+	std::vector<edict_t*> Edicts;
+};
+
+static AutoaimCandidates g_AutoaimCandidates;
+
+static const std::vector<edict_t*>& GetAutoaimCandidates()
+{
+	// Rebuilt at most once per frame regardless of how many players fire.
+	// Entities that start taking damage later in the same frame are picked up on the next frame.
+	edict_t* entityList = UTIL_GetEntityList();
+
+	// The entity list is reallocated on map change so the time alone does not identify the frame.
+	if (g_AutoaimCandidates.FrameTime != gpGlobals->time || g_AutoaimCandidates.EntityList != entityList)
+	{
+		g_AutoaimCandidates.FrameTime = gpGlobals->time;
+		g_AutoaimCandidates.EntityList = entityList;
+		g_AutoaimCandidates.Edicts.clear();
+
+		edict_t* pEdict = entityList + 1;
+
+		for (int i = 1; i < gpGlobals->maxEntities; i++, pEdict++)
+		{
+			if (0 == pEdict->free && pEdict->v.takedamage == DAMAGE_AIM)
+			{
+				g_AutoaimCandidates.Edicts.push_back(pEdict);
+			}
+		}
+	}
+
+	return g_AutoaimCandidates.Edicts;
+}
+
+/**
+ *	@brief Conservative test to see if an entity's body target can lie inside the autoaim cone.
+ *	@details A target passes AutoaimDeflection's angle check only if the component of its direction
+ *	perpendicular to @p forward is at most twice @p flDelta, so this tests a bounding sphere around every
+ *	position BodyTarget can return against that cone.
+ */
+static bool IsInAutoaimCone(const edict_t* pEdict, const Vector& vecSrc, const Vector& forward, float flDelta)
+{
+	const Vector center = (pEdict->v.absmin + pEdict->v.absmax) * 0.5;
+
+	const float radius = std::max(pEdict->v.size.Length() * 0.5f, (pEdict->v.origin - center).Length()) + pEdict->v.view_ofs.Length() * 1.1f + 1;
+
+	const Vector offset = center - vecSrc;
+	const float along = DotProduct(offset, forward);
+
+	// Entirely behind the player.
+	if (along + radius < 0)
+	{
+		return false;
+	}
+
+	const float sinCone = std::min(1.f, flDelta * 2);
+
+	if (sinCone >= 1)
+	{
+		return true;
+	}
+
+	const float cosCone = std::sqrt(1 - sinCone * sinCone);
+	const float perpendicular = (offset - forward * along).Length();
+
+	// Distance from the sphere center to the cone's surface.
+	return perpendicular * cosCone - along * sinCone <= radius;
+}
+
 Vector CBasePlayer::AutoaimDeflection(const Vector& vecSrc, float flDist, float flDelta)
 {
-	edict_t* pEdict = UTIL_GetEntityList() + 1;
+	const Vector viewAngles = pev->v_angle + pev->punchangle + m_vecAutoAim;
+
+	// Weapons query the autoaim vector several times per frame with the same inputs, reuse the result.
+	if (m_AutoaimCache.Time == gpGlobals->time && m_AutoaimCache.Source == vecSrc && m_AutoaimCache.Distance == flDist && m_AutoaimCache.Delta == flDelta && m_AutoaimCache.ViewAngles == viewAngles && m_AutoaimCache.AutoAim == m_vecAutoAim && m_AutoaimCache.PlayerWaterLevel == pev->waterlevel)
+	{
+		m_fOnTarget = m_AutoaimCache.OnTarget;
+		return m_AutoaimCache.Result;
+	}
+
+	m_AutoaimCache.Time = gpGlobals->time;
+	m_AutoaimCache.Source = vecSrc;
+	m_AutoaimCache.Distance = flDist;
+	m_AutoaimCache.Delta = flDelta;
+	m_AutoaimCache.ViewAngles = viewAngles;
+	m_AutoaimCache.AutoAim = m_vecAutoAim;
+	m_AutoaimCache.PlayerWaterLevel = pev->waterlevel;
+
+	m_AutoaimCache.Result = FindAutoaimDeflection(vecSrc, flDist, flDelta);
+	m_AutoaimCache.OnTarget = m_fOnTarget;
+
+	return m_AutoaimCache.Result;
+}
+
+Vector CBasePlayer::FindAutoaimDeflection(const Vector& vecSrc, float flDist, float flDelta)
+{
 	CBaseEntity* pEntity;
 	float bestdot;
 	Vector bestdir;
@@ -4388,12 +4493,15 @@ Vector CBasePlayer::AutoaimDeflection(const Vector& vecSrc, float flDist, float
 		}
 	}
 
-	for (int i = 1; i < gpGlobals->maxEntities; i++, pEdict++)
+	const Vector forward = gpGlobals->v_forward;
+
+	for (auto pEdict : GetAutoaimCandidates())
 	{
 		Vector center;
 		Vector dir;
 		float dot;
 
+		// May have been removed or changed since the candidate list was built.
 		if (0 != pEdict->free) // Not in use
 			continue;
 
@@ -4402,6 +4510,9 @@ Vector CBasePlayer::AutoaimDeflection(const Vector& vecSrc, float flDist, float
 		if (pEdict == edict())
 			continue;
 
+		if (!IsInAutoaimCone(pEdict, vecSrc, forward, flDelta))
+			continue;
+
 		pEntity = Instance(pEdict);
 
 		if (pEntity == nullptr)
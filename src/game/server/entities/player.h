@@ -25,23 +25,15 @@
 #include "CGameRules.h"
 #include "ctf/CTFDefs.h"
 #include "palette.h"
+#include "pm_constants.h"
 #include "items/CBaseItem.h"
 #include "sound/MaterialSystem.h"
 
 class CBaseItem;
 class CRope;
+struct HudDelta;
 class CTFGoalFlag;
 
-#define PLAYER_FATAL_FALL_SPEED 1024															  // approx 60 feet
-#define PLAYER_MAX_SAFE_FALL_SPEED 580															  // approx 20 feet
-#define DAMAGE_FOR_FALL_SPEED (float)100 / (PLAYER_FATAL_FALL_SPEED - PLAYER_MAX_SAFE_FALL_SPEED) // damage per unit per second.
-#define PLAYER_MIN_BOUNCE_SPEED 200
-#define PLAYER_FALL_PUNCH_THRESHHOLD (float)350 // won't punch player's screen/make scrape noise unless player falling at least this fast.
-
-#define PLAYER_LONGJUMP_SPEED 350 // how fast we longjump
-
-#define PLAYER_DUCKING_MULTIPLIER 0.333
-
 //
 // Player PHYSICS FLAGS bits
 //
@@ -297,6 +289,21 @@ public:
 
 	Vector m_vecAutoAim;
 	bool m_fOnTarget;
+
+	// Not saved, the inputs and result of the last AutoaimDeflection call this frame.
+	struct
+	{
+		float Time = -1;
+		Vector Source;
+		float Distance = 0;
+		float Delta = 0;
+		Vector ViewAngles;
+		Vector AutoAim;
+		WaterLevel PlayerWaterLevel = WaterLevel::Dry;
+		Vector Result;
+		bool OnTarget = false;
+	} m_AutoaimCache;
+
 	int m_iDeaths;
 	float m_iRespawnFrames; // used in PlayerDeathThink() to make sure players can always respawn
 
@@ -470,8 +477,9 @@ public:
 
 	/**
 	 *	@brief makes sure the client has all the necessary ammo info, if values have changed
+	 *	@details Changed ammo slots are added to @p delta so they are all sent in one message.
 	 */
-	void SendAmmoUpdate();
+	void SendAmmoUpdate(HudDelta& delta);
 	void SendSingleAmmoUpdate(int ammoIndex, bool clearLastState);
 
 private:
@@ -523,6 +531,11 @@ public:
 	Vector GetAutoaimVector(float flDelta);
 
 	Vector GetAutoaimVectorFromPoint(const Vector& vecSrc, float flDelta);
+
+	/**
+	 *	@brief Finds the angles to deflect the aim by to hit the best target.
+	 *	The result is cached for the current frame since weapons query this several times per frame.
+	 */
 	Vector AutoaimDeflection(const Vector& vecSrc, float flDist, float flDelta);
 
 	/**
@@ -628,6 +641,11 @@ private:
 	bool m_bInfiniteArmor;
 	bool m_JetpackEnabled = false;
 
+	/**
+	 *	@brief Searches for the best autoaim target. Only call through AutoaimDeflection.
+	 */
+	Vector FindAutoaimDeflection(const Vector& vecSrc, float flDist, float flDelta);
+
 public:
 	/**
 	 *	@brief Sets the player's hud color
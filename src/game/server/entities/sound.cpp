@@ -16,55 +16,13 @@
 #include <fmt/format.h>
 
 #include "cbase.h"
+#include "client.h"
+#include "CEnvSound.h"
 #include "talkmonster.h"
+#include "UserMessages.h"
+#include "sound/AmbientModulation.h"
 #include "sound/MaterialSystem.h"
-
-/**
- *	@brief runtime pitch shift and volume fadein/out structure
- *	@details NOTE: IF YOU CHANGE THIS STRUCT YOU MUST CHANGE THE SAVE/RESTORE VERSION NUMBER
- *	SEE BELOW (in the typedescription for the class)
- */
-struct dynpitchvol_t
-{
-	// NOTE: do not change the order of these parameters
-	// NOTE: unless you also change order of rgdpvpreset array elements!
-	int preset;
-
-	int pitchrun;	// pitch shift % when sound is running 0 - 255
-	int pitchstart; // pitch shift % when sound stops or starts 0 - 255
-	int spinup;		// spinup time 0 - 100
-	int spindown;	// spindown time 0 - 100
-
-	int volrun;	  // volume change % when sound is running 0 - 10
-	int volstart; // volume change % when sound stops or starts 0 - 10
-	int fadein;	  // volume fade in time 0 - 100
-	int fadeout;  // volume fade out time 0 - 100
-
-	// Low Frequency Oscillator
-	int lfotype; // 0) off 1) square 2) triangle 3) random
-	int lforate; // 0 - 1000, how fast lfo osciallates
-
-	int lfomodpitch; // 0-100 mod of current pitch. 0 is off.
-	int lfomodvol;	 // 0-100 mod of current volume. 0 is off.
-
-	int cspinup; // each trigger hit increments counter and spinup pitch
-
-
-	int cspincount;
-
-	int pitch;
-	int spinupsav;
-	int spindownsav;
-	int pitchfrac;
-
-	int vol;
-	int fadeinsav;
-	int fadeoutsav;
-	int volfrac;
-
-	int lfofrac;
-	int lfomult;
-};
+#include "sound/RoomTypeSystem.h"
 
 #define CDPVPRESETMAX 27
 
@@ -133,6 +91,18 @@ public:
 	 */
 	void InitModulationParms();
 
+	/**
+	 *	@brief Sends the modulation parameters to clients so they can evaluate ramps and LFOs locally.
+	 *	Only used when @c sv_ambient_client_modulation was enabled when the sound started.
+	 *	@param active If @c false clients stop evaluating the modulation for this entity.
+	 */
+	void SendClientModulation(bool active);
+
+	/**
+	 *	@brief Decides whether clients should modulate the sound that is about to start and syncs them if so.
+	 */
+	void StartClientModulation();
+
 	int ObjectCaps() override { return (CBaseEntity::ObjectCaps() & ~FCAP_ACROSS_TRANSITION); }
 
 	float m_flAttenuation; // attenuation value
@@ -140,6 +110,10 @@ public:
 
 	bool m_fActive;	 // only true when the entity is playing a looping sound
 	bool m_fLooping; // true when the sound played will loop
+
+	// Not saved, re-evaluated when the sound restarts in Precache.
+	bool m_ClientModulation = false;
+	float m_LastPlayerJoinTimeCheck = 0;
 };
 
 LINK_ENTITY_TO_CLASS(ambient_generic, CAmbientGeneric);
@@ -246,204 +220,112 @@ void CAmbientGeneric::Precache()
 			(m_dpv.vol * 0.01), m_flAttenuation, SND_SPAWNING, m_dpv.pitch);
 
 		pev->nextthink = gpGlobals->time + 0.1;
+
+		StartClientModulation();
 	}
 }
 
 void CAmbientGeneric::RampThink()
 {
 	const char* szSoundFile = STRING(pev->message);
-	int pitch = m_dpv.pitch;
-	int vol = m_dpv.vol;
-	int flags = 0;
-	bool fChanged = false; // false if pitch and vol remain unchanged this round
-	int prev;
 
-	if (0 == m_dpv.spinup && 0 == m_dpv.spindown && 0 == m_dpv.fadein && 0 == m_dpv.fadeout && 0 == m_dpv.lfotype)
+	if (!IsAmbientModulated(m_dpv))
 		return; // no ramps or lfo, stop thinking
 
-	// ==============
-	// pitch envelope
-	// ==============
-	if (0 != m_dpv.spinup || 0 != m_dpv.spindown)
-	{
-		prev = m_dpv.pitchfrac >> 8;
-
-		if (m_dpv.spinup > 0)
-			m_dpv.pitchfrac += m_dpv.spinup;
-		else if (m_dpv.spindown > 0)
-			m_dpv.pitchfrac -= m_dpv.spindown;
-
-		pitch = m_dpv.pitchfrac >> 8;
-
-		if (pitch > m_dpv.pitchrun)
-		{
-			pitch = m_dpv.pitchrun;
-			m_dpv.spinup = 0; // done with ramp up
-		}
-
-		if (pitch < m_dpv.pitchstart)
-		{
-			pitch = m_dpv.pitchstart;
-			m_dpv.spindown = 0; // done with ramp down
-
-			// shut sound off
-			EmitAmbientSound(pev->origin, szSoundFile,
-				0, 0, SND_STOP, 0);
-
-			// return without setting nextthink
-			return;
-		}
-
-		if (pitch > 255)
-			pitch = 255;
-		if (pitch < 1)
-			pitch = 1;
-
-		m_dpv.pitch = pitch;
-
-		fChanged |= (prev != pitch);
-		flags |= SND_CHANGE_PITCH;
-	}
+	const auto result = UpdateAmbientModulation(m_dpv);
 
-	// ==================
-	// amplitude envelope
-	// ==================
-	if (0 != m_dpv.fadein || 0 != m_dpv.fadeout)
+	if (result.Stopped)
 	{
-		prev = m_dpv.volfrac >> 8;
+		// shut sound off
+		EmitAmbientSound(pev->origin, szSoundFile,
+			0, 0, SND_STOP, 0);
 
-		if (m_dpv.fadein > 0)
-			m_dpv.volfrac += m_dpv.fadein;
-		else if (m_dpv.fadeout > 0)
-			m_dpv.volfrac -= m_dpv.fadeout;
+		// return without setting nextthink
+		return;
+	}
 
-		vol = m_dpv.volfrac >> 8;
+	// update ramps at 5hz
+	pev->nextthink = gpGlobals->time + AmbientModulationInterval;
 
-		if (vol > m_dpv.volrun)
+	if (m_ClientModulation)
+	{
+		// Clients evaluate the same curves locally. Players that joined since the last sync need the current state.
+		if (m_LastPlayerJoinTimeCheck < g_LastPlayerJoinTime)
 		{
-			vol = m_dpv.volrun;
-			m_dpv.fadein = 0; // done with ramp up
+			SendClientModulation(true);
 		}
 
-		if (vol < m_dpv.volstart)
-		{
-			vol = m_dpv.volstart;
-			m_dpv.fadeout = 0; // done with ramp down
-
-			// shut sound off
-			EmitAmbientSound(pev->origin, szSoundFile,
-				0, 0, SND_STOP, 0);
-
-			// return without setting nextthink
-			return;
-		}
-
-		if (vol > 100)
-			vol = 100;
-		if (vol < 1)
-			vol = 1;
-
-		m_dpv.vol = vol;
-
-		fChanged |= (prev != vol);
-		flags |= SND_CHANGE_VOL;
+		return;
 	}
 
-	// ===================
-	// pitch/amplitude LFO
-	// ===================
-	if (0 != m_dpv.lfotype)
-	{
-		int pos;
-
-		if (m_dpv.lfofrac > 0x6fffffff)
-			m_dpv.lfofrac = 0;
-
-		// update lfo, lfofrac/255 makes a triangle wave 0-255
-		m_dpv.lfofrac += m_dpv.lforate;
-		pos = m_dpv.lfofrac >> 8;
-
-		if (m_dpv.lfofrac < 0)
-		{
-			m_dpv.lfofrac = 0;
-			m_dpv.lforate = abs(m_dpv.lforate);
-			pos = 0;
-		}
-		else if (pos > 255)
-		{
-			pos = 255;
-			m_dpv.lfofrac = (255 << 8);
-			m_dpv.lforate = -abs(m_dpv.lforate);
-		}
+	// Send update to playing sound only if we actually changed
+	// pitch or volume in this routine.
 
-		switch (m_dpv.lfotype)
-		{
-		case LFO_SQUARE:
-			if (pos < 128)
-				m_dpv.lfomult = 255;
-			else
-				m_dpv.lfomult = 0;
-
-			break;
-		case LFO_RANDOM:
-			if (pos == 255)
-				m_dpv.lfomult = RANDOM_LONG(0, 255);
-			break;
-		case LFO_TRIANGLE:
-		default:
-			m_dpv.lfomult = pos;
-			break;
-		}
+	if (0 != result.Flags && result.Changed)
+	{
+		EmitAmbientSound(pev->origin, szSoundFile,
+			(result.Volume * 0.01), m_flAttenuation, result.Flags, result.Pitch);
+	}
+}
 
-		if (0 != m_dpv.lfomodpitch)
-		{
-			prev = pitch;
+void CAmbientGeneric::SendClientModulation(bool active)
+{
+	m_LastPlayerJoinTimeCheck = g_LastPlayerJoinTime;
 
-			// pitch 0-255
-			pitch += ((m_dpv.lfomult - 128) * m_dpv.lfomodpitch) / 100;
+	MESSAGE_BEGIN(MSG_ALL, gmsgAmbientModulation);
+	WRITE_SHORT(entindex());
+	WRITE_BYTE(active ? 1 : 0);
 
-			if (pitch > 255)
-				pitch = 255;
-			if (pitch < 1)
-				pitch = 1;
+	if (active)
+	{
+		// Time until the next step in hundredths of a second so clients stay in phase with the server.
+		WRITE_BYTE(std::clamp(static_cast<int>((pev->nextthink - gpGlobals->time) * 100), 0, 255));
+
+		WRITE_BYTE(m_dpv.pitchrun);
+		WRITE_BYTE(m_dpv.pitchstart);
+		WRITE_SHORT(m_dpv.spinup);
+		WRITE_SHORT(m_dpv.spindown);
+
+		WRITE_BYTE(m_dpv.volrun);
+		WRITE_BYTE(m_dpv.volstart);
+		WRITE_SHORT(m_dpv.fadein);
+		WRITE_SHORT(m_dpv.fadeout);
+
+		WRITE_BYTE(m_dpv.lfotype);
+		WRITE_LONG(m_dpv.lforate);
+		WRITE_BYTE(m_dpv.lfomodpitch);
+		WRITE_BYTE(m_dpv.lfomodvol);
+
+		WRITE_BYTE(m_dpv.pitch);
+		WRITE_BYTE(m_dpv.vol);
+		WRITE_LONG(m_dpv.pitchfrac);
+		WRITE_LONG(m_dpv.volfrac);
+		WRITE_LONG(m_dpv.lfofrac);
+		WRITE_BYTE(m_dpv.lfomult);
+	}
 
+	MESSAGE_END();
+}
 
-			fChanged |= (prev != pitch);
-			flags |= SND_CHANGE_PITCH;
-		}
+void CAmbientGeneric::StartClientModulation()
+{
+	const bool clientModulation = sv_ambient_client_modulation.value != 0 && IsAmbientModulated(m_dpv);
 
-		if (0 != m_dpv.lfomodvol)
+	if (clientModulation)
+	{
+		// Sounds started while the map is loading are synced by RampThink once a player has joined.
+		if (g_LastPlayerJoinTime != 0)
 		{
-			// vol 0-100
-			prev = vol;
-
-			vol += ((m_dpv.lfomult - 128) * m_dpv.lfomodvol) / 100;
-
-			if (vol > 100)
-				vol = 100;
-			if (vol < 0)
-				vol = 0;
-
-			fChanged |= (prev != vol);
-			flags |= SND_CHANGE_VOL;
+			SendClientModulation(true);
 		}
 	}
-
-	// Send update to playing sound only if we actually changed
-	// pitch or volume in this routine.
-
-	if (0 != flags && fChanged)
+	else if (m_ClientModulation)
 	{
-		if (pitch == PITCH_NORM)
-			pitch = PITCH_NORM + 1; // don't send 'no pitch' !
-
-		EmitAmbientSound(pev->origin, szSoundFile,
-			(vol * 0.01), m_flAttenuation, flags, pitch);
+		// Stop clients from modulating the new sound using the old parameters.
+		SendClientModulation(false);
 	}
 
-	// update ramps at 5hz
-	pev->nextthink = gpGlobals->time + 0.2;
-	return;
+	m_ClientModulation = clientModulation;
 }
 
 void CAmbientGeneric::InitModulationParms()
@@ -553,6 +435,11 @@ void CAmbientGeneric::ToggleUse(CBaseEntity* pActivator, CBaseEntity* pCaller, U
 		EmitAmbientSound(pev->origin, szSoundFile,
 			0, 0, SND_CHANGE_PITCH, m_dpv.pitch);
 
+		if (m_ClientModulation)
+		{
+			SendClientModulation(true);
+		}
+
 		return;
 	}
 
@@ -585,6 +472,11 @@ void CAmbientGeneric::ToggleUse(CBaseEntity* pActivator, CBaseEntity* pCaller, U
 					m_dpv.pitchrun = 255;
 
 				pev->nextthink = gpGlobals->time + 0.1;
+
+				if (m_ClientModulation)
+				{
+					SendClientModulation(true);
+				}
 			}
 		}
 		else
@@ -603,10 +495,23 @@ void CAmbientGeneric::ToggleUse(CBaseEntity* pActivator, CBaseEntity* pCaller, U
 				m_dpv.fadeout = m_dpv.fadeoutsav;
 				m_dpv.fadein = 0;
 				pev->nextthink = gpGlobals->time + 0.1;
+
+				if (m_ClientModulation)
+				{
+					SendClientModulation(true);
+				}
 			}
 			else
+			{
 				EmitAmbientSound(pev->origin, szSoundFile,
 					0, 0, SND_STOP, 0);
+
+				if (m_ClientModulation)
+				{
+					SendClientModulation(false);
+					m_ClientModulation = false;
+				}
+			}
 		}
 	}
 	else
@@ -632,6 +537,8 @@ void CAmbientGeneric::ToggleUse(CBaseEntity* pActivator, CBaseEntity* pCaller, U
 			(m_dpv.vol * 0.01), m_flAttenuation, 0, m_dpv.pitch);
 
 		pev->nextthink = gpGlobals->time + 0.1;
+
+		StartClientModulation();
 	}
 }
 
@@ -1032,36 +939,6 @@ std::string CAmbientMusic::GetCommand() const
 	}();
 }
 
-/**
- *	@brief A sound entity that will set player roomtype when player moves in range and sight.
- *	@details A client that is visible and in range of a sound entity will have its room_type set by that sound entity.
- *	If two or more sound entities are contending for a client,
- *	then the nearest sound entity to the client will set the client's room_type.
- *	A client's room_type will remain set to its prior value until a new in-range,
- *	visible sound entity resets a new room_type.
- */
-class CEnvSound : public CPointEntity
-{
-	DECLARE_CLASS(CEnvSound, CPointEntity);
-	DECLARE_DATAMAP();
-
-public:
-	bool KeyValue(KeyValueData* pkvd) override;
-	void Spawn() override;
-
-	/**
-	*	@brief A client that is visible and in range of a sound entity will have its room_type set by that sound entity.If two or more
-// sound entities are contending for a client, then the nearest
-// sound entity to the client will set the client's room_type.
-// A client's room_type will remain set to its prior value until
-// a new in-range, visible sound entity resets a new room_type.
-	*/
-	void Think() override;
-
-	float m_flRadius;
-	int m_Roomtype;
-};
-
 LINK_ENTITY_TO_CLASS(env_sound, CEnvSound);
 
 BEGIN_DATAMAP(CEnvSound)
@@ -1069,6 +946,21 @@ DEFINE_FIELD(m_flRadius, FIELD_FLOAT),
 	DEFINE_FIELD(m_Roomtype, FIELD_INTEGER),
 	END_DATAMAP();
 
+void CEnvSound::OnCreate()
+{
+	CPointEntity::OnCreate();
+
+	// Also called for entities restored from a save game.
+	sound::g_RoomTypes.AddSoundEntity(this);
+}
+
+void CEnvSound::OnDestroy()
+{
+	sound::g_RoomTypes.RemoveSoundEntity(this);
+
+	CPointEntity::OnDestroy();
+}
+
 bool CEnvSound::KeyValue(KeyValueData* pkvd)
 {
 
@@ -1086,9 +978,6 @@ bool CEnvSound::KeyValue(KeyValueData* pkvd)
 	return false;
 }
 
-/**
- *	@brief returns true if the given sound entity (pSound) is in range and can see the given player entity (target)
- */
 bool FEnvSoundInRange(CEnvSound* pSound, CBaseEntity* target, float& flRange)
 {
 	const Vector vecSpot1 = pSound->pev->origin + pSound->pev->view_ofs;
@@ -1112,82 +1001,6 @@ bool FEnvSoundInRange(CEnvSound* pSound, CBaseEntity* target, float& flRange)
 
 // CONSIDER: if player in water state, autoset roomtype to 14,15 or 16.
 
-void CEnvSound::Think()
-{
-	const bool shouldThinkFast = [this]()
-	{
-		// get pointer to client if visible; UTIL_FindClientInPVS will
-		// cycle through visible clients on consecutive calls.
-		CBasePlayer* player = UTIL_FindClientInPVS(this);
-
-		if (!player)
-			return false; // no player in pvs of sound entity, slow it down
-
-		// check to see if this is the sound entity that is currently affecting this player
-		float flRange;
-
-		if (player->m_SndLast && player->m_SndLast == this)
-		{
-			// this is the entity currently affecting player, check for validity
-			if (player->m_SndRoomtype != 0 && player->m_flSndRange != 0)
-			{
-				// we're looking at a valid sound entity affecting
-				// player, make sure it's still valid, update range
-				if (FEnvSoundInRange(this, player, flRange))
-				{
-					player->m_flSndRange = flRange;
-					return true;
-				}
-				else
-				{
-					// current sound entity affecting player is no longer valid,
-					// flag this state by clearing sound handle and range.
-					// NOTE: we do not actually change the player's room_type
-					// NOTE: until we have a new valid room_type to change it to.
-
-					player->m_SndLast = nullptr;
-					player->m_flSndRange = 0;
-				}
-			}
-
-			// entity is affecting player but is out of range,
-			// wait passively for another entity to usurp it...
-			return false;
-		}
-
-		// if we got this far, we're looking at an entity that is contending
-		// for current player sound. the closest entity to player wins.
-		if (FEnvSoundInRange(this, player, flRange))
-		{
-			if (flRange < player->m_flSndRange || player->m_flSndRange == 0)
-			{
-				// new entity is closer to player, so it wins.
-				player->m_SndLast = this;
-				player->m_SndRoomtype = m_Roomtype;
-				player->m_flSndRange = flRange;
-
-				// New room type is sent to player in CBasePlayer::UpdateClientData.
-
-				// crank up nextthink rate for new active sound entity
-			}
-			// player is not closer to the contending sound entity.
-			// this effectively cranks up the think rate of env_sound entities near the player.
-		}
-
-		// player is in pvs of sound entity, but either not visible or not in range. do nothing.
-
-		return true;
-	}();
-
-	pev->nextthink = gpGlobals->time + (shouldThinkFast ? 0.25 : 0.75);
-}
-
-void CEnvSound::Spawn()
-{
-	// spread think times
-	pev->nextthink = gpGlobals->time + RANDOM_FLOAT(0.0, 0.5);
-}
-
 // ===================== MATERIAL TYPE DETECTION, MAIN ROUTINES ========================
 
 /**
@@ -26,6 +26,7 @@
 #include "world.h"
 #include "ServerLibrary.h"
 #include "ctf/ctf_items.h"
+#include "utils/LoadProfiler.h"
 
 /**
  *	@details This must match the list in util.h
@@ -365,24 +366,28 @@ void CWorld::Precache()
 
 	g_GameLogger->trace("Setting up node graph");
 
-	// init the WorldGraph.
-	WorldGraph.InitGraph();
+	{
+		const ScopedLoadTimer nodeGraphTimer{"NodeGraph", "Load"};
 
-	// make sure the .NOD file is newer than the .BSP file.
-	if (!WorldGraph.CheckNODFile(STRING(gpGlobals->mapname)))
-	{ // NOD file is not present, or is older than the BSP file.
-		WorldGraph.AllocNodes();
-	}
-	else
-	{ // Load the node graph for this level
-		if (!WorldGraph.FLoadGraph(STRING(gpGlobals->mapname)))
-		{ // couldn't load, so alloc and prepare to build a graph.
-			CGraph::Logger->debug("*Error opening .NOD file");
+		// init the WorldGraph.
+		WorldGraph.InitGraph();
+
+		// make sure the .NOD file is newer than the .BSP file.
+		if (!WorldGraph.CheckNODFile(STRING(gpGlobals->mapname)))
+		{ // NOD file is not present, or is older than the BSP file.
 			WorldGraph.AllocNodes();
 		}
 		else
-		{
-			CGraph::Logger->debug("\n*Graph Loaded!");
+		{ // Load the node graph for this level
+			if (!WorldGraph.FLoadGraph(STRING(gpGlobals->mapname)))
+			{ // couldn't load, so alloc and prepare to build a graph.
+				CGraph::Logger->debug("*Error opening .NOD file");
+				WorldGraph.AllocNodes();
+			}
+			else
+			{
+				CGraph::Logger->debug("\n*Graph Loaded!");
+			}
 		}
 	}
 
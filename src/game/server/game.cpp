@@ -55,6 +55,8 @@ cvar_t sv_entityinfo_eager{"sv_entityinfo_eager", "1", FCVAR_SERVER};
 
 cvar_t sv_schedule_debug{"sv_schedule_debug", "0", FCVAR_SERVER};
 
+cvar_t sv_ambient_client_modulation{"sv_ambient_client_modulation", "1", FCVAR_SERVER};
+
 static bool SV_InitServer()
 {
 	if (!FileSystem_LoadFileSystem())
@@ -138,6 +140,8 @@ void GameDLLInit()
 
 	CVAR_REGISTER(&sv_schedule_debug);
 
+	CVAR_REGISTER(&sv_ambient_client_modulation);
+
 	// Link user messages immediately so there are no race conditions.
 	LinkUserMessages();
 }
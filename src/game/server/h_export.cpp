@@ -20,6 +20,7 @@
 #include "cbase.h"
 #include "client.h"
 #include "pm_shared.h"
+#include "PlayerMovementBenchmark.h"
 
 #ifdef WIN32
 #define GIVEFNPTRSTODLL_DLLEXPORT __stdcall
@@ -77,7 +78,8 @@ static DLL_FUNCTIONS gFunctionTable =
 
 		Sys_Error, // pfnSys_Error				Called when engine has encountered an error
 
-		PM_Move, // pfnPM_Move
+		[](playermove_t* ppmove, qboolean server)
+		{ g_PlayerMovementBenchmark.RunPlayerMove(ppmove, server); }, // pfnPM_Move
 		PM_Init, // pfnPM_Init				Server version of player movement initialization
 		[](const char* name)
 		{ return g_MaterialSystem.FindTextureType(name); }, // pfnPM_FindTextureType
@@ -24,6 +24,7 @@
 #include "nodes.h"
 #include "doors.h"
 #include "filesystem_utils.h"
+#include "utils/LoadProfiler.h"
 
 #define HULL_STEP_SIZE 16 // how far the test hull moves on each step
 #define NODE_HEIGHT 8	  // how high to lift nodes off the ground after we drop them all (make stair/ramp mapping easier)
@@ -1600,6 +1601,8 @@ void CTestHull::ShowBadNode()
 
 void CTestHull::CallBuildNodeGraph()
 {
+	const ScopedLoadTimer timer{"NodeGraph", "Build"};
+
 	// TOUCH HACK -- Don't allow this entity to call anyone's "touch" function
 	gTouchDisabled = true;
 	BuildNodeGraph();
@@ -0,0 +1,257 @@
+/***
+ *
+ *	Copyright (c) 1996-2001, Valve LLC. All rights reserved.
+ *
+ *	This product contains software technology licensed from Id
+ *	Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *	All Rights Reserved.
+ *
+ *   Use, distribution, and modification of this source code and/or resulting
+ *   object code is restricted to non-commercial enhancements to products from
+ *   Valve LLC.  All other use, distribution, or modification is prohibited
+ *   without written permission from Valve LLC.
+ *
+ ****/
+
+#include <algorithm>
+#include <cmath>
+
+#include "cbase.h"
+#include "CEnvSound.h"
+#include "RoomTypeSystem.h"
+
+namespace sound
+{
+/**
+ *	@brief How often each player's room type is re-evaluated. Matches the rate at which env_sound used to think near players.
+ */
+constexpr float RoomTypeUpdateInterval = 0.25f;
+
+constexpr float RoomTypeCellSize = 512;
+
+/**
+ *	@brief Entities that would be added to more cells than this are checked for every player instead.
+ */
+constexpr int RoomTypeMaxCellsPerEntity = 64;
+
+/**
+ *	@brief A contending env_sound must be this much closer than the current one to take over,
+ *	so players standing halfway between two env_sounds don't flip between room types.
+ */
+constexpr float RoomTypeSwitchDistance = 32;
+
+static int GetCellCoordinate(float value)
+{
+	return static_cast<int>(std::floor(value / RoomTypeCellSize));
+}
+
+bool RoomTypeSystem::Initialize()
+{
+	m_MaxTraces = g_ConCommands.CreateCVar("roomtype_max_traces", "16");
+	return true;
+}
+
+void RoomTypeSystem::RunFrame()
+{
+	// Handle level changes.
+	if (gpGlobals->time < m_LastUpdateTime)
+	{
+		m_NextPlayerUpdateTimes.fill(0);
+		m_NextPlayerIndex = 1;
+	}
+
+	m_LastUpdateTime = gpGlobals->time;
+
+	if (m_SoundEntities.empty())
+	{
+		return;
+	}
+
+	if (m_GridDirty)
+	{
+		RebuildGrid();
+	}
+
+	int tracesLeft = std::max(1, static_cast<int>(m_MaxTraces->value));
+
+	bool updatedPlayer = false;
+
+	// Start with the player that ran out of traces last frame so every player gets updated eventually.
+	for (int i = 0; i < gpGlobals->maxClients; ++i)
+	{
+		const int index = ((m_NextPlayerIndex - 1 + i) % gpGlobals->maxClients) + 1;
+
+		if (m_NextPlayerUpdateTimes[index] > gpGlobals->time)
+		{
+			continue;
+		}
+
+		auto player = UTIL_PlayerByIndex(index);
+
+		if (!player || !player->IsConnected())
+		{
+			continue;
+		}
+
+		// The first player is allowed to go over the budget.
+		// Otherwise a player with more candidates than the budget would never finish and block everyone after them.
+		if (!UpdatePlayer(player, tracesLeft, !updatedPlayer))
+		{
+			m_NextPlayerIndex = index;
+			return;
+		}
+
+		updatedPlayer = true;
+
+		m_NextPlayerUpdateTimes[index] = gpGlobals->time + RoomTypeUpdateInterval;
+	}
+}
+
+void RoomTypeSystem::AddSoundEntity(CEnvSound* entity)
+{
+	m_SoundEntities.push_back(entity);
+	m_GridDirty = true;
+}
+
+void RoomTypeSystem::RemoveSoundEntity(CEnvSound* entity)
+{
+	if (auto it = std::find(m_SoundEntities.begin(), m_SoundEntities.end(), entity); it != m_SoundEntities.end())
+	{
+		m_SoundEntities.erase(it);
+		m_GridDirty = true;
+	}
+}
+
+void RoomTypeSystem::RebuildGrid()
+{
+	m_GridDirty = false;
+
+	m_Grid.clear();
+	m_LargeSoundEntities.clear();
+
+	for (auto entity : m_SoundEntities)
+	{
+		if (entity->m_flRadius <= 0)
+		{
+			continue;
+		}
+
+		const Vector center = entity->pev->origin + entity->pev->view_ofs;
+		const Vector extents{entity->m_flRadius, entity->m_flRadius, entity->m_flRadius};
+
+		const Vector mins = center - extents;
+		const Vector maxs = center + extents;
+
+		const int minX = GetCellCoordinate(mins.x), maxX = GetCellCoordinate(maxs.x);
+		const int minY = GetCellCoordinate(mins.y), maxY = GetCellCoordinate(maxs.y);
+		const int minZ = GetCellCoordinate(mins.z), maxZ = GetCellCoordinate(maxs.z);
+
+		if ((maxX - minX + 1) * (maxY - minY + 1) * (maxZ - minZ + 1) > RoomTypeMaxCellsPerEntity)
+		{
+			m_LargeSoundEntities.push_back(entity);
+			continue;
+		}
+
+		for (int x = minX; x <= maxX; ++x)
+		{
+			for (int y = minY; y <= maxY; ++y)
+			{
+				for (int z = minZ; z <= maxZ; ++z)
+				{
+					m_Grid[GetCellKey(x, y, z)].push_back(entity);
+				}
+			}
+		}
+	}
+}
+
+bool RoomTypeSystem::UpdatePlayer(CBasePlayer* player, int& tracesLeft, bool ignoreBudget)
+{
+	const Vector eyes = player->pev->origin + player->pev->view_ofs;
+
+	m_Candidates.clear();
+
+	const auto addCandidates = [&, this](const std::vector<CEnvSound*>& entities)
+	{
+		for (auto entity : entities)
+		{
+			const float range = (eyes - (entity->pev->origin + entity->pev->view_ofs)).Length();
+
+			if (range <= entity->m_flRadius)
+			{
+				m_Candidates.push_back({entity, range});
+			}
+		}
+	};
+
+	if (auto cell = m_Grid.find(GetCellKey(GetCellCoordinate(eyes.x), GetCellCoordinate(eyes.y), GetCellCoordinate(eyes.z)));
+		cell != m_Grid.end())
+	{
+		addCandidates(cell->second);
+	}
+
+	addCandidates(m_LargeSoundEntities);
+
+	std::sort(m_Candidates.begin(), m_Candidates.end(), [](const auto& lhs, const auto& rhs)
+		{ return lhs.Range < rhs.Range; });
+
+	const bool hasCurrent = player->m_SndLast && player->m_flSndRange != 0;
+	const float switchRange = player->m_flSndRange - RoomTypeSwitchDistance;
+
+	// The first pass only considers the current env_sound and those that are clearly closer.
+	// If the current one is no longer valid the second pass considers the rest.
+	const int passes = hasCurrent ? 2 : 1;
+
+	for (int pass = 0; pass < passes; ++pass)
+	{
+		for (const auto& candidate : m_Candidates)
+		{
+			const bool isCurrent = hasCurrent && player->m_SndLast == candidate.Entity;
+			const bool isCloser = candidate.Range <= switchRange;
+
+			if (hasCurrent && (pass == 0 ? !isCurrent && !isCloser : isCurrent || isCloser))
+			{
+				continue;
+			}
+
+			if (tracesLeft <= 0 && !ignoreBudget)
+			{
+				return false;
+			}
+
+			--tracesLeft;
+
+			float range;
+
+			if (!FEnvSoundInRange(candidate.Entity, player, range))
+			{
+				continue;
+			}
+
+			if (!isCurrent)
+			{
+				player->m_SndLast = candidate.Entity;
+				player->m_SndRoomtype = candidate.Entity->m_Roomtype;
+
+				// New room type is sent to player in CBasePlayer::UpdateClientData.
+			}
+
+			player->m_flSndRange = range;
+			return true;
+		}
+	}
+
+	// No env_sound in range and visible. The player keeps their room type until a new env_sound takes over.
+	player->m_SndLast = nullptr;
+	player->m_flSndRange = 0;
+
+	return true;
+}
+
+std::uint64_t RoomTypeSystem::GetCellKey(int x, int y, int z)
+{
+	constexpr std::uint64_t Mask = (1 << 21) - 1;
+
+	return ((static_cast<std::uint64_t>(x) & Mask) << 42) | ((static_cast<std::uint64_t>(y) & Mask) << 21) | (static_cast<std::uint64_t>(z) & Mask);
+}
+}
@@ -0,0 +1,94 @@
+/***
+ *
+ *	Copyright (c) 1996-2001, Valve LLC. All rights reserved.
+ *
+ *	This product contains software technology licensed from Id
+ *	Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *	All Rights Reserved.
+ *
+ *   Use, distribution, and modification of this source code and/or resulting
+ *   object code is restricted to non-commercial enhancements to products from
+ *   Valve LLC.  All other use, distribution, or modification is prohibited
+ *   without written permission from Valve LLC.
+ *
+ ****/
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "cdll_dll.h"
+#include "GameSystem.h"
+
+class CBasePlayer;
+class CEnvSound;
+struct cvar_t;
+
+namespace sound
+{
+/**
+ *	@brief Resolves the room type of each player from the env_sound entities in the map.
+ *	@details env_sound entities are bucketed into a grid so each player only considers the ones near it.
+ *	Candidates are traced nearest first and the first visible one wins.
+ *	The number of traces per frame is limited by @c sv_roomtype_max_traces;
+ *	players that could not be updated in a frame are updated first on the next frame,
+ *	and the first player updated in a frame is always allowed to finish.
+ */
+class RoomTypeSystem final : public IGameSystem
+{
+public:
+	const char* GetName() const override { return "RoomType"; }
+
+	bool Initialize() override;
+
+	void PostInitialize() override {}
+
+	void Shutdown() override {}
+
+	void RunFrame();
+
+	void AddSoundEntity(CEnvSound* entity);
+
+	void RemoveSoundEntity(CEnvSound* entity);
+
+private:
+	struct Candidate
+	{
+		CEnvSound* Entity;
+		float Range;
+	};
+
+	void RebuildGrid();
+
+	/**
+	 *	@param ignoreBudget If @c true the player is always resolved, even if that uses more traces than are left.
+	 *	@return @c false if the trace budget ran out before the player could be resolved.
+	 */
+	bool UpdatePlayer(CBasePlayer* player, int& tracesLeft, bool ignoreBudget);
+
+	static std::uint64_t GetCellKey(int x, int y, int z);
+
+private:
+	cvar_t* m_MaxTraces{};
+
+	std::vector<CEnvSound*> m_SoundEntities;
+
+	bool m_GridDirty = true;
+
+	std::unordered_map<std::uint64_t, std::vector<CEnvSound*>> m_Grid;
+
+	// Entities whose radius covers too many cells to bucket, checked for every player.
+	std::vector<CEnvSound*> m_LargeSoundEntities;
+
+	std::vector<Candidate> m_Candidates;
+
+	float m_LastUpdateTime = 0;
+	int m_NextPlayerIndex = 1;
+	std::array<float, MAX_PLAYERS + 1> m_NextPlayerUpdateTimes{};
+};
+
+inline RoomTypeSystem g_RoomTypes;
+}
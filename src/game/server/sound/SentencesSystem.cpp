@@ -29,8 +29,6 @@
 
 namespace sentences
 {
-constexpr std::string_view SentencesSchemaName{"Sentences"sv};
-
 static std::string GetSentencesSchema()
 {
 	return fmt::format(R"(
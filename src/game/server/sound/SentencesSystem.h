@@ -18,6 +18,7 @@
 #include <memory>
 #include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <spdlog/logger.h>
@@ -31,6 +32,8 @@ class CBaseEntity;
 
 namespace sentences
 {
+constexpr std::string_view SentencesSchemaName{"Sentences"};
+
 struct Sentence
 {
 	SentenceName Name;
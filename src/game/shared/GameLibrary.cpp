@@ -25,6 +25,8 @@
 
 #include "networking/NetworkDataSystem.h"
 
+#include "player_movement/pm_shared.h"
+
 #include "scripting/AS/ASManager.h"
 
 #include "sound/MaterialSystem.h"
@@ -34,6 +36,7 @@
 #include "utils/ConCommandSystem.h"
 #include "utils/GameSystem.h"
 #include "utils/JSONSystem.h"
+#include "utils/LoadProfiler.h"
 #include "utils/ReplacementMaps.h"
 
 bool GameLibrary::Initialize()
@@ -46,6 +49,12 @@ bool GameLibrary::Initialize()
 
 	g_pDeveloper = g_ConCommands.GetCVar("developer");
 
+	// Profile startup to see how long each game system takes to initialize.
+	if (COM_HasParam("-load_profile"))
+	{
+		g_LoadProfiler.Begin("startup");
+	}
+
 	AddGameSystems();
 
 	if (!g_GameSystems.Initialize())
@@ -58,11 +67,20 @@ bool GameLibrary::Initialize()
 	CBaseEntity::Logger = g_Logging.CreateLogger("ent");
 	CBasePlayerWeapon::WeaponsLogger = g_Logging.CreateLogger("ent.weapons");
 
-	g_GameSystems.Invoke(&IGameSystem::PostInitialize);
+	g_GameSystems.PostInitialize();
 
 	g_ConCommands.CreateCommand("log_setentlevels", [this](const auto& args)
 		{ SetEntLogLevels(args); });
 
+	PM_CreateCommands();
+
+	if (g_LoadProfiler.IsActive())
+	{
+		g_LoadProfiler.End();
+		g_LoadProfiler.PrintTable(LoadProfileConsoleEntries);
+		g_LoadProfiler.WriteToFile(fmt::format("{}/startup_{}.json", LoadProfileDirectory, GetShortLibraryPrefix()));
+	}
+
 	return true;
 }
 
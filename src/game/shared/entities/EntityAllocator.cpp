@@ -0,0 +1,194 @@
+/***
+ *
+ *	Copyright (c) 1996-2001, Valve LLC. All rights reserved.
+ *
+ *	This product contains software technology licensed from Id
+ *	Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *	All Rights Reserved.
+ *
+ *   Use, distribution, and modification of this source code and/or resulting
+ *   object code is restricted to non-commercial enhancements to products from
+ *   Valve LLC.  All other use, distribution, or modification is prohibited
+ *   without written permission from Valve LLC.
+ *
+ ****/
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+#include "cbase.h"
+#include "EntityAllocator.h"
+
+EntityAllocator::~EntityAllocator()
+{
+	for (auto& pool : m_Pools)
+	{
+		for (auto slab : pool.Slabs)
+		{
+			::operator delete(slab, BlockAlignment);
+		}
+	}
+}
+
+void* EntityAllocator::Allocate(std::size_t size)
+{
+	const std::size_t poolIndex = (sizeof(BlockHeader) + size + Granularity - 1) / Granularity;
+	const std::size_t blockSize = GetBlockSize(poolIndex);
+
+	BlockHeader* header;
+
+	if (blockSize > MaximumBlockSize)
+	{
+		header = static_cast<BlockHeader*>(::operator new(sizeof(BlockHeader) + size, BlockAlignment));
+		header->PoolIndex = LargeAllocation;
+	}
+	else
+	{
+		if (poolIndex >= m_Pools.size())
+		{
+			m_Pools.resize(poolIndex + 1);
+		}
+
+		auto& pool = m_Pools[poolIndex];
+
+		if (!pool.FreeList)
+		{
+			const std::size_t blockCount = GetBlocksPerSlab(blockSize);
+
+			auto slab = static_cast<std::byte*>(::operator new(blockSize * blockCount, BlockAlignment));
+
+			pool.Slabs.push_back(slab);
+
+			// Link blocks in address order so consecutive allocations are adjacent in memory.
+			for (std::size_t i = blockCount; i-- > 0;)
+			{
+				auto block = reinterpret_cast<FreeBlock*>(slab + i * blockSize);
+				block->Next = pool.FreeList;
+				pool.FreeList = block;
+			}
+		}
+
+		auto block = pool.FreeList;
+		pool.FreeList = block->Next;
+		++pool.LiveBlocks;
+
+		header = reinterpret_cast<BlockHeader*>(block);
+		header->PoolIndex = static_cast<std::uint32_t>(poolIndex);
+	}
+
+	header->ClassIndex = TakeClassIndex(size);
+
+	auto memory = header + 1;
+
+	// Allocate zero-initialized memory.
+	std::memset(memory, 0, size);
+
+	return memory;
+}
+
+void EntityAllocator::Free(void* memory)
+{
+	if (!memory)
+	{
+		return;
+	}
+
+	auto header = static_cast<BlockHeader*>(memory) - 1;
+
+	auto& stats = m_ClassStats[header->ClassIndex];
+	--stats.Live;
+
+	if (header->PoolIndex == LargeAllocation)
+	{
+		::operator delete(header, BlockAlignment);
+		return;
+	}
+
+	auto& pool = m_Pools[header->PoolIndex];
+
+	auto block = reinterpret_cast<FreeBlock*>(header);
+	block->Next = pool.FreeList;
+	pool.FreeList = block;
+	--pool.LiveBlocks;
+}
+
+std::uint32_t EntityAllocator::TakeClassIndex(std::size_t size)
+{
+	std::string_view className = m_NextClassName;
+	m_NextClassName = {};
+
+	if (className.empty())
+	{
+		className = "<unnamed>";
+	}
+
+	auto it = m_ClassIndices.find(className);
+
+	if (it == m_ClassIndices.end())
+	{
+		it = m_ClassIndices.emplace(className, static_cast<std::uint32_t>(m_ClassStats.size())).first;
+		m_ClassStats.push_back(ClassStats{.ClassName = className, .Size = size});
+	}
+
+	auto& stats = m_ClassStats[it->second];
+
+	++stats.Live;
+	++stats.Total;
+	stats.Peak = std::max(stats.Peak, stats.Live);
+
+	return it->second;
+}
+
+void EntityAllocator::PrintStats() const
+{
+	std::vector<const ClassStats*> stats;
+	stats.reserve(m_ClassStats.size());
+
+	for (const auto& classStats : m_ClassStats)
+	{
+		stats.push_back(&classStats);
+	}
+
+	std::sort(stats.begin(), stats.end(), [](const auto lhs, const auto rhs)
+		{ return lhs->Live * lhs->Size > rhs->Live * rhs->Size; });
+
+	Con_Printf("%-32s %8s %8s %8s %8s %10s\n", "class", "size", "live", "peak", "total", "bytes");
+
+	std::size_t liveBytes = 0;
+
+	for (const auto classStats : stats)
+	{
+		const std::size_t bytes = classStats->Live * classStats->Size;
+
+		Con_Printf("%-32.*s %8d %8d %8d %8d %10d\n",
+			static_cast<int>(classStats->ClassName.size()), classStats->ClassName.data(),
+			static_cast<int>(classStats->Size), classStats->Live, classStats->Peak, classStats->Total, static_cast<int>(bytes));
+
+		liveBytes += bytes;
+	}
+
+	Con_Printf("\n%-10s %8s %8s %10s\n", "block size", "slabs", "live", "reserved");
+
+	std::size_t reservedBytes = 0;
+
+	for (std::size_t i = 0; i < m_Pools.size(); ++i)
+	{
+		const auto& pool = m_Pools[i];
+
+		if (pool.Slabs.empty())
+		{
+			continue;
+		}
+
+		const std::size_t blockSize = GetBlockSize(i);
+		const std::size_t bytes = pool.Slabs.size() * GetBlocksPerSlab(blockSize) * blockSize;
+
+		Con_Printf("%-10d %8d %8d %10d\n",
+			static_cast<int>(blockSize), static_cast<int>(pool.Slabs.size()), static_cast<int>(pool.LiveBlocks), static_cast<int>(bytes));
+
+		reservedBytes += bytes;
+	}
+
+	Con_Printf("%d bytes in live entities, %d bytes reserved in slabs\n", static_cast<int>(liveBytes), static_cast<int>(reservedBytes));
+}
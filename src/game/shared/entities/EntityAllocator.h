@@ -0,0 +1,120 @@
+/***
+ *
+ *	Copyright (c) 1996-2001, Valve LLC. All rights reserved.
+ *
+ *	This product contains software technology licensed from Id
+ *	Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *	All Rights Reserved.
+ *
+ *   Use, distribution, and modification of this source code and/or resulting
+ *   object code is restricted to non-commercial enhancements to products from
+ *   Valve LLC.  All other use, distribution, or modification is prohibited
+ *   without written permission from Valve LLC.
+ *
+ ****/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ *	@brief Allocates memory for entity objects from slabs of equally sized blocks.
+ *	@details Short-lived entities like gibs, shell casings and projectiles are created and removed constantly.
+ *	Reusing blocks of the same size class keeps the heap from fragmenting on servers that run for a long time.
+ *	Memory is zero-initialized, as entities expect.
+ */
+class EntityAllocator final
+{
+public:
+	EntityAllocator() = default;
+	~EntityAllocator();
+
+	EntityAllocator(const EntityAllocator&) = delete;
+	EntityAllocator& operator=(const EntityAllocator&) = delete;
+
+	/**
+	 *	@brief Sets the class name that the next allocation is recorded under in the statistics.
+	 *	@details Must outlive the allocator, entity descriptors pass their class name literal.
+	 */
+	void SetNextClassName(std::string_view className) { m_NextClassName = className; }
+
+	void* Allocate(std::size_t size);
+
+	void Free(void* memory);
+
+	/**
+	 *	@brief Prints live count, peak and bytes per class name, and the memory reserved by each size class.
+	 */
+	void PrintStats() const;
+
+private:
+	// Blocks are a multiple of this size so that objects of similar size share a pool.
+	static constexpr std::size_t Granularity = 64;
+
+	// Blocks larger than this are allocated individually.
+	static constexpr std::size_t MaximumBlockSize = 64 * 1024;
+
+	// Slabs hold at least this many bytes, or MinimumBlocksPerSlab blocks for large size classes.
+	static constexpr std::size_t SlabSize = 64 * 1024;
+	static constexpr std::size_t MinimumBlocksPerSlab = 8;
+
+	static constexpr std::uint32_t LargeAllocation = 0xFFFFFFFF;
+
+	// Stored in front of each object so freeing needs no lookup.
+	struct alignas(16) BlockHeader
+	{
+		std::uint32_t PoolIndex;
+		std::uint32_t ClassIndex;
+	};
+
+	// operator new only guarantees 8 byte alignment on some platforms, so memory is requested with the header's alignment.
+	static constexpr std::align_val_t BlockAlignment{alignof(BlockHeader)};
+
+	static_assert(Granularity % alignof(BlockHeader) == 0, "Blocks in a slab must keep the header's alignment");
+
+	struct FreeBlock
+	{
+		FreeBlock* Next;
+	};
+
+	struct Pool
+	{
+		FreeBlock* FreeList{};
+		std::vector<void*> Slabs;
+		std::size_t LiveBlocks{};
+	};
+
+	struct ClassStats
+	{
+		std::string_view ClassName;
+		std::size_t Size{};
+		int Live{};
+		int Peak{};
+		int Total{};
+	};
+
+	std::uint32_t TakeClassIndex(std::size_t size);
+
+	static std::size_t GetBlockSize(std::size_t poolIndex) { return poolIndex * Granularity; }
+
+	static std::size_t GetBlocksPerSlab(std::size_t blockSize)
+	{
+		const std::size_t count = SlabSize / blockSize;
+		return count > MinimumBlocksPerSlab ? count : MinimumBlocksPerSlab;
+	}
+
+private:
+	std::vector<Pool> m_Pools;
+
+	std::vector<ClassStats> m_ClassStats;
+	std::unordered_map<std::string_view, std::uint32_t> m_ClassIndices;
+
+	std::string_view m_NextClassName;
+};
+
+inline EntityAllocator g_EntityAllocator;
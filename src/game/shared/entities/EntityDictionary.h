@@ -72,6 +72,7 @@ public:
 
 	CBaseEntity* Create() const override
 	{
+		g_EntityAllocator.SetNextClassName(GetClassName());
 		return new TEntity();
 	}
 };
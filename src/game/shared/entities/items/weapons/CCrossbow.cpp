@@ -17,10 +17,16 @@
 #include "CCrossbow.h"
 #include "UserMessages.h"
 
+static SkillVarHandle SkillCrossbowSniperBolt{"crossbow_sniper_bolt"};
+
 #ifndef CLIENT_DLL
 #define BOLT_AIR_VELOCITY 2000
 #define BOLT_WATER_VELOCITY 1000
 
+static SkillVarHandle SkillPlrXbowBoltClient{"plr_xbow_bolt_client"};
+static SkillVarHandle SkillPlrXbowBoltMonster{"plr_xbow_bolt_monster"};
+static SkillVarHandle SkillCrossbowExplosiveBolt{"crossbow_explosive_bolt"};
+
 class CCrossbowBolt : public CBaseEntity
 {
 	DECLARE_CLASS(CCrossbowBolt, CBaseEntity);
@@ -100,11 +106,11 @@ void CCrossbowBolt::BoltTouch(CBaseEntity* pOther)
 
 		if (pOther->IsPlayer())
 		{
-			pOther->TraceAttack(owner, GetSkillFloat("plr_xbow_bolt_client"sv), pev->velocity.Normalize(), &tr, DMG_NEVERGIB);
+			pOther->TraceAttack(owner, GetSkillFloat(SkillPlrXbowBoltClient), pev->velocity.Normalize(), &tr, DMG_NEVERGIB);
 		}
 		else
 		{
-			pOther->TraceAttack(owner, GetSkillFloat("plr_xbow_bolt_monster"sv), pev->velocity.Normalize(), &tr, DMG_BULLET | DMG_NEVERGIB);
+			pOther->TraceAttack(owner, GetSkillFloat(SkillPlrXbowBoltMonster), pev->velocity.Normalize(), &tr, DMG_BULLET | DMG_NEVERGIB);
 		}
 
 		ApplyMultiDamage(this, owner);
@@ -153,7 +159,7 @@ void CCrossbowBolt::BoltTouch(CBaseEntity* pOther)
 		}
 	}
 
-	if (g_Skill.GetValue("crossbow_explosive_bolt") != 0)
+	if (g_Skill.GetValue(SkillCrossbowExplosiveBolt) != 0)
 	{
 		SetThink(&CCrossbowBolt::ExplodeThink);
 		pev->nextthink = gpGlobals->time + 0.1;
@@ -263,7 +269,7 @@ void CCrossbow::Holster()
 
 void CCrossbow::PrimaryAttack()
 {
-	if (m_pPlayer->m_iFOV != 0 && g_Skill.GetValue("crossbow_sniper_bolt") != 0)
+	if (m_pPlayer->m_iFOV != 0 && g_Skill.GetValue(SkillCrossbowSniperBolt) != 0)
 	{
 		FireSniperBolt();
 		return;
@@ -16,6 +16,10 @@
 #include "cbase.h"
 #include "CCrowbar.h"
 
+#ifndef CLIENT_DLL
+#include "LagCompensationSystem.h"
+#endif
+
 #define CROWBAR_BODYHIT_VOLUME 128
 #define CROWBAR_WALLHIT_VOLUME 512
 
@@ -99,7 +103,12 @@ bool CCrowbar::Swing(bool fFirst)
 
 	UTIL_MakeVectors(m_pPlayer->pev->v_angle);
 	Vector vecSrc = m_pPlayer->GetGunPosition();
-	Vector vecEnd = vecSrc + gpGlobals->v_forward * 32;
+	Vector vecEnd = vecSrc + gpGlobals->v_forward * MELEE_RANGE;
+
+#ifndef CLIENT_DLL
+	// Trace against NPCs where the player saw them.
+	g_LagCompensation.StartLagCompensation(m_pPlayer, MELEE_LAG_COMPENSATION_RANGE);
+#endif
 
 	UTIL_TraceLine(vecSrc, vecEnd, dont_ignore_monsters, m_pPlayer->edict(), &tr);
 
@@ -117,6 +126,8 @@ bool CCrowbar::Swing(bool fFirst)
 			vecEnd = tr.vecEndPos; // This is the point on the actual surface (the hull could have hit space)
 		}
 	}
+
+	g_LagCompensation.FinishLagCompensation();
 #endif
 
 	if (fFirst)
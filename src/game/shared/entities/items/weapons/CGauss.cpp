@@ -18,6 +18,15 @@
 #include "shake.h"
 #include "UserMessages.h"
 
+static SkillVarHandle SkillGaussChargeTime{"gauss_charge_time"};
+static SkillVarHandle SkillGaussFastAmmoUse{"gauss_fast_ammo_use"};
+
+#ifndef CLIENT_DLL
+static SkillVarHandle SkillPlrGauss{"plr_gauss"};
+static SkillVarHandle SkillGaussVerticalForce{"gauss_vertical_force"};
+static SkillVarHandle SkillGaussDamageRadius{"gauss_damage_radius"};
+#endif
+
 LINK_ENTITY_TO_CLASS(weapon_gauss, CGauss);
 
 BEGIN_DATAMAP(CGauss)
@@ -30,7 +39,7 @@ DEFINE_FIELD(m_fInAttack, FIELD_INTEGER),
 
 float CGauss::GetFullChargeTime()
 {
-	return g_Skill.GetValue("gauss_charge_time");
+	return g_Skill.GetValue(SkillGaussChargeTime);
 }
 
 void CGauss::OnCreate()
@@ -195,7 +204,7 @@ void CGauss::SecondaryAttack()
 			{
 				m_pPlayer->AdjustAmmoByIndex(m_iPrimaryAmmoType, -1);
 
-				if (g_Skill.GetValue("gauss_fast_ammo_use") != 0)
+				if (g_Skill.GetValue(SkillGaussFastAmmoUse) != 0)
 				{
 					m_pPlayer->m_flNextAmmoBurn = UTIL_WeaponTimeBase() + 0.1;
 				}
@@ -285,7 +294,7 @@ void CGauss::StartFire()
 #ifdef CLIENT_DLL
 		flDamage = 20;
 #else
-		flDamage = GetSkillFloat("plr_gauss"sv);
+		flDamage = GetSkillFloat(SkillPlrGauss);
 #endif
 	}
 
@@ -301,7 +310,7 @@ void CGauss::StartFire()
 			m_pPlayer->pev->velocity = m_pPlayer->pev->velocity - gpGlobals->v_forward * flDamage * 5;
 		}
 
-		if (g_Skill.GetValue("gauss_vertical_force") == 0)
+		if (g_Skill.GetValue(SkillGaussVerticalForce) == 0)
 		{
 			// Don't pop you up into the air.
 			m_pPlayer->pev->velocity.z = flZVel;
@@ -437,7 +446,7 @@ void CGauss::Fire(Vector vecOrigSrc, Vector vecDir, float flDamage)
 
 							// exit blast damage
 							// m_pPlayer->RadiusDamage(beam_tr.vecEndPos + vecDir * 8, this, m_pPlayer, flDamage, DMG_BLAST);
-							const float damage_radius = flDamage * g_Skill.GetValue("gauss_damage_radius");
+							const float damage_radius = flDamage * g_Skill.GetValue(SkillGaussDamageRadius);
 
 							::RadiusDamage(beam_tr.vecEndPos + vecDir * 8, this, m_pPlayer, flDamage, damage_radius, DMG_BLAST);
 
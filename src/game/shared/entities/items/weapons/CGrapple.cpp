@@ -24,6 +24,12 @@
 
 #include "CGrapple.h"
 
+static SkillVarHandle SkillGrappleFast{"grapple_fast"};
+
+#ifndef CLIENT_DLL
+static SkillVarHandle SkillPlrGrapple{"plr_grapple"};
+#endif
+
 BEGIN_DATAMAP(CGrapple)
 DEFINE_FIELD(m_pBeam, FIELD_CLASSPTR),
 	DEFINE_FIELD(m_flShootTime, FIELD_TIME),
@@ -252,7 +258,7 @@ void CGrapple::PrimaryAttack()
 
 		m_flTimeWeaponIdle = UTIL_WeaponTimeBase() + 0.1;
 
-		if (g_Skill.GetValue("grapple_fast") != 0)
+		if (g_Skill.GetValue(SkillGrappleFast) != 0)
 		{
 			m_flShootTime = gpGlobals->time;
 		}
@@ -329,7 +335,7 @@ void CGrapple::PrimaryAttack()
 #ifndef CLIENT_DLL
 						ClearMultiDamage();
 
-						float flDamage = GetSkillFloat("plr_grapple"sv);
+						float flDamage = GetSkillFloat(SkillPlrGrapple);
 
 						pHit->TraceAttack(this, flDamage, gpGlobals->v_forward, &tr, DMG_ALWAYSGIB | DMG_CLUB);
 
@@ -362,7 +368,7 @@ void CGrapple::PrimaryAttack()
 	}
 #endif
 
-	if (g_Skill.GetValue("grapple_fast") != 0)
+	if (g_Skill.GetValue(SkillGrappleFast) != 0)
 	{
 		m_flNextPrimaryAttack = m_flNextSecondaryAttack = UTIL_WeaponTimeBase();
 	}
@@ -428,7 +434,7 @@ void CGrapple::EndAttack()
 
 	m_flTimeWeaponIdle = UTIL_WeaponTimeBase();
 
-	if (g_Skill.GetValue("grapple_fast") != 0)
+	if (g_Skill.GetValue(SkillGrappleFast) != 0)
 	{
 		m_flNextPrimaryAttack = m_flNextSecondaryAttack = UTIL_WeaponTimeBase();
 	}
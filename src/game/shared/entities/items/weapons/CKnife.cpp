@@ -16,6 +16,10 @@
 
 #include "CKnife.h"
 
+#ifndef CLIENT_DLL
+#include "LagCompensationSystem.h"
+#endif
+
 #define KNIFE_BODYHIT_VOLUME 128
 #define KNIFE_WALLHIT_VOLUME 512
 
@@ -85,7 +89,12 @@ bool CKnife::Swing(const bool bFirst)
 
 	UTIL_MakeVectors(m_pPlayer->pev->v_angle);
 	Vector vecSrc = m_pPlayer->GetGunPosition();
-	Vector vecEnd = vecSrc + gpGlobals->v_forward * 32;
+	Vector vecEnd = vecSrc + gpGlobals->v_forward * MELEE_RANGE;
+
+#ifndef CLIENT_DLL
+	// Trace against NPCs where the player saw them.
+	g_LagCompensation.StartLagCompensation(m_pPlayer, MELEE_LAG_COMPENSATION_RANGE);
+#endif
 
 	UTIL_TraceLine(vecSrc, vecEnd, dont_ignore_monsters, m_pPlayer->edict(), &tr);
 
@@ -103,6 +112,8 @@ bool CKnife::Swing(const bool bFirst)
 			vecEnd = tr.vecEndPos; // This is the point on the actual surface (the hull could have hit space)
 		}
 	}
+
+	g_LagCompensation.FinishLagCompensation();
 #endif
 
 	if (bFirst)
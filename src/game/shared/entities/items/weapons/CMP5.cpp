@@ -17,6 +17,8 @@
 #include "CMP5.h"
 #include "UserMessages.h"
 
+static SkillVarHandle SkillSmgWideSpread{"smg_wide_spread"};
+
 LINK_ENTITY_TO_CLASS(weapon_9mmar, CMP5);
 
 void CMP5::OnCreate()
@@ -126,7 +128,7 @@ void CMP5::PrimaryAttack()
 	Vector vecAiming = m_pPlayer->GetAutoaimVector(AUTOAIM_5DEGREES);
 	Vector vecDir;
 
-	if (g_Skill.GetValue("smg_wide_spread") != 0)
+	if (g_Skill.GetValue(SkillSmgWideSpread) != 0)
 	{
 		// optimized multiplayer. Widened to make it easier to hit a moving player
 		vecDir = m_pPlayer->FireBulletsPlayer(1, vecSrc, vecAiming, VECTOR_CONE_6DEGREES, 8192, BULLET_PLAYER_MP5, 2, 0, m_pPlayer, m_pPlayer->random_seed);
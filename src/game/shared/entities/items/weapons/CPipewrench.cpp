@@ -16,6 +16,10 @@
 #include "cbase.h"
 #include "CPipewrench.h"
 
+#ifndef CLIENT_DLL
+#include "LagCompensationSystem.h"
+#endif
+
 #define PIPEWRENCH_BODYHIT_VOLUME 128
 #define PIPEWRENCH_WALLHIT_VOLUME 512
 
@@ -121,7 +125,12 @@ bool CPipewrench::Swing(const bool bFirst)
 
 	UTIL_MakeVectors(m_pPlayer->pev->v_angle);
 	Vector vecSrc = m_pPlayer->GetGunPosition();
-	Vector vecEnd = vecSrc + gpGlobals->v_forward * 32;
+	Vector vecEnd = vecSrc + gpGlobals->v_forward * MELEE_RANGE;
+
+#ifndef CLIENT_DLL
+	// Trace against NPCs where the player saw them.
+	g_LagCompensation.StartLagCompensation(m_pPlayer, MELEE_LAG_COMPENSATION_RANGE);
+#endif
 
 	UTIL_TraceLine(vecSrc, vecEnd, dont_ignore_monsters, m_pPlayer->edict(), &tr);
 
@@ -139,6 +148,8 @@ bool CPipewrench::Swing(const bool bFirst)
 			vecEnd = tr.vecEndPos; // This is the point on the actual surface (the hull could have hit space)
 		}
 	}
+
+	g_LagCompensation.FinishLagCompensation();
 #endif
 
 	if (bFirst)
@@ -311,7 +322,12 @@ void CPipewrench::BigSwing()
 
 	UTIL_MakeVectors(m_pPlayer->pev->v_angle);
 	Vector vecSrc = m_pPlayer->GetGunPosition();
-	Vector vecEnd = vecSrc + gpGlobals->v_forward * 32;
+	Vector vecEnd = vecSrc + gpGlobals->v_forward * MELEE_RANGE;
+
+#ifndef CLIENT_DLL
+	// Trace against NPCs where the player saw them.
+	g_LagCompensation.StartLagCompensation(m_pPlayer, MELEE_LAG_COMPENSATION_RANGE);
+#endif
 
 	UTIL_TraceLine(vecSrc, vecEnd, dont_ignore_monsters, m_pPlayer->edict(), &tr);
 
@@ -329,6 +345,8 @@ void CPipewrench::BigSwing()
 			vecEnd = tr.vecEndPos; // This is the point on the actual surface (the hull could have hit space)
 		}
 	}
+
+	g_LagCompensation.FinishLagCompensation();
 #endif
 
 	PLAYBACK_EVENT_FULL(FEV_NOTHOST, m_pPlayer->edict(), m_usPipewrench,
@@ -581,6 +581,15 @@ inline MULTIDAMAGE gMultiDamage;
 
 void FindHullIntersection(const Vector& vecSrc, TraceResult& tr, const Vector& mins, const Vector& maxs, CBaseEntity* pEntity);
 
+// How far melee attacks reach from the gun position.
+constexpr float MELEE_RANGE = 32;
+
+/**
+ *	@brief Range to lag compensate melee attacks over.
+ *	@details Includes the extents of the head hull that is traced when the line trace misses.
+ */
+inline const float MELEE_LAG_COMPENSATION_RANGE = MELEE_RANGE + VEC_DUCK_HULL_MAX.Length();
+
 #define LOUD_GUN_VOLUME 1000
 #define NORMAL_GUN_VOLUME 600
 #define QUIET_GUN_VOLUME 200
@@ -21,6 +21,8 @@
 #include "com_weapons.h"
 #endif
 
+static SkillVarHandle SkillBottomlessMagazines{"bottomless_magazines"};
+
 BEGIN_DATAMAP(CBasePlayerWeapon)
 DEFINE_FIELD(m_pPlayer, FIELD_CLASSPTR),
 	DEFINE_FIELD(m_pNext, FIELD_CLASSPTR),
@@ -466,7 +468,7 @@ void CBasePlayerWeapon::AdjustMagazine1(int count)
 	if (count < 0)
 	{
 		// Subtract from reserve ammo first.
-		if (g_Skill.GetValue("bottomless_magazines") != 0)
+		if (g_Skill.GetValue(SkillBottomlessMagazines) != 0)
 		{
 			const int amountAdjusted = m_pPlayer->AdjustAmmoByIndex(m_iPrimaryAmmoType, count);
 
@@ -16,6 +16,8 @@
 #include "cbase.h"
 #include "AmmoTypeSystem.h"
 
+static SkillVarHandle SkillInfiniteAmmo{"infinite_ammo"};
+
 LINK_ENTITY_TO_CLASS(player, CBasePlayer);
 
 void CBasePlayer::OnCreate()
@@ -45,7 +47,7 @@ int CBasePlayer::GetAmmoCountByIndex(int ammoIndex) const
 		return -1;
 	}
 
-	if (g_Skill.GetValue("infinite_ammo") != 0)
+	if (g_Skill.GetValue(SkillInfiniteAmmo) != 0)
 	{
 		return g_AmmoTypes.GetByIndex(ammoIndex)->MaximumCapacity;
 	}
@@ -65,7 +67,7 @@ void CBasePlayer::SetAmmoCountByIndex(int ammoIndex, int count)
 		return;
 	}
 
-	if (g_Skill.GetValue("infinite_ammo") != 0)
+	if (g_Skill.GetValue(SkillInfiniteAmmo) != 0)
 	{
 		count = g_AmmoTypes.GetByIndex(ammoIndex)->MaximumCapacity;
 	}
@@ -82,7 +84,7 @@ int CBasePlayer::AdjustAmmoByIndex(int ammoIndex, int count)
 
 	const auto ammoType = g_AmmoTypes.GetByIndex(ammoIndex);
 
-	if (g_Skill.GetValue("infinite_ammo") != 0)
+	if (g_Skill.GetValue(SkillInfiniteAmmo) != 0)
 	{
 		m_rgAmmo[ammoIndex] = ammoType->MaximumCapacity;
 		return count;
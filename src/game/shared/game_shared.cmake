@@ -12,6 +12,8 @@ function(add_game_shared_sources target)
 			
 			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/entities/ehandle.cpp
 			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/entities/ehandle.h
+			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/entities/EntityAllocator.cpp
+			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/entities/EntityAllocator.h
 			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/entities/EntityClassificationSystem.cpp
 			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/entities/EntityClassificationSystem.h
 			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/entities/EntityDictionary.h
@@ -80,16 +82,22 @@ function(add_game_shared_sources target)
 			
 			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/models/BspLoader.cpp
 			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/models/BspLoader.h
+			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/models/BspLoaderMemory.cpp
 			
+			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/networking/HudDelta.cpp
+			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/networking/HudDelta.h
 			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/networking/NetworkDataSystem.cpp
 			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/networking/NetworkDataSystem.h
 			
+			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/player_movement/pm_constants.h
 			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/player_movement/pm_debug.cpp
 			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/player_movement/pm_debug.h
 			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/player_movement/pm_defs.h
 			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/player_movement/pm_info.h
 			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/player_movement/pm_materials.h
 			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/player_movement/pm_movevars.h
+			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/player_movement/pm_replay.cpp
+			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/player_movement/pm_replay.h
 			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/player_movement/pm_shared.cpp
 			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/player_movement/pm_shared.h
 			
@@ -106,6 +114,8 @@ function(add_game_shared_sources target)
 			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/scripting/AS/ASManager.cpp
 			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/scripting/AS/ASManager.h
 			
+			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/sound/AmbientModulation.cpp
+			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/sound/AmbientModulation.h
 			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/sound/MaterialSystem.cpp
 			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/sound/MaterialSystem.h
 			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/sound/sentence_utils.cpp
@@ -114,6 +124,8 @@ function(add_game_shared_sources target)
 			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/ui/hud/HudReplacementSystem.cpp
 			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/ui/hud/HudReplacementSystem.h
 			
+			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/utils/AsyncLogSink.cpp
+			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/utils/AsyncLogSink.h
 			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/utils/ConCommandSystem.cpp
 			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/utils/ConCommandSystem.h
 			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/utils/filesystem_utils.cpp
@@ -124,8 +136,11 @@ function(add_game_shared_sources target)
 			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/utils/json_fwd.h
 			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/utils/JSONSystem.cpp
 			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/utils/JSONSystem.h
+			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/utils/LoadProfiler.cpp
+			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/utils/LoadProfiler.h
 			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/utils/LogSystem.cpp
 			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/utils/LogSystem.h
+			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/utils/PerfectHashTable.h
 			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/utils/PrecacheList.cpp
 			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/utils/PrecacheList.h
 			${CMAKE_CURRENT_FUNCTION_LIST_DIR}/utils/ReplacementMaps.cpp
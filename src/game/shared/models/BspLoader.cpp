@@ -16,34 +16,13 @@
 #include "cbase.h"
 #include "BspLoader.h"
 
-#define vec3_t Vector
-
-// Pull in tools header for definitions. Don't call any of its functions!
-#include "../../utils/common/bspfile.h"
+#include "utils/LoadProfiler.h"
 
 std::optional<BspData> BspLoader::Load(const char* fileName)
 {
-	const auto contents = FileSystem_LoadFileIntoBuffer(fileName, FileContentFormat::Binary);
-
-	if (contents.size() < sizeof(dheader_t))
-	{
-		return {};
-	}
-
-	dheader_t header;
-
-	std::memcpy(&header, contents.data(), sizeof(dheader_t));
+	const ScopedLoadTimer timer{"BspLoader", "Load"};
 
-	if (header.version != BSPVERSION)
-	{
-		return {};
-	}
-
-	BspData data;
-
-	const auto& modelLump = header.lumps[LUMP_MODELS];
-
-	data.SubModelCount = static_cast<std::size_t>(modelLump.filelen) / sizeof(dmodel_t);
+	const auto contents = FileSystem_LoadFileIntoBuffer(fileName, FileContentFormat::Binary);
 
-	return data;
+	return LoadFromMemory(contents);
 }
@@ -15,12 +15,61 @@
 
 #pragma once
 
+#include <array>
 #include <cstddef>
 #include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+struct BspPlane
+{
+	float Normal[3];
+	float Distance;
+	int Type;
+};
+
+/**
+ *	@brief A node in a clipping hull. Negative children are contents.
+ */
+struct BspClipNode
+{
+	int PlaneIndex;
+	short Children[2];
+};
 
 struct BspData
 {
 	std::size_t SubModelCount{};
+
+	/**
+	 *	@brief Number of world leafs with visibility data. The engine's PVS and PAS buffers have one bit per leaf.
+	 */
+	std::size_t WorldVisLeafCount{};
+
+	/**
+	 *	@brief Texture names in miptex lump order, empty for missing textures.
+	 */
+	std::vector<std::string> TextureNames;
+
+	// World collision data, only loaded if requested.
+
+	std::vector<BspPlane> Planes;
+
+	/**
+	 *	@brief Clip nodes of hull 0, made from the BSP nodes the same way the engine does.
+	 */
+	std::vector<BspClipNode> PointHullClipNodes;
+
+	/**
+	 *	@brief Clip nodes of hulls 1 to 3.
+	 */
+	std::vector<BspClipNode> ClipNodes;
+
+	/**
+	 *	@brief First clip node of each hull of the world.
+	 */
+	std::array<int, 4> WorldHeadNodes{};
 };
 
 /**
@@ -33,4 +82,10 @@ public:
 	BspLoader() = delete;
 
 	static std::optional<BspData> Load(const char* fileName);
+
+	/**
+	 *	@brief Loads BSP data from a buffer. Does not use the engine, so this can be used by tools.
+	 *	@param loadCollision Whether to load the world's collision hulls.
+	 */
+	static std::optional<BspData> LoadFromMemory(std::span<const std::byte> contents, bool loadCollision = false);
 };
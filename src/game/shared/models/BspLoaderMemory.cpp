@@ -0,0 +1,220 @@
+/***
+ *
+ *	Copyright (c) 1996-2001, Valve LLC. All rights reserved.
+ *
+ *	This product contains software technology licensed from Id
+ *	Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *	All Rights Reserved.
+ *
+ *   Use, distribution, and modification of this source code and/or resulting
+ *   object code is restricted to non-commercial enhancements to products from
+ *   Valve LLC.  All other use, distribution, or modification is prohibited
+ *   without written permission from Valve LLC.
+ *
+ ****/
+
+// Kept separate from BspLoader.cpp so tools can load BSP files without the engine and game.
+
+#include <algorithm>
+#include <cstring>
+
+#include "Platform.h"
+#include "mathlib.h"
+#include "BspLoader.h"
+
+#define vec3_t Vector
+
+// Pull in tools header for definitions. Don't call any of its functions!
+#include "../../utils/common/bspfile.h"
+
+template <typename T>
+static bool ReadLump(std::span<const std::byte> contents, const lump_t& lump, std::vector<T>& data)
+{
+	if (lump.fileofs < 0 || lump.filelen < 0 || lump.filelen % sizeof(T) != 0 ||
+		static_cast<std::size_t>(lump.fileofs) + lump.filelen > contents.size())
+	{
+		return false;
+	}
+
+	data.resize(lump.filelen / sizeof(T));
+	std::memcpy(data.data(), contents.data() + lump.fileofs, lump.filelen);
+
+	return true;
+}
+
+static bool IsValidHull(const std::vector<BspClipNode>& clipNodes, std::size_t planeCount)
+{
+	for (const auto& node : clipNodes)
+	{
+		if (node.PlaneIndex < 0 || static_cast<std::size_t>(node.PlaneIndex) >= planeCount)
+		{
+			return false;
+		}
+
+		for (const auto child : node.Children)
+		{
+			if (child >= 0 && static_cast<std::size_t>(child) >= clipNodes.size())
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+static bool LoadCollision(std::span<const std::byte> contents, const dheader_t& header, BspData& data)
+{
+	std::vector<dplane_t> planes;
+	std::vector<dnode_t> nodes;
+	std::vector<dleaf_t> leafs;
+	std::vector<dclipnode_t> clipNodes;
+	std::vector<dmodel_t> models;
+
+	if (!ReadLump(contents, header.lumps[LUMP_PLANES], planes) ||
+		!ReadLump(contents, header.lumps[LUMP_NODES], nodes) ||
+		!ReadLump(contents, header.lumps[LUMP_LEAFS], leafs) ||
+		!ReadLump(contents, header.lumps[LUMP_CLIPNODES], clipNodes) ||
+		!ReadLump(contents, header.lumps[LUMP_MODELS], models) ||
+		models.empty())
+	{
+		return false;
+	}
+
+	data.Planes.reserve(planes.size());
+
+	for (const auto& plane : planes)
+	{
+		data.Planes.push_back({{plane.normal[0], plane.normal[1], plane.normal[2]}, plane.dist, plane.type});
+	}
+
+	// Hull 0 uses the BSP nodes, with leafs replaced by their contents.
+	data.PointHullClipNodes.reserve(nodes.size());
+
+	for (const auto& node : nodes)
+	{
+		BspClipNode clipNode{node.planenum};
+
+		for (int i = 0; i < 2; ++i)
+		{
+			const int child = node.children[i];
+
+			if (child < 0)
+			{
+				const int leaf = -1 - child;
+
+				if (static_cast<std::size_t>(leaf) >= leafs.size())
+				{
+					return false;
+				}
+
+				clipNode.Children[i] = static_cast<short>(leafs[leaf].contents);
+			}
+			else
+			{
+				clipNode.Children[i] = static_cast<short>(child);
+			}
+		}
+
+		data.PointHullClipNodes.push_back(clipNode);
+	}
+
+	data.ClipNodes.reserve(clipNodes.size());
+
+	for (const auto& clipNode : clipNodes)
+	{
+		data.ClipNodes.push_back({clipNode.planenum, {clipNode.children[0], clipNode.children[1]}});
+	}
+
+	if (!IsValidHull(data.PointHullClipNodes, data.Planes.size()) || !IsValidHull(data.ClipNodes, data.Planes.size()))
+	{
+		return false;
+	}
+
+	for (int i = 0; i < MAX_MAP_HULLS; ++i)
+	{
+		const int headNode = models[0].headnode[i];
+		const auto& hullNodes = i == 0 ? data.PointHullClipNodes : data.ClipNodes;
+
+		if (headNode < 0 || static_cast<std::size_t>(headNode) >= hullNodes.size())
+		{
+			return false;
+		}
+
+		data.WorldHeadNodes[i] = headNode;
+	}
+
+	return true;
+}
+
+std::optional<BspData> BspLoader::LoadFromMemory(std::span<const std::byte> contents, bool loadCollision)
+{
+	if (contents.size() < sizeof(dheader_t))
+	{
+		return {};
+	}
+
+	dheader_t header;
+
+	std::memcpy(&header, contents.data(), sizeof(dheader_t));
+
+	if (header.version != BSPVERSION)
+	{
+		return {};
+	}
+
+	BspData data;
+
+	const auto& modelLump = header.lumps[LUMP_MODELS];
+
+	data.SubModelCount = static_cast<std::size_t>(modelLump.filelen) / sizeof(dmodel_t);
+
+	if (data.SubModelCount > 0 && modelLump.fileofs >= 0 &&
+		static_cast<std::size_t>(modelLump.fileofs) + sizeof(dmodel_t) <= contents.size())
+	{
+		dmodel_t world;
+		std::memcpy(&world, contents.data() + modelLump.fileofs, sizeof(dmodel_t));
+
+		data.WorldVisLeafCount = static_cast<std::size_t>(std::max(0, world.visleafs));
+	}
+
+	const auto& textureLump = header.lumps[LUMP_TEXTURES];
+
+	if (textureLump.fileofs >= 0 && textureLump.filelen >= static_cast<int>(sizeof(int)) &&
+		static_cast<std::size_t>(textureLump.fileofs) + textureLump.filelen <= contents.size())
+	{
+		const std::byte* lump = contents.data() + textureLump.fileofs;
+
+		int textureCount = 0;
+		std::memcpy(&textureCount, lump, sizeof(int));
+
+		if (textureCount > 0 && static_cast<std::size_t>(textureCount) < static_cast<std::size_t>(textureLump.filelen) / sizeof(int))
+		{
+			data.TextureNames.reserve(textureCount);
+
+			for (int i = 0; i < textureCount; ++i)
+			{
+				int offset = -1;
+				std::memcpy(&offset, lump + sizeof(int) * (1 + i), sizeof(int));
+
+				if (offset < 0 || static_cast<std::size_t>(offset) + sizeof(miptex_t) > static_cast<std::size_t>(textureLump.filelen))
+				{
+					data.TextureNames.emplace_back();
+					continue;
+				}
+
+				char name[sizeof(miptex_t::name) + 1]{};
+				std::memcpy(name, lump + offset, sizeof(miptex_t::name));
+
+				data.TextureNames.emplace_back(name);
+			}
+		}
+	}
+
+	if (loadCollision && !LoadCollision(contents, header, data))
+	{
+		return {};
+	}
+
+	return data;
+}
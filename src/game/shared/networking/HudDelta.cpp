@@ -0,0 +1,290 @@
+/***
+ *
+ *	Copyright (c) 1996-2001, Valve LLC. All rights reserved.
+ *
+ *	This product contains software technology licensed from Id
+ *	Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *	All Rights Reserved.
+ *
+ *   Use, distribution, and modification of this source code and/or resulting
+ *   object code is restricted to non-commercial enhancements to products from
+ *   Valve LLC.  All other use, distribution, or modification is prohibited
+ *   without written permission from Valve LLC.
+ *
+ ****/
+
+#include <algorithm>
+
+#include "HudDelta.h"
+
+namespace
+{
+// Field widths in bits.
+constexpr int HealthBits = 15;
+constexpr int BatteryBits = 15;
+constexpr int DamageAmountBits = 8;
+constexpr int DamageTypeBits = 32;
+constexpr int CoordBits = 16;
+constexpr int FlashBatteryBits = 7;
+constexpr int TrainBits = 4;
+constexpr int AmmoSlotCountBits = 6;
+constexpr int AmmoIndexBits = 5;
+constexpr int AmmoCountBits = 8;
+
+static_assert(MAX_AMMO_TYPES <= (1 << AmmoIndexBits));
+static_assert(MAX_AMMO_TYPES < (1 << AmmoSlotCountBits));
+
+// Worst case size in bits, must fit in the message buffer.
+static_assert(8 + HealthBits + BatteryBits + 64 + (DamageAmountBits * 2) + DamageTypeBits + (CoordBits * 3) + FlashBatteryBits + TrainBits + AmmoSlotCountBits + (MAX_AMMO_TYPES * (AmmoIndexBits + AmmoCountBits)) <= HudDelta::MaxMessageSize * 8);
+
+class BitWriter
+{
+public:
+	explicit BitWriter(std::span<std::byte> buffer)
+		: m_Buffer(buffer)
+	{
+		std::fill(m_Buffer.begin(), m_Buffer.end(), std::byte{0});
+	}
+
+	std::size_t GetSizeInBytes() const { return (m_Bit + 7) / 8; }
+
+	void WriteBits(std::uint32_t value, int count)
+	{
+		for (int i = 0; i < count; ++i, ++m_Bit)
+		{
+			if ((value & (1U << i)) != 0)
+			{
+				m_Buffer[m_Bit / 8] |= std::byte(1U << (m_Bit % 8));
+			}
+		}
+	}
+
+	void WriteCoord(float value)
+	{
+		// Same precision as WRITE_COORD.
+		WriteBits(static_cast<std::uint16_t>(static_cast<int>(value * 8)), CoordBits);
+	}
+
+private:
+	std::span<std::byte> m_Buffer;
+	std::size_t m_Bit = 0;
+};
+
+class BitReader
+{
+public:
+	explicit BitReader(std::span<const std::byte> buffer)
+		: m_Buffer(buffer)
+	{
+	}
+
+	bool HasOverflowed() const { return m_Overflowed; }
+
+	std::uint32_t ReadBits(int count)
+	{
+		if (m_Bit + count > m_Buffer.size() * 8)
+		{
+			m_Overflowed = true;
+			return 0;
+		}
+
+		std::uint32_t value = 0;
+
+		for (int i = 0; i < count; ++i, ++m_Bit)
+		{
+			if ((m_Buffer[m_Bit / 8] & std::byte(1U << (m_Bit % 8))) != std::byte{0})
+			{
+				value |= 1U << i;
+			}
+		}
+
+		return value;
+	}
+
+	float ReadCoord()
+	{
+		return static_cast<std::int16_t>(ReadBits(CoordBits)) * (1.0f / 8);
+	}
+
+private:
+	std::span<const std::byte> m_Buffer;
+	std::size_t m_Bit = 0;
+	bool m_Overflowed = false;
+};
+}
+
+void HudDelta::SetHealth(int health)
+{
+	Fields |= Health;
+	HealthValue = std::clamp(health, 0, (1 << HealthBits) - 1);
+}
+
+void HudDelta::SetBattery(int battery)
+{
+	Fields |= Battery;
+	BatteryValue = std::clamp(battery, 0, (1 << BatteryBits) - 1);
+}
+
+void HudDelta::SetWeapons(std::uint64_t weaponBits)
+{
+	Fields |= Weapons;
+	WeaponBits = weaponBits;
+}
+
+void HudDelta::SetDamage(int save, int take, int bits, const Vector& origin)
+{
+	Fields |= Damage;
+	DamageSave = std::clamp(save, 0, 255);
+	DamageTake = std::clamp(take, 0, 255);
+	DamageBits = bits;
+	DamageOrigin = origin;
+}
+
+void HudDelta::SetFlashBattery(int battery)
+{
+	Fields |= FlashBattery;
+	FlashBatteryValue = std::clamp(battery, 0, 100);
+}
+
+void HudDelta::SetTrain(int train)
+{
+	Fields |= Train;
+	TrainValue = train & 0xF;
+}
+
+void HudDelta::AddAmmo(int index, int count)
+{
+	// Overwrite a slot that was already added this frame.
+	auto slot = std::find_if(AmmoSlots.begin(), AmmoSlots.begin() + AmmoSlotCount, [&](const auto& candidate)
+		{ return candidate.Index == index; });
+
+	if (slot == AmmoSlots.begin() + AmmoSlotCount)
+	{
+		if (AmmoSlotCount >= static_cast<int>(AmmoSlots.size()))
+		{
+			return;
+		}
+
+		++AmmoSlotCount;
+	}
+
+	Fields |= Ammo;
+	slot->Index = static_cast<std::uint8_t>(index);
+	slot->Count = static_cast<std::uint8_t>(std::clamp(count, 0, 254));
+}
+
+std::size_t HudDelta::Write(std::span<std::byte, MaxMessageSize> buffer) const
+{
+	BitWriter writer{buffer};
+
+	writer.WriteBits(Fields, 8);
+
+	if ((Fields & Health) != 0)
+	{
+		writer.WriteBits(HealthValue, HealthBits);
+	}
+
+	if ((Fields & Battery) != 0)
+	{
+		writer.WriteBits(BatteryValue, BatteryBits);
+	}
+
+	if ((Fields & Weapons) != 0)
+	{
+		writer.WriteBits(static_cast<std::uint32_t>(WeaponBits & 0xFFFFFFFF), 32);
+		writer.WriteBits(static_cast<std::uint32_t>(WeaponBits >> 32), 32);
+	}
+
+	if ((Fields & Damage) != 0)
+	{
+		writer.WriteBits(DamageSave, DamageAmountBits);
+		writer.WriteBits(DamageTake, DamageAmountBits);
+		writer.WriteBits(DamageBits, DamageTypeBits);
+		writer.WriteCoord(DamageOrigin.x);
+		writer.WriteCoord(DamageOrigin.y);
+		writer.WriteCoord(DamageOrigin.z);
+	}
+
+	if ((Fields & FlashBattery) != 0)
+	{
+		writer.WriteBits(FlashBatteryValue, FlashBatteryBits);
+	}
+
+	if ((Fields & Train) != 0)
+	{
+		writer.WriteBits(TrainValue, TrainBits);
+	}
+
+	if ((Fields & Ammo) != 0)
+	{
+		writer.WriteBits(AmmoSlotCount, AmmoSlotCountBits);
+
+		for (int i = 0; i < AmmoSlotCount; ++i)
+		{
+			writer.WriteBits(AmmoSlots[i].Index, AmmoIndexBits);
+			writer.WriteBits(AmmoSlots[i].Count, AmmoCountBits);
+		}
+	}
+
+	return writer.GetSizeInBytes();
+}
+
+bool HudDelta::Read(std::span<const std::byte> buffer)
+{
+	BitReader reader{buffer};
+
+	Fields = static_cast<std::uint8_t>(reader.ReadBits(8));
+
+	if ((Fields & Health) != 0)
+	{
+		HealthValue = reader.ReadBits(HealthBits);
+	}
+
+	if ((Fields & Battery) != 0)
+	{
+		BatteryValue = reader.ReadBits(BatteryBits);
+	}
+
+	if ((Fields & Weapons) != 0)
+	{
+		const std::uint64_t lowerBits = reader.ReadBits(32);
+		const std::uint64_t upperBits = reader.ReadBits(32);
+
+		WeaponBits = lowerBits | (upperBits << 32ULL);
+	}
+
+	if ((Fields & Damage) != 0)
+	{
+		DamageSave = reader.ReadBits(DamageAmountBits);
+		DamageTake = reader.ReadBits(DamageAmountBits);
+		DamageBits = static_cast<int>(reader.ReadBits(DamageTypeBits));
+		DamageOrigin.x = reader.ReadCoord();
+		DamageOrigin.y = reader.ReadCoord();
+		DamageOrigin.z = reader.ReadCoord();
+	}
+
+	if ((Fields & FlashBattery) != 0)
+	{
+		FlashBatteryValue = reader.ReadBits(FlashBatteryBits);
+	}
+
+	if ((Fields & Train) != 0)
+	{
+		TrainValue = reader.ReadBits(TrainBits);
+	}
+
+	AmmoSlotCount = 0;
+
+	if ((Fields & Ammo) != 0)
+	{
+		AmmoSlotCount = std::min(static_cast<int>(reader.ReadBits(AmmoSlotCountBits)), MAX_AMMO_TYPES);
+
+		for (int i = 0; i < AmmoSlotCount; ++i)
+		{
+			AmmoSlots[i].Index = static_cast<std::uint8_t>(reader.ReadBits(AmmoIndexBits));
+			AmmoSlots[i].Count = static_cast<std::uint8_t>(reader.ReadBits(AmmoCountBits));
+		}
+	}
+
+	return !reader.HasOverflowed();
+}
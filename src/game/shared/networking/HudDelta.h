@@ -0,0 +1,93 @@
+/***
+ *
+ *	Copyright (c) 1996-2001, Valve LLC. All rights reserved.
+ *
+ *	This product contains software technology licensed from Id
+ *	Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *	All Rights Reserved.
+ *
+ *   Use, distribution, and modification of this source code and/or resulting
+ *   object code is restricted to non-commercial enhancements to products from
+ *   Valve LLC.  All other use, distribution, or modification is prohibited
+ *   without written permission from Valve LLC.
+ *
+ ****/
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "Platform.h"
+#include "cdll_dll.h"
+
+/**
+ *	@brief Changes to a player's HUD state collected over a frame and sent to the client in a single @c HudDelta message.
+ *	@details The message starts with a byte containing the changed fields, followed by the values of those fields
+ *	bit-packed in the order the flags are declared in.
+ */
+struct HudDelta
+{
+	enum Field : std::uint8_t
+	{
+		Health = 1 << 0,
+		Battery = 1 << 1,
+		Weapons = 1 << 2,
+		Damage = 1 << 3,
+		FlashBattery = 1 << 4,
+		Train = 1 << 5,
+		Ammo = 1 << 6
+	};
+
+	struct AmmoSlot
+	{
+		std::uint8_t Index;
+		std::uint8_t Count;
+	};
+
+	/**
+	 *	@brief Large enough for a message with every field set and every ammo slot changed.
+	 */
+	static constexpr std::size_t MaxMessageSize = 96;
+
+	std::uint8_t Fields = 0;
+
+	int HealthValue = 0;
+	int BatteryValue = 0;
+	std::uint64_t WeaponBits = 0;
+
+	int DamageSave = 0;
+	int DamageTake = 0;
+	int DamageBits = 0;
+	Vector DamageOrigin;
+
+	int FlashBatteryValue = 0;
+	int TrainValue = 0;
+
+	int AmmoSlotCount = 0;
+	std::array<AmmoSlot, MAX_AMMO_TYPES> AmmoSlots{};
+
+	bool IsEmpty() const { return Fields == 0; }
+
+	void SetHealth(int health);
+	void SetBattery(int battery);
+	void SetWeapons(std::uint64_t weaponBits);
+	void SetDamage(int save, int take, int bits, const Vector& origin);
+	void SetFlashBattery(int battery);
+	void SetTrain(int train);
+	void AddAmmo(int index, int count);
+
+	/**
+	 *	@brief Packs the changed fields into @p buffer.
+	 *	@return Number of bytes written.
+	 */
+	std::size_t Write(std::span<std::byte, MaxMessageSize> buffer) const;
+
+	/**
+	 *	@brief Unpacks a message written by Write.
+	 *	@return @c false if the message is truncated.
+	 */
+	bool Read(std::span<const std::byte> buffer);
+};
@@ -27,6 +27,8 @@
 
 #include "networking/NetworkDataSystem.h"
 
+#include "utils/LoadProfiler.h"
+
 /**
  *	@brief The minimum size that the generated file must be.
  *	See https://github.com/ValveSoftware/halflife/issues/3326 for why this is necessary.
@@ -85,6 +87,8 @@ void NetworkDataSystem::RemoveNetworkDataFiles(const char* pathID)
 #ifndef CLIENT_DLL
 bool NetworkDataSystem::GenerateNetworkDataFile()
 {
+	const ScopedLoadTimer timer{"NetworkData", "GenerateNetworkDataFile"};
+
 	const auto output = TryGenerateNetworkData();
 
 	if (!output)
@@ -0,0 +1,435 @@
+/***
+ *
+ *	Copyright (c) 1996-2002, Valve LLC. All rights reserved.
+ *
+ *	This product contains software technology licensed from Id
+ *	Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *	All Rights Reserved.
+ *
+ *   Use, distribution, and modification of this source code and/or resulting
+ *   object code is restricted to non-commercial enhancements to products from
+ *   Valve LLC.  All other use, distribution, or modification is prohibited
+ *   without written permission from Valve LLC.
+ *
+ ****/
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <type_traits>
+
+#include "pm_replay.h"
+#include "pm_shared.h"
+
+constexpr std::uint32_t RecordingMagic = 'P' | ('M' << 8) | ('R' << 16) | ('C' << 24);
+constexpr std::uint32_t RecordingVersion = 1;
+
+constexpr std::size_t RecordingMapNameSize = 64;
+
+constexpr std::size_t PlayerStateOffset = offsetof(playermove_t, origin);
+constexpr std::size_t PlayerStateSize = offsetof(playermove_t, numphysent) - PlayerStateOffset;
+
+namespace
+{
+/**
+ *	@brief Counts collision queries made by the movement code and replaces the functions that make replays non-deterministic.
+ */
+struct ReplayEnvironment
+{
+	playermove_t Original;
+
+	double Time = 0;
+	std::uint32_t RandomState = 0;
+
+	std::int64_t PlayerTraces = 0;
+	std::int64_t LineTraces = 0;
+	std::int64_t PositionTests = 0;
+	std::int64_t PointContents = 0;
+};
+
+ReplayEnvironment* g_Replay = nullptr;
+
+std::uint32_t NextRandom()
+{
+	// Numerical Recipes LCG, good enough to keep the movement code happy.
+	g_Replay->RandomState = g_Replay->RandomState * 1664525 + 1013904223;
+	return g_Replay->RandomState >> 8;
+}
+
+int32 Replay_RandomLong(int32 lLow, int32 lHigh)
+{
+	if (lHigh <= lLow)
+	{
+		return lLow;
+	}
+
+	return lLow + static_cast<int32>(NextRandom() % static_cast<std::uint32_t>(lHigh - lLow + 1));
+}
+
+float Replay_RandomFloat(float flLow, float flHigh)
+{
+	return flLow + (flHigh - flLow) * (NextRandom() / static_cast<float>(1 << 24));
+}
+
+double Replay_Sys_FloatTime()
+{
+	return g_Replay->Time;
+}
+
+pmtrace_t Replay_PlayerTrace(float* start, float* end, int traceFlags, int ignore_pe)
+{
+	++g_Replay->PlayerTraces;
+	return g_Replay->Original.PM_PlayerTrace(start, end, traceFlags, ignore_pe);
+}
+
+pmtrace_t Replay_PlayerTraceEx(float* start, float* end, int traceFlags, int (*pfnIgnore)(physent_t* pe))
+{
+	++g_Replay->PlayerTraces;
+	return g_Replay->Original.PM_PlayerTraceEx(start, end, traceFlags, pfnIgnore);
+}
+
+pmtrace_t* Replay_TraceLine(float* start, float* end, int flags, int usehull, int ignore_pe)
+{
+	++g_Replay->LineTraces;
+	return g_Replay->Original.PM_TraceLine(start, end, flags, usehull, ignore_pe);
+}
+
+pmtrace_t* Replay_TraceLineEx(float* start, float* end, int flags, int usehull, int (*pfnIgnore)(physent_t* pe))
+{
+	++g_Replay->LineTraces;
+	return g_Replay->Original.PM_TraceLineEx(start, end, flags, usehull, pfnIgnore);
+}
+
+const char* Replay_TraceTexture(int ground, float* vstart, float* vend)
+{
+	++g_Replay->LineTraces;
+	return g_Replay->Original.PM_TraceTexture(ground, vstart, vend);
+}
+
+int Replay_TestPlayerPosition(float* pos, pmtrace_t* ptrace)
+{
+	++g_Replay->PositionTests;
+	return g_Replay->Original.PM_TestPlayerPosition(pos, ptrace);
+}
+
+int Replay_TestPlayerPositionEx(float* pos, pmtrace_t* ptrace, int (*pfnIgnore)(physent_t* pe))
+{
+	++g_Replay->PositionTests;
+	return g_Replay->Original.PM_TestPlayerPositionEx(pos, ptrace, pfnIgnore);
+}
+
+int Replay_PointContents(float* p, int* truecontents)
+{
+	++g_Replay->PointContents;
+	return g_Replay->Original.PM_PointContents(p, truecontents);
+}
+
+int Replay_TruePointContents(float* p)
+{
+	++g_Replay->PointContents;
+	return g_Replay->Original.PM_TruePointContents(p);
+}
+
+int Replay_HullPointContents(hull_t* hull, int num, float* p)
+{
+	++g_Replay->PointContents;
+	return g_Replay->Original.PM_HullPointContents(hull, num, p);
+}
+
+void Replay_StuckTouch(int hitent, pmtrace_t* ptraceresult)
+{
+}
+
+void Replay_Particle(float* origin, int color, float life, int zpos, int zvel)
+{
+}
+
+void Replay_PlaybackEventFull(int flags, int clientindex, unsigned short eventindex, float delay, float* origin, float* angles,
+	float fparam1, float fparam2, int iparam1, int iparam2, int bparam1, int bparam2)
+{
+}
+
+std::uint32_t HashBytes(std::uint32_t hash, const void* data, std::size_t size)
+{
+	// FNV-1a
+	auto bytes = reinterpret_cast<const std::uint8_t*>(data);
+
+	for (std::size_t i = 0; i < size; ++i)
+	{
+		hash = (hash ^ bytes[i]) * 16777619u;
+	}
+
+	return hash;
+}
+
+class RecordingWriter final
+{
+public:
+	template <typename T>
+	void Write(const T& value)
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+		Write(&value, sizeof(T));
+	}
+
+	void Write(const void* data, std::size_t size)
+	{
+		const auto bytes = reinterpret_cast<const std::byte*>(data);
+		Buffer.insert(Buffer.end(), bytes, bytes + size);
+	}
+
+	std::vector<std::byte> Buffer;
+};
+
+class RecordingReader final
+{
+public:
+	explicit RecordingReader(std::span<const std::byte> buffer)
+		: m_Buffer(buffer)
+	{
+	}
+
+	template <typename T>
+	bool Read(T& value)
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+		return Read(&value, sizeof(T));
+	}
+
+	bool Read(void* data, std::size_t size)
+	{
+		if (m_Buffer.size() - m_Position < size)
+		{
+			return false;
+		}
+
+		std::memcpy(data, m_Buffer.data() + m_Position, size);
+		m_Position += size;
+		return true;
+	}
+
+private:
+	std::span<const std::byte> m_Buffer;
+	std::size_t m_Position = 0;
+};
+}
+
+void PM_RecordPlayerState(PlayerMovementRecording& recording, const playermove_t& ppmove)
+{
+	recording.Multiplayer = ppmove.multiplayer;
+	recording.MoveVars = *ppmove.movevars;
+	std::memcpy(recording.PhysInfo, ppmove.physinfo, sizeof(recording.PhysInfo));
+
+	const auto state = reinterpret_cast<const std::byte*>(&ppmove) + PlayerStateOffset;
+	recording.PlayerState.assign(state, state + PlayerStateSize);
+}
+
+void PM_RecordPlayerMove(PlayerMovementRecording& recording, const playermove_t& ppmove)
+{
+	recording.Commands.push_back(RecordedPlayerMove{
+		.Time = ppmove.time,
+		.FrameTime = ppmove.frametime,
+		.Cmd = ppmove.cmd,
+		.Angles = ppmove.angles,
+		.OldAngles = ppmove.oldangles,
+		.MaxSpeed = ppmove.maxspeed,
+		.ClientMaxSpeed = ppmove.clientmaxspeed,
+		.Gravity = ppmove.gravity,
+		.Friction = ppmove.friction});
+}
+
+std::vector<std::byte> PM_SerializeRecording(const PlayerMovementRecording& recording)
+{
+	RecordingWriter writer;
+
+	char mapName[RecordingMapNameSize]{};
+	strncpy(mapName, recording.MapName.c_str(), sizeof(mapName) - 1);
+
+	writer.Write(RecordingMagic);
+	writer.Write(RecordingVersion);
+	writer.Write(mapName);
+	writer.Write(recording.PlayerIndex);
+	writer.Write(recording.Multiplayer);
+	writer.Write(recording.MoveVars);
+	writer.Write(recording.PhysInfo);
+	writer.Write(static_cast<std::uint32_t>(recording.PlayerState.size()));
+	writer.Write(recording.PlayerState.data(), recording.PlayerState.size());
+	writer.Write(recording.EndOrigin);
+	writer.Write(static_cast<std::uint32_t>(recording.Commands.size()));
+	writer.Write(recording.Commands.data(), recording.Commands.size() * sizeof(RecordedPlayerMove));
+
+	return std::move(writer.Buffer);
+}
+
+std::unique_ptr<PlayerMovementRecording> PM_DeserializeRecording(std::span<const std::byte> data, std::string& error)
+{
+	RecordingReader reader{data};
+
+	std::uint32_t magic = 0;
+	std::uint32_t version = 0;
+
+	if (!reader.Read(magic) || magic != RecordingMagic || !reader.Read(version) || version != RecordingVersion)
+	{
+		error = "not a player movement recording or made by a different version of the game";
+		return {};
+	}
+
+	auto recording = std::make_unique<PlayerMovementRecording>();
+
+	char mapName[RecordingMapNameSize]{};
+	std::uint32_t stateSize = 0;
+	std::uint32_t commandCount = 0;
+
+	if (!reader.Read(mapName) ||
+		!reader.Read(recording->PlayerIndex) ||
+		!reader.Read(recording->Multiplayer) ||
+		!reader.Read(recording->MoveVars) ||
+		!reader.Read(recording->PhysInfo) ||
+		!reader.Read(stateSize) ||
+		stateSize != PlayerStateSize)
+	{
+		error = "invalid header";
+		return {};
+	}
+
+	recording->PlayerState.resize(stateSize);
+
+	if (!reader.Read(recording->PlayerState.data(), stateSize) ||
+		!reader.Read(recording->EndOrigin) ||
+		!reader.Read(commandCount) ||
+		commandCount == 0 ||
+		commandCount > PlayerMovementMaxCommands)
+	{
+		error = "invalid player state";
+		return {};
+	}
+
+	recording->Commands.resize(commandCount);
+
+	if (!reader.Read(recording->Commands.data(), commandCount * sizeof(RecordedPlayerMove)))
+	{
+		error = "truncated command list";
+		return {};
+	}
+
+	mapName[sizeof(mapName) - 1] = '\0';
+	recording->MapName = mapName;
+
+	// Guard against out of range indices in the stuck offset table.
+	if (recording->PlayerIndex < 0 || recording->PlayerIndex >= MAX_PLAYERS)
+	{
+		error = "invalid player index";
+		return {};
+	}
+
+	recording->PhysInfo[sizeof(recording->PhysInfo) - 1] = '\0';
+
+	return recording;
+}
+
+PlayerMovementReplayResult PM_ReplayRecording(playermove_t& ppmove, const PlayerMovementRecording& recording, int iterations)
+{
+	iterations = std::max(1, iterations);
+
+	auto replay = std::make_unique<ReplayEnvironment>();
+
+	replay->Original = ppmove;
+
+	g_Replay = replay.get();
+
+	// Collide with the world only so the results do not depend on where entities are.
+	ppmove.numphysent = std::min(ppmove.numphysent, 1);
+	ppmove.numvisent = std::min(ppmove.numvisent, 1);
+	ppmove.nummoveent = 0;
+
+	movevars_t moveVars = recording.MoveVars;
+
+	ppmove.player_index = recording.PlayerIndex;
+	ppmove.server = 1;
+	ppmove.multiplayer = recording.Multiplayer;
+	ppmove.movevars = &moveVars;
+	std::memcpy(ppmove.physinfo, recording.PhysInfo, sizeof(ppmove.physinfo));
+
+	ppmove.PM_PlayerTrace = Replay_PlayerTrace;
+	ppmove.PM_PlayerTraceEx = Replay_PlayerTraceEx;
+	ppmove.PM_TraceLine = Replay_TraceLine;
+	ppmove.PM_TraceLineEx = Replay_TraceLineEx;
+	ppmove.PM_TraceTexture = Replay_TraceTexture;
+	ppmove.PM_TestPlayerPosition = Replay_TestPlayerPosition;
+	ppmove.PM_TestPlayerPositionEx = Replay_TestPlayerPositionEx;
+	ppmove.PM_PointContents = Replay_PointContents;
+	ppmove.PM_TruePointContents = Replay_TruePointContents;
+	ppmove.PM_HullPointContents = Replay_HullPointContents;
+	ppmove.PM_StuckTouch = Replay_StuckTouch;
+	ppmove.PM_Particle = Replay_Particle;
+	ppmove.PM_PlaybackEventFull = Replay_PlaybackEventFull;
+	ppmove.RandomLong = Replay_RandomLong;
+	ppmove.RandomFloat = Replay_RandomFloat;
+	ppmove.Sys_FloatTime = Replay_Sys_FloatTime;
+
+	g_IsReplayingPlayerMovement = true;
+
+	PlayerMovementReplayResult result;
+	std::chrono::steady_clock::duration totalTime{};
+
+	for (int iteration = 0; iteration < iterations; ++iteration)
+	{
+		std::memcpy(reinterpret_cast<std::byte*>(&ppmove) + PlayerStateOffset, recording.PlayerState.data(), PlayerStateSize);
+		ppmove.numtouch = 0;
+		PM_ResetStuckOffsets(ppmove.player_index, ppmove.server);
+		replay->RandomState = 0;
+
+		std::uint32_t checksum = 2166136261u;
+
+		const auto startTime = std::chrono::steady_clock::now();
+
+		for (const auto& command : recording.Commands)
+		{
+			replay->Time = command.Time / 1000.0;
+
+			ppmove.time = command.Time;
+			ppmove.frametime = command.FrameTime;
+			ppmove.cmd = command.Cmd;
+			ppmove.angles = command.Angles;
+			ppmove.oldangles = command.OldAngles;
+			ppmove.maxspeed = command.MaxSpeed;
+			ppmove.clientmaxspeed = command.ClientMaxSpeed;
+			ppmove.gravity = command.Gravity;
+			ppmove.friction = command.Friction;
+			ppmove.numtouch = 0;
+
+			PM_Move(&ppmove, ppmove.server);
+
+			checksum = HashBytes(checksum, &ppmove.origin, sizeof(ppmove.origin));
+		}
+
+		totalTime += std::chrono::steady_clock::now() - startTime;
+
+		if (iteration == 0)
+		{
+			result.Checksum = checksum;
+		}
+		else if (checksum != result.Checksum)
+		{
+			result.Deterministic = false;
+		}
+	}
+
+	result.EndOrigin = ppmove.origin;
+
+	g_IsReplayingPlayerMovement = false;
+
+	ppmove = replay->Original;
+
+	g_Replay = nullptr;
+
+	const double commandCount = static_cast<double>(recording.Commands.size()) * iterations;
+
+	result.NsPerCommand = std::chrono::duration<double, std::nano>(totalTime).count() / commandCount;
+	result.PlayerTracesPerCommand = replay->PlayerTraces / commandCount;
+	result.LineTracesPerCommand = replay->LineTraces / commandCount;
+	result.PositionTestsPerCommand = replay->PositionTests / commandCount;
+	result.PointContentsPerCommand = replay->PointContents / commandCount;
+
+	return result;
+}
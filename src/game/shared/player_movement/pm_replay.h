@@ -0,0 +1,119 @@
+/***
+ *
+ *	Copyright (c) 1996-2002, Valve LLC. All rights reserved.
+ *
+ *	This product contains software technology licensed from Id
+ *	Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *	All Rights Reserved.
+ *
+ *   Use, distribution, and modification of this source code and/or resulting
+ *   object code is restricted to non-commercial enhancements to products from
+ *   Valve LLC.  All other use, distribution, or modification is prohibited
+ *   without written permission from Valve LLC.
+ *
+ ****/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "Platform.h"
+#include "mathlib.h"
+#include "const.h"
+#include "cdll_dll.h"
+#include "usercmd.h"
+#include "pm_defs.h"
+#include "pm_movevars.h"
+
+/**
+ *	@file
+ *	Player movement recordings and deterministic replays.
+ *	Used by the server's @c sv_pm_benchmark command and by the standalone @c pm_replay test,
+ *	so this is built with and without the game.
+ */
+
+// About 15 minutes at 100 commands per second.
+constexpr std::size_t PlayerMovementMaxCommands = 100000;
+
+/**
+ *	@brief A user command and the player state that game code sets between commands.
+ */
+struct RecordedPlayerMove
+{
+	float Time;
+	float FrameTime;
+	usercmd_t Cmd;
+	Vector Angles;
+	Vector OldAngles;
+	float MaxSpeed;
+	float ClientMaxSpeed;
+	float Gravity;
+	float Friction;
+};
+
+struct PlayerMovementRecording
+{
+	std::string MapName;
+	int PlayerIndex = 0;
+	qboolean Multiplayer = 0;
+	movevars_t MoveVars{};
+	char PhysInfo[MAX_PHYSINFO_STRING]{};
+
+	// Everything from playermove_t::origin up to the physics entities.
+	std::vector<std::byte> PlayerState;
+
+	// Where the player ended up when the commands were run by the engine.
+	Vector EndOrigin;
+
+	std::vector<RecordedPlayerMove> Commands;
+};
+
+struct PlayerMovementReplayResult
+{
+	double NsPerCommand = 0;
+
+	double PlayerTracesPerCommand = 0;
+	double LineTracesPerCommand = 0;
+	double PositionTestsPerCommand = 0;
+	double PointContentsPerCommand = 0;
+
+	// FNV-1a hash of the origin after every command of the first iteration.
+	std::uint32_t Checksum = 0;
+
+	// Whether all iterations produced the same checksum.
+	bool Deterministic = true;
+
+	// Origin after the last command.
+	Vector EndOrigin;
+};
+
+/**
+ *	@brief Stores the player state at the start of a recording.
+ */
+void PM_RecordPlayerState(PlayerMovementRecording& recording, const playermove_t& ppmove);
+
+/**
+ *	@brief Adds the command @p ppmove is about to run to a recording.
+ */
+void PM_RecordPlayerMove(PlayerMovementRecording& recording, const playermove_t& ppmove);
+
+std::vector<std::byte> PM_SerializeRecording(const PlayerMovementRecording& recording);
+
+/**
+ *	@param error Set to a description of the problem if the recording couldn't be read.
+ *	@return The recording, or @c nullptr if the data isn't a valid recording.
+ */
+std::unique_ptr<PlayerMovementRecording> PM_DeserializeRecording(std::span<const std::byte> data, std::string& error);
+
+/**
+ *	@brief Replays a recording through ::PM_Move @p iterations times.
+ *	@details @p ppmove is restored afterwards. Only the world, physics entity 0, is collided with.
+ *	The collision callbacks in @p ppmove are used, wrapped to count the calls made.
+ *	The clock and random number generator are replaced so the results only depend on the recording and the world.
+ */
+PlayerMovementReplayResult PM_ReplayRecording(playermove_t& ppmove, const PlayerMovementRecording& recording, int iterations);
@@ -13,14 +13,33 @@
  *
  ****/
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#ifdef PM_STANDALONE
+#include "Platform.h"
+#include "mathlib.h"
+#include "const.h"
+#include "cdll_dll.h"
+#include "cvardef.h"
+#include "in_buttons.h"
+#include "pm_materials.h"
+#else
 #include "cbase.h"
+#endif
 
 #include "com_model.h"
 #include "usercmd.h"
+#include "pm_constants.h"
 #include "pm_defs.h"
 #include "pm_shared.h"
 #include "pm_movevars.h"
 #include "pm_debug.h"
+
+#ifndef PM_STANDALONE
 #include "sound/MaterialSystem.h"
 
 #ifndef CLIENT_DLL
@@ -31,6 +50,7 @@
 #include "sound/ISoundSystem.h"
 #include "utils/ReplacementMaps.h"
 #endif
+#endif
 
 #ifdef CLIENT_DLL
 // Spectator Mode
@@ -70,6 +90,161 @@ static int rgStuckLast[MAX_PLAYERS][2];
 
 bool g_onladder = false;
 
+static cvar_t* pm_trace_memo = nullptr;
+
+/**
+ *	@brief Remembers the results of collision queries made during a single call to PM_PlayerMove.
+ *	@details Physics entities don't move while a player moves, so a query with the same inputs has the same result.
+ *	Only queries without output parameters are remembered. Keys are compared bitwise so results are identical.
+ */
+template <typename Key, typename Result>
+class PM_QueryMemo final
+{
+public:
+	static_assert(std::is_trivially_copyable_v<Key>);
+
+	void Clear()
+	{
+		m_Count = 0;
+		m_Next = 0;
+	}
+
+	const Result* Find(const Key& key) const
+	{
+		for (std::size_t i = 0; i < m_Count; ++i)
+		{
+			if (0 == std::memcmp(&m_Entries[i].Input, &key, sizeof(Key)))
+			{
+				return &m_Entries[i].Output;
+			}
+		}
+
+		return nullptr;
+	}
+
+	void Add(const Key& key, const Result& result)
+	{
+		m_Entries[m_Next] = {key, result};
+		m_Next = (m_Next + 1) % Size;
+		m_Count = std::min(m_Count + 1, Size);
+	}
+
+private:
+	static constexpr std::size_t Size = 8;
+
+	struct Entry
+	{
+		Key Input;
+		Result Output;
+	};
+
+	std::array<Entry, Size> m_Entries;
+	std::size_t m_Count = 0;
+	std::size_t m_Next = 0;
+};
+
+struct PM_PlayerTraceKey
+{
+	float Start[3];
+	float End[3];
+	int Hull;
+	int TraceFlags;
+	int IgnorePe;
+};
+
+struct PM_PositionKey
+{
+	float Position[3];
+	int Hull;
+};
+
+// Keys are compared with memcmp so they can't have padding.
+static_assert(sizeof(PM_PlayerTraceKey) == 9 * sizeof(int));
+static_assert(sizeof(PM_PositionKey) == 4 * sizeof(int));
+
+static bool g_TraceMemoEnabled = false;
+static PM_QueryMemo<PM_PlayerTraceKey, pmtrace_t> g_PlayerTraceMemo;
+static PM_QueryMemo<PM_PositionKey, int> g_TestPositionMemo;
+static PM_QueryMemo<PM_PositionKey, int> g_PointContentsMemo;
+
+static std::uint64_t g_TraceMemoQueries = 0;
+static std::uint64_t g_TraceMemoSaved = 0;
+
+static void PM_ResetTraceMemo()
+{
+	g_TraceMemoEnabled = pm_trace_memo && pm_trace_memo->value != 0;
+	g_PlayerTraceMemo.Clear();
+	g_TestPositionMemo.Clear();
+	g_PointContentsMemo.Clear();
+}
+
+static pmtrace_t PM_PlayerTrace(Vector start, Vector end, int traceFlags, int ignore_pe)
+{
+	if (!g_TraceMemoEnabled)
+	{
+		return pmove->PM_PlayerTrace(start, end, traceFlags, ignore_pe);
+	}
+
+	const PM_PlayerTraceKey key{{start.x, start.y, start.z}, {end.x, end.y, end.z}, pmove->usehull, traceFlags, ignore_pe};
+
+	++g_TraceMemoQueries;
+
+	if (auto result = g_PlayerTraceMemo.Find(key); result)
+	{
+		++g_TraceMemoSaved;
+		return *result;
+	}
+
+	const pmtrace_t trace = pmove->PM_PlayerTrace(start, end, traceFlags, ignore_pe);
+	g_PlayerTraceMemo.Add(key, trace);
+	return trace;
+}
+
+static int PM_TestPlayerPosition(Vector pos, pmtrace_t* ptrace)
+{
+	if (!g_TraceMemoEnabled || ptrace)
+	{
+		return pmove->PM_TestPlayerPosition(pos, ptrace);
+	}
+
+	const PM_PositionKey key{{pos.x, pos.y, pos.z}, pmove->usehull};
+
+	++g_TraceMemoQueries;
+
+	if (auto result = g_TestPositionMemo.Find(key); result)
+	{
+		++g_TraceMemoSaved;
+		return *result;
+	}
+
+	const int hitent = pmove->PM_TestPlayerPosition(pos, nullptr);
+	g_TestPositionMemo.Add(key, hitent);
+	return hitent;
+}
+
+static int PM_PointContents(Vector point, int* truecontents)
+{
+	if (!g_TraceMemoEnabled || truecontents)
+	{
+		return pmove->PM_PointContents(point, truecontents);
+	}
+
+	// Contents don't depend on the hull.
+	const PM_PositionKey key{{point.x, point.y, point.z}, 0};
+
+	++g_TraceMemoQueries;
+
+	if (auto result = g_PointContentsMemo.Find(key); result)
+	{
+		++g_TraceMemoSaved;
+		return *result;
+	}
+
+	const int contents = pmove->PM_PointContents(point, nullptr);
+	g_PointContentsMemo.Add(key, contents);
+	return contents;
+}
+
 static void PM_InitTrace(trace_t* trace, const Vector& end)
 {
 	memset(trace, 0, sizeof(*trace));
@@ -88,8 +263,13 @@ void PM_PlaySound(int channel, const char* sample, float volume, float attenuati
 {
 	// It's possible for this to execute before the client has received the replacement map.
 	// The engine will load the sound even if it wasn't precached, so it's not a problem.
-#ifndef CLIENT_DLL
-	EMIT_SOUND_PREDICTED(UTIL_PlayerByIndex(pmove->player_index + 1), channel, sample, volume, attenuation, fFlags, pitch);
+#ifdef PM_STANDALONE
+	// No sounds without the engine.
+#elif !defined(CLIENT_DLL)
+	if (!g_IsReplayingPlayerMovement)
+	{
+		EMIT_SOUND_PREDICTED(UTIL_PlayerByIndex(pmove->player_index + 1), channel, sample, volume, attenuation, fFlags, pitch);
+	}
 #else
 	if (pmove->runfuncs != 0)
 	{
@@ -391,6 +571,19 @@ void PM_CatagorizeTextureType()
 	if (!pTextureName)
 		return;
 
+#ifdef PM_STANDALONE
+	// Materials are only used for footstep sounds, which aren't played without the engine.
+	strncpy(pmove->sztexturename, pTextureName, sizeof(pmove->sztexturename) - 1);
+	pmove->sztexturename[sizeof(pmove->sztexturename) - 1] = 0;
+#else
+	// Common case: texture from the map's texture lump, material already known.
+	if (const auto texture = g_MaterialSystem.FindMapTexture(pTextureName); texture)
+	{
+		std::memcpy(pmove->sztexturename, texture->Name.c_str(), texture->Name.size() + 1);
+		pmove->chtexturetype = texture->Type;
+		return;
+	}
+
 	pTextureName = g_MaterialSystem.StripTexturePrefix(pTextureName);
 
 	strncpy(pmove->sztexturename, pTextureName, TextureNameMax - 1);
@@ -398,6 +591,7 @@ void PM_CatagorizeTextureType()
 
 	// get texture type
 	pmove->chtexturetype = g_MaterialSystem.FindTextureType(pmove->sztexturename);
+#endif
 }
 
 void PM_UpdateStepSound()
@@ -466,13 +660,13 @@ void PM_UpdateStepSound()
 			fvol = 0.35;
 			pmove->flTimeStepSound = 350;
 		}
-		else if (pmove->PM_PointContents(knee, nullptr) == CONTENTS_WATER)
+		else if (PM_PointContents(knee, nullptr) == CONTENTS_WATER)
 		{
 			step = STEP_WADE;
 			fvol = 0.65;
 			pmove->flTimeStepSound = 600;
 		}
-		else if (pmove->PM_PointContents(feet, nullptr) == CONTENTS_WATER)
+		else if (PM_PointContents(feet, nullptr) == CONTENTS_WATER)
 		{
 			step = STEP_SLOSH;
 			fvol = fWalking ? 0.2 : 0.5;
@@ -732,7 +926,7 @@ int PM_FlyMove()
 			end[i] = pmove->origin[i] + time_left * pmove->velocity[i];
 
 		// See if we can make it from origin to end point.
-		trace = pmove->PM_PlayerTrace(pmove->origin, end, PM_NORMAL, -1);
+		trace = PM_PlayerTrace(pmove->origin, end, PM_NORMAL, -1);
 
 		allFraction += trace.fraction;
 		// If we started in a solid object, or we were in solid space
@@ -1008,7 +1202,7 @@ void PM_WalkMove()
 
 	// first try moving directly to the next spot
 	start = dest;
-	trace = pmove->PM_PlayerTrace(pmove->origin, dest, PM_NORMAL, -1);
+	trace = PM_PlayerTrace(pmove->origin, dest, PM_NORMAL, -1);
 	// If we made it all the way, then copy trace end
 	//  as new player position.
 	if (trace.fraction == 1)
@@ -1045,7 +1239,7 @@ void PM_WalkMove()
 	dest = pmove->origin;
 	dest[2] += pmove->movevars->stepsize;
 
-	trace = pmove->PM_PlayerTrace(pmove->origin, dest, PM_NORMAL, -1);
+	trace = PM_PlayerTrace(pmove->origin, dest, PM_NORMAL, -1);
 	// If we started okay and made it part of the way at least,
 	//  copy the results to the movement start position and then
 	//  run another move try.
@@ -1062,7 +1256,7 @@ void PM_WalkMove()
 	dest = pmove->origin;
 	dest[2] -= pmove->movevars->stepsize;
 
-	trace = pmove->PM_PlayerTrace(pmove->origin, dest, PM_NORMAL, -1);
+	trace = PM_PlayerTrace(pmove->origin, dest, PM_NORMAL, -1);
 
 	// If we are not on the ground any more then
 	//  use the original movement attempt
@@ -1131,7 +1325,7 @@ void PM_Friction()
 		start[2] = pmove->origin[2] + pmove->player_mins[pmove->usehull][2];
 		stop[2] = start[2] - 34;
 
-		trace = pmove->PM_PlayerTrace(start, stop, PM_NORMAL, -1);
+		trace = PM_PlayerTrace(start, stop, PM_NORMAL, -1);
 
 		if (trace.fraction == 1.0)
 			friction = pmove->movevars->friction * pmove->movevars->edgefriction;
@@ -1288,7 +1482,7 @@ void PM_WaterMove()
 	dest = pmove->origin + (pmove->frametime * pmove->velocity);
 	start = dest;
 	start[2] += pmove->movevars->stepsize + 1;
-	trace = pmove->PM_PlayerTrace(start, dest, PM_NORMAL, -1);
+	trace = PM_PlayerTrace(start, dest, PM_NORMAL, -1);
 	if (0 == trace.startsolid && 0 == trace.allsolid) // FIXME: check steep slope?
 	{												  // walked up the step, so just keep result and exit
 		pmove->origin = trace.endpos;
@@ -1382,7 +1576,7 @@ bool PM_CheckWater()
 	pmove->watertype = CONTENTS_EMPTY;
 
 	// Grab point contents.
-	cont = pmove->PM_PointContents(point, &truecont);
+	cont = PM_PointContents(point, &truecont);
 	// Are we under water? (not solid and not empty?)
 	if (cont <= CONTENTS_WATER && cont > CONTENTS_TRANSLUCENT)
 	{
@@ -1397,7 +1591,7 @@ bool PM_CheckWater()
 
 		// Now check a point that is at the player hull midpoint.
 		point[2] = pmove->origin[2] + heightover2;
-		cont = pmove->PM_PointContents(point, nullptr);
+		cont = PM_PointContents(point, nullptr);
 		// If that point is also under water...
 		if (cont <= CONTENTS_WATER && cont > CONTENTS_TRANSLUCENT)
 		{
@@ -1407,7 +1601,7 @@ bool PM_CheckWater()
 			// Now check the eye position.  (view_ofs is relative to the origin)
 			point[2] = pmove->origin[2] + pmove->view_ofs[2];
 
-			cont = pmove->PM_PointContents(point, nullptr);
+			cont = PM_PointContents(point, nullptr);
 			if (cont <= CONTENTS_WATER && cont > CONTENTS_TRANSLUCENT)
 				pmove->waterlevel = 3; // In over our eyes
 		}
@@ -1462,7 +1656,7 @@ void PM_CatagorizePosition()
 	else
 	{
 		// Try and move down.
-		tr = pmove->PM_PlayerTrace(pmove->origin, point, PM_NORMAL, -1);
+		tr = PM_PlayerTrace(pmove->origin, point, PM_NORMAL, -1);
 		// If we hit a steep plane, we are not on ground
 		if (tr.plane.normal[2] < 0.7)
 			pmove->onground = -1; // too steep
@@ -1542,7 +1736,7 @@ bool PM_TryToUnstuck(Vector base)
 				test[1] += y;
 				test[2] += z;
 
-				if (pmove->PM_TestPlayerPosition(test, NULL) == -1)
+				if (PM_TestPlayerPosition(test, NULL) == -1)
 				{
 					pmove->origin = test;
 					return false;
@@ -1566,7 +1760,7 @@ bool PM_CheckStuck()
 	static float rgStuckCheckTime[MAX_PLAYERS][2]; // Last time we did a full
 
 	// If position is okay, exit
-	hitent = pmove->PM_TestPlayerPosition(pmove->origin, &traceresult);
+	hitent = PM_TestPlayerPosition(pmove->origin, &traceresult);
 	if (hitent == -1)
 	{
 		PM_ResetStuckOffsets(pmove->player_index, pmove->server);
@@ -1591,7 +1785,7 @@ bool PM_CheckStuck()
 				i = PM_GetRandomStuckOffsets(pmove->player_index, pmove->server, offset);
 
 				test = base + offset;
-				if (pmove->PM_TestPlayerPosition(test, &traceresult) == -1)
+				if (PM_TestPlayerPosition(test, &traceresult) == -1)
 				{
 					PM_ResetStuckOffsets(pmove->player_index, pmove->server);
 
@@ -1626,7 +1820,7 @@ bool PM_CheckStuck()
 	i = PM_GetRandomStuckOffsets(pmove->player_index, pmove->server, offset);
 
 	test = base + offset;
-	if ((hitent = pmove->PM_TestPlayerPosition(test, nullptr)) == -1)
+	if ((hitent = PM_TestPlayerPosition(test, nullptr)) == -1)
 	{
 		// Con_DPrintf("Nudged\n");
 
@@ -1821,7 +2015,7 @@ void PM_FixPlayerCrouchStuck(int direction)
 	int i;
 	Vector test;
 
-	hitent = pmove->PM_TestPlayerPosition(pmove->origin, nullptr);
+	hitent = PM_TestPlayerPosition(pmove->origin, nullptr);
 	if (hitent == -1)
 		return;
 
@@ -1829,7 +2023,7 @@ void PM_FixPlayerCrouchStuck(int direction)
 	for (i = 0; i < 36; i++)
 	{
 		pmove->origin[2] += direction;
-		hitent = pmove->PM_TestPlayerPosition(pmove->origin, nullptr);
+		hitent = PM_TestPlayerPosition(pmove->origin, nullptr);
 		if (hitent == -1)
 			return;
 	}
@@ -1853,14 +2047,14 @@ void PM_UnDuck()
 		}
 	}
 
-	trace = pmove->PM_PlayerTrace(newOrigin, newOrigin, PM_NORMAL, -1);
+	trace = PM_PlayerTrace(newOrigin, newOrigin, PM_NORMAL, -1);
 
 	if (0 == trace.startsolid)
 	{
 		pmove->usehull = 0;
 
 		// Oh, no, changing hulls stuck us into something, try unsticking downward first.
-		trace = pmove->PM_PlayerTrace(newOrigin, newOrigin, PM_NORMAL, -1);
+		trace = PM_PlayerTrace(newOrigin, newOrigin, PM_NORMAL, -1);
 		if (0 != trace.startsolid)
 		{
 			// See if we are stuck?  If so, stay ducked with the duck hull until we have a clear spot
@@ -1999,7 +2193,7 @@ void PM_LadderMove(physent_t* pLadder)
 	floor = pmove->origin;
 	floor[2] += pmove->player_mins[pmove->usehull][2] - 1;
 
-	const bool onFloor = pmove->PM_PointContents(floor, nullptr) == CONTENTS_SOLID;
+	const bool onFloor = PM_PointContents(floor, nullptr) == CONTENTS_SOLID;
 
 	pmove->gravity = 0;
 	PM_TraceModel(pLadder, pmove->origin, ladderCenter, &trace);
@@ -2188,7 +2382,7 @@ pmtrace_t PM_PushEntity(Vector push)
 
 	end = pmove->origin + push;
 
-	trace = pmove->PM_PlayerTrace(pmove->origin, end, PM_NORMAL, -1);
+	trace = PM_PlayerTrace(pmove->origin, end, PM_NORMAL, -1);
 
 	pmove->origin = trace.endpos;
 
@@ -2598,14 +2792,14 @@ void PM_CheckWaterJump()
 	// Trace, this trace should use the point sized collision hull
 	savehull = pmove->usehull;
 	pmove->usehull = 2;
-	tr = pmove->PM_PlayerTrace(vecStart, vecEnd, PM_NORMAL, -1);
+	tr = PM_PlayerTrace(vecStart, vecEnd, PM_NORMAL, -1);
 	if (tr.fraction < 1.0 && fabs(tr.plane.normal[2]) < 0.1f) // Facing a near vertical wall?
 	{
 		vecStart[2] += pmove->player_maxs[savehull][2] - WJ_HEIGHT;
 		vecEnd = vecStart + (24 * flatforward);
 		pmove->movedir = vec3_origin + (-50 * tr.plane.normal);
 
-		tr = pmove->PM_PlayerTrace(vecStart, vecEnd, PM_NORMAL, -1);
+		tr = PM_PlayerTrace(vecStart, vecEnd, PM_NORMAL, -1);
 		if (tr.fraction == 1.0)
 		{
 			pmove->waterjumptime = 2000;
@@ -2889,6 +3083,8 @@ void PM_PlayerMove(qboolean server)
 	// Adjust speeds etc.
 	PM_CheckParamters();
 
+	PM_ResetTraceMemo();
+
 	// Assume we don't touch anything
 	pmove->numtouch = 0;
 
@@ -3293,6 +3489,29 @@ int PM_GetPhysEntInfo(int ent)
 	return -1;
 }
 
+#ifdef PM_STANDALONE
+void PM_CreateCommands()
+{
+	// There is no console, so the trace memo is always enabled.
+	static cvar_t traceMemo{.name = "pm_trace_memo", .string = "1", .value = 1};
+	pm_trace_memo = &traceMemo;
+}
+#else
+void PM_CreateCommands()
+{
+	pm_trace_memo = g_ConCommands.CreateCVar("pm_trace_memo", "1");
+
+	g_ConCommands.CreateCommand("pm_trace_memo_stats", [](const auto&)
+		{
+			Con_Printf("Player movement trace memo: %llu queries, %llu saved (%.1f%%)\n",
+				static_cast<unsigned long long>(g_TraceMemoQueries), static_cast<unsigned long long>(g_TraceMemoSaved),
+				g_TraceMemoQueries > 0 ? 100.0 * g_TraceMemoSaved / g_TraceMemoQueries : 0.0);
+
+			g_TraceMemoQueries = 0;
+			g_TraceMemoSaved = 0; });
+}
+#endif
+
 void PM_Init(playermove_t* ppmove)
 {
 	assert(!pm_shared_initialized);
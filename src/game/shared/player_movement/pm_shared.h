@@ -19,11 +19,25 @@
 
 #pragma once
 
+/**
+ *	@file
+ *	When @c PM_STANDALONE is defined the movement code is built without the engine and game,
+ *	for use in tools like the player movement replay test. Sounds are not played and texture materials are not looked up.
+ */
+
 #include "Platform.h"
+
+#ifndef PM_STANDALONE
 #include "sound/MaterialSystem.h"
+#endif
 
 struct playermove_t;
 
+/**
+ *	@brief Creates the console commands and variables used by the movement code.
+ */
+void PM_CreateCommands();
+
 void PM_Init(playermove_t* ppmove);
 void PM_Move(playermove_t* ppmove, qboolean server);
 
@@ -35,6 +49,8 @@ bool PM_GetHullBounds(int hullnumber, float* mins, float* maxs);
 int PM_GetVisEntInfo(int ent);
 int PM_GetPhysEntInfo(int ent);
 
+void PM_ResetStuckOffsets(int nIndex, int server);
+
 // Spectator Movement modes (stored in pev->iuser1, so the physics code can get at them)
 #define OBS_NONE 0
 #define OBS_CHASE_LOCKED 1
@@ -47,3 +63,8 @@ int PM_GetPhysEntInfo(int ent);
 extern playermove_t* pmove;
 
 inline bool g_CheckForPlayerStuck = false;
+
+/**
+ *	@brief Set while recorded player movement is being replayed. Sounds are not played during replays.
+ */
+inline bool g_IsReplayingPlayerMovement = false;
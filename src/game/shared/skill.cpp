@@ -37,8 +37,6 @@
 
 using namespace std::literals;
 
-constexpr std::string_view SkillConfigSchemaName{"SkillConfig"sv};
-
 constexpr std::string_view SkillVariableNameRegexPattern{"^([a-zA-Z_](?:[a-zA-Z_0-9]*[a-zA-Z_]))([123]?)$"};
 const std::regex SkillVariableNameRegex{SkillVariableNameRegexPattern.data(), SkillVariableNameRegexPattern.length()};
 
@@ -131,6 +129,11 @@ bool SkillSystem::Initialize()
 
 			const auto printer = [=](const SkillVariable& variable)
 			{
+				if ((variable.Flags & VarFlag_IsPresent) == 0)
+				{
+					return;
+				}
+
 				if (networkedOnly && variable.NetworkIndex == NotNetworkedIndex)
 				{
 					return;
@@ -189,6 +192,40 @@ bool SkillSystem::Initialize()
 	g_ClientUserMessages.RegisterHandler("SkillVars", &SkillSystem::MsgFunc_SkillVars, this);
 #endif
 
+	g_ConCommands.CreateCommand("sk_profile", [this](const auto& args)
+		{
+			const std::string_view mode{args.Count() >= 2 ? args.Argument(1) : "print"};
+
+			if (mode == "start")
+			{
+				m_LookupCounts.clear();
+				m_ProfileLookups = true;
+				Con_Printf("Counting skill variable lookups by name\n");
+			}
+			else if (mode == "stop")
+			{
+				m_ProfileLookups = false;
+			}
+			else if (mode == "print")
+			{
+				std::vector<std::pair<std::string_view, int>> counts(m_LookupCounts.begin(), m_LookupCounts.end());
+
+				std::sort(counts.begin(), counts.end(), [](const auto& lhs, const auto& rhs)
+					{ return lhs.second > rhs.second; });
+
+				for (const auto& [name, count] : counts)
+				{
+					Con_Printf("%8d %.*s\n", count, static_cast<int>(name.size()), name.data());
+				}
+
+				Con_Printf("%d variables looked up by name%s\n", static_cast<int>(counts.size()), m_ProfileLookups ? "" : " (not counting)");
+			}
+			else
+			{
+				Con_Printf("Usage: %s [start|stop|print]\n", args.Argument(0));
+			}
+		});
+
 	return true;
 }
 
@@ -231,7 +268,11 @@ void SkillSystem::HandleNetworkDataBlock(NetworkDataBlock& block)
 	}
 	else
 	{
-		m_SkillVariables.clear();
+		for (auto& variable : m_SkillVariables)
+		{
+			RemoveVariable(variable);
+		}
+
 		m_NextNetworkedIndex = 0;
 
 		for (const auto& varData : block.Data)
@@ -260,16 +301,15 @@ void SkillSystem::LoadSkillConfigFiles(std::span<const std::string> fileNames)
 	SetSkillLevel(static_cast<SkillLevel>(iSkill));
 
 	// Erase all previous data.
-	for (auto it = m_SkillVariables.begin(); it != m_SkillVariables.end();)
+	for (auto& variable : m_SkillVariables)
 	{
-		if ((it->Flags & VarFlag_IsExplicitlyDefined) != 0)
+		if ((variable.Flags & VarFlag_IsExplicitlyDefined) != 0)
 		{
-			it->CurrentValue = it->InitialValue;
-			++it;
+			variable.CurrentValue = variable.InitialValue;
 		}
 		else
 		{
-			it = m_SkillVariables.erase(it);
+			RemoveVariable(variable);
 		}
 	}
 
@@ -294,10 +334,9 @@ void SkillSystem::LoadSkillConfigFiles(std::span<const std::string> fileNames)
 
 void SkillSystem::DefineVariable(std::string name, float initialValue, const SkillVarConstraints& constraints)
 {
-	auto it = std::find_if(m_SkillVariables.begin(), m_SkillVariables.end(), [&](const auto& variable)
-		{ return variable.Name == name; });
+	const int index = FindVariableIndex(name);
 
-	if (it != m_SkillVariables.end())
+	if (index != -1 && (m_SkillVariables[index].Flags & VarFlag_IsPresent) != 0)
 	{
 		m_Logger->error("Cannot define variable \"{}\": already defined", name);
 		assert(!"Variable already defined");
@@ -338,18 +377,37 @@ void SkillSystem::DefineVariable(std::string name, float initialValue, const Ski
 		.InitialValue = initialValue,
 		.Constraints = updatedConstraints,
 		.NetworkIndex = networkIndex,
-		.Flags = VarFlag_IsExplicitlyDefined};
+		.Flags = VarFlag_IsExplicitlyDefined | VarFlag_IsPresent};
 
-	m_SkillVariables.emplace_back(std::move(variable));
+	if (index != -1)
+	{
+		m_SkillVariables[index] = std::move(variable);
+	}
+	else
+	{
+		m_VariableIndices.emplace(variable.Name, static_cast<int>(m_SkillVariables.size()));
+		m_SkillVariables.emplace_back(std::move(variable));
+	}
 }
 
 float SkillSystem::GetValue(std::string_view name, float defaultValue) const
 {
-	if (const auto it = std::find_if(m_SkillVariables.begin(), m_SkillVariables.end(), [&](const auto& variable)
-			{ return variable.Name == name; });
-		it != m_SkillVariables.end())
+	if (m_ProfileLookups)
 	{
-		return it->CurrentValue;
+		if (auto it = m_LookupCounts.find(name); it != m_LookupCounts.end())
+		{
+			++it->second;
+		}
+		else
+		{
+			m_LookupCounts.emplace(name, 1);
+		}
+	}
+
+	if (const int index = FindVariableIndex(name);
+		index != -1 && (m_SkillVariables[index].Flags & VarFlag_IsPresent) != 0)
+	{
+		return m_SkillVariables[index].CurrentValue;
 	}
 
 	m_Logger->debug("Undefined variable {}{}", name, m_SkillLevel);
@@ -357,23 +415,53 @@ float SkillSystem::GetValue(std::string_view name, float defaultValue) const
 	return defaultValue;
 }
 
+float SkillSystem::GetValue(const SkillVarHandle& handle, float defaultValue) const
+{
+	if (handle.m_Index == -1)
+	{
+		// Stays unresolved until the variable is first set or defined.
+		handle.m_Index = FindVariableIndex(handle.m_Name);
+	}
+
+	if (handle.m_Index != -1)
+	{
+		const auto& variable = m_SkillVariables[handle.m_Index];
+
+		if ((variable.Flags & VarFlag_IsPresent) != 0)
+		{
+			return variable.CurrentValue;
+		}
+	}
+
+	m_Logger->debug("Undefined variable {}{}", handle.m_Name, m_SkillLevel);
+
+	return defaultValue;
+}
+
 void SkillSystem::SetValue(std::string_view name, float value)
 {
-	auto it = std::find_if(m_SkillVariables.begin(), m_SkillVariables.end(), [&](const auto& variable)
-		{ return variable.Name == name; });
+	int index = FindVariableIndex(name);
 
-	if (it == m_SkillVariables.end())
+	if (index == -1)
 	{
 		SkillVariable variable{
 			.Name = std::string{name},
 			.CurrentValue = 0,
-			.InitialValue = 0};
+			.InitialValue = 0,
+			.Flags = VarFlag_IsPresent};
 
-		m_SkillVariables.emplace_back(std::move(variable));
+		index = static_cast<int>(m_SkillVariables.size());
 
-		it = m_SkillVariables.end() - 1;
+		m_VariableIndices.emplace(variable.Name, index);
+		m_SkillVariables.emplace_back(std::move(variable));
+	}
+	else
+	{
+		m_SkillVariables[index].Flags |= VarFlag_IsPresent;
 	}
 
+	const auto it = m_SkillVariables.begin() + index;
+
 	value = ClampValue(value, it->Constraints);
 
 	if (it->CurrentValue != value)
@@ -459,6 +547,22 @@ float SkillSystem::ClampValue(float value, const SkillVarConstraints& constraint
 	return value;
 }
 
+int SkillSystem::FindVariableIndex(std::string_view name) const
+{
+	if (const auto it = m_VariableIndices.find(name); it != m_VariableIndices.end())
+	{
+		return it->second;
+	}
+
+	return -1;
+}
+
+void SkillSystem::RemoveVariable(SkillVariable& variable)
+{
+	std::string name = std::move(variable.Name);
+	variable = SkillVariable{.Name = std::move(name)};
+}
+
 bool SkillSystem::ParseConfiguration(const json& input)
 {
 	if (!input.is_object())
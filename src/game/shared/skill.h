@@ -22,6 +22,7 @@
 #include <span>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 #include <vector>
 
 #include <fmt/core.h>
@@ -29,11 +30,14 @@
 #include <spdlog/logger.h>
 
 #include "networking/NetworkDataSystem.h"
+#include "utils/heterogeneous_lookup.h"
 #include "utils/json_fwd.h"
 #include "utils/GameSystem.h"
 
 class BufferReader;
 
+constexpr std::string_view SkillConfigSchemaName{"SkillConfig"};
+
 enum class SkillLevel
 {
 	Easy = 1,
@@ -64,6 +68,29 @@ struct SkillVarConstraints
 	SkillVarType Type{SkillVarType::Float};
 };
 
+/**
+ *	@brief Refers to a skill variable by name, resolved to an index on first use.
+ *	@details Intended for variables read often, declare these as static variables
+ *	and pass them to SkillSystem::GetValue instead of the name.
+ *	The name must outlive the handle, typically a string literal.
+ */
+class SkillVarHandle final
+{
+public:
+	constexpr explicit SkillVarHandle(std::string_view name)
+		: m_Name(name)
+	{
+	}
+
+	constexpr std::string_view GetName() const { return m_Name; }
+
+private:
+	friend class SkillSystem;
+
+	std::string_view m_Name;
+	mutable int m_Index = -1;
+};
+
 /**
  *	@brief Loads skill variables from files and provides a means of looking them up.
  */
@@ -85,6 +112,11 @@ private:
 	enum VarFlag
 	{
 		VarFlag_IsExplicitlyDefined = 1 << 0,
+
+		/**
+		 *	@brief Variables are never erased so handles stay valid, removed variables only lose this flag.
+		 */
+		VarFlag_IsPresent = 1 << 1,
 	};
 
 	struct SkillVariable
@@ -120,6 +152,11 @@ public:
 	 */
 	float GetValue(std::string_view name, float defaultValue = 0.f) const;
 
+	/**
+	 *	@brief Gets the value for a given skill variable without looking up its name after the first call.
+	 */
+	float GetValue(const SkillVarHandle& handle, float defaultValue = 0.f) const;
+
 	void SetValue(std::string_view name, float value);
 
 #ifndef CLIENT_DLL
@@ -129,6 +166,10 @@ public:
 private:
 	static float ClampValue(float value, const SkillVarConstraints& constraints);
 
+	int FindVariableIndex(std::string_view name) const;
+
+	static void RemoveVariable(SkillVariable& variable);
+
 	bool ParseConfiguration(const json& input);
 
 #ifdef CLIENT_DLL
@@ -141,9 +182,13 @@ private:
 	SkillLevel m_SkillLevel = SkillLevel::Easy;
 
 	std::vector<SkillVariable> m_SkillVariables;
+	std::unordered_map<std::string, int, TransparentStringHash, TransparentEqual> m_VariableIndices;
 
 	int m_NextNetworkedIndex = 0;
 
+	bool m_ProfileLookups = false;
+	mutable std::unordered_map<std::string, int, TransparentStringHash, TransparentEqual> m_LookupCounts;
+
 	bool m_LoadingSkillFiles = false;
 };
 
@@ -0,0 +1,193 @@
+/***
+ *
+ *	Copyright (c) 1996-2001, Valve LLC. All rights reserved.
+ *
+ *	This product contains software technology licensed from Id
+ *	Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *	All Rights Reserved.
+ *
+ *   Use, distribution, and modification of this source code and/or resulting
+ *   object code is restricted to non-commercial enhancements to products from
+ *   Valve LLC.  All other use, distribution, or modification is prohibited
+ *   without written permission from Valve LLC.
+ *
+ ****/
+
+#include "cbase.h"
+#include "AmbientModulation.h"
+
+AmbientModulationResult UpdateAmbientModulation(dynpitchvol_t& dpv)
+{
+	AmbientModulationResult result{.Pitch = dpv.pitch, .Volume = dpv.vol};
+
+	int& pitch = result.Pitch;
+	int& vol = result.Volume;
+	int prev;
+
+	// ==============
+	// pitch envelope
+	// ==============
+	if (0 != dpv.spinup || 0 != dpv.spindown)
+	{
+		prev = dpv.pitchfrac >> 8;
+
+		if (dpv.spinup > 0)
+			dpv.pitchfrac += dpv.spinup;
+		else if (dpv.spindown > 0)
+			dpv.pitchfrac -= dpv.spindown;
+
+		pitch = dpv.pitchfrac >> 8;
+
+		if (pitch > dpv.pitchrun)
+		{
+			pitch = dpv.pitchrun;
+			dpv.spinup = 0; // done with ramp up
+		}
+
+		if (pitch < dpv.pitchstart)
+		{
+			pitch = dpv.pitchstart;
+			dpv.spindown = 0; // done with ramp down
+
+			// shut sound off
+			result.Stopped = true;
+			return result;
+		}
+
+		if (pitch > 255)
+			pitch = 255;
+		if (pitch < 1)
+			pitch = 1;
+
+		dpv.pitch = pitch;
+
+		result.Changed |= (prev != pitch);
+		result.Flags |= SND_CHANGE_PITCH;
+	}
+
+	// ==================
+	// amplitude envelope
+	// ==================
+	if (0 != dpv.fadein || 0 != dpv.fadeout)
+	{
+		prev = dpv.volfrac >> 8;
+
+		if (dpv.fadein > 0)
+			dpv.volfrac += dpv.fadein;
+		else if (dpv.fadeout > 0)
+			dpv.volfrac -= dpv.fadeout;
+
+		vol = dpv.volfrac >> 8;
+
+		if (vol > dpv.volrun)
+		{
+			vol = dpv.volrun;
+			dpv.fadein = 0; // done with ramp up
+		}
+
+		if (vol < dpv.volstart)
+		{
+			vol = dpv.volstart;
+			dpv.fadeout = 0; // done with ramp down
+
+			// shut sound off
+			result.Stopped = true;
+			return result;
+		}
+
+		if (vol > 100)
+			vol = 100;
+		if (vol < 1)
+			vol = 1;
+
+		dpv.vol = vol;
+
+		result.Changed |= (prev != vol);
+		result.Flags |= SND_CHANGE_VOL;
+	}
+
+	// ===================
+	// pitch/amplitude LFO
+	// ===================
+	if (0 != dpv.lfotype)
+	{
+		int pos;
+
+		if (dpv.lfofrac > 0x6fffffff)
+			dpv.lfofrac = 0;
+
+		// update lfo, lfofrac/255 makes a triangle wave 0-255
+		dpv.lfofrac += dpv.lforate;
+		pos = dpv.lfofrac >> 8;
+
+		if (dpv.lfofrac < 0)
+		{
+			dpv.lfofrac = 0;
+			dpv.lforate = abs(dpv.lforate);
+			pos = 0;
+		}
+		else if (pos > 255)
+		{
+			pos = 255;
+			dpv.lfofrac = (255 << 8);
+			dpv.lforate = -abs(dpv.lforate);
+		}
+
+		switch (dpv.lfotype)
+		{
+		case LFO_SQUARE:
+			if (pos < 128)
+				dpv.lfomult = 255;
+			else
+				dpv.lfomult = 0;
+
+			break;
+		case LFO_RANDOM:
+			if (pos == 255)
+				dpv.lfomult = RANDOM_LONG(0, 255);
+			break;
+		case LFO_TRIANGLE:
+		default:
+			dpv.lfomult = pos;
+			break;
+		}
+
+		if (0 != dpv.lfomodpitch)
+		{
+			prev = pitch;
+
+			// pitch 0-255
+			pitch += ((dpv.lfomult - 128) * dpv.lfomodpitch) / 100;
+
+			if (pitch > 255)
+				pitch = 255;
+			if (pitch < 1)
+				pitch = 1;
+
+
+			result.Changed |= (prev != pitch);
+			result.Flags |= SND_CHANGE_PITCH;
+		}
+
+		if (0 != dpv.lfomodvol)
+		{
+			// vol 0-100
+			prev = vol;
+
+			vol += ((dpv.lfomult - 128) * dpv.lfomodvol) / 100;
+
+			if (vol > 100)
+				vol = 100;
+			if (vol < 0)
+				vol = 0;
+
+			result.Changed |= (prev != vol);
+			result.Flags |= SND_CHANGE_VOL;
+		}
+	}
+
+	if (pitch == PITCH_NORM)
+		pitch = PITCH_NORM + 1; // don't send 'no pitch' !
+
+	return result;
+}
@@ -0,0 +1,103 @@
+/***
+ *
+ *	Copyright (c) 1996-2001, Valve LLC. All rights reserved.
+ *
+ *	This product contains software technology licensed from Id
+ *	Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *	All Rights Reserved.
+ *
+ *   Use, distribution, and modification of this source code and/or resulting
+ *   object code is restricted to non-commercial enhancements to products from
+ *   Valve LLC.  All other use, distribution, or modification is prohibited
+ *   without written permission from Valve LLC.
+ *
+ ****/
+
+#pragma once
+
+/**
+ *	@brief runtime pitch shift and volume fadein/out structure
+ *	@details NOTE: IF YOU CHANGE THIS STRUCT YOU MUST CHANGE THE SAVE/RESTORE VERSION NUMBER
+ *	SEE ambient_generic's typedescription in sound.cpp
+ */
+struct dynpitchvol_t
+{
+	// NOTE: do not change the order of these parameters
+	// NOTE: unless you also change order of rgdpvpreset array elements!
+	int preset;
+
+	int pitchrun;	// pitch shift % when sound is running 0 - 255
+	int pitchstart; // pitch shift % when sound stops or starts 0 - 255
+	int spinup;		// spinup time 0 - 100
+	int spindown;	// spindown time 0 - 100
+
+	int volrun;	  // volume change % when sound is running 0 - 10
+	int volstart; // volume change % when sound stops or starts 0 - 10
+	int fadein;	  // volume fade in time 0 - 100
+	int fadeout;  // volume fade out time 0 - 100
+
+	// Low Frequency Oscillator
+	int lfotype; // 0) off 1) square 2) triangle 3) random
+	int lforate; // 0 - 1000, how fast lfo osciallates
+
+	int lfomodpitch; // 0-100 mod of current pitch. 0 is off.
+	int lfomodvol;	 // 0-100 mod of current volume. 0 is off.
+
+	int cspinup; // each trigger hit increments counter and spinup pitch
+
+
+	int cspincount;
+
+	int pitch;
+	int spinupsav;
+	int spindownsav;
+	int pitchfrac;
+
+	int vol;
+	int fadeinsav;
+	int fadeoutsav;
+	int volfrac;
+
+	int lfofrac;
+	int lfomult;
+};
+
+/**
+ *	@brief Ramps and LFOs are evaluated at 5hz.
+ */
+constexpr float AmbientModulationInterval = 0.2f;
+
+struct AmbientModulationResult
+{
+	int Pitch = 0;
+	int Volume = 0;
+
+	/**
+	 *	@brief @c SND_CHANGE_PITCH and/or @c SND_CHANGE_VOL if the sound is being modulated.
+	 */
+	int Flags = 0;
+
+	/**
+	 *	@brief Whether the pitch or volume differs from the previous step.
+	 */
+	bool Changed = false;
+
+	/**
+	 *	@brief Whether a ramp down has finished and the sound should be stopped.
+	 */
+	bool Stopped = false;
+};
+
+/**
+ *	@brief Whether the sound has any ramps or an LFO that need to be evaluated.
+ */
+inline bool IsAmbientModulated(const dynpitchvol_t& dpv)
+{
+	return 0 != dpv.spinup || 0 != dpv.spindown || 0 != dpv.fadein || 0 != dpv.fadeout || 0 != dpv.lfotype;
+}
+
+/**
+ *	@brief Advances the pitch and volume ramps and the LFO by one step.
+ *	@details Used by ambient_generic on the server and by the client sound system so both produce the same curves.
+ */
+AmbientModulationResult UpdateAmbientModulation(dynpitchvol_t& dpv);
@@ -14,6 +14,7 @@
  ****/
 
 #include <algorithm>
+#include <cstdint>
 
 #include "cbase.h"
 #include "MaterialSystem.h"
@@ -24,8 +25,6 @@
 
 constexpr std::size_t MinimumMaterialsCount = 512; // original max number of textures loaded
 
-constexpr std::string_view MaterialsConfigSchemaName{"MaterialsConfig"sv};
-
 static std::string GetMaterialsConfigSchema()
 {
 	return fmt::format(R"(
@@ -95,6 +94,8 @@ void MaterialSystem::HandleNetworkDataBlock(NetworkDataBlock& block)
 		}
 
 		g_NetworkData.GetLogger()->debug("Parsed {} materials from network data", m_Materials.size());
+
+		UpdateMapTextures();
 	}
 }
 
@@ -118,6 +119,8 @@ void MaterialSystem::LoadMaterials(std::span<const std::string> fileNames)
 	}
 
 	m_Logger->debug("Loaded {} materials", m_Materials.size());
+
+	UpdateMapTextures();
 }
 
 const char* MaterialSystem::StripTexturePrefix(const char* name)
@@ -151,6 +154,77 @@ char MaterialSystem::FindTextureType(const char* name) const
 	return CHAR_TEX_CONCRETE;
 }
 
+void MaterialSystem::SetMapTextures(std::vector<std::string> textureNames)
+{
+	m_MapTextureNames = std::move(textureNames);
+
+	m_MapTextureIndices.clear();
+	m_MapTextureIndices.reserve(m_MapTextureNames.size());
+
+	for (int i = 0; i < static_cast<int>(m_MapTextureNames.size()); ++i)
+	{
+		if (!m_MapTextureNames[i].empty())
+		{
+			// Keep the first texture if a name occurs more than once, like the engine does.
+			m_MapTextureIndices.emplace(m_MapTextureNames[i], i);
+		}
+	}
+
+	UpdateMapTextures();
+
+	m_Logger->debug("Map has {} textures", m_MapTextureNames.size());
+}
+
+const MapTexture* MaterialSystem::FindMapTexture(const char* engineName) const
+{
+	if (!engineName)
+	{
+		return nullptr;
+	}
+
+	auto& entry = m_MapTextureCache[(reinterpret_cast<std::uintptr_t>(engineName) >> 4) % m_MapTextureCache.size()];
+
+	if (entry.EngineName != engineName ||
+		// Make sure the engine didn't reuse the address for another name.
+		0 != strncmp(engineName, m_MapTextureNames[entry.Index].c_str(), TextureNameMax))
+	{
+		const auto it = m_MapTextureIndices.find(std::string_view{engineName, strnlen(engineName, TextureNameMax)});
+
+		if (it == m_MapTextureIndices.end())
+		{
+			return nullptr;
+		}
+
+		entry.EngineName = engineName;
+		entry.Index = it->second;
+	}
+
+	return &m_MapTextures[entry.Index];
+}
+
+void MaterialSystem::UpdateMapTextures()
+{
+	m_MapTextures.clear();
+	m_MapTextures.reserve(m_MapTextureNames.size());
+
+	for (const auto& name : m_MapTextureNames)
+	{
+		MapTexture& texture = m_MapTextures.emplace_back();
+
+		texture.Name.assign(StripTexturePrefix(name.c_str()));
+
+		if (texture.Name.size() >= TextureNameMax)
+		{
+			texture.Name.resize(TextureNameMax - 1);
+		}
+
+		texture.Type = FindTextureType(texture.Name.c_str());
+	}
+
+	// Materials or texture indices may have changed.
+	m_MapTextureCache.fill({});
+}
+
 bool MaterialSystem::ParseConfiguration(const json& input)
 {
 	if (!input.is_object())
@@ -20,7 +20,9 @@
 #include <memory>
 #include <span>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
 
 #include <EASTL/fixed_string.h>
 
@@ -32,6 +34,8 @@
 #include "utils/heterogeneous_lookup.h"
 #include "utils/json_fwd.h"
 
+constexpr std::string_view MaterialsConfigSchemaName{"MaterialsConfig"};
+
 constexpr std::size_t TextureNameMax = 16; // Must match texture name length in WAD and BSP file formats.
 
 using TextureName = eastl::fixed_string<char, TextureNameMax>;
@@ -48,6 +52,18 @@ struct Material
 	char Type{};
 };
 
+/**
+ *	@brief Material of a texture in the current map's texture lump.
+ */
+struct MapTexture
+{
+	/**
+	 *	@brief Texture name with prefix stripped, as stored in @c playermove_t::sztexturename.
+	 */
+	TextureName Name;
+	char Type{};
+};
+
 /**
  *	@brief Used to detect the texture the player is standing on,
  *	map the texture name to a material type.
@@ -78,12 +94,41 @@ public:
 	 */
 	char FindTextureType(const char* name) const;
 
+	/**
+	 *	@brief Sets the textures in the current map's texture lump, in miptex order.
+	 */
+	void SetMapTextures(std::vector<std::string> textureNames);
+
+	/**
+	 *	@brief Finds a map texture by the name returned by the engine's texture traces.
+	 *	@details The engine returns names stored in its texture list,
+	 *	so after the first lookup the name's address is used to find the texture.
+	 *	@return The texture, or @c nullptr if it is not in the map's texture lump.
+	 */
+	const MapTexture* FindMapTexture(const char* engineName) const;
+
 private:
 	bool ParseConfiguration(const json& input);
 
+	void UpdateMapTextures();
+
 private:
+	struct MapTextureCacheEntry
+	{
+		const char* EngineName{};
+		int Index{-1};
+	};
+
+	static constexpr std::size_t MapTextureCacheSize = 64;
+
 	std::shared_ptr<spdlog::logger> m_Logger;
 	std::unordered_map<TextureName, Material, TextureNameHash, TransparentEqual> m_Materials;
+
+	std::vector<std::string> m_MapTextureNames;
+	std::unordered_map<std::string, int, TransparentStringHash, TransparentEqual> m_MapTextureIndices;
+	std::vector<MapTexture> m_MapTextures;
+
+	mutable std::array<MapTextureCacheEntry, MapTextureCacheSize> m_MapTextureCache;
 };
 
 inline MaterialSystem g_MaterialSystem;
@@ -0,0 +1,322 @@
+/***
+ *
+ *	Copyright (c) 1996-2001, Valve LLC. All rights reserved.
+ *
+ *	This product contains software technology licensed from Id
+ *	Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *	All Rights Reserved.
+ *
+ *   Use, distribution, and modification of this source code and/or resulting
+ *   object code is restricted to non-commercial enhancements to products from
+ *   Valve LLC.  All other use, distribution, or modification is prohibited
+ *   without written permission from Valve LLC.
+ *
+ ****/
+
+#include <algorithm>
+#include <bit>
+
+#include "AsyncLogSink.h"
+
+using namespace std::literals;
+
+// How long the writer thread sleeps when there is nothing to write, in case a wakeup was missed.
+constexpr auto WriterIdleTimeout = 100ms;
+
+std::optional<LogOverflowPolicy> LogOverflowPolicyFromString(std::string_view name)
+{
+	if (name == "block"sv)
+	{
+		return LogOverflowPolicy::Block;
+	}
+	else if (name == "drop_oldest"sv)
+	{
+		return LogOverflowPolicy::DropOldest;
+	}
+	else if (name == "drop_newest"sv)
+	{
+		return LogOverflowPolicy::DropNewest;
+	}
+
+	return {};
+}
+
+std::string_view LogOverflowPolicyToString(LogOverflowPolicy policy)
+{
+	switch (policy)
+	{
+	case LogOverflowPolicy::Block: return "block"sv;
+	case LogOverflowPolicy::DropOldest: return "drop_oldest"sv;
+	case LogOverflowPolicy::DropNewest: return "drop_newest"sv;
+	}
+
+	return "unknown"sv;
+}
+
+AsyncLogSink::AsyncLogSink(std::shared_ptr<spdlog::sinks::sink> sink, std::size_t queueSize, LogOverflowPolicy overflowPolicy, int rateLimit)
+	: m_Sink(std::move(sink)),
+	  m_OverflowPolicy(overflowPolicy),
+	  m_RateLimit(std::max(0, rateLimit)),
+	  m_Mask(std::bit_ceil(std::max<std::size_t>(queueSize, 2)) - 1)
+{
+	m_Cells = std::make_unique<Cell[]>(m_Mask + 1);
+
+	for (std::size_t i = 0; i <= m_Mask; ++i)
+	{
+		m_Cells[i].Sequence.store(i, std::memory_order_relaxed);
+	}
+
+	m_Writer = std::thread{&AsyncLogSink::WriterThread, this};
+}
+
+AsyncLogSink::~AsyncLogSink()
+{
+	// The writer thread writes everything that's still queued before it stops.
+	m_Stopping = true;
+	m_Wake.notify_one();
+	m_Writer.join();
+}
+
+void AsyncLogSink::log(const spdlog::details::log_msg& msg)
+{
+	if (m_RateLimit > 0 && IsRateLimited({msg.logger_name.data(), msg.logger_name.size()}))
+	{
+		++m_RateLimited;
+		return;
+	}
+
+	if (!TryEnqueue(msg))
+	{
+		switch (m_OverflowPolicy)
+		{
+		case LogOverflowPolicy::Block:
+			++m_Blocked;
+
+			do
+			{
+				WakeWriter();
+				std::this_thread::yield();
+			} while (!TryEnqueue(msg));
+			break;
+
+		case LogOverflowPolicy::DropOldest:
+			do
+			{
+				if (TryDequeue(nullptr))
+				{
+					++m_Dropped;
+				}
+			} while (!TryEnqueue(msg));
+			break;
+
+		case LogOverflowPolicy::DropNewest:
+			++m_Dropped;
+			return;
+		}
+	}
+
+	++m_Enqueued;
+
+	if (m_WriterWaiting.load(std::memory_order_acquire))
+	{
+		WakeWriter();
+	}
+}
+
+void AsyncLogSink::flush()
+{
+	while (!IsEmpty())
+	{
+		WakeWriter();
+		std::this_thread::yield();
+	}
+
+	// Wait for the writer thread to finish writing the last messages it took out of the queue.
+	std::lock_guard lock{m_SinkMutex};
+	m_Sink->flush();
+}
+
+void AsyncLogSink::set_pattern(const std::string& pattern)
+{
+	std::lock_guard lock{m_SinkMutex};
+	m_Sink->set_pattern(pattern);
+}
+
+void AsyncLogSink::set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter)
+{
+	std::lock_guard lock{m_SinkMutex};
+	m_Sink->set_formatter(std::move(sink_formatter));
+}
+
+AsyncLogSink::Stats AsyncLogSink::GetStats() const
+{
+	const std::size_t enqueuePosition = m_EnqueuePosition.load(std::memory_order_relaxed);
+	const std::size_t dequeuePosition = m_DequeuePosition.load(std::memory_order_relaxed);
+
+	return {
+		.Queued = enqueuePosition - std::min(enqueuePosition, dequeuePosition),
+		.Enqueued = m_Enqueued,
+		.Written = m_Written,
+		.Dropped = m_Dropped,
+		.RateLimited = m_RateLimited,
+		.Blocked = m_Blocked};
+}
+
+bool AsyncLogSink::IsRateLimited(std::string_view loggerName)
+{
+	const auto now = std::chrono::steady_clock::now();
+
+	std::lock_guard lock{m_RateMutex};
+
+	auto it = m_RateBuckets.find(loggerName);
+
+	if (it == m_RateBuckets.end())
+	{
+		it = m_RateBuckets.emplace(std::string{loggerName}, RateBucket{.Tokens = static_cast<double>(m_RateLimit), .LastRefill = now}).first;
+	}
+
+	auto& bucket = it->second;
+
+	// Refill at the rate limit, allowing bursts of up to a second's worth of messages.
+	const std::chrono::duration<double> elapsed = now - bucket.LastRefill;
+	bucket.Tokens = std::min(static_cast<double>(m_RateLimit), bucket.Tokens + elapsed.count() * m_RateLimit);
+	bucket.LastRefill = now;
+
+	if (bucket.Tokens < 1)
+	{
+		return true;
+	}
+
+	bucket.Tokens -= 1;
+
+	return false;
+}
+
+// Bounded multi-producer queue based on Dmitry Vyukov's design. Each cell's sequence number tells whether
+// it's ready to be written to or read from for a given position, so producers only contend on the position counter.
+bool AsyncLogSink::TryEnqueue(const spdlog::details::log_msg& msg)
+{
+	Cell* cell;
+	std::size_t position = m_EnqueuePosition.load(std::memory_order_relaxed);
+
+	while (true)
+	{
+		cell = &m_Cells[position & m_Mask];
+
+		const std::size_t sequence = cell->Sequence.load(std::memory_order_acquire);
+		const auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+
+		if (difference == 0)
+		{
+			if (m_EnqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+			{
+				break;
+			}
+		}
+		else if (difference < 0)
+		{
+			// Full.
+			return false;
+		}
+		else
+		{
+			position = m_EnqueuePosition.load(std::memory_order_relaxed);
+		}
+	}
+
+	cell->Message = spdlog::details::log_msg_buffer{msg};
+	cell->Sequence.store(position + 1, std::memory_order_release);
+
+	return true;
+}
+
+bool AsyncLogSink::TryDequeue(spdlog::details::log_msg_buffer* message)
+{
+	Cell* cell;
+	std::size_t position = m_DequeuePosition.load(std::memory_order_relaxed);
+
+	while (true)
+	{
+		cell = &m_Cells[position & m_Mask];
+
+		const std::size_t sequence = cell->Sequence.load(std::memory_order_acquire);
+		const auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position + 1);
+
+		if (difference == 0)
+		{
+			if (m_DequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+			{
+				break;
+			}
+		}
+		else if (difference < 0)
+		{
+			// Empty.
+			return false;
+		}
+		else
+		{
+			position = m_DequeuePosition.load(std::memory_order_relaxed);
+		}
+	}
+
+	if (message)
+	{
+		*message = std::move(cell->Message);
+	}
+
+	cell->Sequence.store(position + m_Mask + 1, std::memory_order_release);
+
+	return true;
+}
+
+bool AsyncLogSink::IsEmpty() const
+{
+	return m_DequeuePosition.load(std::memory_order_acquire) >= m_EnqueuePosition.load(std::memory_order_acquire);
+}
+
+void AsyncLogSink::WakeWriter()
+{
+	m_Wake.notify_one();
+}
+
+void AsyncLogSink::WriterThread()
+{
+	spdlog::details::log_msg_buffer message;
+
+	while (true)
+	{
+		{
+			std::lock_guard lock{m_SinkMutex};
+
+			bool wroteMessages = false;
+
+			while (TryDequeue(&message))
+			{
+				m_Sink->log(message);
+				++m_Written;
+				wroteMessages = true;
+			}
+
+			// Keep the file up to date while the game is running, but only once per batch.
+			if (wroteMessages)
+			{
+				m_Sink->flush();
+			}
+		}
+
+		if (m_Stopping && IsEmpty())
+		{
+			break;
+		}
+
+		std::unique_lock lock{m_WakeMutex};
+
+		m_WriterWaiting.store(true, std::memory_order_release);
+
+		m_Wake.wait_for(lock, WriterIdleTimeout, [this]
+			{ return m_Stopping || !IsEmpty(); });
+
+		m_WriterWaiting.store(false, std::memory_order_release);
+	}
+}
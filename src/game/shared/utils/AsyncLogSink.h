@@ -0,0 +1,151 @@
+/***
+ *
+ *	Copyright (c) 1996-2001, Valve LLC. All rights reserved.
+ *
+ *	This product contains software technology licensed from Id
+ *	Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *	All Rights Reserved.
+ *
+ *   Use, distribution, and modification of this source code and/or resulting
+ *   object code is restricted to non-commercial enhancements to products from
+ *   Valve LLC.  All other use, distribution, or modification is prohibited
+ *   without written permission from Valve LLC.
+ *
+ ****/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+
+#include <spdlog/details/log_msg_buffer.h>
+#include <spdlog/sinks/sink.h>
+
+#include "heterogeneous_lookup.h"
+
+/**
+ *	@brief What to do with a message when the queue is full.
+ */
+enum class LogOverflowPolicy
+{
+	Block,		//!< Wait for the writer thread to make room.
+	DropOldest, //!< Discard the oldest queued message to make room.
+	DropNewest	//!< Discard the new message.
+};
+
+std::optional<LogOverflowPolicy> LogOverflowPolicyFromString(std::string_view name);
+
+std::string_view LogOverflowPolicyToString(LogOverflowPolicy policy);
+
+/**
+ *	@brief Passes log messages on to another sink on a dedicated writer thread.
+ *	@details Messages are copied into a bounded lock-free ring buffer that any number of threads can log into.
+ *	Only the writer thread uses the wrapped sink, so it doesn't need to be thread-safe.
+ */
+class AsyncLogSink final : public spdlog::sinks::sink
+{
+public:
+	struct Stats
+	{
+		std::uint64_t Queued = 0;	   //!< Messages waiting to be written right now.
+		std::uint64_t Enqueued = 0;	   //!< Messages added to the queue.
+		std::uint64_t Written = 0;	   //!< Messages written by the writer thread.
+		std::uint64_t Dropped = 0;	   //!< Messages discarded because the queue was full.
+		std::uint64_t RateLimited = 0; //!< Messages discarded because their logger was over its rate limit.
+		std::uint64_t Blocked = 0;	   //!< Messages that had to wait for room in the queue.
+	};
+
+	/**
+	 *	@param queueSize Maximum number of queued messages, rounded up to a power of 2.
+	 *	@param rateLimit Maximum number of messages per second per logger, or 0 for no limit.
+	 */
+	AsyncLogSink(std::shared_ptr<spdlog::sinks::sink> sink, std::size_t queueSize, LogOverflowPolicy overflowPolicy, int rateLimit);
+	~AsyncLogSink() override;
+
+	AsyncLogSink(const AsyncLogSink&) = delete;
+	AsyncLogSink& operator=(const AsyncLogSink&) = delete;
+
+	void log(const spdlog::details::log_msg& msg) override;
+
+	/**
+	 *	@brief Waits until every queued message has been written, then flushes the wrapped sink.
+	 */
+	void flush() override;
+
+	void set_pattern(const std::string& pattern) override;
+	void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) override;
+
+	Stats GetStats() const;
+
+	std::size_t GetQueueSize() const { return m_Mask + 1; }
+	LogOverflowPolicy GetOverflowPolicy() const { return m_OverflowPolicy; }
+	int GetRateLimit() const { return m_RateLimit; }
+
+private:
+	struct Cell
+	{
+		std::atomic<std::size_t> Sequence;
+		spdlog::details::log_msg_buffer Message;
+	};
+
+	struct RateBucket
+	{
+		double Tokens;
+		std::chrono::steady_clock::time_point LastRefill;
+	};
+
+	bool IsRateLimited(std::string_view loggerName);
+
+	bool TryEnqueue(const spdlog::details::log_msg& msg);
+
+	/**
+	 *	@param message If null the message is discarded.
+	 */
+	bool TryDequeue(spdlog::details::log_msg_buffer* message);
+
+	bool IsEmpty() const;
+
+	void WakeWriter();
+
+	void WriterThread();
+
+private:
+	const std::shared_ptr<spdlog::sinks::sink> m_Sink;
+	const LogOverflowPolicy m_OverflowPolicy;
+	const int m_RateLimit;
+
+	std::unique_ptr<Cell[]> m_Cells;
+	const std::size_t m_Mask;
+
+	alignas(64) std::atomic<std::size_t> m_EnqueuePosition{0};
+	alignas(64) std::atomic<std::size_t> m_DequeuePosition{0};
+
+	alignas(64) std::atomic<std::uint64_t> m_Enqueued{0};
+	std::atomic<std::uint64_t> m_Written{0};
+	std::atomic<std::uint64_t> m_Dropped{0};
+	std::atomic<std::uint64_t> m_RateLimited{0};
+	std::atomic<std::uint64_t> m_Blocked{0};
+
+	std::mutex m_RateMutex;
+	std::unordered_map<std::string, RateBucket, TransparentStringHash, TransparentEqual> m_RateBuckets;
+
+	// Held by the writer thread while it uses the wrapped sink.
+	std::mutex m_SinkMutex;
+
+	std::mutex m_WakeMutex;
+	std::condition_variable m_Wake;
+	std::atomic<bool> m_WriterWaiting{false};
+	std::atomic<bool> m_Stopping{false};
+
+	std::thread m_Writer;
+};
@@ -13,8 +13,12 @@
  *
  ****/
 
+#include <algorithm>
+#include <chrono>
 #include <string>
 #include <string_view>
+#include <utility>
+#include <vector>
 
 #include <fmt/format.h>
 
@@ -41,6 +45,37 @@ const char* CommandArgs::Argument(int index) const
 	return CMD_ARGV(index);
 }
 
+static double ToMilliseconds(std::chrono::steady_clock::duration time)
+{
+	return std::chrono::duration<double, std::milli>(time).count();
+}
+
+void PrintCommandStats(std::vector<std::pair<std::string_view, CommandStats*>>& commands)
+{
+	std::erase_if(commands, [](const auto& command)
+		{ return command.second->Invocations == 0; });
+
+	if (commands.empty())
+	{
+		Con_Printf("No commands executed since the last report\n");
+		return;
+	}
+
+	std::sort(commands.begin(), commands.end(), [](const auto& lhs, const auto& rhs)
+		{ return lhs.second->Time > rhs.second->Time; });
+
+	Con_Printf("%-32s %8s %10s %10s %10s\n", "command", "calls", "total ms", "avg ms", "max ms");
+
+	for (const auto& [name, stats] : commands)
+	{
+		Con_Printf("%-32.*s %8u %10.3f %10.3f %10.3f\n",
+			static_cast<int>(name.size()), name.data(), stats->Invocations,
+			ToMilliseconds(stats->Time), ToMilliseconds(stats->Time) / stats->Invocations, ToMilliseconds(stats->MaxTime));
+
+		*stats = {};
+	}
+}
+
 ConCommandSystem::ConCommandSystem() = default;
 ConCommandSystem::~ConCommandSystem() = default;
 
@@ -48,6 +83,9 @@ bool ConCommandSystem::Initialize()
 {
 	m_Logger = g_Logging.CreateLogger("cvar");
 
+	CreateCommand("command_stats", [this](const auto&)
+		{ PrintStats(); });
+
 	return true;
 }
 
@@ -58,6 +96,7 @@ void ConCommandSystem::PostInitialize()
 
 void ConCommandSystem::Shutdown()
 {
+	m_CommandLookup.Clear();
 	m_Commands.clear();
 	m_Cvars.clear();
 	g_Logging.RemoveLogger(m_Logger);
@@ -175,6 +214,16 @@ void ConCommandSystem::CreateCommand(std::string_view name, std::function<void(c
 
 	m_Commands.emplace(key, std::move(data));
 
+	std::vector<PerfectHashTable<CommandData*>::Entry> entries;
+	entries.reserve(m_Commands.size());
+
+	for (auto& [commandName, command] : m_Commands)
+	{
+		entries.emplace_back(commandName, &command);
+	}
+
+	m_CommandLookup.Rebuild(entries);
+
 	g_engfuncs.pfnAddServerCommand(key.data(), &ConCommandSystem::CommandCallbackWrapper);
 }
 
@@ -223,9 +272,13 @@ void ConCommandSystem::CommandCallback()
 {
 	const CommandArgs args{};
 
-	if (auto it = m_Commands.find(args.Argument(0)); it != m_Commands.end())
+	if (auto command = m_CommandLookup.Find(args.Argument(0)); command)
 	{
-		it->second.Callback(args);
+		const auto startTime = std::chrono::steady_clock::now();
+
+		command->Callback(args);
+
+		command->Stats.Add(std::chrono::steady_clock::now() - startTime);
 	}
 	else
 	{
@@ -256,3 +309,16 @@ const char* ConCommandSystem::TryGetCVarCommandLineValue(std::string_view name)
 
 	return next;
 }
+
+void ConCommandSystem::PrintStats()
+{
+	std::vector<std::pair<std::string_view, CommandStats*>> commands;
+	commands.reserve(m_Commands.size());
+
+	for (auto& [name, command] : m_Commands)
+	{
+		commands.emplace_back(name, &command.Stats);
+	}
+
+	PrintCommandStats(commands);
+}
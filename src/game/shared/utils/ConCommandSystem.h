@@ -15,6 +15,9 @@
 
 #pragma once
 
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
@@ -25,6 +28,7 @@
 #include <spdlog/logger.h>
 
 #include "GameSystem.h"
+#include "PerfectHashTable.h"
 
 struct cvar_t;
 
@@ -54,6 +58,28 @@ struct ChangeCallback
 	float OldValue;
 };
 
+/**
+ *	@brief Tracks how many times a command was executed and how long it took.
+ */
+struct CommandStats
+{
+	std::uint32_t Invocations = 0;
+	std::chrono::steady_clock::duration Time{};
+	std::chrono::steady_clock::duration MaxTime{};
+
+	void Add(std::chrono::steady_clock::duration time)
+	{
+		++Invocations;
+		Time += time;
+		MaxTime = std::max(MaxTime, time);
+	}
+};
+
+/**
+ *	@brief Prints the stats of the given commands that were executed, most expensive first, and resets them.
+ */
+void PrintCommandStats(std::vector<std::pair<std::string_view, CommandStats*>>& commands);
+
 enum class CommandLibraryPrefix
 {
 	No = 0,
@@ -83,6 +109,8 @@ private:
 		std::unique_ptr<char[]> Name;
 
 		std::function<void(const CommandArgs&)> Callback;
+
+		CommandStats Stats;
 	};
 
 	struct ChangeCallbackData
@@ -140,6 +168,8 @@ private:
 
 	const char* TryGetCVarCommandLineValue(std::string_view name) const;
 
+	void PrintStats();
+
 private:
 	std::shared_ptr<spdlog::logger> m_Logger;
 
@@ -147,6 +177,9 @@ private:
 
 	std::unordered_map<std::string_view, CommandData> m_Commands;
 
+	// Rebuilt whenever a command is added. Points to the commands stored above.
+	PerfectHashTable<CommandData*> m_CommandLookup;
+
 	std::vector<ChangeCallbackData> m_ChangeCallbacks;
 };
 
@@ -2,6 +2,7 @@
 
 #include "cbase.h"
 #include "GameSystem.h"
+#include "LoadProfiler.h"
 
 bool GameSystemRegistry::Contains(IGameSystem* system) const
 {
@@ -32,6 +33,8 @@ bool GameSystemRegistry::Initialize()
 {
 	for (auto system : m_GameSystems)
 	{
+		const ScopedLoadTimer timer{"GameSystem.Initialize", system->GetName()};
+
 		if (!system->Initialize())
 		{
 			Con_Printf("Could not initialize %s system\n", system->GetName());
@@ -41,3 +44,12 @@ bool GameSystemRegistry::Initialize()
 
 	return true;
 }
+
+void GameSystemRegistry::PostInitialize()
+{
+	for (auto system : m_GameSystems)
+	{
+		const ScopedLoadTimer timer{"GameSystem.PostInitialize", system->GetName()};
+		system->PostInitialize();
+	}
+}
@@ -58,6 +58,11 @@ struct GameSystemRegistry final
 	 */
 	bool Initialize();
 
+	/**
+	 *	@brief Calls IGameSystem::PostInitialize on all registered systems.
+	 */
+	void PostInitialize();
+
 private:
 	std::vector<IGameSystem*> m_GameSystems;
 };
@@ -13,6 +13,8 @@
  *
  ****/
 
+#include <algorithm>
+#include <future>
 #include <string_view>
 
 #include <fmt/format.h>
@@ -64,11 +66,14 @@ static json GetSchemaAsJson(const std::string& schema)
 	return g_JSON.ParseJSONSchema(schema).value_or(json{});
 }
 
+/**
+ *	@brief Collects validation errors so they can be logged on the main thread.
+ */
 class JSONValidatorErrorHandler : public basic_error_handler
 {
 public:
-	JSONValidatorErrorHandler(spdlog::logger& logger)
-		: m_Logger(logger)
+	JSONValidatorErrorHandler(std::vector<std::string>& errors)
+		: m_Errors(errors)
 	{
 	}
 
@@ -89,17 +94,18 @@ public:
 			return contents;
 		};
 
-		m_Logger.error("Error validating JSON \"{}\" with value \"{}\": {}",
-			formatContents(pointer.to_string()), formatContents(instance.dump()), message);
+		m_Errors.push_back(fmt::format("Error validating JSON \"{}\" with value \"{}\": {}",
+			formatContents(pointer.to_string()), formatContents(instance.dump()), message));
 	}
 
 private:
-	spdlog::logger& m_Logger;
+	std::vector<std::string>& m_Errors;
 };
 
 bool JSONSystem::Initialize()
 {
 	m_JsonSchemaValidation = g_ConCommands.CreateCVar("json_schema_validation", "0", FCVAR_PROTECTED);
+	m_JsonFileCache = g_ConCommands.CreateCVar("json_file_cache", "1", FCVAR_PROTECTED);
 
 	g_ConCommands.CreateCommand("json_listschemas", [this](const auto& args)
 		{ ListSchemas(args); });
@@ -120,9 +126,11 @@ void JSONSystem::PostInitialize()
 
 void JSONSystem::Shutdown()
 {
+	ClearFileCache();
 	m_Schemas.clear();
 	g_Logging.RemoveLogger(m_Logger);
 	m_Logger.reset();
+	m_JsonFileCache = nullptr;
 	m_JsonSchemaValidation = nullptr;
 }
 
@@ -140,6 +148,9 @@ void JSONSystem::RegisterSchema(std::string&& name, std::function<std::string()>
 	}
 
 	m_Schemas.push_back({std::move(name), std::move(getSchemaFunction)});
+
+	// Cached files refer to validators which may have moved.
+	ClearFileCache();
 }
 
 const json_validator* JSONSystem::GetValidator(std::string_view schemaName) const
@@ -209,66 +220,211 @@ std::optional<json> JSONSystem::LoadJSONFile(const char* fileName, const JSONLoa
 		return {};
 	}
 
-	auto validator = [&]() -> const json_validator*
+	const auto validator = GetValidatorForLoad(parameters);
+
+	m_Logger->trace("Loading JSON file \"{}\"", fileName);
+
+	auto contents = ReadFileContents(fileName, parameters.PathID);
+
+	if (!contents)
+	{
+		m_Logger->error("Couldn't open file \"{}\"", fileName);
+		return {};
+	}
+
+	if (auto cached = FindCachedFile(*contents, validator); cached)
 	{
-		// Only validate if enabled.
-		if (0 == m_JsonSchemaValidation->value)
+		m_Logger->trace("Using cached JSON file");
+
+		// The first load of a preloaded file isn't a cache hit, it was parsed for this load.
+		// Its errors were already logged by PreloadJSONFiles.
+		if (cached->Preloaded)
 		{
-			return nullptr;
+			cached->Preloaded = false;
 		}
+		else
+		{
+			cached->LastUse = CacheUse::Hit;
+			++cached->Hits;
+			cached->TimeSaved += cached->LoadTime;
 
-		if (parameters.Validator)
+			for (const auto& error : cached->Errors)
+			{
+				m_Logger->error("{}", error);
+			}
+		}
+
+		if (validator && !cached->PassedValidation)
 		{
-			assert(parameters.SchemaName.empty());
-			return parameters.Validator;
+			m_Logger->trace("JSON file failed validation");
 		}
 
-		return GetOrCreateValidator(parameters.SchemaName);
-	}();
+		return cached->Data;
+	}
 
-	m_Logger->trace("Loading JSON file \"{}\"", fileName);
+	auto result = ParseFileContents(*contents, validator);
 
-	if (const auto file = FileSystem_LoadFileIntoBuffer(fileName, FileContentFormat::Text, parameters.PathID); !file.empty())
+	for (const auto& error : result.Errors)
 	{
-		try
+		m_Logger->error("{}", error);
+	}
+
+	if (!result.Data)
+	{
+		return {};
+	}
+
+	m_Logger->trace("Successfully loaded JSON file");
+
+	if (validator)
+	{
+		if (result.PassedValidation)
 		{
-			auto text = reinterpret_cast<const char*>(file.data());
+			m_Logger->trace("JSON file passed validation");
+		}
+		else
+		{
+			m_Logger->trace("JSON file failed validation");
+		}
+	}
 
-			auto data = json::parse(text, text + file.size(), nullptr, true, true);
+	AddCachedFile(std::move(*contents), validator, result, CacheUse::Miss);
 
-			m_Logger->trace("Successfully loaded JSON file");
+	return std::move(result.Data);
+}
 
-			if (validator)
-			{
-				m_Logger->trace("Validating JSON file");
+void JSONSystem::PreloadJSONFiles(std::span<const JSONPreloadFile> files)
+{
+	if (!m_Logger || 0 == m_JsonFileCache->value)
+	{
+		return;
+	}
 
-				JSONValidatorErrorHandler errorHandler{*m_Logger};
+	struct PreloadJob
+	{
+		FileContents Contents;
+		const json_validator* Validator;
+		std::future<ParseResult> Result;
+	};
 
-				validator->validate(data, errorHandler);
+	std::vector<PreloadJob> jobs;
 
-				if (errorHandler)
-				{
-					m_Logger->trace("JSON file failed validation");
-				}
-				else
-				{
-					m_Logger->trace("JSON file passed validation");
-				}
-			}
+	jobs.reserve(files.size());
+
+	// Files are read and validators created on this thread since the engine's filesystem and the logger aren't thread-safe.
+	for (const auto& file : files)
+	{
+		const auto validator = GetValidatorForLoad({.SchemaName = file.SchemaName, .PathID = file.PathID});
 
-			return data;
+		auto contents = ReadFileContents(file.FileName.c_str(), file.PathID);
+
+		if (!contents || FindCachedFile(*contents, validator))
+		{
+			continue;
 		}
-		catch (const json::exception& e)
+
+		if (std::any_of(jobs.begin(), jobs.end(), [&](const auto& job)
+				{ return job.Contents.Key == contents->Key; }))
 		{
-			m_Logger->error("Error \"{}\" parsing JSON: \"{}\"", e.id, e.what());
+			continue;
 		}
+
+		jobs.push_back({.Contents = std::move(*contents), .Validator = validator});
 	}
-	else
+
+	if (jobs.empty())
 	{
-		m_Logger->error("Couldn't open file \"{}\"", fileName);
+		return;
+	}
+
+	m_Logger->trace("Preloading {} JSON files", jobs.size());
+
+	for (auto& job : jobs)
+	{
+		job.Result = std::async(std::launch::async, &JSONSystem::ParseFileContents, std::cref(job.Contents), job.Validator);
+	}
+
+	for (auto& job : jobs)
+	{
+		const auto result = job.Result.get();
+
+		for (const auto& error : result.Errors)
+		{
+			m_Logger->error("Error preloading \"{}\": {}", job.Contents.Key, error);
+		}
+
+		if (result.Data)
+		{
+			AddCachedFile(std::move(job.Contents), job.Validator, result, CacheUse::Preloaded);
+		}
+	}
+}
+
+void JSONSystem::LogFileCacheStatistics()
+{
+	if (!m_Logger || !m_Logger->should_log(spdlog::level::debug))
+	{
+		for (auto& [key, cached] : m_FileCache)
+		{
+			cached.LastUse = CacheUse::None;
+			cached.Hits = 0;
+			cached.TimeSaved = {};
+		}
+
+		return;
+	}
+
+	std::vector<std::pair<const std::string*, CachedFile*>> used;
+
+	for (auto& [key, cached] : m_FileCache)
+	{
+		if (cached.LastUse != CacheUse::None)
+		{
+			used.emplace_back(&key, &cached);
+		}
 	}
 
-	return {};
+	std::sort(used.begin(), used.end(), [](const auto& lhs, const auto& rhs)
+		{ return *lhs.first < *rhs.first; });
+
+	int hits = 0;
+	int misses = 0;
+	int preloaded = 0;
+	std::chrono::duration<double> timeSaved{};
+
+	for (auto [key, cached] : used)
+	{
+		const auto loadTimeMs = std::chrono::duration<double, std::milli>(cached->LoadTime).count();
+
+		switch (cached->LastUse)
+		{
+		case CacheUse::Hit:
+			m_Logger->debug("\"{}\": {} cache hits, {:.2f}ms saved",
+				*key, cached->Hits, std::chrono::duration<double, std::milli>(cached->TimeSaved).count());
+			hits += cached->Hits;
+			timeSaved += cached->TimeSaved;
+			break;
+
+		case CacheUse::Miss:
+			m_Logger->debug("\"{}\": loaded in {:.2f}ms", *key, loadTimeMs);
+			++misses;
+			break;
+
+		case CacheUse::Preloaded:
+			m_Logger->debug("\"{}\": preloaded in {:.2f}ms", *key, loadTimeMs);
+			++preloaded;
+			break;
+
+		default: break;
+		}
+
+		cached->LastUse = CacheUse::None;
+		cached->Hits = 0;
+		cached->TimeSaved = {};
+	}
+
+	m_Logger->debug("JSON file cache: {} hits, {} misses, {} preloaded, {:.2f}ms saved ({} files cached)",
+		hits, misses, preloaded, std::chrono::duration<double, std::milli>(timeSaved).count(), m_FileCache.size());
 }
 
 void JSONSystem::ListSchemas(const CommandArgs& args)
@@ -337,3 +493,123 @@ void JSONSystem::WriteSchemaToFile(std::string_view schemaName, const json& sche
 		Con_Printf("Wrote schema to \"%s\"\n", fileName.c_str());
 	}
 }
+
+const json_validator* JSONSystem::GetValidatorForLoad(const JSONLoadParameters& parameters)
+{
+	// Only validate if enabled.
+	if (0 == m_JsonSchemaValidation->value)
+	{
+		return nullptr;
+	}
+
+	if (parameters.Validator)
+	{
+		assert(parameters.SchemaName.empty());
+		return parameters.Validator;
+	}
+
+	return GetOrCreateValidator(parameters.SchemaName);
+}
+
+std::optional<JSONSystem::FileContents> JSONSystem::ReadFileContents(const char* fileName, const char* pathID)
+{
+	auto buffer = FileSystem_LoadFileIntoBuffer(fileName, FileContentFormat::Text, pathID);
+
+	if (buffer.empty())
+	{
+		return {};
+	}
+
+	FileContents contents;
+
+	contents.Key = fmt::format("{}:{}", pathID ? pathID : "", fileName);
+	contents.ModificationTime = g_pFileSystem->GetFileTime(fileName);
+	contents.Hash = std::hash<std::string_view>{}({reinterpret_cast<const char*>(buffer.data()), buffer.size()});
+	contents.Buffer = std::move(buffer);
+
+	return contents;
+}
+
+JSONSystem::CachedFile* JSONSystem::FindCachedFile(const FileContents& contents, const json_validator* validator)
+{
+	if (0 == m_JsonFileCache->value)
+	{
+		ClearFileCache();
+		return nullptr;
+	}
+
+	if (auto it = m_FileCache.find(contents.Key); it != m_FileCache.end())
+	{
+		auto& cached = it->second;
+
+		// Validation settings may have changed since the file was cached.
+		if (cached.Size == contents.Buffer.size() &&
+			cached.ModificationTime == contents.ModificationTime &&
+			cached.Hash == contents.Hash &&
+			cached.Validator == validator)
+		{
+			return &cached;
+		}
+	}
+
+	return nullptr;
+}
+
+void JSONSystem::AddCachedFile(FileContents&& contents, const json_validator* validator, const ParseResult& result, CacheUse use)
+{
+	if (0 == m_JsonFileCache->value || !result.Data)
+	{
+		return;
+	}
+
+	CachedFile cached{
+		.Size = contents.Buffer.size(),
+		.ModificationTime = contents.ModificationTime,
+		.Hash = contents.Hash,
+		.Validator = validator,
+		.PassedValidation = result.PassedValidation,
+		.Data = *result.Data,
+		.Errors = result.Errors,
+		.LoadTime = result.LoadTime,
+		.Preloaded = use == CacheUse::Preloaded,
+		.LastUse = use};
+
+	m_FileCache.insert_or_assign(std::move(contents.Key), std::move(cached));
+}
+
+JSONSystem::ParseResult JSONSystem::ParseFileContents(const FileContents& contents, const json_validator* validator)
+{
+	ParseResult result;
+
+	const auto start = std::chrono::steady_clock::now();
+
+	try
+	{
+		auto text = reinterpret_cast<const char*>(contents.Buffer.data());
+
+		result.Data = json::parse(text, text + contents.Buffer.size(), nullptr, true, true);
+
+		if (validator)
+		{
+			JSONValidatorErrorHandler errorHandler{result.Errors};
+
+			validator->validate(*result.Data, errorHandler);
+
+			result.PassedValidation = !errorHandler;
+		}
+	}
+	catch (const json::exception& e)
+	{
+		result.Data.reset();
+		result.Errors.push_back(fmt::format("Error \"{}\" parsing JSON: \"{}\"", e.id, e.what()));
+	}
+
+	result.LoadTime = std::chrono::steady_clock::now() - start;
+
+	return result;
+}
+
+void JSONSystem::ClearFileCache()
+{
+	m_FileCache.clear();
+}
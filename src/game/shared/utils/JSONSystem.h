@@ -15,11 +15,15 @@
 
 #pragma once
 
+#include <chrono>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <optional>
+#include <span>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 #include <vector>
 
 #include <spdlog/logger.h>
@@ -29,6 +33,7 @@
 #include "GameSystem.h"
 
 #include "filesystem_utils.h"
+#include "heterogeneous_lookup.h"
 #include "json_fwd.h"
 
 class CommandArgs;
@@ -53,6 +58,17 @@ struct JSONLoadParameters final
 	const char* PathID = nullptr;
 };
 
+/**
+ *	@brief A file to load ahead of time using JSONSystem::PreloadJSONFiles.
+ *	The parameters must match those used to load the file later on for the preloaded data to be used.
+ */
+struct JSONPreloadFile final
+{
+	std::string FileName;
+	std::string_view SchemaName;
+	const char* PathID = nullptr;
+};
+
 class JSONSystem final : public IGameSystem
 {
 private:
@@ -64,6 +80,57 @@ private:
 		std::optional<json_validator> Validator;
 	};
 
+	enum class CacheUse
+	{
+		None,
+		Miss,
+		Hit,
+		Preloaded
+	};
+
+	/**
+	 *	@brief Parsed and validated contents of a file, reused as long as the file doesn't change.
+	 */
+	struct CachedFile
+	{
+		std::size_t Size = 0;
+		long ModificationTime = 0;
+		std::uint64_t Hash = 0;
+		const json_validator* Validator = nullptr;
+		bool PassedValidation = true;
+		json Data;
+
+		// Logged again every time the cached file is used, except on the first load of a preloaded file.
+		std::vector<std::string> Errors;
+
+		// How long parsing and validating took when the file was loaded.
+		std::chrono::duration<double> LoadTime{};
+
+		// Parsed by PreloadJSONFiles and not loaded yet.
+		bool Preloaded = false;
+
+		// Statistics since the last call to LogFileCacheStatistics.
+		CacheUse LastUse = CacheUse::None;
+		int Hits = 0;
+		std::chrono::duration<double> TimeSaved{};
+	};
+
+	struct FileContents
+	{
+		std::string Key;
+		std::vector<std::byte> Buffer;
+		long ModificationTime = 0;
+		std::uint64_t Hash = 0;
+	};
+
+	struct ParseResult
+	{
+		std::optional<json> Data;
+		bool PassedValidation = true;
+		std::vector<std::string> Errors;
+		std::chrono::duration<double> LoadTime{};
+	};
+
 public:
 	JSONSystem() = default;
 	~JSONSystem() = default;
@@ -107,6 +174,18 @@ public:
 	 */
 	std::optional<json> LoadJSONFile(const char* fileName, const JSONLoadParameters& parameters = {});
 
+	/**
+	 *	@brief Parses and validates files that aren't cached yet on worker threads
+	 *	so subsequent calls to LoadJSONFile for these files use the cached result.
+	 *	Only use this for files that don't depend on each other.
+	 */
+	void PreloadJSONFiles(std::span<const JSONPreloadFile> files);
+
+	/**
+	 *	@brief Logs which files were loaded from the cache since the last call and how much time was saved.
+	 */
+	void LogFileCacheStatistics();
+
 	/**
 	 *	@brief Helper function to parse JSON.
 	 *	Pass in a callable object that will parse JSON into a movable or copyable object.
@@ -139,11 +218,32 @@ private:
 
 	void WriteSchemaToFile(std::string_view schemaName, const json& schema);
 
+	const json_validator* GetValidatorForLoad(const JSONLoadParameters& parameters);
+
+	std::optional<FileContents> ReadFileContents(const char* fileName, const char* pathID);
+
+	/**
+	 *	@brief Gets the cached file if it's enabled and the file hasn't changed since it was cached.
+	 */
+	CachedFile* FindCachedFile(const FileContents& contents, const json_validator* validator);
+
+	void AddCachedFile(FileContents&& contents, const json_validator* validator, const ParseResult& result, CacheUse use);
+
+	/**
+	 *	@brief Parses and validates a file. Does not log or use the engine so it can be used on worker threads.
+	 */
+	static ParseResult ParseFileContents(const FileContents& contents, const json_validator* validator);
+
+	void ClearFileCache();
+
 private:
 	cvar_t* m_JsonSchemaValidation = nullptr;
+	cvar_t* m_JsonFileCache = nullptr;
 	std::shared_ptr<spdlog::logger> m_Logger;
 
 	std::vector<SchemaData> m_Schemas;
+
+	std::unordered_map<std::string, CachedFile, TransparentStringHash, TransparentEqual> m_FileCache;
 };
 
 template <typename Callable>
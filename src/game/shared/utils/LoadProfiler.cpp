@@ -0,0 +1,177 @@
+/***
+ *
+ *	Copyright (c) 1996-2001, Valve LLC. All rights reserved.
+ *
+ *	This product contains software technology licensed from Id
+ *	Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *	All Rights Reserved.
+ *
+ *   Use, distribution, and modification of this source code and/or resulting
+ *   object code is restricted to non-commercial enhancements to products from
+ *   Valve LLC.  All other use, distribution, or modification is prohibited
+ *   without written permission from Valve LLC.
+ *
+ ****/
+
+#include <algorithm>
+
+#include <nlohmann/json.hpp>
+
+#include "cbase.h"
+#include "LoadProfiler.h"
+
+static double ToMilliseconds(std::chrono::duration<double> time)
+{
+	return std::chrono::duration<double, std::milli>(time).count();
+}
+
+void LoadProfiler::Begin(std::string_view name)
+{
+	m_Name = name;
+	m_Active = true;
+	m_StartTime = Clock::now();
+	m_TotalTime = {};
+	m_Loaded = false;
+	m_CurrentEntity = {};
+	m_Phases.clear();
+}
+
+void LoadProfiler::MarkLoaded()
+{
+	if (!m_Active || m_Loaded)
+	{
+		return;
+	}
+
+	m_Loaded = true;
+	m_TotalTime = Clock::now() - m_StartTime;
+}
+
+void LoadProfiler::End()
+{
+	if (!m_Active)
+	{
+		return;
+	}
+
+	MarkLoaded();
+
+	m_Active = false;
+	m_CurrentEntity = {};
+}
+
+void LoadProfiler::Add(std::string_view phase, std::string_view name, Clock::duration time)
+{
+	if (!m_Active)
+	{
+		return;
+	}
+
+	auto it = std::find_if(m_Phases.begin(), m_Phases.end(), [&](const auto& candidate)
+		{ return candidate.Name == phase; });
+
+	if (it == m_Phases.end())
+	{
+		it = m_Phases.insert(m_Phases.end(), Phase{.Name = std::string{phase}});
+	}
+
+	if (name.empty())
+	{
+		name = "(none)";
+	}
+
+	auto timing = it->Timings.find(name);
+
+	if (timing == it->Timings.end())
+	{
+		timing = it->Timings.emplace(std::string{name}, Timing{}).first;
+	}
+
+	timing->second.Time += time;
+	++timing->second.Count;
+}
+
+void LoadProfiler::PrintTable(std::size_t maxEntriesPerPhase) const
+{
+	Con_Printf("Load profile \"%s\": %.2f ms total\n", m_Name.c_str(), ToMilliseconds(m_TotalTime));
+
+	std::vector<std::pair<const std::string*, const Timing*>> timings;
+
+	for (const auto& phase : m_Phases)
+	{
+		timings.clear();
+
+		std::chrono::duration<double> phaseTime{};
+
+		for (const auto& [name, timing] : phase.Timings)
+		{
+			timings.emplace_back(&name, &timing);
+			phaseTime += timing.Time;
+		}
+
+		std::sort(timings.begin(), timings.end(), [](const auto& lhs, const auto& rhs)
+			{ return lhs.second->Time > rhs.second->Time; });
+
+		Con_Printf("\n%-32s %10.2f ms (%zu entries)\n", phase.Name.c_str(), ToMilliseconds(phaseTime), timings.size());
+		Con_Printf("  %-40s %8s %12s %12s\n", "Name", "Count", "Total (ms)", "Avg (ms)");
+
+		const std::size_t count = std::min(timings.size(), maxEntriesPerPhase);
+
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			const auto& [name, timing] = timings[i];
+
+			Con_Printf("  %-40s %8d %12.3f %12.3f\n",
+				name->c_str(), timing->Count, ToMilliseconds(timing->Time), ToMilliseconds(timing->Time) / timing->Count);
+		}
+
+		if (count < timings.size())
+		{
+			Con_Printf("  ... %zu more\n", timings.size() - count);
+		}
+	}
+}
+
+json LoadProfiler::ToJSON() const
+{
+	auto phases = json::array();
+
+	for (const auto& phase : m_Phases)
+	{
+		std::vector<std::pair<const std::string*, const Timing*>> timings;
+
+		timings.reserve(phase.Timings.size());
+
+		std::chrono::duration<double> phaseTime{};
+
+		for (const auto& [name, timing] : phase.Timings)
+		{
+			timings.emplace_back(&name, &timing);
+			phaseTime += timing.Time;
+		}
+
+		std::sort(timings.begin(), timings.end(), [](const auto& lhs, const auto& rhs)
+			{ return *lhs.first < *rhs.first; });
+
+		auto entries = json::array();
+
+		for (const auto& [name, timing] : timings)
+		{
+			entries.push_back({{"Name", *name}, {"Count", timing->Count}, {"TimeMs", ToMilliseconds(timing->Time)}});
+		}
+
+		phases.push_back({{"Name", phase.Name}, {"TimeMs", ToMilliseconds(phaseTime)}, {"Entries", std::move(entries)}});
+	}
+
+	return {{"Name", m_Name}, {"TotalTimeMs", ToMilliseconds(m_TotalTime)}, {"Phases", std::move(phases)}};
+}
+
+bool LoadProfiler::WriteToFile(const std::string& fileName) const
+{
+	if (const auto separator = fileName.find_last_of('/'); separator != std::string::npos)
+	{
+		g_pFileSystem->CreateDirHierarchy(fileName.substr(0, separator).c_str(), "GAMECONFIG");
+	}
+
+	return FileSystem_WriteTextToFile(fileName.c_str(), ToJSON().dump(1, '\t').c_str(), "GAMECONFIG");
+}
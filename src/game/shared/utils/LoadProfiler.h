@@ -0,0 +1,175 @@
+/***
+ *
+ *	Copyright (c) 1996-2001, Valve LLC. All rights reserved.
+ *
+ *	This product contains software technology licensed from Id
+ *	Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *	All Rights Reserved.
+ *
+ *   Use, distribution, and modification of this source code and/or resulting
+ *   object code is restricted to non-commercial enhancements to products from
+ *   Valve LLC.  All other use, distribution, or modification is prohibited
+ *   without written permission from Valve LLC.
+ *
+ ****/
+
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "heterogeneous_lookup.h"
+#include "json_fwd.h"
+
+/**
+ *	@brief Records how long each phase of loading the game or a map takes.
+ *	@details Timings are grouped by phase (e.g. @c Spawn) and by name within a phase (e.g. the entity classname).
+ *	Nothing is recorded unless a profile is active, so the timers are cheap to leave in place.
+ */
+class LoadProfiler final
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	struct Timing
+	{
+		std::chrono::duration<double> Time{};
+		int Count = 0;
+	};
+
+	struct Phase
+	{
+		std::string Name;
+		std::unordered_map<std::string, Timing, TransparentStringHash, TransparentEqual> Timings;
+	};
+
+	bool IsActive() const { return m_Active; }
+
+	const std::string& GetName() const { return m_Name; }
+
+	/**
+	 *	@brief Starts a new profile, discarding the results of the previous one.
+	 */
+	void Begin(std::string_view name);
+
+	/**
+	 *	@brief Marks the end of the load itself. Work done after this, like building node graphs,
+	 *	is still recorded but not counted in the total time.
+	 */
+	void MarkLoaded();
+
+	/**
+	 *	@brief Stops recording. The results remain available until the next profile begins.
+	 */
+	void End();
+
+	void Add(std::string_view phase, std::string_view name, Clock::duration time);
+
+	/**
+	 *	@brief Gets the name of the entity that is currently spawning, used to group precaches.
+	 */
+	std::string_view GetCurrentEntity() const { return m_CurrentEntity; }
+
+	std::chrono::duration<double> GetTotalTime() const { return m_TotalTime; }
+
+	/**
+	 *	@brief Prints the slowest entries of each phase to the console.
+	 */
+	void PrintTable(std::size_t maxEntriesPerPhase) const;
+
+	/**
+	 *	@brief Gets the results as JSON. Entries are sorted by name so results from different builds can be diffed.
+	 */
+	json ToJSON() const;
+
+	/**
+	 *	@brief Writes the results to a file in the @c GAMECONFIG path.
+	 */
+	bool WriteToFile(const std::string& fileName) const;
+
+private:
+	friend class ScopedEntitySpawnTimer;
+
+	std::string m_Name;
+	bool m_Active = false;
+	Clock::time_point m_StartTime;
+	std::chrono::duration<double> m_TotalTime{};
+	bool m_Loaded = false;
+
+	std::string_view m_CurrentEntity;
+
+	// In the order in which phases were first recorded.
+	std::vector<Phase> m_Phases;
+};
+
+inline LoadProfiler g_LoadProfiler;
+
+constexpr std::string_view LoadProfileDirectory{"profiles/load"};
+
+// Maximum number of entries per phase to print to the console.
+constexpr std::size_t LoadProfileConsoleEntries = 15;
+
+/**
+ *	@brief Adds the time between construction and destruction to the active profile, if any.
+ *	@details The phase and name must outlive this object.
+ */
+class ScopedLoadTimer final
+{
+public:
+	explicit ScopedLoadTimer(std::string_view phase, std::string_view name = {})
+		: m_Phase(phase),
+		  m_Name(name),
+		  m_Active(g_LoadProfiler.IsActive())
+	{
+		if (m_Active)
+		{
+			m_Start = LoadProfiler::Clock::now();
+		}
+	}
+
+	~ScopedLoadTimer()
+	{
+		if (m_Active)
+		{
+			g_LoadProfiler.Add(m_Phase, m_Name, LoadProfiler::Clock::now() - m_Start);
+		}
+	}
+
+	ScopedLoadTimer(const ScopedLoadTimer&) = delete;
+	ScopedLoadTimer& operator=(const ScopedLoadTimer&) = delete;
+
+private:
+	const std::string_view m_Phase;
+	const std::string_view m_Name;
+	const bool m_Active;
+	LoadProfiler::Clock::time_point m_Start;
+};
+
+/**
+ *	@brief Times an entity's spawn and attributes precaches made while it spawns to its classname.
+ */
+class ScopedEntitySpawnTimer final
+{
+public:
+	explicit ScopedEntitySpawnTimer(std::string_view className)
+		: m_PreviousEntity(g_LoadProfiler.m_CurrentEntity),
+		  m_Timer("Spawn", className)
+	{
+		g_LoadProfiler.m_CurrentEntity = className;
+	}
+
+	~ScopedEntitySpawnTimer()
+	{
+		g_LoadProfiler.m_CurrentEntity = m_PreviousEntity;
+	}
+
+	ScopedEntitySpawnTimer(const ScopedEntitySpawnTimer&) = delete;
+	ScopedEntitySpawnTimer& operator=(const ScopedEntitySpawnTimer&) = delete;
+
+private:
+	const std::string_view m_PreviousEntity;
+	const ScopedLoadTimer m_Timer;
+};
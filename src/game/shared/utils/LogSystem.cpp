@@ -142,6 +142,21 @@ static std::string GetLoggingConfigSchema()
 				"MaxFiles": {{
 					"type": "integer",
 					"pattern": "^\\d+$"
+				}},
+				"Async": {{
+					"type": "boolean"
+				}},
+				"QueueSize": {{
+					"type": "integer",
+					"minimum": 2
+				}},
+				"OverflowPolicy": {{
+					"type": "string",
+					"enum": ["block", "drop_oldest", "drop_newest"]
+				}},
+				"RateLimit": {{
+					"type": "integer",
+					"minimum": 0
 				}}
 			}},
 			"required": [
@@ -185,6 +200,7 @@ void LogSystem::PreInitialize()
 	m_Settings.Defaults.Level = startupLogLevel;
 
 	m_Settings.LogFile.Enabled = COM_HasParam("-log_file_on");
+	m_Settings.LogFile.Async = COM_HasParam("-log_file_async");
 
 	m_Logger = CreateLogger("logging");
 
@@ -203,6 +219,8 @@ bool LogSystem::Initialize()
 		{ SetAllLogLevels(args); });
 	g_ConCommands.CreateCommand("log_file", [this](const auto& args)
 		{ FileCommand(args); });
+	g_ConCommands.CreateCommand("log_stats", [this](const auto&)
+		{ PrintStats(); });
 
 	g_JSON.RegisterSchema(LoggingConfigSchemaName, &GetLoggingConfigSchema);
 
@@ -379,6 +397,52 @@ LogSystem::Settings LogSystem::LoadSettings(const json& input)
 		{
 			settings.LogFile.MaxFiles = DefaultMaxFiles;
 		}
+
+		if (auto async = logFile->find("Async"); async != logFile->end() && async->is_boolean())
+		{
+			settings.LogFile.Async = async->get<bool>();
+		}
+		else
+		{
+			// Leave setting as-is, in case it was enabled through command line.
+		}
+
+		if (auto queueSize = logFile->find("QueueSize"); queueSize != logFile->end() && queueSize->is_number_integer())
+		{
+			settings.LogFile.QueueSize = static_cast<std::size_t>(std::clamp(queueSize->get<std::int64_t>(), std::int64_t{2}, std::int64_t{MaxQueueSize}));
+		}
+		else
+		{
+			settings.LogFile.QueueSize = DefaultQueueSize;
+		}
+
+		if (auto overflowPolicy = logFile->find("OverflowPolicy"); overflowPolicy != logFile->end() && overflowPolicy->is_string())
+		{
+			const auto name = overflowPolicy->get<std::string>();
+
+			if (auto policy = LogOverflowPolicyFromString(name); policy)
+			{
+				settings.LogFile.OverflowPolicy = *policy;
+			}
+			else
+			{
+				m_Logger->error("Unknown log file overflow policy \"{}\", using \"block\"", name);
+				settings.LogFile.OverflowPolicy = LogOverflowPolicy::Block;
+			}
+		}
+		else
+		{
+			settings.LogFile.OverflowPolicy = LogOverflowPolicy::Block;
+		}
+
+		if (auto rateLimit = logFile->find("RateLimit"); rateLimit != logFile->end() && rateLimit->is_number_integer())
+		{
+			settings.LogFile.RateLimit = std::max(0, rateLimit->get<int>());
+		}
+		else
+		{
+			settings.LogFile.RateLimit = 0;
+		}
 	}
 
 	return settings;
@@ -411,12 +475,21 @@ void LogSystem::SetFileLoggingEnabled(bool enable)
 
 		m_FileSink = std::make_shared<spdlog::sinks::daily_file_sink_st>(baseFileName, 0, 0, false, m_Settings.LogFile.MaxFiles);
 
-		m_Sinks.push_back(m_FileSink);
+		// The console sink stays synchronous since it has to print on the game thread.
+		if (m_Settings.LogFile.Async)
+		{
+			m_AsyncFileSink = std::make_shared<AsyncLogSink>(m_FileSink,
+				m_Settings.LogFile.QueueSize, m_Settings.LogFile.OverflowPolicy, m_Settings.LogFile.RateLimit);
+		}
+
+		const auto fileSink = GetInstalledFileSink();
+
+		m_Sinks.push_back(fileSink);
 
 		const auto fileName = m_FileSink->filename();
 
-		spdlog::apply_all([this](std::shared_ptr<spdlog::logger> logger)
-			{ logger->sinks().push_back(m_FileSink); });
+		spdlog::apply_all([&](std::shared_ptr<spdlog::logger> logger)
+			{ logger->sinks().push_back(fileSink); });
 
 		Con_Printf("Logging data to file %s\n", fileName.c_str());
 
@@ -428,20 +501,34 @@ void LogSystem::SetFileLoggingEnabled(bool enable)
 
 		Con_Printf("Logging disabled\n");
 
+		const auto fileSink = GetInstalledFileSink();
+
 		// Flush any pending data before removing the sink to avoid race conditions.
-		m_FileSink->flush();
+		fileSink->flush();
 
-		m_Sinks.erase(std::find(m_Sinks.begin(), m_Sinks.end(), m_FileSink));
+		m_Sinks.erase(std::find(m_Sinks.begin(), m_Sinks.end(), fileSink));
 
-		spdlog::apply_all([this](std::shared_ptr<spdlog::logger> logger)
+		spdlog::apply_all([&](std::shared_ptr<spdlog::logger> logger)
 			{
 				auto& sinks = logger->sinks();
-				sinks.erase(std::find(sinks.begin(), sinks.end(), m_FileSink)); });
+				sinks.erase(std::find(sinks.begin(), sinks.end(), fileSink)); });
 
+		// Stops the writer thread before the file is closed.
+		m_AsyncFileSink.reset();
 		m_FileSink.reset();
 	}
 }
 
+std::shared_ptr<spdlog::sinks::sink> LogSystem::GetInstalledFileSink() const
+{
+	if (m_AsyncFileSink)
+	{
+		return m_AsyncFileSink;
+	}
+
+	return m_FileSink;
+}
+
 void LogSystem::ListLogLevels()
 {
 	for (auto level : SPDLOG_LEVEL_NAMES)
@@ -546,3 +633,30 @@ void LogSystem::FileCommand(const CommandArgs& args)
 		}
 	}
 }
+
+void LogSystem::PrintStats()
+{
+	if (!m_FileSink)
+	{
+		Con_Printf("Not currently logging to file\n");
+		return;
+	}
+
+	if (!m_AsyncFileSink)
+	{
+		Con_Printf("File logging is synchronous\n");
+		return;
+	}
+
+	const auto stats = m_AsyncFileSink->GetStats();
+
+	Con_Printf("Overflow policy: %s\n", LogOverflowPolicyToString(m_AsyncFileSink->GetOverflowPolicy()).data());
+	Con_Printf("Queue size: %zu\n", m_AsyncFileSink->GetQueueSize());
+	Con_Printf("Rate limit: %d messages per second per logger\n", m_AsyncFileSink->GetRateLimit());
+	Con_Printf("Queued: %llu\n", static_cast<unsigned long long>(stats.Queued));
+	Con_Printf("Enqueued: %llu\n", static_cast<unsigned long long>(stats.Enqueued));
+	Con_Printf("Written: %llu\n", static_cast<unsigned long long>(stats.Written));
+	Con_Printf("Blocked: %llu\n", static_cast<unsigned long long>(stats.Blocked));
+	Con_Printf("Dropped: %llu\n", static_cast<unsigned long long>(stats.Dropped));
+	Con_Printf("Rate limited: %llu\n", static_cast<unsigned long long>(stats.RateLimited));
+}
@@ -24,6 +24,7 @@
 #include <spdlog/logger.h>
 #include <spdlog/sinks/daily_file_sink.h>
 
+#include "AsyncLogSink.h"
 #include "GameSystem.h"
 #include "json_fwd.h"
 
@@ -36,6 +37,8 @@ private:
 	static const inline std::string DefaultBaseFileName{"L"};
 	static constexpr std::size_t MaxBaseFileNameLength{16};
 	static constexpr std::uint16_t DefaultMaxFiles{8}; // Have a finite limit for files by default.
+	static constexpr std::size_t DefaultQueueSize{8192};
+	static constexpr std::size_t MaxQueueSize{1 << 20};
 
 	struct LoggerConfigurationSettings
 	{
@@ -53,6 +56,12 @@ private:
 		bool Enabled = false;
 		std::optional<std::string> BaseFileName;
 		std::uint16_t MaxFiles = DefaultMaxFiles;
+
+		// Write to the file on a separate thread.
+		bool Async = false;
+		std::size_t QueueSize = DefaultQueueSize;
+		LogOverflowPolicy OverflowPolicy = LogOverflowPolicy::Block;
+		int RateLimit = 0;
 	};
 
 	struct Settings
@@ -89,6 +98,11 @@ private:
 
 	void SetFileLoggingEnabled(bool enable);
 
+	/**
+	 *	@brief Gets the sink that loggers write file output to, which is either the file sink or the async sink wrapping it.
+	 */
+	std::shared_ptr<spdlog::sinks::sink> GetInstalledFileSink() const;
+
 	void ListLogLevels();
 
 	void ListLoggers();
@@ -99,11 +113,16 @@ private:
 
 	void FileCommand(const CommandArgs& args);
 
+	void PrintStats();
+
 private:
 	std::vector<std::shared_ptr<spdlog::sinks::sink>> m_Sinks;
 
 	std::shared_ptr<spdlog::sinks::daily_file_sink_st> m_FileSink;
 
+	// Only used from the async sink's writer thread if set.
+	std::shared_ptr<AsyncLogSink> m_AsyncFileSink;
+
 	std::shared_ptr<spdlog::logger> m_Logger;
 
 	Settings m_Settings;
@@ -0,0 +1,212 @@
+/***
+ *
+ *	Copyright (c) 1996-2002, Valve LLC. All rights reserved.
+ *
+ *	This product contains software technology licensed from Id
+ *	Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *	All Rights Reserved.
+ *
+ *   Use, distribution, and modification of this source code and/or resulting
+ *   object code is restricted to non-commercial enhancements to products from
+ *   Valve LLC.  All other use, distribution, or modification is prohibited
+ *   without written permission from Valve LLC.
+ *
+ ****/
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ *	@brief Maps a set of string keys to values using a perfect hash, so every lookup compares against at most one key.
+ *	@details Uses hash and displace: keys are grouped into buckets by a first hash,
+ *	and each bucket stores the seed of a second hash that places all of its keys in unused slots.
+ *	The table has to be rebuilt whenever the set of keys changes, so it is meant for sets that rarely change.
+ *	Keys are not copied and must remain valid until the table is rebuilt or cleared.
+ */
+template <typename T>
+class PerfectHashTable final
+{
+public:
+	using Entry = std::pair<std::string_view, T>;
+
+	void Clear()
+	{
+		m_Mask = 0;
+		m_Displacements.clear();
+		m_Entries.clear();
+	}
+
+	/**
+	 *	@brief Rebuilds the table from the given entries. Keys must be unique.
+	 */
+	void Rebuild(const std::vector<Entry>& entries)
+	{
+		Clear();
+
+		if (entries.empty())
+		{
+			return;
+		}
+
+		for (std::size_t size = std::bit_ceil(entries.size());; size *= 2)
+		{
+			if (TryBuild(entries, size))
+			{
+				return;
+			}
+		}
+	}
+
+	/**
+	 *	@brief Finds the value associated with @p key.
+	 *	@return The value, or a value-initialized @c T if the key is not in the table.
+	 */
+	T Find(std::string_view key) const
+	{
+		if (m_Entries.empty())
+		{
+			return {};
+		}
+
+		const std::uint32_t displacement = m_Displacements[Hash(key, 0) & m_Mask];
+
+		const std::uint32_t slot = (displacement & DirectSlotFlag) != 0
+									   ? displacement & ~DirectSlotFlag
+									   : Hash(key, displacement) & m_Mask;
+
+		const auto& entry = m_Entries[slot];
+
+		return entry.first == key ? entry.second : T{};
+	}
+
+private:
+	// Buckets containing a single key store its slot directly to avoid the second hash.
+	static constexpr std::uint32_t DirectSlotFlag = 1U << 31;
+
+	static constexpr std::uint32_t MaxDisplacement = 1U << 16;
+
+	static std::uint32_t Hash(std::string_view key, std::uint32_t seed)
+	{
+		// FNV-1a followed by the MurmurHash3 finalizer so the low bits depend on the whole seed.
+		std::uint32_t hash = 2166136261U ^ (seed * 0x9E3779B9U);
+
+		for (const char c : key)
+		{
+			hash ^= static_cast<unsigned char>(c);
+			hash *= 16777619U;
+		}
+
+		hash ^= hash >> 16;
+		hash *= 0x85EBCA6BU;
+		hash ^= hash >> 13;
+		hash *= 0xC2B2AE35U;
+		hash ^= hash >> 16;
+
+		return hash;
+	}
+
+	bool TryBuild(const std::vector<Entry>& entries, std::size_t size)
+	{
+		const auto mask = static_cast<std::uint32_t>(size - 1);
+
+		std::vector<std::vector<std::uint32_t>> buckets(size);
+
+		for (std::uint32_t i = 0; i < entries.size(); ++i)
+		{
+			buckets[Hash(entries[i].first, 0) & mask].push_back(i);
+		}
+
+		std::vector<std::uint32_t> order(size);
+
+		for (std::uint32_t i = 0; i < size; ++i)
+		{
+			order[i] = i;
+		}
+
+		// Place the largest buckets first while there are still plenty of free slots.
+		std::stable_sort(order.begin(), order.end(), [&](auto lhs, auto rhs)
+			{ return buckets[lhs].size() > buckets[rhs].size(); });
+
+		std::vector<std::uint32_t> displacements(size, 0);
+		std::vector<Entry> slots(size);
+		std::vector<bool> used(size, false);
+		std::vector<std::uint32_t> candidates;
+
+		std::size_t index = 0;
+
+		for (; index < order.size() && buckets[order[index]].size() > 1; ++index)
+		{
+			const auto& bucket = buckets[order[index]];
+
+			std::uint32_t displacement = 1;
+
+			for (; displacement < MaxDisplacement; ++displacement)
+			{
+				candidates.clear();
+
+				for (const auto i : bucket)
+				{
+					const std::uint32_t slot = Hash(entries[i].first, displacement) & mask;
+
+					if (used[slot] || std::find(candidates.begin(), candidates.end(), slot) != candidates.end())
+					{
+						break;
+					}
+
+					candidates.push_back(slot);
+				}
+
+				if (candidates.size() == bucket.size())
+				{
+					break;
+				}
+			}
+
+			if (displacement == MaxDisplacement)
+			{
+				return false;
+			}
+
+			displacements[order[index]] = displacement;
+
+			for (std::size_t i = 0; i < bucket.size(); ++i)
+			{
+				used[candidates[i]] = true;
+				slots[candidates[i]] = entries[bucket[i]];
+			}
+		}
+
+		std::uint32_t freeSlot = 0;
+
+		for (; index < order.size() && buckets[order[index]].size() == 1; ++index)
+		{
+			while (used[freeSlot])
+			{
+				++freeSlot;
+			}
+
+			const auto i = buckets[order[index]][0];
+
+			displacements[order[index]] = DirectSlotFlag | freeSlot;
+			used[freeSlot] = true;
+			slots[freeSlot] = entries[i];
+		}
+
+		m_Mask = mask;
+		m_Displacements = std::move(displacements);
+		m_Entries = std::move(slots);
+
+		return true;
+	}
+
+private:
+	std::uint32_t m_Mask = 0;
+	std::vector<std::uint32_t> m_Displacements;
+	std::vector<Entry> m_Entries;
+};
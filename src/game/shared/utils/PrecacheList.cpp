@@ -17,6 +17,7 @@
 
 #include "cbase.h"
 
+#include "LoadProfiler.h"
 #include "PrecacheList.h"
 
 int PrecacheList::IndexOf(const char* str) const
@@ -52,6 +53,9 @@ int PrecacheList::Add(const char* str)
 		return index;
 	}
 
+	// Group by the entity that is spawning so expensive assets can be traced back to the entities using them.
+	const ScopedLoadTimer timer{m_ProfilePhase, g_LoadProfiler.GetCurrentEntity()};
+
 	const int index = static_cast<int>(m_Precaches.size());
 
 	m_Precaches.push_back(str);
@@ -16,6 +16,7 @@
 #pragma once
 
 #include <cassert>
+#include <string>
 #include <memory>
 #include <string_view>
 #include <vector>
@@ -34,6 +35,7 @@ public:
 		EnginePrecacheFunction enginePrecacheFunction = nullptr,
 		unsigned int maxEnginePrecaches = 0)
 		: m_Type(type),
+		  m_ProfilePhase("Precache." + std::string{type}),
 		  m_Logger(logger),
 		  m_ValidationFunction(validationFunction),
 		  m_EnginePrecacheFunction(enginePrecacheFunction),
@@ -70,6 +72,7 @@ private:
 
 private:
 	const std::string_view m_Type;
+	const std::string m_ProfilePhase;
 	const std::shared_ptr<spdlog::logger> m_Logger;
 	const ValidationFunction m_ValidationFunction;
 	const EnginePrecacheFunction m_EnginePrecacheFunction;
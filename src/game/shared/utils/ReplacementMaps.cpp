@@ -23,8 +23,6 @@
 
 using namespace std::literals;
 
-constexpr std::string_view ReplacementMapSchemaName{"ReplacementMap"sv};
-
 static std::string GetReplacementMapSchema()
 {
 	return fmt::format(R"(
@@ -18,6 +18,7 @@
 #include <memory>
 #include <span>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 
 #include <spdlog/logger.h>
@@ -26,6 +27,8 @@
 #include "utils/heterogeneous_lookup.h"
 #include "utils/JSONSystem.h"
 
+constexpr std::string_view ReplacementMapSchemaName{"ReplacementMap"};
+
 using Replacements = std::unordered_map<std::string, std::string, TransparentStringHash, TransparentEqual>;
 
 /**
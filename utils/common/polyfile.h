@@ -0,0 +1,46 @@
+/***
+ *
+ *	Copyright (c) 1996-2002, Valve LLC. All rights reserved.
+ *
+ *	This product contains software technology licensed from Id
+ *	Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *	All Rights Reserved.
+ *
+ ****/
+
+// polyfile.h
+
+#pragma once
+
+/*
+===================================================================
+
+BINARY HULL FILES
+
+qcsg writes the faces of each hull to a .p0 - .p3 file for qbsp2.
+The binary form starts with a polyfileheader_t, followed by one
+polyfileface_t per face, each followed by numpoints points of three
+doubles, so the points qbsp2 reads are bit for bit the ones qcsg
+computed. A face with all fields set to -1 ends a model.
+
+Files without the header are read as the older text format.
+
+===================================================================
+*/
+
+#define POLYFILE_IDENT (('F' << 24) + ('P' << 16) + ('S' << 8) + 'Q')
+#define POLYFILE_VERSION 1
+
+typedef struct
+{
+	int ident;
+	int version;
+} polyfileheader_t;
+
+typedef struct
+{
+	int planenum;
+	int texinfo;
+	int contents;
+	int numpoints;
+} polyfileface_t;
@@ -8,103 +8,88 @@
  *
  ****/
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
 #include "cmdlib.h"
 #define NO_THREAD_NAMES
 #include "threads.h"
 
-#define MAX_THREADS 64
+/*
+===================================================================
 
-int dispatch;
-int workcount;
-int oldf;
-qboolean pacifier;
+Work is handed out from a set of per-thread ranges. Each thread starts with
+an equal contiguous slice of [0, workcount) and takes chunks from the front
+of its own slice without touching any shared lock. When a thread runs out it
+steals the back half of the largest remaining slice of another thread.
 
-qboolean threaded;
+Chunk size adapts to the amount of work left (guided scheduling) so that
+large jobs pay for very few refills while the tail of a job is split finely
+enough to keep all threads busy.
 
-/*
-=============
-GetThreadWork
-
-=============
+===================================================================
 */
-int GetThreadWork(void)
-{
-	int r;
-	int f;
-
-	ThreadLock();
 
-	if (dispatch == workcount)
-	{
-		ThreadUnlock();
-		return -1;
-	}
+int numthreads = -1;
 
-	f = 10 * dispatch / workcount;
-	if (f != oldf)
-	{
-		oldf = f;
-		if (pacifier)
-			printf("%i...", f);
-	}
+namespace
+{
+struct alignas(64) WorkRange
+{
+	std::mutex lock;
 
-	r = dispatch;
-	dispatch++;
-	ThreadUnlock();
+	// Only modified while holding the lock, atomic so other threads can look for work to steal
+	std::atomic<int> next = 0;
+	std::atomic<int> end = 0;
+};
 
-	return r;
-}
+struct PhaseTime
+{
+	std::string name;
+	double seconds = 0;
+	int workcount = 0;
+	int steals = 0;
+	int runs = 0;
+};
 
+std::unique_ptr<WorkRange[]> workranges;
+int workrangecount;
 
-void (*workfunction)(int);
+int workcount;
+std::atomic<int> dispatched;
+std::atomic<int> steals;
+std::atomic<int> oldf;
+qboolean pacifier;
 
-void ThreadWorkerFunction(int /*threadnum*/)
-{
-	int work;
+std::mutex crit;
+std::atomic<bool> threaded;
+bool enter;
 
-	while (1)
-	{
-		work = GetThreadWork();
-		if (work == -1)
-			break;
-		workfunction(work);
-	}
-}
+const char* phasename;
+std::vector<PhaseTime> phasetimes;
 
-void RunThreadsOnIndividual(int workcnt, qboolean showpacifier, void (*func)(int))
-{
-	workfunction = func;
-	RunThreadsOn(workcnt, showpacifier, ThreadWorkerFunction);
+thread_local int threadindex;
+thread_local int chunknext;
+thread_local int chunkend;
 }
 
-
 /*
-===================================================================
-
-WIN32
+=============
+ThreadSetDefault
 
-===================================================================
+=============
 */
-#ifdef WIN32
-
-#define USED
-
-#include <windows.h>
-
-int numthreads = -1;
-CRITICAL_SECTION crit;
-static int enter;
-
 void ThreadSetDefault(void)
 {
-	SYSTEM_INFO info;
-
 	if (numthreads == -1) // not set manually
 	{
-		GetSystemInfo(&info);
-		numthreads = info.dwNumberOfProcessors;
-		if (numthreads < 1 || numthreads > 32)
-			numthreads = 1;
+		numthreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
 	}
 
 	qprintf("%i threads\n", numthreads);
@@ -115,10 +100,10 @@ void ThreadLock(void)
 {
 	if (!threaded)
 		return;
-	EnterCriticalSection(&crit);
+	crit.lock();
 	if (enter)
 		Error("Recursive ThreadLock\n");
-	enter = 1;
+	enter = true;
 }
 
 void ThreadUnlock(void)
@@ -127,177 +112,215 @@ void ThreadUnlock(void)
 		return;
 	if (!enter)
 		Error("ThreadUnlock without lock\n");
-	enter = 0;
-	LeaveCriticalSection(&crit);
+	enter = false;
+	crit.unlock();
 }
 
 /*
 =============
-RunThreadsOn
+GrabChunk
+
+Takes the next chunk from the front of a range.
+The range must be locked by the caller.
 =============
 */
-void RunThreadsOn(int workcnt, qboolean showpacifier, void (*func)(int))
+static bool GrabChunk(WorkRange& range)
 {
-	DWORD threadid[MAX_THREADS];
-	HANDLE threadhandle[MAX_THREADS];
-	int i;
-	int start, end;
+	const int remaining = range.end - range.next;
 
-	start = I_FloatTime();
-	dispatch = 0;
-	workcount = workcnt;
-	oldf = -1;
-	pacifier = showpacifier;
-	threaded = true;
-	//
-	// run threads in parallel
-	//
-	InitializeCriticalSection(&crit);
-	for (i = 0; i < numthreads; i++)
-	{
-		threadhandle[i] = CreateThread(
-			NULL,						  // LPSECURITY_ATTRIBUTES lpsa,
-			0,							  // DWORD cbStack,
-			(LPTHREAD_START_ROUTINE)func, // LPTHREAD_START_ROUTINE lpStartAddr,
-			(LPVOID)i,					  // LPVOID lpvThreadParm,
-			0,							  //   DWORD fdwCreate,
-			&threadid[i]);
-	}
+	if (remaining <= 0)
+		return false;
 
-	for (i = 0; i < numthreads; i++)
-		WaitForSingleObject(threadhandle[i], INFINITE);
-	DeleteCriticalSection(&crit);
+	// Take a share of what is left so refills get rarer for big jobs and finer near the end
+	const int grain = std::max(1, remaining / (2 * workrangecount));
 
-	threaded = false;
-	end = I_FloatTime();
-	if (pacifier)
-		printf(" (%i)\n", end - start);
+	chunknext = range.next;
+	chunkend = chunknext + grain;
+	range.next = chunkend;
+
+	return true;
 }
 
+/*
+=============
+StealWork
 
-#endif
+Moves the back half of the largest other range into this thread's range.
+=============
+*/
+static bool StealWork(void)
+{
+	while (true)
+	{
+		int victim = -1;
+		int largest = 0;
 
-/*
-===================================================================
+		// Unlocked scan, the result is verified after locking the victim
+		for (int i = 1; i < workrangecount; ++i)
+		{
+			const int index = (threadindex + i) % workrangecount;
+			const int remaining = workranges[index].end - workranges[index].next;
 
-OSF1
+			if (remaining > largest)
+			{
+				largest = remaining;
+				victim = index;
+			}
+		}
 
-===================================================================
-*/
+		if (victim == -1)
+			return false;
 
-#ifdef __osf__
-#define USED
+		int stolennext, stolenend;
 
-int numthreads = 4;
+		{
+			std::lock_guard guard{workranges[victim].lock};
+			auto& range = workranges[victim];
 
-void ThreadSetDefault(void)
-{
-	numthreads = 4;
-}
+			const int remaining = range.end - range.next;
 
+			if (remaining <= 0)
+				continue;
 
-#include <pthread.h>
+			stolenend = range.end;
+			stolennext = range.end - (remaining + 1) / 2;
+			range.end = stolennext;
+		}
 
-pthread_mutex_t* my_mutex;
+		{
+			std::lock_guard guard{workranges[threadindex].lock};
+			workranges[threadindex].next = stolennext;
+			workranges[threadindex].end = stolenend;
+		}
 
-void ThreadLock(void)
-{
-	if (my_mutex)
-		pthread_mutex_lock(my_mutex);
-}
+		++steals;
 
-void ThreadUnlock(void)
-{
-	if (my_mutex)
-		pthread_mutex_unlock(my_mutex);
+		return true;
+	}
 }
 
-
 /*
 =============
-RunThreadsOn
+GetThreadWork
+
 =============
 */
-void RunThreadsOn(int workcnt, qboolean showpacifier, void (*func)(int))
+int GetThreadWork(void)
 {
-	int i;
-	pthread_t work_threads[MAX_THREADS];
-	pthread_addr_t status;
-	pthread_attr_t attrib;
-	pthread_mutexattr_t mattrib;
-	int start, end;
-
-	start = I_FloatTime();
-	dispatch = 0;
-	workcount = workcnt;
-	oldf = -1;
-	pacifier = showpacifier;
-	threaded = true;
-
-	if (pacifier)
-		setbuf(stdout, NULL);
-
-	if (!my_mutex)
+	if (chunknext >= chunkend)
 	{
-		my_mutex = malloc(sizeof(*my_mutex));
-		if (pthread_mutexattr_create(&mattrib) == -1)
-			Error("pthread_mutex_attr_create failed");
-		if (pthread_mutexattr_setkind_np(&mattrib, MUTEX_FAST_NP) == -1)
-			Error("pthread_mutexattr_setkind_np failed");
-		if (pthread_mutex_init(my_mutex, mattrib) == -1)
-			Error("pthread_mutex_init failed");
-	}
+		bool found;
 
-	if (pthread_attr_create(&attrib) == -1)
-		Error("pthread_attr_create failed");
-	if (pthread_attr_setstacksize(&attrib, 0x100000) == -1)
-		Error("pthread_attr_setstacksize failed");
+		do
+		{
+			{
+				std::lock_guard guard{workranges[threadindex].lock};
+				found = GrabChunk(workranges[threadindex]);
+			}
+		} while (!found && StealWork());
 
-	for (i = 0; i < numthreads; i++)
-	{
-		if (pthread_create(&work_threads[i], attrib, (pthread_startroutine_t)func, (pthread_addr_t)i) == -1)
-			Error("pthread_create failed");
-	}
+		if (!found)
+			return -1;
 
-	for (i = 0; i < numthreads; i++)
-	{
-		if (pthread_join(work_threads[i], &status) == -1)
-			Error("pthread_join failed");
-	}
+		const int done = dispatched.fetch_add(chunkend - chunknext) + (chunkend - chunknext);
 
-	threaded = false;
+		if (pacifier)
+		{
+			const int f = static_cast<int>(10LL * done / workcount);
+			int previous = oldf.load();
+
+			while (f > previous)
+			{
+				if (oldf.compare_exchange_weak(previous, f))
+				{
+					for (int i = previous + 1; i <= f && i < 10; ++i)
+						printf("%i...", i);
+					fflush(stdout);
+					break;
+				}
+			}
+		}
+	}
 
-	end = I_FloatTime();
-	if (pacifier)
-		printf(" (%i)\n", end - start);
+	return chunknext++;
 }
 
 
-#endif
-
-/*
-=======================================================================
+void (*workfunction)(int);
 
-  SINGLE THREAD
+void ThreadWorkerFunction(int /*threadnum*/)
+{
+	int work;
 
-=======================================================================
-*/
+	while (1)
+	{
+		work = GetThreadWork();
+		if (work == -1)
+			break;
+		workfunction(work);
+	}
+}
 
-#ifndef USED
+void RunThreadsOnIndividual(int workcnt, qboolean showpacifier, void (*func)(int))
+{
+	workfunction = func;
+	RunThreadsOn(workcnt, showpacifier, ThreadWorkerFunction);
+}
 
-int numthreads = 1;
+/*
+=============
+ThreadSetPhaseName
 
-void ThreadSetDefault(void)
+Names the next RunThreadsOn call in the phase timing report.
+=============
+*/
+void ThreadSetPhaseName(const char* name)
 {
-	numthreads = 1;
+	phasename = name;
 }
 
-void ThreadLock(void)
+static void RecordPhaseTime(double seconds)
 {
+	const char* name = phasename ? phasename : "unnamed";
+	phasename = nullptr;
+
+	auto it = std::find_if(phasetimes.begin(), phasetimes.end(), [&](const auto& phase)
+		{ return phase.name == name; });
+
+	if (it == phasetimes.end())
+	{
+		phasetimes.push_back(PhaseTime{name});
+		it = phasetimes.end() - 1;
+	}
+
+	it->seconds += seconds;
+	it->workcount += workcount;
+	it->steals += steals;
+	++it->runs;
 }
 
-void ThreadUnlock(void)
+/*
+=============
+ThreadPrintPhaseTimes
+
+=============
+*/
+void ThreadPrintPhaseTimes(void)
 {
+	if (phasetimes.empty())
+		return;
+
+	double total = 0;
+
+	printf("\n%-24s %10s %10s %8s %6s\n", "phase", "seconds", "items", "steals", "runs");
+
+	for (const auto& phase : phasetimes)
+	{
+		printf("%-24s %10.3f %10i %8i %6i\n", phase.name.c_str(), phase.seconds, phase.workcount, phase.steals, phase.runs);
+		total += phase.seconds;
+	}
+
+	printf("%-24s %10.3f\n", "total", total);
 }
 
 /*
@@ -307,23 +330,62 @@ RunThreadsOn
 */
 void RunThreadsOn(int workcnt, qboolean showpacifier, void (*func)(int))
 {
-	int i;
-	int start, end;
+	const auto start = std::chrono::steady_clock::now();
+
+	const int threadcount = std::max(1, numthreads);
+
+	if (workrangecount != threadcount)
+	{
+		workranges = std::make_unique<WorkRange[]>(threadcount);
+		workrangecount = threadcount;
+	}
+
+	for (int i = 0; i < workrangecount; ++i)
+	{
+		workranges[i].next = static_cast<int>(static_cast<long long>(workcnt) * i / workrangecount);
+		workranges[i].end = static_cast<int>(static_cast<long long>(workcnt) * (i + 1) / workrangecount);
+	}
 
-	dispatch = 0;
 	workcount = workcnt;
+	dispatched = 0;
+	steals = 0;
 	oldf = -1;
 	pacifier = showpacifier;
-	start = I_FloatTime();
-#ifdef NeXT
-	if (pacifier)
-		setbuf(stdout, NULL);
-#endif
-	func(0);
 
-	end = I_FloatTime();
+	auto threadfunc = [func](int index)
+	{
+		threadindex = index;
+		chunknext = chunkend = 0;
+		func(index);
+	};
+
+	if (threadcount == 1)
+	{
+		threadfunc(0);
+	}
+	else
+	{
+		threaded = true;
+
+		std::vector<std::thread> threads;
+		threads.reserve(threadcount - 1);
+
+		for (int i = 1; i < threadcount; ++i)
+			threads.emplace_back(threadfunc, i);
+
+		// The calling thread does its share of the work too
+		threadfunc(0);
+
+		for (auto& thread : threads)
+			thread.join();
+
+		threaded = false;
+	}
+
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	RecordPhaseTime(seconds);
+
 	if (pacifier)
-		printf(" (%i)\n", end - start);
+		printf(" (%.2f)\n", seconds);
 }
-
-#endif
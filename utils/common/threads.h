@@ -16,18 +16,22 @@ void RunThreadsOnIndividual(int workcnt, qboolean showpacifier, void (*func)(int
 void RunThreadsOn(int workcnt, qboolean showpacifier, void (*func)(int));
 void ThreadLock(void);
 void ThreadUnlock(void);
+void ThreadSetPhaseName(const char* name);
+void ThreadPrintPhaseTimes(void);
 
 #ifndef NO_THREAD_NAMES
 #define RunThreadsOn(n, p, f)         \
 	{                                 \
 		if (p)                        \
 			printf("%-20s ", #f ":"); \
+		ThreadSetPhaseName(#f);       \
 		RunThreadsOn(n, p, f);        \
 	}
 #define RunThreadsOnIndividual(n, p, f)  \
 	{                                    \
 		if (p)                           \
 			printf("%-20s ", #f ":");    \
+		ThreadSetPhaseName(#f);          \
 		RunThreadsOnIndividual(n, p, f); \
 	}
 #endif
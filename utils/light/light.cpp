@@ -221,6 +221,7 @@ int main(int argc, char** argv)
 
 	end = I_FloatTime();
 	printf("%5.1f seconds elapsed\n", end - start);
+	ThreadPrintPhaseTimes();
 
 	return 0;
 }
@@ -13,6 +13,7 @@
 #include "cmdlib.h"
 #include "mathlib.h"
 #include "bspfile.h"
+#include "polyfile.h"
 #include "polylib.h"
 #include "threads.h"
 
@@ -150,7 +151,7 @@ typedef struct portal_s
 	winding_t* winding;
 } portal_t;
 
-extern node_t outside_node; // portals outside the world face this
+extern thread_local node_t outside_node; // portals outside the world face this
 
 void AddPortalToNodes(portal_t* p, node_t* front, node_t* back);
 void RemovePortalFromNode(portal_t* portal, node_t* l);
@@ -220,11 +221,11 @@ extern qboolean watervis;
 
 extern int subdivide_size;
 
-extern int hullnum;
+extern thread_local int hullnum;
 
 void qprintf(char* fmt, ...); // only prints if verbose
 
-extern int valid;
+extern thread_local int valid;
 
 extern char portfilename[1024];
 extern char g_bspfilename[1024];
@@ -232,7 +233,7 @@ extern char pointfilename[1024];
 
 extern qboolean worldmodel;
 
-extern face_t* validfaces[MAX_MAP_PLANES];
+extern thread_local face_t* validfaces[MAX_MAP_PLANES];
 
 surfchain_t* SurflistFromValidFaces(void);
 
@@ -10,11 +10,12 @@
 
 #include "bsp5.h"
 
-int outleafs;
-int valid;
-int c_falsenodes;
-int c_free_faces;
-int c_keep_faces;
+// Per thread, the clipping hulls are filled in parallel
+thread_local int outleafs;
+thread_local int valid;
+thread_local int c_falsenodes;
+thread_local int c_free_faces;
+thread_local int c_keep_faces;
 
 /*
 ===========
@@ -57,7 +58,7 @@ qboolean PlaceOccupant(int num, vec3_t point, node_t* headnode)
 MarkLeakTrail
 ==============
 */
-portal_t* prevleaknode;
+thread_local portal_t* prevleaknode;
 FILE *pointfile, *linefile;
 void MarkLeakTrail(portal_t* n2)
 {
@@ -101,8 +102,8 @@ If fill is false, just check, don't fill
 Returns true if an occupied leaf is reached
 ==================
 */
-int hit_occupied;
-int backdraw;
+thread_local int hit_occupied;
+thread_local int backdraw;
 qboolean RecursiveFillOutside(node_t* l, qboolean fill)
 {
 	portal_t* p;
@@ -11,7 +11,7 @@
 #include "bsp5.h"
 
 
-node_t outside_node; // portals outside the world face this
+thread_local node_t outside_node; // portals outside the world face this
 
 //=============================================================================
 
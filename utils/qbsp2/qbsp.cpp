@@ -10,6 +10,8 @@
 
 // qbsp.c
 
+#include <atomic>
+
 #include "bsp5.h"
 
 //
@@ -30,9 +32,17 @@ char g_bspfilename[1024];
 char pointfilename[1024];
 char portfilename[1024];
 
-FILE* polyfiles[NUM_HULLS];
+typedef struct
+{
+	FILE* file; // text format
+	byte* data; // binary format, read whole
+	int size;
+	int offset;
+} polyfile_t;
+
+polyfile_t polyfiles[NUM_HULLS];
 
-int hullnum;
+thread_local int hullnum;
 
 //===========================================================================
 
@@ -527,17 +537,18 @@ void SplitFace(face_t* in, dplane_t* split, face_t** front, face_t** back)
 
 //===========================================================================
 
-int c_activefaces, c_peakfaces;
-int c_activesurfaces, c_peaksurfaces;
-int c_activewindings, c_peakwindings;
-int c_activeportals, c_peakportals;
+// Atomic because the clipping hulls are built in parallel
+std::atomic<int> c_activefaces, c_peakfaces;
+std::atomic<int> c_activesurfaces, c_peaksurfaces;
+std::atomic<int> c_activewindings, c_peakwindings;
+std::atomic<int> c_activeportals, c_peakportals;
 
 void PrintMemory(void)
 {
-	printf("faces   : %6i (%6i)\n", c_activefaces, c_peakfaces);
-	printf("surfaces: %6i (%6i)\n", c_activesurfaces, c_peaksurfaces);
-	printf("windings: %6i (%6i)\n", c_activewindings, c_peakwindings);
-	printf("portals : %6i (%6i)\n", c_activeportals, c_peakportals);
+	printf("faces   : %6i (%6i)\n", c_activefaces.load(), c_peakfaces.load());
+	printf("surfaces: %6i (%6i)\n", c_activesurfaces.load(), c_peaksurfaces.load());
+	printf("windings: %6i (%6i)\n", c_activewindings.load(), c_peakwindings.load());
+	printf("portals : %6i (%6i)\n", c_activeportals.load(), c_peakportals.load());
 }
 
 /*
@@ -555,7 +566,7 @@ winding_t* NewWinding(int points)
 
 	c_activewindings++;
 	if (c_activewindings > c_peakwindings)
-		c_peakwindings = c_activewindings;
+		c_peakwindings = c_activewindings.load();
 
 	size = (int)((winding_t*)0)->points[points];
 	w = reinterpret_cast<winding_t*>(malloc(size));
@@ -575,7 +586,7 @@ face_t* AllocFace(void)
 
 	c_activefaces++;
 	if (c_activefaces > c_peakfaces)
-		c_peakfaces = c_activefaces;
+		c_peakfaces = c_activefaces.load();
 
 	f = reinterpret_cast<face_t*>(malloc(sizeof(face_t)));
 	memset(f, 0, sizeof(face_t));
@@ -606,7 +617,7 @@ surface_t* AllocSurface(void)
 
 	c_activesurfaces++;
 	if (c_activesurfaces > c_peaksurfaces)
-		c_peaksurfaces = c_activesurfaces;
+		c_peaksurfaces = c_activesurfaces.load();
 
 	return s;
 }
@@ -628,7 +639,7 @@ portal_t* AllocPortal(void)
 
 	c_activeportals++;
 	if (c_activeportals > c_peakportals)
-		c_peakportals = c_activeportals;
+		c_peakportals = c_activeportals.load();
 
 	p = reinterpret_cast<portal_t*>(malloc(sizeof(portal_t)));
 	memset(p, 0, sizeof(portal_t));
@@ -661,7 +672,7 @@ node_t* AllocNode(void)
 
 //===========================================================================
 
-face_t* validfaces[MAX_MAP_PLANES];
+thread_local face_t* validfaces[MAX_MAP_PLANES];
 
 
 
@@ -732,6 +743,74 @@ surfchain_t* SurflistFromValidFaces(void)
 	return sc;
 }
 
+/*
+===============
+AddSurfFace
+===============
+*/
+face_t* AddSurfFace(int planenum, int texturenum, int contents, int numpoints)
+{
+	face_t* f;
+
+	if (numpoints > MAXPOINTS)
+		Error("ReadSurfs: %i > MAXPOINTS", numpoints);
+	if (planenum > numplanes)
+		Error("ReadSurfs: %i > numplanes", planenum);
+	if (texturenum > numtexinfo)
+		Error("ReadSurfs: %i > numtexinfo", texturenum);
+
+	f = AllocFace();
+	f->planenum = planenum;
+	f->texturenum = texturenum;
+	f->contents = contents;
+	f->numpoints = numpoints;
+	f->next = validfaces[planenum];
+	validfaces[planenum] = f;
+
+	return f;
+}
+
+/*
+===============
+ReadBinarySurfs
+===============
+*/
+surfchain_t* ReadBinarySurfs(polyfile_t* file)
+{
+	polyfileface_t face;
+	face_t* f;
+	int i;
+	double v[3];
+
+	// read in the polygons
+	while (1)
+	{
+		if (file->offset == file->size)
+			return NULL;
+		if (file->offset + (int)sizeof(face) > file->size)
+			Error("ReadSurfs: unexpected end of file");
+
+		memcpy(&face, file->data + file->offset, sizeof(face));
+		file->offset += sizeof(face);
+
+		if (face.planenum == -1) // end of model
+			break;
+		if (face.numpoints < 0 || file->offset + face.numpoints * (int)sizeof(v) > file->size)
+			Error("ReadSurfs: unexpected end of file");
+
+		f = AddSurfFace(face.planenum, face.texinfo, face.contents, face.numpoints);
+
+		for (i = 0; i < f->numpoints; i++)
+		{
+			memcpy(v, file->data + file->offset, sizeof(v));
+			file->offset += sizeof(v);
+			VectorCopy(v, f->pts[i]);
+		}
+	}
+
+	return SurflistFromValidFaces();
+}
+
 /*
 ===============
 ReadSurfs
@@ -755,21 +834,8 @@ surfchain_t* ReadSurfs(FILE* file)
 			break;
 		if (r != 4)
 			Error("ReadSurfs: scanf failure");
-		if (numpoints > MAXPOINTS)
-			Error("ReadSurfs: %i > MAXPOINTS", numpoints);
-		if (planenum > numplanes)
-			Error("ReadSurfs: %i > numplanes", planenum);
-		if (texturenum > numtexinfo)
-			Error("ReadSurfs: %i > numtexinfo", texturenum);
-
-
-		f = AllocFace();
-		f->planenum = planenum;
-		f->texturenum = texturenum;
-		f->contents = contents;
-		f->numpoints = numpoints;
-		f->next = validfaces[planenum];
-		validfaces[planenum] = f;
+
+		f = AddSurfFace(planenum, texturenum, contents, numpoints);
 
 		for (i = 0; i < f->numpoints; i++)
 		{
@@ -783,6 +849,89 @@ surfchain_t* ReadSurfs(FILE* file)
 }
 
 
+/*
+===============
+ReadHullSurfs
+===============
+*/
+surfchain_t* ReadHullSurfs(int hull)
+{
+	if (polyfiles[hull].data)
+		return ReadBinarySurfs(&polyfiles[hull]);
+
+	return ReadSurfs(polyfiles[hull].file);
+}
+
+/*
+===============
+OpenPolyFile
+
+Binary hull files are read into memory in one go, text files are parsed as they are read
+===============
+*/
+void OpenPolyFile(polyfile_t* polyfile, char* name)
+{
+	polyfileheader_t header;
+
+	memset(polyfile, 0, sizeof(*polyfile));
+
+	polyfile->file = fopen(name, "rb");
+	if (!polyfile->file)
+		Error("Can't open %s", name);
+
+	if (fread(&header, sizeof(header), 1, polyfile->file) == 1 && header.ident == POLYFILE_IDENT)
+	{
+		if (header.version != POLYFILE_VERSION)
+			Error("%s is version %i, not %i", name, header.version, POLYFILE_VERSION);
+
+		fclose(polyfile->file);
+		polyfile->file = NULL;
+
+		polyfile->size = LoadFile(name, reinterpret_cast<void**>(&polyfile->data));
+		polyfile->offset = sizeof(header);
+	}
+	else
+	{
+		rewind(polyfile->file);
+	}
+}
+
+void ClosePolyFile(polyfile_t* polyfile)
+{
+	if (polyfile->file)
+		fclose(polyfile->file);
+
+	free(polyfile->data);
+
+	memset(polyfile, 0, sizeof(*polyfile));
+}
+
+/*
+===============
+BuildClipHull
+
+Builds the tree of one clipping hull for the current model.
+The three clipping hulls don't share any state, so they are built in parallel.
+===============
+*/
+node_t* clipnodes[NUM_HULLS];
+
+void BuildClipHull(int hull)
+{
+	surfchain_t* surfs;
+	node_t* nodes;
+
+	hullnum = hull + 1;
+
+	surfs = ReadHullSurfs(hullnum);
+	nodes = SolidBSP(surfs);
+	if (nummodels == 1 && !nofill) // assume non-world bmodels are simple
+		nodes = FillOutside(nodes, false);
+	FreePortals(nodes);
+
+	clipnodes[hullnum] = nodes;
+}
+
 /*
 ===============
 ProcessModel
@@ -794,8 +943,9 @@ qboolean ProcessModel(void)
 	node_t* nodes;
 	dmodel_t* model;
 	int startleafs;
+	int i;
 
-	surfs = ReadSurfs(polyfiles[0]);
+	surfs = ReadHullSurfs(0);
 
 	if (!surfs)
 		return false; // all models are done
@@ -846,15 +996,22 @@ qboolean ProcessModel(void)
 	//
 	// the clipping hulls are simpler
 	//
-	for (hullnum = 1; hullnum < NUM_HULLS; hullnum++)
+	if (drawflag)
+	{
+		for (i = 0; i < NUM_HULLS - 1; i++)
+			BuildClipHull(i);
+	}
+	else
+	{
+		RunThreadsOnIndividual(NUM_HULLS - 1, false, BuildClipHull);
+	}
+
+	// Emit in hull order so the output doesn't depend on which hull finished first
+	for (i = 1; i < NUM_HULLS; i++)
 	{
-		surfs = ReadSurfs(polyfiles[hullnum]);
-		nodes = SolidBSP(surfs);
-		if (nummodels == 1 && !nofill) // assume non-world bmodels are simple
-			nodes = FillOutside(nodes, false);
-		FreePortals(nodes);
-		model->headnode[hullnum] = numclipnodes;
-		WriteClipNodes(nodes);
+		model->headnode[i] = numclipnodes;
+		WriteClipNodes(clipnodes[i]);
+		clipnodes[i] = NULL;
 	}
 
 	return true;
@@ -882,9 +1039,7 @@ void ProcessFile(char* bspfilename)
 	for (i = 0; i < NUM_HULLS; i++)
 	{
 		sprintf(name, "%s.p%i", bspfilename, i);
-		polyfiles[i] = fopen(name, "r");
-		if (!polyfiles[i])
-			Error("Can't open %s", name);
+		OpenPolyFile(&polyfiles[i], name);
 	}
 
 	// load the output of qcsg
@@ -899,6 +1054,9 @@ void ProcessFile(char* bspfilename)
 	while (ProcessModel())
 		;
 
+	for (i = 0; i < NUM_HULLS; i++)
+		ClosePolyFile(&polyfiles[i]);
+
 	// write the updated bsp file out
 	FinishBSPFile();
 }
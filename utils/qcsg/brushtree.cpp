@@ -0,0 +1,215 @@
+/***
+ *
+ *	Copyright (c) 1996-2002, Valve LLC. All rights reserved.
+ *
+ *	This product contains software technology licensed from Id
+ *	Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *	All Rights Reserved.
+ *
+ ****/
+
+// brushtree.cpp
+
+#include <algorithm>
+#include <vector>
+
+#include "csg.h"
+
+/*
+===================================================================
+
+BRUSH BOUNDS TREES
+
+A bounding volume hierarchy over the hull bounds of each entity's
+brushes, so CSGBrush only visits the brushes that can clip it instead
+of testing every other brush of the entity.
+
+===================================================================
+*/
+
+#define BRUSHTREE_LEAF_SIZE 4
+
+typedef struct
+{
+	vec3_t mins, maxs;
+	int children[2];
+	int firstbrush; // leafs only
+	int numbrushes; // zero for interior nodes
+} brushtreenode_t;
+
+typedef struct
+{
+	std::vector<brushtreenode_t> nodes;
+	std::vector<int> brushes; // entity relative brush numbers
+} brushtree_t;
+
+// One per entity and hull
+static std::vector<brushtree_t> brushtrees;
+
+static brushhull_t* TreeBrushHull(entity_t* e, int hull, int bn)
+{
+	return &mapbrushes[e->firstbrush + bn].hulls[hull];
+}
+
+/*
+============
+BuildBrushTree_r
+
+Splits the brushes at the median of the longest axis of their centers
+============
+*/
+static int BuildBrushTree_r(brushtree_t* tree, entity_t* e, int hull, int first, int count)
+{
+	brushtreenode_t node;
+	vec3_t centermins, centermaxs;
+	int i, j, axis;
+
+	ClearBounds(node.mins, node.maxs);
+	ClearBounds(centermins, centermaxs);
+
+	for (i = first; i < first + count; i++)
+	{
+		brushhull_t* bh = TreeBrushHull(e, hull, tree->brushes[i]);
+		vec3_t center;
+
+		AddPointToBounds(bh->mins, node.mins, node.maxs);
+		AddPointToBounds(bh->maxs, node.mins, node.maxs);
+
+		VectorAdd(bh->mins, bh->maxs, center);
+		AddPointToBounds(center, centermins, centermaxs);
+	}
+
+	node.children[0] = node.children[1] = -1;
+	node.firstbrush = first;
+	node.numbrushes = count;
+
+	const int nodenum = (int)tree->nodes.size();
+	tree->nodes.push_back(node);
+
+	if (count <= BRUSHTREE_LEAF_SIZE)
+		return nodenum;
+
+	axis = 0;
+	for (j = 1; j < 3; j++)
+	{
+		if (centermaxs[j] - centermins[j] > centermaxs[axis] - centermins[axis])
+			axis = j;
+	}
+
+	auto begin = tree->brushes.begin() + first;
+	std::nth_element(begin, begin + count / 2, begin + count, [&](int lhs, int rhs)
+		{
+			brushhull_t* l = TreeBrushHull(e, hull, lhs);
+			brushhull_t* r = TreeBrushHull(e, hull, rhs);
+			return l->mins[axis] + l->maxs[axis] < r->mins[axis] + r->maxs[axis];
+		});
+
+	const int child0 = BuildBrushTree_r(tree, e, hull, first, count / 2);
+	const int child1 = BuildBrushTree_r(tree, e, hull, first + count / 2, count - count / 2);
+
+	// nodes may have been reallocated
+	tree->nodes[nodenum].children[0] = child0;
+	tree->nodes[nodenum].children[1] = child1;
+	tree->nodes[nodenum].numbrushes = 0;
+
+	return nodenum;
+}
+
+/*
+============
+BuildBrushTrees
+============
+*/
+void BuildBrushTrees(void)
+{
+	int i, hull, bn;
+
+	brushtrees.clear();
+	brushtrees.resize(num_entities * NUM_HULLS);
+
+	for (i = 0; i < num_entities; i++)
+	{
+		entity_t* e = &entities[i];
+
+		for (hull = 0; hull < NUM_HULLS; hull++)
+		{
+			brushtree_t* tree = &brushtrees[i * NUM_HULLS + hull];
+
+			for (bn = 0; bn < e->numbrushes; bn++)
+			{
+				if (TreeBrushHull(e, hull, bn)->faces) // brushes not in this hull can't clip
+					tree->brushes.push_back(bn);
+			}
+
+			if (!tree->brushes.empty())
+				BuildBrushTree_r(tree, e, hull, 0, (int)tree->brushes.size());
+		}
+	}
+}
+
+/*
+============
+FreeBrushTrees
+============
+*/
+void FreeBrushTrees(void)
+{
+	brushtrees.clear();
+	brushtrees.shrink_to_fit();
+}
+
+/*
+============
+BrushesInBounds
+
+Fills list with the entity relative numbers of all brushes whose hull bounds
+touch the given bounds, in ascending order
+============
+*/
+void BrushesInBounds(int entitynum, int hull, vec3_t mins, vec3_t maxs, std::vector<int>& list)
+{
+	const brushtree_t* tree = &brushtrees[entitynum * NUM_HULLS + hull];
+	entity_t* e = &entities[entitynum];
+	int stack[64];
+	int depth = 0;
+	int i;
+
+	list.clear();
+
+	if (tree->nodes.empty())
+		return;
+
+	stack[depth++] = 0;
+
+	while (depth > 0)
+	{
+		const brushtreenode_t* node = &tree->nodes[stack[--depth]];
+
+		for (i = 0; i < 3; i++)
+			if (mins[i] > node->maxs[i] || maxs[i] < node->mins[i])
+				break;
+		if (i < 3)
+			continue;
+
+		if (!node->numbrushes)
+		{
+			stack[depth++] = node->children[0];
+			stack[depth++] = node->children[1];
+			continue;
+		}
+
+		for (int j = node->firstbrush; j < node->firstbrush + node->numbrushes; j++)
+		{
+			brushhull_t* bh = TreeBrushHull(e, hull, tree->brushes[j]);
+
+			for (i = 0; i < 3; i++)
+				if (mins[i] > bh->maxs[i] || maxs[i] < bh->mins[i])
+					break;
+			if (i == 3)
+				list.push_back(tree->brushes[j]);
+		}
+	}
+
+	// Clipping order decides which of two overlapping brushes wins
+	std::sort(list.begin(), list.end());
+}
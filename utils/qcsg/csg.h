@@ -9,12 +9,15 @@
  ****/
 
 
+#include <vector>
+
 #include "cmdlib.h"
 #include "mathlib.h"
 #include "scriplib.h"
 #include "polylib.h"
 #include "threads.h"
 #include "bspfile.h"
+#include "polyfile.h"
 
 #include <windows.h>
 
@@ -100,6 +103,7 @@ extern side_t brushsides[MAX_MAP_SIDES];
 
 extern qboolean noclip;
 extern qboolean wadtextures;
+extern qboolean textpoly;
 
 extern int nWadInclude;
 extern char* pszWadInclude[];
@@ -156,3 +160,11 @@ void TextureAxisFromPlane(plane_t* pln, vec3_t xv, vec3_t yv);
 // hullfile.c
 
 void CheckHullFile(qboolean hullfile, char* filename);
+
+//=============================================================================
+
+// brushtree.c
+
+void BuildBrushTrees(void);
+void FreeBrushTrees(void);
+void BrushesInBounds(int entitynum, int hull, vec3_t mins, vec3_t maxs, std::vector<int>& list);
@@ -10,6 +10,9 @@
 
 // csg4.c
 
+#include <atomic>
+#include <vector>
+
 #include "csg.h"
 
 /*
@@ -22,12 +25,17 @@ NOTES
 
 */
 
-int brushfaces;
-int c_csgfaces;
+std::atomic<int> brushfaces;
+std::atomic<int> c_csgfaces;
 FILE* out[NUM_HULLS];
 
-int c_tiny, c_tiny_clip;
-int c_outfaces;
+// Faces are collected per brush and hull while the brushes are processed
+// in parallel, then written out in brush order
+static std::vector<std::vector<byte>> hulloutput;
+static thread_local std::vector<byte>* currentoutput;
+
+std::atomic<int> c_tiny, c_tiny_clip;
+std::atomic<int> c_outfaces;
 
 qboolean hullfile = false;
 static char qhullfile[256];
@@ -36,6 +44,7 @@ qboolean glview;
 qboolean noclip;
 qboolean onlyents;
 qboolean wadtextures = true;
+qboolean textpoly;
 
 vec3_t world_mins, world_maxs;
 
@@ -165,6 +174,32 @@ bface_t* ClipFace(brush_t* /*b*/, bface_t* f, bface_t** outside,
 	return f;
 }
 
+/*
+===========
+OutputBytes
+
+Appends to the output of the brush hull this thread is working on
+===========
+*/
+static void OutputBytes(const void* data, int size)
+{
+	const byte* bytes = reinterpret_cast<const byte*>(data);
+	currentoutput->insert(currentoutput->end(), bytes, bytes + size);
+}
+
+static void OutputPrintf(const char* format, ...)
+{
+	char text[256];
+	va_list argptr;
+	int length;
+
+	va_start(argptr, format);
+	length = vsnprintf(text, sizeof(text), format, argptr);
+	va_end(argptr);
+
+	OutputBytes(text, length);
+}
+
 /*
 ===========
 WriteFace
@@ -174,10 +209,9 @@ void WriteFace(int hull, bface_t* f)
 {
 	int i;
 	winding_t* w;
-	static int level = 128;
+	static std::atomic<int> level = 128;
 	vec_t light;
 
-	ThreadLock();
 	if (!hull)
 		c_csgfaces++;
 
@@ -185,12 +219,11 @@ void WriteFace(int hull, bface_t* f)
 	{
 		// .gl format
 		w = f->w;
-		fprintf(out[hull], "%i\n", w->numpoints);
-		level += 28;
-		light = (level & 255) / 255.0;
+		OutputPrintf("%i\n", w->numpoints);
+		light = ((level += 28) & 255) / 255.0;
 		for (i = 0; i < w->numpoints; i++)
 		{
-			fprintf(out[hull], "%5.2f %5.2f %5.2f %5.3f %5.3f %5.3f\n",
+			OutputPrintf("%5.2f %5.2f %5.2f %5.3f %5.3f %5.3f\n",
 				w->points[i][0],
 				w->points[i][1],
 				w->points[i][2],
@@ -198,24 +231,44 @@ void WriteFace(int hull, bface_t* f)
 				light,
 				light);
 		}
-		fprintf(out[hull], "\n");
+		OutputPrintf("\n");
+	}
+	else if (!textpoly)
+	{
+		// binary .p0 format
+		polyfileface_t face;
+		double points[MAX_POINTS_ON_WINDING][3];
+
+		w = f->w;
+		face.planenum = f->planenum;
+		face.texinfo = f->texinfo;
+		face.contents = f->contents;
+		face.numpoints = w->numpoints;
+
+		for (i = 0; i < w->numpoints; i++)
+		{
+			points[i][0] = w->points[i][0];
+			points[i][1] = w->points[i][1];
+			points[i][2] = w->points[i][2];
+		}
+
+		OutputBytes(&face, sizeof(face));
+		OutputBytes(points, w->numpoints * sizeof(points[0]));
 	}
 	else
 	{
-		// .p0 format
+		// text .p0 format
 		w = f->w;
-		fprintf(out[hull], "%i %i %i %i\n", f->planenum, f->texinfo, f->contents, w->numpoints);
+		OutputPrintf("%i %i %i %i\n", f->planenum, f->texinfo, f->contents, w->numpoints);
 		for (i = 0; i < w->numpoints; i++)
 		{
-			fprintf(out[hull], "%5.2f %5.2f %5.2f\n",
+			OutputPrintf("%5.2f %5.2f %5.2f\n",
 				w->points[i][0],
 				w->points[i][1],
 				w->points[i][2]);
 		}
-		fprintf(out[hull], "\n");
+		OutputPrintf("\n");
 	}
-
-	ThreadUnlock();
 }
 
 /*
@@ -363,11 +416,16 @@ bface_t* CopyFacesToOutside(brushhull_t* bh)
 /*
 ===========
 CSGBrush
+
+Clips one hull of a brush by the other brushes of its entity.
+Work is numbered brushnum * NUM_HULLS + hull.
 ===========
 */
-void CSGBrush(int brushnum)
+void CSGBrush(int work)
 {
-	int hull;
+	static thread_local std::vector<int> touching;
+
+	int brushnum, hull;
 	brush_t *b1, *b2;
 	brushhull_t *bh1, *bh2;
 	int bn;
@@ -375,121 +433,114 @@ void CSGBrush(int brushnum)
 	int i;
 	bface_t *f, *f2, *next, *fcopy;
 	bface_t *outside, *oldoutside;
-	entity_t* e;
 	vec_t area;
 
 	SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_ABOVE_NORMAL);
 
+	brushnum = work / NUM_HULLS;
+	hull = work % NUM_HULLS;
+
+	currentoutput = &hulloutput[work];
+
 	b1 = &mapbrushes[brushnum];
+	bh1 = &b1->hulls[hull];
+
+	if (!bh1->faces)
+		return;
+
+	// set outside to a copy of the brush's faces
+	outside = CopyFacesToOutside(bh1);
 
-	e = &entities[b1->entitynum];
+	// only the brushes whose bounds touch this one can clip it
+	BrushesInBounds(b1->entitynum, hull, bh1->mins, bh1->maxs, touching);
 
-	for (hull = 0; hull < NUM_HULLS; hull++)
+	for (size_t touchindex = 0; touchindex < touching.size(); touchindex++)
 	{
-		bh1 = &b1->hulls[hull];
+		// see if b2 needs to clip a chunk out of b1
+		bn = touching[touchindex];
 
-		// set outside to a copy of the brush's faces
-		outside = CopyFacesToOutside(bh1);
-		overwrite = false;
+		if (bn == brushnum)
+			continue;
 
-		for (bn = 0; bn < e->numbrushes; bn++)
-		{
-			// see if b2 needs to clip a chunk out of b1
+		overwrite = bn > brushnum; // later brushes overwrite
 
-			if (bn == brushnum)
-			{
-				overwrite = true; // later brushes now overwrite
-				continue;
-			}
+		b2 = &mapbrushes[entities[b1->entitynum].firstbrush + bn];
+		bh2 = &b2->hulls[hull];
 
-			b2 = &mapbrushes[e->firstbrush + bn];
-			bh2 = &b2->hulls[hull];
+		// divide faces by the planes of the b2 to find which
+		// fragments are inside
 
-			if (!bh2->faces)
-				continue; // brush isn't in this hull
+		f = outside;
+		outside = NULL;
+		for (; f; f = next)
+		{
+			next = f->next;
 
-			// check brush bounding box first
+			// check face bounding box first
 			for (i = 0; i < 3; i++)
-				if (bh1->mins[i] > bh2->maxs[i] || bh1->maxs[i] < bh2->mins[i])
+				if (bh2->mins[i] > f->maxs[i] || bh2->maxs[i] < f->mins[i])
 					break;
 			if (i < 3)
+			{ // this face doesn't intersect brush2's bbox
+				f->next = outside;
+				outside = f;
 				continue;
+			}
+
+			oldoutside = outside;
+			fcopy = CopyFace(f); // save to avoid fake splits
 
-			// divide faces by the planes of the b2 to find which
-			// fragments are inside
+			// throw pieces on the front sides of the planes
+			// into the outside list, return the remains on the inside
+			for (f2 = bh2->faces; f2 && f; f2 = f2->next)
+				f = ClipFace(b1, f, &outside, f2->planenum, overwrite);
 
-			f = outside;
-			outside = NULL;
-			for (; f; f = next)
+			area = f ? WindingArea(f->w) : 0;
+			if (f && area < 1.0)
 			{
-				next = f->next;
-
-				// check face bounding box first
-				for (i = 0; i < 3; i++)
-					if (bh2->mins[i] > f->maxs[i] || bh2->maxs[i] < f->mins[i])
-						break;
-				if (i < 3)
-				{ // this face doesn't intersect brush2's bbox
+				qprintf("Entity %i, Brush %i: tiny penetration\n", b1->entitynum, b1->brushnum);
+				c_tiny_clip++;
+				FreeFace(f);
+				f = NULL;
+			}
+			if (f)
+			{
+				// there is one convex fragment of the original
+				// face left inside brush2
+				FreeFace(fcopy);
+
+				if (b1->contents > b2->contents)
+				{ // inside a water brush
+					f->contents = b2->contents;
 					f->next = outside;
 					outside = f;
-					continue;
 				}
+				else			 // inside a solid brush
+					FreeFace(f); // throw it away
+			}
+			else
+			{ // the entire thing was on the outside, even
+				// though the bounding boxes intersected,
+				// which will never happen with axial planes
 
-				oldoutside = outside;
-				fcopy = CopyFace(f); // save to avoid fake splits
-
-				// throw pieces on the front sides of the planes
-				// into the outside list, return the remains on the inside
-				for (f2 = bh2->faces; f2 && f; f2 = f2->next)
-					f = ClipFace(b1, f, &outside, f2->planenum, overwrite);
-
-				area = f ? WindingArea(f->w) : 0;
-				if (f && area < 1.0)
-				{
-					qprintf("Entity %i, Brush %i: tiny penetration\n", b1->entitynum, b1->brushnum);
-					c_tiny_clip++;
-					FreeFace(f);
-					f = NULL;
-				}
-				if (f)
+				// free the fragments chopped to the outside
+				while (outside != oldoutside)
 				{
-					// there is one convex fragment of the original
-					// face left inside brush2
-					FreeFace(fcopy);
-
-					if (b1->contents > b2->contents)
-					{ // inside a water brush
-						f->contents = b2->contents;
-						f->next = outside;
-						outside = f;
-					}
-					else			 // inside a solid brush
-						FreeFace(f); // throw it away
+					f2 = outside->next;
+					FreeFace(outside);
+					outside = f2;
 				}
-				else
-				{ // the entire thing was on the outside, even
-					// though the bounding boxes intersected,
-					// which will never happen with axial planes
-
-					// free the fragments chopped to the outside
-					while (outside != oldoutside)
-					{
-						f2 = outside->next;
-						FreeFace(outside);
-						outside = f2;
-					}
 
-					// revert to the original face to avoid
-					// unneeded false cuts
-					fcopy->next = outside;
-					outside = fcopy;
-				}
+				// revert to the original face to avoid
+				// unneeded false cuts
+				fcopy->next = outside;
+				outside = fcopy;
 			}
 		}
-
-		// all of the faces left in outside are real surface faces
-		SaveOutside(b1, hull, outside, b1->contents);
 	}
+
+	// all of the faces left in outside are real surface faces
+	SaveOutside(b1, hull, outside, b1->contents);
 }
 
 //======================================================================
@@ -620,7 +671,7 @@ int typecontents[4] = {CONTENTS_WATER, CONTENTS_SLIME, CONTENTS_LAVA, CONTENTS_S
 
 void ProcessModels(void)
 {
-	int i, j, type;
+	int i, j, type, hull;
 	int placed;
 	int first, contents;
 	brush_t temp;
@@ -643,33 +694,64 @@ void ProcessModels(void)
 				if (mapbrushes[first + j].contents == contents)
 				{
 					temp = mapbrushes[first + placed];
-					mapbrushes[first + placed] = mapbrushes[j];
-					mapbrushes[j] = temp;
+					mapbrushes[first + placed] = mapbrushes[first + j];
+					mapbrushes[first + j] = temp;
 					placed++;
 				}
 			}
 		}
+	}
 
-		//
-		// csg them in order
-		//
-		if (i == 0)
-		{
-			RunThreadsOnIndividual(entities[i].numbrushes, 1, CSGBrush);
-		}
-		else
+	BuildBrushTrees();
+
+	//
+	// csg every hull of every brush, for all models at once
+	//
+	hulloutput.resize(nummapbrushes * NUM_HULLS);
+
+	RunThreadsOnIndividual(nummapbrushes * NUM_HULLS, true, CSGBrush);
+
+	FreeBrushTrees();
+
+	//
+	// write the faces out in brush order
+	//
+	for (i = 0; i < num_entities; i++)
+	{
+		if (!entities[i].numbrushes)
+			continue;
+
+		first = entities[i].firstbrush;
+
+		for (hull = 0; hull < NUM_HULLS; hull++)
 		{
 			for (j = 0; j < entities[i].numbrushes; j++)
-				CSGBrush(first + j);
+			{
+				std::vector<byte>& output = hulloutput[(first + j) * NUM_HULLS + hull];
+
+				if (!output.empty())
+					SafeWrite(out[hull], output.data(), (int)output.size());
+
+				std::vector<byte>().swap(output);
+			}
 		}
 
 		// write end of model marker
-		if (!glview)
+		if (!glview && !textpoly)
+		{
+			polyfileface_t end = {-1, -1, -1, -1};
+
+			for (j = 0; j < NUM_HULLS; j++)
+				SafeWrite(out[j], &end, sizeof(end));
+		}
+		else if (!glview)
 		{
 			for (j = 0; j < NUM_HULLS; j++)
 				fprintf(out[j], "-1 -1 -1 -1\n");
 		}
 	}
+
+	hulloutput.clear();
 }
 
 //=========================================
@@ -768,6 +850,11 @@ int main(int argc, char** argv)
 			strcpy(qproject, argv[i + 1]);
 			i++;
 		}
+		else if (!strcmp(argv[i], "-textpoly"))
+		{
+			printf("textpoly = true\n");
+			textpoly = true;
+		}
 		else if (!strcmp(argv[i], "-hullfile"))
 		{
 			hullfile = true;
@@ -781,7 +868,7 @@ int main(int argc, char** argv)
 	}
 
 	if (i != argc - 1)
-		Error("usage: qcsg [-nowadtextures] [-wadinclude <name>] [-draw] [-glview] [-noclip] [-onlyents] [-proj <name>] [-threads #] [-v] [-hullfile <name>] mapfile");
+		Error("usage: qcsg [-nowadtextures] [-wadinclude <name>] [-draw] [-glview] [-noclip] [-onlyents] [-proj <name>] [-threads #] [-v] [-hullfile <name>] [-textpoly] mapfile");
 
 	SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_ABOVE_NORMAL);
 	start = I_FloatTime();
@@ -815,6 +902,7 @@ int main(int argc, char** argv)
 
 		end = I_FloatTime();
 		printf("%5.0f seconds elapsed\n", end - start);
+		ThreadPrintPhaseTimes();
 		return 0;
 	}
 
@@ -837,17 +925,23 @@ int main(int argc, char** argv)
 			sprintf(hullName, "%s.gl%i", source, i);
 		else
 			sprintf(hullName, "%s.p%i", source, i);
-		out[i] = fopen(hullName, "w");
+		out[i] = fopen(hullName, glview || textpoly ? "w" : "wb");
 		if (!out[i])
 			Error("Couldn't open %s", hullName);
+
+		if (!glview && !textpoly)
+		{
+			polyfileheader_t header = {POLYFILE_IDENT, POLYFILE_VERSION};
+			SafeWrite(out[i], &header, sizeof(header));
+		}
 	}
 
 	ProcessModels();
 
-	qprintf("%5i csg faces\n", c_csgfaces);
-	qprintf("%5i used faces\n", c_outfaces);
-	qprintf("%5i tiny faces\n", c_tiny);
-	qprintf("%5i tiny clips\n", c_tiny_clip);
+	qprintf("%5i csg faces\n", c_csgfaces.load());
+	qprintf("%5i used faces\n", c_outfaces.load());
+	qprintf("%5i tiny faces\n", c_tiny.load());
+	qprintf("%5i tiny clips\n", c_tiny_clip.load());
 
 	for (i = 0; i < NUM_HULLS; i++)
 		fclose(out[i]);
@@ -860,6 +954,7 @@ int main(int argc, char** argv)
 
 	end = I_FloatTime();
 	printf("%5.0f seconds elapsed\n", end - start);
+	ThreadPrintPhaseTimes();
 
 	return 0;
 }
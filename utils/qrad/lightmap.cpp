@@ -8,6 +8,8 @@
  *
  ****/
 
+#include <vector>
+
 #include "qrad.h"
 
 typedef struct
@@ -1048,6 +1050,59 @@ float r_avertexnormals[NUMVERTEXNORMALS][3] = {
 
 #define VectorMaximum(a) (max((a)[0], max((a)[1], (a)[2])))
 
+/*
+Lights that pass the intensity checks for a sample, waiting for their occlusion test.
+All of them are traced together so the tracer can work on several lines at once.
+*/
+typedef struct
+{
+	directlight_t* light;
+	vec3_t add;
+	int needcontents; // contents the line has to reach for the light to be visible
+} samplelight_t;
+
+static thread_local std::vector<samplelight_t> samplelights;
+static thread_local std::vector<float> samplestarts; // vec3_t each
+static thread_local std::vector<float> samplestops;
+static thread_local std::vector<int> sampleresults;
+
+static void AddSampleLightRay(vec3_t pos, vec3_t stop)
+{
+	samplestarts.insert(samplestarts.end(), pos, pos + 3);
+	samplestops.insert(samplestops.end(), stop, stop + 3);
+}
+
+static int TestSampleLightRays()
+{
+	const int count = static_cast<int>(samplestarts.size() / 3);
+
+	sampleresults.resize(count);
+	TestLines(count, reinterpret_cast<const vec3_t*>(samplestarts.data()), reinterpret_cast<const vec3_t*>(samplestops.data()), sampleresults.data());
+
+	return count;
+}
+
+static int FindSampleStyle(vec3_t pos, byte* styles, int style)
+{
+	int style_index;
+
+	for (style_index = 0; style_index < MAXLIGHTMAPS; style_index++)
+		if (styles[style_index] == style || styles[style_index] == 255)
+			break;
+
+	if (style_index == MAXLIGHTMAPS)
+	{
+		printf("WARNING: Too many direct light styles on a face(%f,%f,%f)\n",
+			pos[0], pos[1], pos[2]);
+		return -1;
+	}
+
+	if (styles[style_index] == 255)
+		styles[style_index] = style;
+
+	return style_index;
+}
+
 void GatherSampleLight(vec3_t pos, byte* pvs, vec3_t normal, vec3_t* sample, byte* styles)
 {
 	int i;
@@ -1060,6 +1115,10 @@ void GatherSampleLight(vec3_t pos, byte* pvs, vec3_t normal, vec3_t* sample, byt
 	int style_index;
 	directlight_t* sky_used = NULL;
 
+	samplelights.clear();
+	samplestarts.clear();
+	samplestops.clear();
+
 	for (i = 1; i < numleafs; i++)
 	{
 		if (l = directlights[i]; l != nullptr && (pvs[(i - 1) >> 3] & (1 << ((i - 1) & 7))))
@@ -1079,12 +1138,6 @@ void GatherSampleLight(vec3_t pos, byte* pvs, vec3_t normal, vec3_t* sample, byt
 					if (dot <= ON_EPSILON / 10)
 						continue;
 
-					// search back to see if we can hit a sky brush
-					VectorScale(l->normal, -10000, delta);
-					VectorAdd(pos, delta, delta);
-					if (TestLine_r(0, pos, delta) != CONTENTS_SKY)
-						continue; // occluded
-
 					VectorScale(l->intensity, dot, add);
 				}
 				else
@@ -1129,38 +1182,58 @@ void GatherSampleLight(vec3_t pos, byte* pvs, vec3_t normal, vec3_t* sample, byt
 
 				if (VectorMaximum(add) > (l->style ? coring : 0))
 				{
-					if (l->type != emittype_t::skylight && TestLine_r(0, pos, l->origin) != CONTENTS_EMPTY)
-						continue; // occluded
+					samplelight_t& candidate = samplelights.emplace_back();
+					candidate.light = l;
+					VectorCopy(add, candidate.add);
 
-
-					for (style_index = 0; style_index < MAXLIGHTMAPS; style_index++)
-						if (styles[style_index] == l->style || styles[style_index] == 255)
-							break;
-
-					if (style_index == MAXLIGHTMAPS)
+					if (l->type == emittype_t::skylight)
 					{
-						printf("WARNING: Too many direct light styles on a face(%f,%f,%f)\n",
-							pos[0], pos[1], pos[2]);
-						continue;
+						// search back to see if we can hit a sky brush
+						VectorScale(l->normal, -10000, delta);
+						VectorAdd(pos, delta, delta);
+						AddSampleLightRay(pos, delta);
+						candidate.needcontents = CONTENTS_SKY;
+					}
+					else
+					{
+						AddSampleLightRay(pos, l->origin);
+						candidate.needcontents = CONTENTS_EMPTY;
 					}
-
-					if (styles[style_index] == 255)
-						styles[style_index] = l->style;
-
-					VectorAdd(sample[style_index], add, sample[style_index]);
 				}
 			}
 		}
 	}
+
+	TestSampleLightRays();
+
+	// Add in the original order so styles are assigned to lightmap slots the same way
+	for (size_t light = 0; light < samplelights.size(); light++)
+	{
+		const samplelight_t& candidate = samplelights[light];
+
+		if (sampleresults[light] != candidate.needcontents)
+			continue; // occluded
+
+		style_index = FindSampleStyle(pos, styles, candidate.light->style);
+
+		if (style_index == -1)
+			continue;
+
+		VectorAdd(sample[style_index], candidate.add, sample[style_index]);
+	}
+
 	if (sky_used && indirect_sun != 0.0)
 	{
 		vec3_t total;
 		int j;
 		vec3_t sky_intensity;
+		float dots[NUMVERTEXNORMALS];
 
 		VectorScale(sky_used->intensity, indirect_sun / (NUMVERTEXNORMALS * 2), sky_intensity);
 
-		total[0] = total[1] = total[2] = 0.0;
+		samplestarts.clear();
+		samplestops.clear();
+
 		for (j = 0; j < NUMVERTEXNORMALS; j++)
 		{
 			// make sure the angle is okay
@@ -1168,30 +1241,31 @@ void GatherSampleLight(vec3_t pos, byte* pvs, vec3_t normal, vec3_t* sample, byt
 			if (dot <= ON_EPSILON / 10)
 				continue;
 
+			dots[samplestarts.size() / 3] = dot;
+
 			// search back to see if we can hit a sky brush
 			VectorScale(r_avertexnormals[j], -10000, delta);
 			VectorAdd(pos, delta, delta);
-			if (TestLine_r(0, pos, delta) != CONTENTS_SKY)
+			AddSampleLightRay(pos, delta);
+		}
+
+		const int count = TestSampleLightRays();
+
+		total[0] = total[1] = total[2] = 0.0;
+		for (j = 0; j < count; j++)
+		{
+			if (sampleresults[j] != CONTENTS_SKY)
 				continue; // occluded
 
-			VectorScale(sky_intensity, dot, add);
+			VectorScale(sky_intensity, dots[j], add);
 			VectorAdd(total, add, total);
 		}
 		if (VectorMaximum(total) > 0)
 		{
-			for (style_index = 0; style_index < MAXLIGHTMAPS; style_index++)
-				if (styles[style_index] == sky_used->style || styles[style_index] == 255)
-					break;
+			style_index = FindSampleStyle(pos, styles, sky_used->style);
 
-			if (style_index == MAXLIGHTMAPS)
-			{
-				printf("WARNING: Too many direct light styles on a face(%f,%f,%f)\n",
-					pos[0], pos[1], pos[2]);
+			if (style_index == -1)
 				return;
-			}
-
-			if (styles[style_index] == 255)
-				styles[style_index] = sky_used->style;
 
 			VectorAdd(sample[style_index], total, sample[style_index]);
 		}
@@ -37,8 +37,6 @@ float maxchop = 64;
 float minchop = 64;
 qboolean dumppatches;
 
-int TestLine(vec3_t start, vec3_t stop);
-
 int junk;
 
 vec3_t ambient = {0, 0, 0};
@@ -667,6 +665,53 @@ void SubdividePatches(void)
 
 //=====================================================================
 
+/*
+=============
+ComputeTransfer
+
+Returns how much of the light leaving patch is collected by patch2,
+scaled to the 16 bit range but not yet normalized. send is set to the
+fraction of patch's light that patch2 receives, used to normalize.
+=============
+*/
+float ComputeTransfer(patch_t* patch, patch_t* patch2, float* send)
+{
+	vec3_t delta;
+	vec_t dist, scale;
+	float trans;
+
+	// calculate transferemnce
+	VectorSubtract(patch2->origin, patch->origin, delta);
+	dist = VectorNormalize(delta);
+
+	// skys don't care about the interface angle, but everything
+	// else does
+	if (!patch->sky)
+		scale = DotProduct(delta, patch->normal);
+	else
+		scale = 1;
+
+	scale *= -DotProduct(delta, patch2->normal);
+
+	trans = scale / (dist * dist);
+
+	if (trans < -ON_EPSILON)
+		Error("transfer < 0");
+	*send = trans * patch2->area;
+	if (*send > 0.4f)
+	{
+		trans = 0.4f / patch2->area;
+		*send = 0.4f;
+	}
+
+	// scale to 16 bit
+	trans = trans * patch->area * INVERSE_TRANSFER_SCALE;
+	if (trans >= 0x10000)
+		trans = 0xffff;
+
+	return trans;
+}
+
 /*
 =============
 MakeScales
@@ -681,15 +726,10 @@ void MakeScales(int /*threadnum*/)
 {
 	int i;
 	unsigned j;
-	vec3_t delta;
-	vec_t dist, scale;
 	int count;
 	float trans;
 	patch_t *patch, *patch2;
 	float total, send;
-	dplane_t plane;
-	vec3_t origin;
-	vec_t area;
 	transfer_t transfers[MAX_PATCHES], *all_transfers;
 
 	count = 0;
@@ -705,12 +745,6 @@ void MakeScales(int /*threadnum*/)
 		total = 0;
 		patch->numtransfers = 0;
 
-		VectorCopy(patch->origin, origin);
-		plane = *patch->plane;
-		plane.dist = PatchPlaneDist(patch);
-
-		area = patch->area;
-
 		// find out which patch2's will collect light
 		// from patch
 
@@ -720,36 +754,9 @@ void MakeScales(int /*threadnum*/)
 			if (!CheckVisBit(i, j))
 				continue;
 
-			// calculate transferemnce
-			VectorSubtract(patch2->origin, origin, delta);
-			dist = VectorNormalize(delta);
-
-			// skys don't care about the interface angle, but everything
-			// else does
-			if (!patch->sky)
-				scale = DotProduct(delta, patch->normal);
-			else
-				scale = 1;
-
-			scale *= -DotProduct(delta, patch2->normal);
-
-			trans = scale / (dist * dist);
-
-			if (trans < -ON_EPSILON)
-				Error("transfer < 0");
-			send = trans * patch2->area;
-			if (send > 0.4f)
-			{
-				trans = 0.4f / patch2->area;
-				send = 0.4f;
-			}
+			trans = ComputeTransfer(patch, patch2, &send);
 			total += send;
 
-
-			// scale to 16 bit
-			trans = trans * area * INVERSE_TRANSFER_SCALE;
-			if (trans >= 0x10000)
-				trans = 0xffff;
 			if (!trans)
 				continue;
 			all_transfers->transfer = (unsigned short)trans;
@@ -957,6 +964,12 @@ void GatherLight(int /*threadnum*/)
 		if (j == -1)
 			break;
 
+		if (sparsetransfers)
+		{
+			GatherSparseLight(j, addlight[j]);
+			continue;
+		}
+
 		patch = &patches[j];
 
 		trans = patch->transfers;
@@ -1148,6 +1161,12 @@ long readtransfers(char* transferfile, long numpatches)
 
 void MakeAllScales(void)
 {
+	if (sparsetransfers)
+	{
+		MakeSparseTransfers();
+		return;
+	}
+
 	strcpy(g_transferfile, source);
 	StripExtension(g_transferfile);
 	DefaultExtension(g_transferfile, ".r2");
@@ -1180,6 +1199,7 @@ void RadWorld(void)
 	MakeBackplanes();
 	MakeParents(0, -1);
 	MakeTnodes();
+	MakeTraceBVH();
 
 	// turn each face into a single patch
 	MakePatches();
@@ -1206,11 +1226,16 @@ void RadWorld(void)
 		MakeAllScales();
 
 		// invert the transfers for gather vs scatter
-		RunThreadsOnIndividual(num_patches, true, SwapTransfersTask);
+		// sparse transfers are written out already inverted
+		if (!sparsetransfers)
+			RunThreadsOnIndividual(num_patches, true, SwapTransfersTask);
 
 		// spread light around
 		BounceLight();
 
+		if (sparsetransfers)
+			FreeSparseTransfers();
+
 		for (unsigned int i = 0; i < num_patches; i++)
 			if (!VectorCompare(patches[i].directlight, vec3_origin))
 				VectorSubtract(patches[i].totallight, patches[i].directlight, patches[i].totallight);
@@ -1463,6 +1488,14 @@ int main(int argc, char** argv)
 		{
 			texscale = false;
 		}
+		else if (!strcmp(argv[i], "-bsptrace"))
+		{
+			bsptrace = true;
+		}
+		else if (!strcmp(argv[i], "-sparse"))
+		{
+			sparsetransfers = true;
+		}
 		else
 		{
 			break;
@@ -1475,7 +1508,7 @@ int main(int argc, char** argv)
 		maxlight = 255;
 
 	if (i != argc - 1)
-		Error("usage: qrad [-dump] [-inc] [-bounce n] [-threads n] [-verbose] [-terse] [-chop n] [-maxchop n] [-scale n] [-ambient red green blue] [-proj file] [-maxlight n] [-threads n] [-lights file] [-gamma n] [-dlight n] [-extra] [-smooth n] [-coring n] [-notexscale] bspfile");
+		Error("usage: qrad [-dump] [-inc] [-bounce n] [-threads n] [-verbose] [-terse] [-chop n] [-maxchop n] [-scale n] [-ambient red green blue] [-proj file] [-maxlight n] [-threads n] [-lights file] [-gamma n] [-dlight n] [-extra] [-smooth n] [-coring n] [-notexscale] [-bsptrace] [-sparse] bspfile");
 
 	start = I_FloatTime();
 
@@ -1544,6 +1577,7 @@ int main(int argc, char** argv)
 
 	end = I_FloatTime();
 	printf("%5.0f seconds elapsed\n", end - start);
+	ThreadPrintPhaseTimes();
 
 	return 0;
 }
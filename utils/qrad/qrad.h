@@ -120,6 +120,14 @@ _int64 getfreespace(char* filepath);
 long getfilesize(char* filename);
 time_t getfiletime(char* filename);
 
+float ComputeTransfer(patch_t* patch, patch_t* patch2, float* send);
+
+extern qboolean sparsetransfers;
+
+void MakeSparseTransfers(void);
+void GatherSparseLight(int patchnum, vec3_t sum);
+void FreeSparseTransfers(void);
+
 void BuildVisMatrix(void);
 void FreeVisMatrix(void);
 qboolean CheckVisBit(int p1, int p2);
@@ -147,6 +155,12 @@ void PrecompLightmapOffsets();
 void FinalLightFace(int facenum);
 void PvsForOrigin(vec3_t org, byte* pvs);
 int TestLine_r(int node, vec3_t start, vec3_t stop);
+
+extern qboolean bsptrace;
+
+void MakeTraceBVH();
+int TestLine(vec3_t start, vec3_t stop);
+void TestLines(int count, const vec3_t* starts, const vec3_t* stops, int* results);
 void CreateDirectLights(void);
 void DeleteDirectLights(void);
 int ProgressiveRefinement(void);
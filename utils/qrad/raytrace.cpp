@@ -0,0 +1,524 @@
+/***
+ *
+ *	Copyright (c) 1996-2002, Valve LLC. All rights reserved.
+ *
+ *	This product contains software technology licensed from Id
+ *	Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *	All Rights Reserved.
+ *
+ ****/
+
+// raytrace.cpp
+
+#include <algorithm>
+#include <cfloat>
+#include <vector>
+
+#include <xmmintrin.h>
+
+#include "qrad.h"
+
+/*
+==============================================================================
+
+BVH LINE TRACING
+
+Every solid and sky leaf of the world BSP is a convex volume bounded by the
+planes on the path from the root node to it. Those volumes are put in a
+bounding volume hierarchy and lines are traced against it four at a time,
+testing the node bounds of all four lines at once with SSE.
+
+A line hits a volume where it enters the last of its bounding half spaces.
+The first volume entered gives the same contents as TestLine_r, the
+original BSP walk that is kept as a reference mode (-bsptrace).
+
+==============================================================================
+*/
+
+qboolean bsptrace = false;
+
+typedef struct
+{
+	vec3_t normal; // points out of the volume
+	float dist;
+} traceplane_t;
+
+typedef struct
+{
+	int firstplane;
+	int numplanes;
+	int contents;
+	vec3_t mins, maxs;
+	vec3_t center;
+} traceprim_t;
+
+typedef struct
+{
+	float mins[3];
+	int first; // child index for interior nodes, first primitive for leaves
+	float maxs[3];
+	int count; // 0 for interior nodes
+} bvhnode_t;
+
+static std::vector<traceplane_t> traceplanes;
+static std::vector<traceprim_t> traceprims;
+static std::vector<bvhnode_t> bvhnodes;
+
+static vec3_t worldmins, worldmaxs;
+
+#define BVH_LEAF_SIZE 4
+#define BVH_MAX_DEPTH 64
+
+// Volumes extend past the world's bounds by this much so lines leaving the world still hit something
+#define WORLD_BOUNDS_PADDING 64
+
+/*
+==============
+AddLeafVolumes
+
+Collects the bounding planes of every solid and sky leaf below a node
+==============
+*/
+static void AddLeafVolumes(int nodenum, std::vector<traceplane_t>& path)
+{
+	const dnode_t* node = dnodes + nodenum;
+	const dplane_t* plane = dplanes + node->planenum;
+
+	for (int side = 0; side < 2; side++)
+	{
+		traceplane_t bound;
+
+		// The front child is in front of the plane, so its outward normal faces the other way
+		if (side == 0)
+		{
+			VectorSubtract(vec3_origin, plane->normal, bound.normal);
+			bound.dist = -plane->dist;
+		}
+		else
+		{
+			VectorCopy(plane->normal, bound.normal);
+			bound.dist = plane->dist;
+		}
+
+		path.push_back(bound);
+
+		const int child = node->children[side];
+
+		if (child >= 0)
+		{
+			AddLeafVolumes(child, path);
+		}
+		else
+		{
+			const int contents = dleafs[-child - 1].contents;
+
+			if (contents == CONTENTS_SOLID || contents == CONTENTS_SKY)
+			{
+				traceprim_t prim;
+				prim.firstplane = static_cast<int>(traceplanes.size());
+				prim.numplanes = static_cast<int>(path.size());
+				prim.contents = contents;
+
+				traceplanes.insert(traceplanes.end(), path.begin(), path.end());
+				traceprims.push_back(prim);
+			}
+		}
+
+		path.pop_back();
+	}
+}
+
+/*
+==============
+MakeVolumeBounds
+
+Finds the bounds of a leaf volume by clipping each of its faces against the rest
+==============
+*/
+static void MakeVolumeBounds(int primnum)
+{
+	traceprim_t* prim = &traceprims[primnum];
+	const traceplane_t* planes = &traceplanes[prim->firstplane];
+
+	// The world box is added as six extra bounding planes
+	traceplane_t boxplanes[6];
+
+	for (int i = 0; i < 3; i++)
+	{
+		VectorCopy(vec3_origin, boxplanes[i * 2].normal);
+		boxplanes[i * 2].normal[i] = 1;
+		boxplanes[i * 2].dist = worldmaxs[i];
+
+		VectorCopy(vec3_origin, boxplanes[i * 2 + 1].normal);
+		boxplanes[i * 2 + 1].normal[i] = -1;
+		boxplanes[i * 2 + 1].dist = -worldmins[i];
+	}
+
+	const int totalplanes = prim->numplanes + 6;
+
+	auto getplane = [&](int index) -> const traceplane_t&
+	{
+		return index < prim->numplanes ? planes[index] : boxplanes[index - prim->numplanes];
+	};
+
+	ClearBounds(prim->mins, prim->maxs);
+
+	for (int i = 0; i < totalplanes; i++)
+	{
+		const traceplane_t& face = getplane(i);
+
+		winding_t* w = BaseWindingForPlane(const_cast<vec_t*>(face.normal), face.dist);
+
+		for (int j = 0; j < totalplanes && w; j++)
+		{
+			if (j == i)
+				continue;
+
+			const traceplane_t& clip = getplane(j);
+
+			// Keep the part inside the volume
+			vec3_t normal;
+			VectorSubtract(vec3_origin, clip.normal, normal);
+			w = ChopWinding(w, normal, -clip.dist);
+		}
+
+		if (!w)
+			continue;
+
+		for (int j = 0; j < w->numpoints; j++)
+			AddPointToBounds(w->points[j], prim->mins, prim->maxs);
+
+		FreeWinding(w);
+	}
+
+	for (int i = 0; i < 3; i++)
+	{
+		prim->mins[i] -= 1;
+		prim->maxs[i] += 1;
+		prim->center[i] = (prim->mins[i] + prim->maxs[i]) * 0.5f;
+	}
+}
+
+/*
+==============
+BuildBVHNode
+
+Fills in a node, splitting its primitives at the median of the longest axis of their centers
+==============
+*/
+static void BuildBVHNode(int nodenum, int first, int count, int depth)
+{
+	vec3_t mins, maxs, centermins, centermaxs;
+	ClearBounds(mins, maxs);
+	ClearBounds(centermins, centermaxs);
+
+	for (int i = first; i < first + count; i++)
+	{
+		AddPointToBounds(traceprims[i].mins, mins, maxs);
+		AddPointToBounds(traceprims[i].maxs, mins, maxs);
+		AddPointToBounds(traceprims[i].center, centermins, centermaxs);
+	}
+
+	VectorCopy(mins, bvhnodes[nodenum].mins);
+	VectorCopy(maxs, bvhnodes[nodenum].maxs);
+
+	if (count <= BVH_LEAF_SIZE || depth >= BVH_MAX_DEPTH - 1)
+	{
+		bvhnodes[nodenum].first = first;
+		bvhnodes[nodenum].count = count;
+		return;
+	}
+
+	int axis = 0;
+
+	for (int i = 1; i < 3; i++)
+	{
+		if (centermaxs[i] - centermins[i] > centermaxs[axis] - centermins[axis])
+			axis = i;
+	}
+
+	const int half = count / 2;
+
+	std::nth_element(traceprims.begin() + first, traceprims.begin() + first + half, traceprims.begin() + first + count,
+		[axis](const traceprim_t& lhs, const traceprim_t& rhs)
+		{ return lhs.center[axis] < rhs.center[axis]; });
+
+	// Children are always stored next to each other
+	const int children = static_cast<int>(bvhnodes.size());
+	bvhnodes.resize(bvhnodes.size() + 2);
+
+	bvhnodes[nodenum].first = children;
+	bvhnodes[nodenum].count = 0;
+
+	BuildBVHNode(children, first, half, depth + 1);
+	BuildBVHNode(children + 1, first + half, count - half, depth + 1);
+}
+
+/*
+==============
+MakeTraceBVH
+
+Builds the line tracing hierarchy for the world
+==============
+*/
+void MakeTraceBVH()
+{
+	traceplanes.clear();
+	traceprims.clear();
+	bvhnodes.clear();
+
+	if (bsptrace)
+		return;
+
+	for (int i = 0; i < 3; i++)
+	{
+		worldmins[i] = dmodels[0].mins[i] - WORLD_BOUNDS_PADDING;
+		worldmaxs[i] = dmodels[0].maxs[i] + WORLD_BOUNDS_PADDING;
+	}
+
+	std::vector<traceplane_t> path;
+	AddLeafVolumes(dmodels[0].headnode[0], path);
+
+	RunThreadsOnIndividual(static_cast<int>(traceprims.size()), true, MakeVolumeBounds);
+
+	// Drop volumes that lie entirely outside the world box
+	traceprims.erase(std::remove_if(traceprims.begin(), traceprims.end(), [](const traceprim_t& prim)
+						 { return prim.mins[0] > prim.maxs[0]; }),
+		traceprims.end());
+
+	if (traceprims.empty())
+		return;
+
+	bvhnodes.reserve(traceprims.size() / BVH_LEAF_SIZE * 4);
+	bvhnodes.resize(1);
+	BuildBVHNode(0, 0, static_cast<int>(traceprims.size()), 0);
+
+	qprintf("%i trace volumes, %i planes, %i bvh nodes\n",
+		static_cast<int>(traceprims.size()), static_cast<int>(traceplanes.size()), static_cast<int>(bvhnodes.size()));
+}
+
+/*
+==============
+ClipToVolume
+
+Returns the fraction along the line at which it enters the volume, or a value > 1 if it misses
+==============
+*/
+static float ClipToVolume(const traceprim_t* prim, const float* start, const float* delta, float maxfrac)
+{
+	float enter = 0;
+	float leave = maxfrac;
+
+	const traceplane_t* plane = &traceplanes[prim->firstplane];
+
+	for (int i = 0; i < prim->numplanes; i++, plane++)
+	{
+		// Shrink the volume slightly so lines grazing a surface behave like TestLine_r
+		const float d1 = DotProduct(start, plane->normal) - plane->dist + ON_EPSILON;
+		const float dd = DotProduct(delta, plane->normal);
+		const float d2 = d1 + dd;
+
+		if (d1 > 0 && d2 > 0)
+			return 2;
+
+		if (d1 <= 0 && d2 <= 0)
+			continue;
+
+		const float frac = d1 / (d1 - d2);
+
+		if (d1 > 0)
+		{
+			if (frac > enter)
+				enter = frac;
+		}
+		else if (frac < leave)
+			leave = frac;
+
+		if (enter > leave)
+			return 2;
+	}
+
+	return enter;
+}
+
+/*
+==============
+TraceLinePacket
+
+Traces up to four lines through the hierarchy together
+==============
+*/
+static void TraceLinePacket(int count, const vec3_t* starts, const vec3_t* stops, int* results)
+{
+	alignas(16) float ox[4], oy[4], oz[4];
+	alignas(16) float ix[4], iy[4], iz[4];
+	alignas(16) float maxfrac[4];
+	vec3_t deltas[4];
+
+	for (int i = 0; i < 4; i++)
+	{
+		const int src = i < count ? i : count - 1;
+
+		VectorSubtract(stops[src], starts[src], deltas[i]);
+
+		ox[i] = starts[src][0];
+		oy[i] = starts[src][1];
+		oz[i] = starts[src][2];
+
+		auto inverse = [](float value)
+		{
+			if (fabs(value) < 1e-20f)
+				value = value < 0 ? -1e-20f : 1e-20f;
+			return 1.0f / value;
+		};
+
+		ix[i] = inverse(deltas[i][0]);
+		iy[i] = inverse(deltas[i][1]);
+		iz[i] = inverse(deltas[i][2]);
+
+		// Padding lanes never hit anything
+		maxfrac[i] = i < count ? 1.0f : -1.0f;
+		results[i] = CONTENTS_EMPTY;
+	}
+
+	const __m128 originx = _mm_load_ps(ox);
+	const __m128 originy = _mm_load_ps(oy);
+	const __m128 originz = _mm_load_ps(oz);
+	const __m128 invx = _mm_load_ps(ix);
+	const __m128 invy = _mm_load_ps(iy);
+	const __m128 invz = _mm_load_ps(iz);
+	const __m128 zero = _mm_setzero_ps();
+
+	int stack[BVH_MAX_DEPTH * 2];
+	int stackdepth = 0;
+
+	stack[stackdepth++] = 0;
+
+	while (stackdepth > 0)
+	{
+		const bvhnode_t* node = &bvhnodes[stack[--stackdepth]];
+
+		// Slab test of all four lines against the node bounds
+		const __m128 tmax = _mm_load_ps(maxfrac);
+
+		__m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node->mins[0]), originx), invx);
+		__m128 t2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node->maxs[0]), originx), invx);
+		__m128 tnear = _mm_min_ps(t1, t2);
+		__m128 tfar = _mm_max_ps(t1, t2);
+
+		t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node->mins[1]), originy), invy);
+		t2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node->maxs[1]), originy), invy);
+		tnear = _mm_max_ps(tnear, _mm_min_ps(t1, t2));
+		tfar = _mm_min_ps(tfar, _mm_max_ps(t1, t2));
+
+		t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node->mins[2]), originz), invz);
+		t2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node->maxs[2]), originz), invz);
+		tnear = _mm_max_ps(tnear, _mm_min_ps(t1, t2));
+		tfar = _mm_min_ps(tfar, _mm_max_ps(t1, t2));
+
+		tnear = _mm_max_ps(tnear, zero);
+		tfar = _mm_min_ps(tfar, tmax);
+
+		const int active = _mm_movemask_ps(_mm_cmple_ps(tnear, tfar));
+
+		if (!active)
+			continue;
+
+		if (node->count == 0)
+		{
+			// Visit the child nearest to the first active line first so lines get shortened sooner
+			int lane = 0;
+			while (!(active & (1 << lane)))
+				lane++;
+
+			const bvhnode_t* children = &bvhnodes[node->first];
+
+			vec3_t leftcenter, rightcenter;
+			VectorAdd(children[0].mins, children[0].maxs, leftcenter);
+			VectorAdd(children[1].mins, children[1].maxs, rightcenter);
+
+			vec3_t between;
+			VectorSubtract(rightcenter, leftcenter, between);
+
+			const bool rightfirst = DotProduct(between, deltas[lane]) < 0;
+
+			stack[stackdepth++] = node->first + (rightfirst ? 0 : 1);
+			stack[stackdepth++] = node->first + (rightfirst ? 1 : 0);
+			continue;
+		}
+
+		for (int i = node->first; i < node->first + node->count; i++)
+		{
+			const traceprim_t* prim = &traceprims[i];
+
+			for (int lane = 0; lane < count; lane++)
+			{
+				if (!(active & (1 << lane)) || maxfrac[lane] < 0)
+					continue;
+
+				const float frac = ClipToVolume(prim, starts[lane], deltas[lane], maxfrac[lane]);
+
+				if (frac <= maxfrac[lane])
+				{
+					maxfrac[lane] = frac;
+					results[lane] = prim->contents;
+				}
+			}
+		}
+	}
+}
+
+/*
+==============
+TestLines
+
+Traces a batch of lines and stores the contents of the first solid or sky
+volume each one enters, or CONTENTS_EMPTY if there is none
+==============
+*/
+void TestLines(int count, const vec3_t* starts, const vec3_t* stops, int* results)
+{
+	if (bsptrace)
+	{
+		for (int i = 0; i < count; i++)
+			results[i] = TestLine_r(0, const_cast<vec_t*>(starts[i]), const_cast<vec_t*>(stops[i]));
+		return;
+	}
+
+	if (bvhnodes.empty())
+	{
+		for (int i = 0; i < count; i++)
+			results[i] = CONTENTS_EMPTY;
+		return;
+	}
+
+	for (int i = 0; i < count; i += 4)
+	{
+		int packet[4];
+		const int packetcount = count - i < 4 ? count - i : 4;
+
+		TraceLinePacket(packetcount, starts + i, stops + i, packet);
+
+		for (int j = 0; j < packetcount; j++)
+			results[i + j] = packet[j];
+	}
+}
+
+/*
+==============
+TestLine
+
+Traces a single line using the selected tracing mode
+==============
+*/
+int TestLine(vec3_t start, vec3_t stop)
+{
+	vec3_t line[2];
+	int result;
+
+	VectorCopy(start, line[0]);
+	VectorCopy(stop, line[1]);
+
+	TestLines(1, &line[0], &line[1], &result);
+	return result;
+}
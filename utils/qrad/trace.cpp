@@ -176,11 +176,6 @@ int TestLine_r(int node, vec3_t start, vec3_t stop)
 	return TestLine_r(tnode->children[!side], mid, stop);
 }
 
-int TestLine(vec3_t start, vec3_t stop)
-{
-	return TestLine_r(0, start, stop);
-}
-
 /*
 ==============================================================================
 
@@ -0,0 +1,414 @@
+/***
+ *
+ *	Copyright (c) 1996-2002, Valve LLC. All rights reserved.
+ *
+ *	This product contains software technology licensed from Id
+ *	Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc.
+ *	All Rights Reserved.
+ *
+ ****/
+
+// transfers.cpp
+
+#include <vector>
+
+#include "qrad.h"
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+/*
+===================================================================
+
+SPARSE TRANSFERS
+
+With -sparse the transfer lists never live in memory. Each patch's
+gathering list is computed directly in its swapped form and appended to
+a file as blocks of delta encoded patch indices, each followed by its
+weight. Both are written as varints, so small weights take one byte.
+The file is then memory mapped, so a bounce pass only needs the pages
+of the list currently being gathered.
+
+Computing the swapped form directly needs the normalization total of
+every sending patch first, so the visibility matrix is walked twice.
+
+===================================================================
+*/
+
+qboolean sparsetransfers = false;
+
+extern char source[MAX_PATH];
+extern char incrementfile[_MAX_PATH];
+extern qboolean incremental;
+extern int total_transfer;
+extern vec3_t emitlight[MAX_PATCHES];
+
+#define SPARSE_IDENT (('F' << 24) + ('T' << 16) + ('R' << 8) + 'Q')
+#define SPARSE_VERSION 1
+
+// Patch indices restart from an absolute value every this many transfers
+#define SPARSE_BLOCK_SIZE 64
+
+typedef struct
+{
+	int ident;
+	int version;
+	int numpatches;
+	int blocksize;
+	long long indexofs;
+} sparseheader_t;
+
+typedef struct
+{
+	long long offset;
+	int numtransfers;
+	int size;
+} sparseindex_t;
+
+static char sparsefile[_MAX_PATH];
+static FILE* sparseout;
+static long long sparseofs;
+static sparseindex_t sparseindex[MAX_PATCHES];
+static float sendtotals[MAX_PATCHES];
+
+static const byte* sparsemap;
+static long long sparsemapsize;
+static const sparseindex_t* mappedindex;
+
+#ifdef WIN32
+static HANDLE sparsefilehandle = INVALID_HANDLE_VALUE;
+static HANDLE sparsemaphandle;
+#else
+static int sparsefiledesc = -1;
+#endif
+
+static void WriteVarInt(std::vector<byte>& out, unsigned value)
+{
+	while (value >= 0x80)
+	{
+		out.push_back((byte)(value | 0x80));
+		value >>= 7;
+	}
+
+	out.push_back((byte)value);
+}
+
+static unsigned ReadVarInt(const byte*& in)
+{
+	unsigned value = 0;
+	int shift = 0;
+
+	while (*in & 0x80)
+	{
+		value |= (unsigned)(*in++ & 0x7f) << shift;
+		shift += 7;
+	}
+
+	value |= (unsigned)(*in++) << shift;
+
+	return value;
+}
+
+/*
+=============
+SparseTotalsTask
+
+Sums the light each patch sends out, as MakeScales does before normalizing
+=============
+*/
+static void SparseTotalsTask(int patchnum)
+{
+	patch_t* patch = patches + patchnum;
+	patch_t* patch2;
+	unsigned j;
+	float total = 0, send;
+
+	for (j = 0, patch2 = patches; j < num_patches; j++, patch2++)
+	{
+		if (!CheckVisBit(patchnum, j))
+			continue;
+
+		ComputeTransfer(patch, patch2, &send);
+		total += send;
+	}
+
+	sendtotals[patchnum] = total;
+}
+
+/*
+=============
+SparseTransfersTask
+
+Builds the gathering list for a patch, matching MakeScales followed by SwapTransfersTask
+=============
+*/
+static void SparseTransfersTask(int patchnum)
+{
+	static thread_local std::vector<byte> encoded;
+
+	patch_t* patch = patches + patchnum;
+	patch_t* patch2;
+	unsigned j;
+	float send;
+	int numtransfers = 0;
+	unsigned lastpatch = 0;
+
+	encoded.clear();
+
+	for (j = 0, patch2 = patches; j < num_patches; j++, patch2++)
+	{
+		if (!CheckVisBit(patchnum, j))
+			continue;
+
+		const float trans = ComputeTransfer(patch, patch2, &send);
+
+		if (!trans)
+			continue;
+
+		// Swapped lists gather what patch2 sends to this patch,
+		// unless patch2 has no transfer back to swap with
+		unsigned short transfer;
+		const float transback = ComputeTransfer(patch2, patch, &send);
+
+		if (transback)
+			transfer = (unsigned short)((unsigned short)transback * (0.5f / sendtotals[j]));
+		else
+			transfer = (unsigned short)((unsigned short)trans * (0.5f / sendtotals[patchnum]));
+
+		if (numtransfers % SPARSE_BLOCK_SIZE == 0)
+			WriteVarInt(encoded, j);
+		else
+			WriteVarInt(encoded, j - lastpatch);
+
+		WriteVarInt(encoded, transfer);
+
+		lastpatch = j;
+		++numtransfers;
+	}
+
+	ThreadLock();
+
+	sparseindex[patchnum].offset = sparseofs;
+	sparseindex[patchnum].numtransfers = numtransfers;
+	sparseindex[patchnum].size = (int)encoded.size();
+
+	if (!encoded.empty())
+		SafeWrite(sparseout, encoded.data(), (int)encoded.size());
+
+	sparseofs += encoded.size();
+	total_transfer += numtransfers;
+
+	ThreadUnlock();
+}
+
+/*
+=============
+MapSparseTransfers
+
+Maps the transfer file, returns false if it is missing or doesn't match this map
+=============
+*/
+static qboolean MapSparseTransfers(void)
+{
+#ifdef WIN32
+	LARGE_INTEGER size;
+
+	sparsefilehandle = CreateFile(sparsefile, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, NULL);
+
+	if (sparsefilehandle == INVALID_HANDLE_VALUE)
+		return false;
+
+	if (!GetFileSizeEx(sparsefilehandle, &size) || size.QuadPart < (long long)sizeof(sparseheader_t))
+	{
+		FreeSparseTransfers();
+		return false;
+	}
+
+	sparsemapsize = size.QuadPart;
+
+	if (sparsemaphandle = CreateFileMapping(sparsefilehandle, NULL, PAGE_READONLY, 0, 0, NULL); !sparsemaphandle)
+	{
+		FreeSparseTransfers();
+		return false;
+	}
+
+	sparsemap = reinterpret_cast<const byte*>(MapViewOfFile(sparsemaphandle, FILE_MAP_READ, 0, 0, 0));
+#else
+	sparsefiledesc = open(sparsefile, O_RDONLY);
+
+	if (sparsefiledesc == -1)
+		return false;
+
+	sparsemapsize = lseek(sparsefiledesc, 0, SEEK_END);
+
+	if (sparsemapsize < (long long)sizeof(sparseheader_t))
+	{
+		FreeSparseTransfers();
+		return false;
+	}
+
+	void* map = mmap(NULL, sparsemapsize, PROT_READ, MAP_SHARED, sparsefiledesc, 0);
+	sparsemap = map != MAP_FAILED ? reinterpret_cast<const byte*>(map) : NULL;
+#endif
+
+	if (!sparsemap)
+	{
+		FreeSparseTransfers();
+		return false;
+	}
+
+	const sparseheader_t* header = reinterpret_cast<const sparseheader_t*>(sparsemap);
+
+	if (header->ident != SPARSE_IDENT || header->version != SPARSE_VERSION || header->numpatches != (int)num_patches || header->blocksize != SPARSE_BLOCK_SIZE || header->indexofs + (long long)(num_patches * sizeof(sparseindex_t)) > sparsemapsize)
+	{
+		FreeSparseTransfers();
+		return false;
+	}
+
+	mappedindex = reinterpret_cast<const sparseindex_t*>(sparsemap + header->indexofs);
+
+	return true;
+}
+
+/*
+=============
+MakeSparseTransfers
+
+Builds the transfer file (or reuses it for incremental runs) and maps it
+=============
+*/
+void MakeSparseTransfers(void)
+{
+	int i;
+
+	strcpy(sparsefile, source);
+	StripExtension(sparsefile);
+	DefaultExtension(sparsefile, ".r3");
+
+	total_transfer = 0;
+
+	if (incremental && IsIncremental(incrementfile) && MapSparseTransfers())
+	{
+		for (i = 0; i < (int)num_patches; i++)
+			total_transfer += mappedindex[i].numtransfers;
+
+		qprintf("Restored [%s]\n", sparsefile);
+	}
+	else
+	{
+		sparseheader_t header;
+
+		// determine visibility between patches
+		BuildVisMatrix();
+
+		RunThreadsOnIndividual(num_patches, true, SparseTotalsTask);
+
+		sparseout = SafeOpenWrite(sparsefile);
+
+		memset(&header, 0, sizeof(header));
+		SafeWrite(sparseout, &header, sizeof(header));
+		sparseofs = sizeof(header);
+
+		RunThreadsOnIndividual(num_patches, true, SparseTransfersTask);
+
+		// release visibility matrix
+		FreeVisMatrix();
+
+		// Keep the index aligned
+		while (sparseofs % sizeof(long long))
+		{
+			fputc(0, sparseout);
+			++sparseofs;
+		}
+
+		header.ident = SPARSE_IDENT;
+		header.version = SPARSE_VERSION;
+		header.numpatches = num_patches;
+		header.blocksize = SPARSE_BLOCK_SIZE;
+		header.indexofs = sparseofs;
+
+		SafeWrite(sparseout, sparseindex, num_patches * sizeof(sparseindex_t));
+
+		fseek(sparseout, 0, SEEK_SET);
+		SafeWrite(sparseout, &header, sizeof(header));
+		fclose(sparseout);
+		sparseout = NULL;
+
+		if (!MapSparseTransfers())
+			Error("Couldn't map %s", sparsefile);
+	}
+
+	qprintf("transfer lists: %5.1f megs (%5.1f megs uncompressed)\n",
+		(double)(sparsemapsize) / (1024 * 1024), (double)total_transfer * sizeof(transfer_t) / (1024 * 1024));
+}
+
+/*
+=============
+GatherSparseLight
+
+Sums the light a patch collects from the mapped transfer lists
+=============
+*/
+void GatherSparseLight(int patchnum, vec3_t sum)
+{
+	const sparseindex_t* index = &mappedindex[patchnum];
+	const byte* in = sparsemap + index->offset;
+	unsigned patch2 = 0;
+	vec3_t v;
+
+	VectorFill(sum, 0);
+
+	for (int k = 0; k < index->numtransfers; k++)
+	{
+		if (k % SPARSE_BLOCK_SIZE == 0)
+			patch2 = ReadVarInt(in);
+		else
+			patch2 += ReadVarInt(in);
+
+		const unsigned transfer = ReadVarInt(in);
+
+		VectorScale(emitlight[patch2], transfer, v);
+		VectorAdd(sum, v, sum);
+	}
+}
+
+/*
+=============
+FreeSparseTransfers
+
+Unmaps the transfer file, deleting it unless it is kept for incremental runs
+=============
+*/
+void FreeSparseTransfers(void)
+{
+#ifdef WIN32
+	if (sparsemap)
+		UnmapViewOfFile(sparsemap);
+
+	if (sparsemaphandle)
+		CloseHandle(sparsemaphandle);
+
+	if (sparsefilehandle != INVALID_HANDLE_VALUE)
+		CloseHandle(sparsefilehandle);
+
+	sparsemaphandle = NULL;
+	sparsefilehandle = INVALID_HANDLE_VALUE;
+#else
+	if (sparsemap)
+		munmap(const_cast<byte*>(sparsemap), sparsemapsize);
+
+	if (sparsefiledesc != -1)
+		close(sparsefiledesc);
+
+	sparsefiledesc = -1;
+#endif
+
+	sparsemap = NULL;
+	mappedindex = NULL;
+
+	if (!incremental && *sparsefile)
+		unlink(sparsefile);
+}
@@ -108,7 +108,7 @@ void TestPatchToFace(unsigned patchnum, int facenum, int head, unsigned bitpos)
 			// if bit has not already been set
 			//  && v2 is not behind light plane
 			//  && v2 is visible from v1
-			if (m > patchnum && DotProduct(patch2->origin, patch->normal) > PatchPlaneDist(patch) + 1.01 && TestLine_r(head, patch->origin, patch2->origin) == CONTENTS_EMPTY)
+			if (m > patchnum && DotProduct(patch2->origin, patch->normal) > PatchPlaneDist(patch) + 1.01 && (head == 0 ? TestLine(patch->origin, patch2->origin) : TestLine_r(head, patch->origin, patch2->origin)) == CONTENTS_EMPTY)
 			{
 				// patchnum can see patch m
 				int bitset = bitpos + m;
@@ -19,6 +19,10 @@
 #pragma warning(disable : 4305)
 
 #include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -1255,17 +1259,149 @@ s_trianglevert_t* lookup_triangle(s_mesh_t* pmesh, int index)
 	return pmesh->triangle[index];
 }
 
+/*
+=================
+WELD HASHES
+
+lookup_normal and lookup_vertex used to compare against every normal and
+vertex already in the model, which is quadratic in the size of the model.
+Both now go through hash tables that are rebuilt whenever they are asked
+about a different model, and still return the first match a linear scan
+would have found.
+=================
+*/
+
+struct vertexkey_t
+{
+	std::uint32_t org[3];
+	int bone;
+
+	bool operator==(const vertexkey_t& other) const
+	{
+		return !memcmp(this, &other, sizeof(*this));
+	}
+};
+
+struct vertexkeyhash_t
+{
+	std::size_t operator()(const vertexkey_t& key) const
+	{
+		std::size_t hash = key.bone;
+
+		for (int i = 0; i < 3; i++)
+			hash = hash * 0x9E3779B1 + key.org[i];
+
+		return hash;
+	}
+};
+
+static s_model_t* vertexhashmodel;
+static int vertexhashcount;
+static std::unordered_map<vertexkey_t, int, vertexkeyhash_t> vertexhash;
+
+static s_model_t* normalhashmodel;
+static int normalhashcount;
+static float normalhashcellsize;
+static std::unordered_map<std::int64_t, std::vector<int>> normalhash;
+
+static vertexkey_t VertexKey(const vec3_t org, int bone)
+{
+	vertexkey_t key;
+
+	for (int i = 0; i < 3; i++)
+	{
+		// + 0 folds -0 into 0 so both hash the same
+		const float value = org[i] + 0.0f;
+		memcpy(&key.org[i], &value, sizeof(value));
+	}
+
+	key.bone = bone;
+
+	return key;
+}
+
+static void NormalCell(const vec3_t org, int cell[3])
+{
+	for (int i = 0; i < 3; i++)
+		cell[i] = (int)floor(org[i] / normalhashcellsize);
+}
+
+static std::int64_t NormalCellKey(int x, int y, int z)
+{
+	return ((std::int64_t)(x & 0x1FFFFF) << 42) | ((std::int64_t)(y & 0x1FFFFF) << 21) | (std::int64_t)(z & 0x1FFFFF);
+}
+
+static void HashNormal(s_model_t* pmodel, int i)
+{
+	int cell[3];
+
+	NormalCell(pmodel->normal[i].org, cell);
+	normalhash[NormalCellKey(cell[0], cell[1], cell[2])].push_back(i);
+}
+
+/*
+=================
+lookup_normal
+
+Two unit normals with a dot product above normal_blend are closer than
+sqrt(2 - 2 * normal_blend), so with cells at least that big a match is
+always in the same or a neighboring cell.
+=================
+*/
 int lookup_normal(s_model_t* pmodel, s_normal_t* pnormal)
 {
 	int i;
-	for (i = 0; i < pmodel->numnorms; i++)
+	int cell[3];
+	int x, y, z;
+
+	if (normalhashmodel != pmodel || normalhashcount != pmodel->numnorms)
+	{
+		normalhashmodel = pmodel;
+		normalhashcount = pmodel->numnorms;
+		// slack for normals that aren't quite unit length
+		normalhashcellsize = sqrt(std::max(0.0f, 2.0f - 2.0f * normal_blend)) + 0.01f;
+		normalhash.clear();
+
+		for (i = 0; i < pmodel->numnorms; i++)
+			HashNormal(pmodel, i);
+	}
+
+	NormalCell(pnormal->org, cell);
+
+	int best = -1;
+
+	for (x = cell[0] - 1; x <= cell[0] + 1; x++)
 	{
-		// if (VectorCompare( pmodel->normal[i].org, pnormal->org )
-		if (DotProduct(pmodel->normal[i].org, pnormal->org) > normal_blend && pmodel->normal[i].bone == pnormal->bone && pmodel->normal[i].skinref == pnormal->skinref)
+		for (y = cell[1] - 1; y <= cell[1] + 1; y++)
 		{
-			return i;
+			for (z = cell[2] - 1; z <= cell[2] + 1; z++)
+			{
+				auto it = normalhash.find(NormalCellKey(x, y, z));
+
+				if (it == normalhash.end())
+					continue;
+
+				// indices are in ascending order, only the first match in each cell matters
+				for (int j : it->second)
+				{
+					if (best != -1 && j >= best)
+						break;
+
+					// if (VectorCompare( pmodel->normal[j].org, pnormal->org )
+					if (DotProduct(pmodel->normal[j].org, pnormal->org) > normal_blend && pmodel->normal[j].bone == pnormal->bone && pmodel->normal[j].skinref == pnormal->skinref)
+					{
+						best = j;
+						break;
+					}
+				}
+			}
 		}
 	}
+
+	if (best != -1)
+		return best;
+
+	i = pmodel->numnorms;
 	if (i >= MAXSTUDIOVERTS)
 	{
 		Error("too many normals in model: \"%s\"\n", pmodel->name);
@@ -1274,10 +1410,22 @@ int lookup_normal(s_model_t* pmodel, s_normal_t* pnormal)
 	pmodel->normal[i].bone = pnormal->bone;
 	pmodel->normal[i].skinref = pnormal->skinref;
 	pmodel->numnorms = i + 1;
+
+	HashNormal(pmodel, i);
+	normalhashcount = pmodel->numnorms;
+
 	return i;
 }
 
 
+/*
+=================
+lookup_vertex
+
+Vertices are rounded to 2 digits, so two of them are within EQUAL_EPSILON
+of each other only if they are exactly equal.
+=================
+*/
 int lookup_vertex(s_model_t* pmodel, s_vertex_t* pv)
 {
 	int i;
@@ -1287,13 +1435,22 @@ int lookup_vertex(s_model_t* pmodel, s_vertex_t* pv)
 	pv->org[1] = (int)(pv->org[1] * 100) / 100.0;
 	pv->org[2] = (int)(pv->org[2] * 100) / 100.0;
 
-	for (i = 0; i < pmodel->numverts; i++)
+	if (vertexhashmodel != pmodel || vertexhashcount != pmodel->numverts)
 	{
-		if (VectorCompare(pmodel->vert[i].org, pv->org) && pmodel->vert[i].bone == pv->bone)
-		{
-			return i;
-		}
+		vertexhashmodel = pmodel;
+		vertexhashcount = pmodel->numverts;
+		vertexhash.clear();
+
+		for (i = 0; i < pmodel->numverts; i++)
+			vertexhash.emplace(VertexKey(pmodel->vert[i].org, pmodel->vert[i].bone), i);
 	}
+
+	auto it = vertexhash.find(VertexKey(pv->org, pv->bone));
+
+	if (it != vertexhash.end())
+		return it->second;
+
+	i = pmodel->numverts;
 	if (i >= MAXSTUDIOVERTS)
 	{
 		Error("too many vertices in model: \"%s\"\n", pmodel->name);
@@ -1301,6 +1458,10 @@ int lookup_vertex(s_model_t* pmodel, s_vertex_t* pv)
 	VectorCopy(pv->org, pmodel->vert[i].org);
 	pmodel->vert[i].bone = pv->bone;
 	pmodel->numverts = i + 1;
+
+	vertexhash.emplace(VertexKey(pv->org, pv->bone), i);
+	vertexhashcount = pmodel->numverts;
+
 	return i;
 }
 
@@ -3490,10 +3651,23 @@ void ParseScript(void)
 main
 ==============
 */
+/*
+==============
+StageTime
+
+Seconds since an arbitrary point, with enough resolution to time stages
+==============
+*/
+double StageTime(void)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 int main(int argc, char** argv)
 {
 	int i;
 	char path[1024];
+	double start, parsetime, skintime, simplifytime, writetime;
 
 	default_scale = 1.0;
 	defaultzrotation = Q_PI / 2;
@@ -3509,11 +3683,19 @@ int main(int argc, char** argv)
 	gamma = 1.8;
 
 	if (argc == 1)
-		Error("usage: studiomdl [-t texture] -r(tag reversed) -n(tag bad normals) -f(flip all triangles) [-a normal_blend_angle] -h(dump hboxes) -i(ignore warnings) -p(force power of 2 textures) [-g max_sequencegroup_size(K)] file.qc");
+		Error("usage: studiomdl [-t texture] -r(tag reversed) -n(tag bad normals) -f(flip all triangles) [-a normal_blend_angle] -h(dump hboxes) -i(ignore warnings) -p(force power of 2 textures) [-g max_sequencegroup_size(K)] -timing(print stage times) -vcache(vertex cache optimized strips) file.qc");
 
 	for (i = 1; i < argc - 1; i++)
 	{
-		if (argv[i][0] == '-')
+		if (!strcmp(argv[i], "-timing"))
+		{
+			print_timing = 1;
+		}
+		else if (!strcmp(argv[i], "-vcache"))
+		{
+			optimize_vcache = 1;
+		}
+		else if (argv[i][0] == '-')
 		{
 			switch (argv[i][1])
 			{
@@ -3578,10 +3760,26 @@ int main(int argc, char** argv)
 	ClearModel();
 	strcpy(outname, argv[i]);
 
+	start = StageTime();
 	ParseScript();
+	parsetime = StageTime();
 	SetSkinValues();
+	skintime = StageTime();
 	SimplifyModel();
+	simplifytime = StageTime();
 	WriteFile();
+	writetime = StageTime();
+
+	if (print_timing)
+	{
+		printf("---------------------\n");
+		printf("parse & grab  %8.3f s\n", parsetime - start);
+		printf("skins         %8.3f s\n", skintime - parsetime);
+		printf("simplify      %8.3f s\n", simplifytime - skintime);
+		printf("tristrips     %8.3f s\n", tristrip_time);
+		printf("write         %8.3f s\n", writetime - simplifytime - tristrip_time);
+		printf("total         %8.3f s\n", writetime - start);
+	}
 
 	return 0;
 }
@@ -51,6 +51,10 @@ EXTERN int flip_triangles;
 EXTERN float normal_blend;
 EXTERN int dump_hboxes;
 EXTERN int ignore_warnings;
+EXTERN int print_timing;
+EXTERN int optimize_vcache;
+
+EXTERN double tristrip_time; // seconds spent in BuildTris, for -timing
 
 EXTERN vec3_t eyeposition;
 EXTERN int gflags;
@@ -71,6 +75,7 @@ extern vec_t Q_rint(vec_t in);
 
 extern void WriteFile(void);
 void* kalloc(int num, int size);
+double StageTime(void);
 
 typedef struct
 {
@@ -397,4 +402,15 @@ EXTERN int numbodyparts;
 EXTERN s_bodypart_t bodypart[MAXSTUDIOBODYPARTS];
 
 
+typedef struct
+{
+	int numtris;
+	int numcommands;
+	int numverts;	 // vertices in all strips and fans
+	int cachemisses; // vertices a 16 entry FIFO cache would have transformed
+} s_tristats_t;
+
+extern s_tristats_t tristats_greedy; // what the default BuildTris would have produced, with -vcache
+extern s_tristats_t tristats;
+
 extern int BuildTris(s_trianglevert_t (*x)[3], s_mesh_t* y, byte** ppdata);
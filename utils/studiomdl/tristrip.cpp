@@ -15,6 +15,12 @@
 #pragma warning(disable : 4305)
 
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/stat.h>
@@ -52,11 +58,73 @@ s_trianglevert_t (*triangles)[3];
 s_mesh_t* pmesh;
 
 
+/*
+================
+EDGE HASH
+
+Every directed edge of the mesh, so FindNeighbor can go straight to the
+triangles that share an edge instead of scanning all of the ones after it.
+Each edge maps to its triangle * 3 + edge numbers in ascending order, which
+is the order the scan used to visit them in.
+================
+*/
+
+struct edgekey_t
+{
+	s_trianglevert_t v[2];
+
+	bool operator==(const edgekey_t& other) const
+	{
+		return !memcmp(v, other.v, sizeof(v));
+	}
+};
+
+struct edgekeyhash_t
+{
+	std::size_t operator()(const edgekey_t& key) const
+	{
+		// FNV-1a
+		const auto* bytes = reinterpret_cast<const std::uint8_t*>(key.v);
+		std::uint32_t hash = 2166136261U;
+
+		for (std::size_t i = 0; i < sizeof(key.v); i++)
+			hash = (hash ^ bytes[i]) * 16777619U;
+
+		return hash;
+	}
+};
+
+static std::unordered_map<edgekey_t, std::vector<int>, edgekeyhash_t> edgehash;
+
+static edgekey_t EdgeKey(const s_trianglevert_t& v0, const s_trianglevert_t& v1)
+{
+	edgekey_t key;
+
+	key.v[0] = v0;
+	key.v[1] = v1;
+
+	return key;
+}
+
+static void BuildEdgeHash(void)
+{
+	int j, k;
+
+	edgehash.clear();
+
+	for (j = 0; j < pmesh->numtris; j++)
+	{
+		for (k = 0; k < 3; k++)
+			edgehash[EdgeKey(triangles[j][k], triangles[j][(k + 1) % 3])].push_back(j * 3 + k);
+	}
+}
+
+
 void FindNeighbor(int starttri, int startv)
 {
 	s_trianglevert_t m1, m2;
 	int j;
-	s_trianglevert_t *last, *check;
+	s_trianglevert_t* last;
 	int k;
 
 	// used[starttri] |= (1 << startv);
@@ -66,27 +134,31 @@ void FindNeighbor(int starttri, int startv)
 	m1 = last[(startv + 1) % 3];
 	m2 = last[(startv + 0) % 3];
 
-	for (j = starttri + 1, check = &triangles[starttri + 1][0]; j < pmesh->numtris; j++, check += 3)
+	auto it = edgehash.find(EdgeKey(m1, m2));
+
+	if (it == edgehash.end())
+		return;
+
+	const auto& edges = it->second;
+
+	// first edge of a triangle after this one
+	for (auto edge = std::upper_bound(edges.begin(), edges.end(), starttri * 3 + 2); edge != edges.end(); ++edge)
 	{
+		j = *edge / 3;
+		k = *edge % 3;
+
 		if (used[j] == 7)
 			continue;
-		for (k = 0; k < 3; k++)
-		{
-			if (memcmp(&check[k], &m1, sizeof(m1)))
-				continue;
-			if (memcmp(&check[(k + 1) % 3], &m2, sizeof(m2)))
-				continue;
 
-			neighbortri[starttri][startv] = j;
-			neighboredge[starttri][startv] = k;
+		neighbortri[starttri][startv] = j;
+		neighboredge[starttri][startv] = k;
 
-			neighbortri[j][k] = starttri;
-			neighboredge[j][k] = startv;
+		neighbortri[j][k] = starttri;
+		neighboredge[j][k] = startv;
 
-			used[starttri] |= (1 << startv);
-			used[j] |= (1 << k);
-			return;
-		}
+		used[starttri] |= (1 << startv);
+		used[j] |= (1 << k);
+		return;
 	}
 }
 
@@ -140,9 +212,9 @@ int StripLength(int starttri, int startv)
 done:
 
 	// clear the temp used flags
-	for (j = 0; j < pmesh->numtris; j++)
-		if (used[j] == 2)
-			used[j] = 0;
+	for (j = 0; j < stripcount; j++)
+		if (used[striptris[j]] == 2)
+			used[striptris[j]] = 0;
 
 	return stripcount;
 }
@@ -189,9 +261,9 @@ int FanLength(int starttri, int startv)
 done:
 
 	// clear the temp used flags
-	for (j = 0; j < pmesh->numtris; j++)
-		if (used[j] == 2)
-			used[j] = 0;
+	for (j = 0; j < stripcount; j++)
+		if (used[striptris[j]] == 2)
+			used[striptris[j]] = 0;
 
 	return stripcount;
 }
@@ -199,15 +271,48 @@ done:
 
 /*
 ================
-BuildTris
+EmitCommand
 
-Generate a list of trifans or strips
-for the model, which holds for all frames
+Appends a strip or fan to the command list and marks its triangles as used
 ================
 */
 int numcommandnodes;
 
-int BuildTris(s_trianglevert_t (*x)[3], s_mesh_t* y, byte** ppdata)
+static void EmitCommand(int type, int len, const int* tris, const int* verts)
+{
+	int j;
+
+	for (j = 0; j < len; j++)
+		used[tris[j]] = 1;
+
+	if (type == 1)
+		commands[numcommands++] = -len;
+	else
+		commands[numcommands++] = len;
+
+	for (j = 0; j < len; j++)
+	{
+		s_trianglevert_t* tri;
+
+		tri = &triangles[tris[j]][verts[j]];
+
+		commands[numcommands++] = tri->vertindex;
+		commands[numcommands++] = tri->normindex;
+		commands[numcommands++] = tri->s;
+		commands[numcommands++] = tri->t;
+	}
+	// printf("%d ", len - 2 );
+	numcommandnodes++;
+}
+
+/*
+================
+BuildGreedyCommands
+
+Starts each strip or fan at whichever unused triangle gives the longest one
+================
+*/
+static void BuildGreedyCommands(void)
 {
 	int i, j, k, m;
 	int startv;
@@ -218,41 +323,11 @@ int BuildTris(s_trianglevert_t (*x)[3], s_mesh_t* y, byte** ppdata)
 	int type;
 	int total = 0;
 	long t;
-	int maxlen;
-
-	triangles = x;
-	pmesh = y;
-
 
 	t = time(NULL);
 
 	for (i = 0; i < pmesh->numtris; i++)
-	{
-		neighbortri[i][0] = neighbortri[i][1] = neighbortri[i][2] = -1;
-		used[i] = 0;
 		peak[i] = pmesh->numtris;
-	}
-
-	// printf("finding neighbors\n");
-	for (i = 0; i < pmesh->numtris; i++)
-	{
-		for (k = 0; k < 3; k++)
-		{
-			if (used[i] & (1 << k))
-				continue;
-
-			FindNeighbor(i, k);
-		}
-		// printf("%d", used[i] );
-	}
-	// printf("\n");
-
-	//
-	// build tristrips
-	//
-	numcommandnodes = 0;
-	numcommands = 0;
-	memset(used, 0, sizeof(used));
 
 	for (i = 0; i < pmesh->numtris;)
 	{
@@ -263,7 +338,6 @@ int BuildTris(s_trianglevert_t (*x)[3], s_mesh_t* y, byte** ppdata)
 			continue;
 		}
 
-		maxlen = 9999;
 		bestlen = 0;
 		m = 0;
 		for (k = i; k < pmesh->numtris && bestlen < 127; k++)
@@ -305,47 +379,405 @@ int BuildTris(s_trianglevert_t (*x)[3], s_mesh_t* y, byte** ppdata)
 				}
 			}
 			peak[k] = localpeak;
-			if (localpeak == maxlen)
-				break;
 		}
 		total += (bestlen - 2);
 
 		// printf("%d (%d) %d\n", bestlen, pmesh->numtris - total, i );
 
-		maxlen = bestlen;
+		EmitCommand(besttype, bestlen, besttris, bestverts);
 
-		// mark the tris on the best strip as used
-		for (j = 0; j < bestlen; j++)
-			used[besttris[j]] = 1;
+		if (t != time(NULL))
+		{
+			printf("%2d%%\r", (total * 100) / pmesh->numtris);
+			t = time(NULL);
+		}
+	}
+}
 
-		if (besttype == 1)
-			commands[numcommands++] = -bestlen;
-		else
-			commands[numcommands++] = bestlen;
+/*
+===================================================================
+
+VERTEX CACHE AWARE COMMANDS
+
+Used with -vcache. Strips and fans are picked like the greedy builder
+does, except that ties go to the triangle with the fewest unused
+neighbors so the edges of the mesh don't end up as single triangles, and
+a strip too long to encode is cut to length when there is nothing else
+to pick instead of ending the command list. The finished
+commands are then ordered so each one reuses as many vertices as it can
+from a simulated vertex cache.
+
+===================================================================
+*/
+
+#define VCACHE_SIZE 16
+
+static int valence[MAXSTUDIOTRIANGLES]; // number of unused neighbors
+
+typedef struct
+{
+	int entries[VCACHE_SIZE][2]; // vertindex, normindex
+	int numentries;
+	int next;
+} vcache_t;
+
+typedef struct
+{
+	int type;
+	std::vector<int> tris;
+	std::vector<int> verts;
+} tricommand_t;
+
+static std::int64_t VCacheKey(const s_trianglevert_t* v)
+{
+	return ((std::int64_t)v->vertindex << 32) | (std::uint32_t)v->normindex;
+}
+
+static bool VCacheContains(const vcache_t* cache, const s_trianglevert_t* v)
+{
+	for (int i = 0; i < cache->numentries; i++)
+	{
+		if (cache->entries[i][0] == v->vertindex && cache->entries[i][1] == v->normindex)
+			return true;
+	}
+
+	return false;
+}
+
+/*
+================
+VCacheAdd
+
+FIFO replacement, like the post transform caches of most hardware.
+Returns whether the vertex had to be transformed.
+================
+*/
+static bool VCacheAdd(vcache_t* cache, const s_trianglevert_t* v)
+{
+	if (VCacheContains(cache, v))
+		return false;
+
+	cache->entries[cache->next][0] = v->vertindex;
+	cache->entries[cache->next][1] = v->normindex;
+	cache->next = (cache->next + 1) % VCACHE_SIZE;
+
+	if (cache->numentries < VCACHE_SIZE)
+		cache->numentries++;
+
+	return true;
+}
+
+static void UseTriangle(int tri)
+{
+	used[tri] = 1;
+
+	for (int k = 0; k < 3; k++)
+	{
+		const int neighbor = neighbortri[tri][k];
+
+		if (neighbor != -1 && valence[neighbor] > 0)
+			valence[neighbor]--;
+	}
+}
+
+/*
+================
+FindLongestCommands
+================
+*/
+static void FindLongestCommands(std::vector<tricommand_t>& found)
+{
+	int i, j, k;
+	int startv, type;
+	int len, bestlen, besttype = 0, bestvalence;
+	int bestverts[MAXSTUDIOTRIANGLES];
+	int besttris[MAXSTUDIOTRIANGLES];
+	int cutverts[127];
+	int cuttris[127];
+	int cuttype;
+	int peak[MAXSTUDIOTRIANGLES];
+
+	for (i = 0; i < pmesh->numtris; i++)
+	{
+		valence[i] = 0;
+
+		for (k = 0; k < 3; k++)
+		{
+			if (neighbortri[i][k] != -1)
+				valence[i]++;
+		}
+
+		peak[i] = pmesh->numtris;
+	}
+
+	for (i = 0; i < pmesh->numtris;)
+	{
+		if (used[i])
+		{
+			i++;
+			continue;
+		}
+
+		bestlen = 0;
+		bestvalence = 4;
+		cuttype = 0;
+		for (k = i; k < pmesh->numtris && bestlen < 127; k++)
+		{
+			int localpeak = 0;
+
+			if (used[k])
+				continue;
+
+			// peaks only go down as triangles get used, but a tie can still win on valence
+			if (peak[k] < bestlen)
+				continue;
+
+			for (type = 0; type < 2; type++)
+			{
+				for (startv = 0; startv < 3; startv++)
+				{
+					if (type == 1)
+						len = FanLength(k, startv);
+					else
+						len = StripLength(k, startv);
+
+					if (len > 127)
+					{
+						// any prefix of a strip or fan is still one, but cutting them
+						// leaves short ones behind so they are only a last resort
+						if (!bestlen && !cuttype)
+						{
+							cuttype = type + 1;
+							for (j = 0; j < 127; j++)
+							{
+								cuttris[j] = striptris[j];
+								cutverts[j] = stripverts[j];
+							}
+						}
+					}
+					else if (len > bestlen || (len == bestlen && valence[k] < bestvalence))
+					{
+						besttype = type;
+						bestlen = len;
+						bestvalence = valence[k];
+						for (j = 0; j < bestlen; j++)
+						{
+							besttris[j] = striptris[j];
+							bestverts[j] = stripverts[j];
+						}
+					}
+					if (len > localpeak)
+						localpeak = len;
+				}
+			}
+			peak[k] = localpeak;
+		}
+
+		if (!bestlen)
+		{
+			besttype = cuttype - 1;
+			bestlen = 127;
+			std::copy(cuttris, cuttris + bestlen, besttris);
+			std::copy(cutverts, cutverts + bestlen, bestverts);
+		}
+
+		tricommand_t command;
+		command.type = besttype;
+		command.tris.assign(besttris, besttris + bestlen);
+		command.verts.assign(bestverts, bestverts + bestlen);
+		found.push_back(std::move(command));
 
+		// strips and fans list their first triangle three times
 		for (j = 0; j < bestlen; j++)
 		{
-			s_trianglevert_t* tri;
+			if (j == 0 || besttris[j] != besttris[j - 1])
+				UseTriangle(besttris[j]);
+		}
+	}
+}
+
+/*
+================
+BuildCacheOptimizedCommands
+================
+*/
+static void BuildCacheOptimizedCommands(void)
+{
+	std::vector<tricommand_t> found;
+	std::unordered_map<std::int64_t, std::vector<int>> vertexcommands;
+	std::vector<bool> emitted;
+	vcache_t cache = {};
+	int first = 0;
+
+	FindLongestCommands(found);
 
-			tri = &triangles[besttris[j]][bestverts[j]];
+	for (int i = 0; i < (int)found.size(); i++)
+	{
+		for (std::size_t j = 0; j < found[i].tris.size(); j++)
+		{
+			auto& commands = vertexcommands[VCacheKey(&triangles[found[i].tris[j]][found[i].verts[j]])];
 
-			commands[numcommands++] = tri->vertindex;
-			commands[numcommands++] = tri->normindex;
-			commands[numcommands++] = tri->s;
-			commands[numcommands++] = tri->t;
+			if (commands.empty() || commands.back() != i)
+				commands.push_back(i);
 		}
-		// printf("%d ", bestlen - 2 );
-		numcommandnodes++;
+	}
 
-		if (t != time(NULL))
+	emitted.resize(found.size());
+
+	for (std::size_t n = 0; n < found.size(); n++)
+	{
+		int best = -1;
+		int besthits = 0;
+
+		// only commands sharing a vertex with the cache can hit it
+		for (int i = 0; i < cache.numentries; i++)
 		{
-			printf("%2d%%\r", (total * 100) / pmesh->numtris);
-			t = time(NULL);
+			s_trianglevert_t v = {};
+
+			v.vertindex = cache.entries[i][0];
+			v.normindex = cache.entries[i][1];
+
+			for (int c : vertexcommands[VCacheKey(&v)])
+			{
+				if (emitted[c])
+					continue;
+
+				int hits = 0;
+				for (std::size_t j = 0; j < found[c].tris.size(); j++)
+				{
+					if (VCacheContains(&cache, &triangles[found[c].tris[j]][found[c].verts[j]]))
+						hits++;
+				}
+
+				if (hits > besthits || (hits == besthits && c < best))
+				{
+					best = c;
+					besthits = hits;
+				}
+			}
+		}
+
+		if (best == -1)
+		{
+			while (emitted[first])
+				first++;
+
+			best = first;
+		}
+
+		const tricommand_t& command = found[best];
+
+		EmitCommand(command.type, (int)command.tris.size(), command.tris.data(), command.verts.data());
+		emitted[best] = true;
+
+		for (std::size_t j = 0; j < command.tris.size(); j++)
+			VCacheAdd(&cache, &triangles[command.tris[j]][command.verts[j]]);
+	}
+}
+
+/*
+================
+MeasureCommands
+
+Adds up the command list from commandstart on
+================
+*/
+static void MeasureCommands(int commandstart, s_tristats_t* stats)
+{
+	vcache_t cache = {};
+	int i = commandstart;
+
+	stats->numtris += pmesh->numtris;
+
+	while (commands[i])
+	{
+		const int len = abs(commands[i++]);
+
+		stats->numcommands++;
+		stats->numverts += len;
+
+		for (int j = 0; j < len; j++, i += 4)
+		{
+			s_trianglevert_t v = {};
+
+			v.vertindex = commands[i];
+			v.normindex = commands[i + 1];
+
+			if (VCacheAdd(&cache, &v))
+				stats->cachemisses++;
+		}
+	}
+}
+
+/*
+================
+BuildTris
+
+Generate a list of trifans or strips
+for the model, which holds for all frames
+================
+*/
+s_tristats_t tristats_greedy;
+s_tristats_t tristats;
+
+int BuildTris(s_trianglevert_t (*x)[3], s_mesh_t* y, byte** ppdata)
+{
+	int i, k;
+
+	triangles = x;
+	pmesh = y;
+
+	for (i = 0; i < pmesh->numtris; i++)
+	{
+		neighbortri[i][0] = neighbortri[i][1] = neighbortri[i][2] = -1;
+		used[i] = 0;
+	}
+
+	// printf("finding neighbors\n");
+	BuildEdgeHash();
+
+	for (i = 0; i < pmesh->numtris; i++)
+	{
+		for (k = 0; k < 3; k++)
+		{
+			if (used[i] & (1 << k))
+				continue;
+
+			FindNeighbor(i, k);
 		}
+		// printf("%d", used[i] );
 	}
+	// printf("\n");
+
+	edgehash.clear();
+
+	//
+	// build tristrips
+	//
+	numcommandnodes = 0;
+	numcommands = 0;
+	memset(used, 0, sizeof(used));
+
+	BuildGreedyCommands();
 
 	commands[numcommands++] = 0; // end of list marker
 
+	if (optimize_vcache)
+	{
+		// keep the greedy commands around only to compare against
+		MeasureCommands(0, &tristats_greedy);
+
+		numcommandnodes = 0;
+		numcommands = 0;
+		memset(used, 0, sizeof(used));
+
+		BuildCacheOptimizedCommands();
+
+		commands[numcommands++] = 0; // end of list marker
+	}
+
+	MeasureCommands(0, &tristats);
+
 	*ppdata = (byte*)commands;
 
 	// printf("%d %d %d\n", numcommandnodes, numcommands, pmesh->numtris  );
@@ -496,6 +496,8 @@ void WriteModel()
 
 		total_tris = 0;
 		total_strips = 0;
+		tristats = {};
+		tristats_greedy = {};
 		for (j = 0; j < model[i]->nummesh; j++)
 		{
 			int numCmdBytes;
@@ -512,7 +514,9 @@ void WriteModel()
 				psrctri++;
 			}
 
+			const double tristripstart = StageTime();
 			numCmdBytes = BuildTris(model[i]->pmesh[j]->triangle, model[i]->pmesh[j], &pCmdSrc);
+			tristrip_time += StageTime() - tristripstart;
 
 			pmesh[j].triindex = (pData - pStart);
 			memcpy(pData, pCmdSrc, numCmdBytes);
@@ -522,6 +526,15 @@ void WriteModel()
 			total_strips += numcommandnodes;
 		}
 		printf("mesh      %6d bytes (%d tris, %d strips)\n", pData - cur, total_tris, total_strips);
+		if (optimize_vcache && tristats.numtris > 0)
+		{
+			printf("          greedy: %5.1f verts/strip, %4.2f verts/tri, %4.2f transforms/tri (%d strips)\n",
+				(float)tristats_greedy.numverts / tristats_greedy.numcommands, (float)tristats_greedy.numverts / tristats_greedy.numtris,
+				(float)tristats_greedy.cachemisses / tristats_greedy.numtris, tristats_greedy.numcommands);
+			printf("          vcache: %5.1f verts/strip, %4.2f verts/tri, %4.2f transforms/tri (%d strips)\n",
+				(float)tristats.numverts / tristats.numcommands, (float)tristats.numverts / tristats.numtris,
+				(float)tristats.cachemisses / tristats.numtris, tristats.numcommands);
+		}
 		cur = pData;
 	}
 }
@@ -8,16 +8,62 @@
  *
  ****/
 
+#include <emmintrin.h>
+
 #include "vis.h"
 #include "threads.h"
 
 int c_fullskip;
 int c_chains;
-int c_portalskip, c_leafskip;
+int c_portalskip, c_leafskip, c_neverskip;
 int c_vistest, c_mighttest;
 
 int active;
 
+/*
+==============
+MergeMightSee
+
+Stores prev & test in might, returns true if that has any bits not already in vis.
+Works 16 bytes at a time, bitbytes is always a multiple of 16.
+==============
+*/
+static bool MergeMightSee(byte* might, const byte* prev, const byte* test, const byte* vis)
+{
+	__m128i more = _mm_setzero_si128();
+
+	for (int j = 0; j < bitbytes; j += 16)
+	{
+		const __m128i bits = _mm_and_si128(
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(prev + j)),
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(test + j)));
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(might + j), bits);
+
+		more = _mm_or_si128(more, _mm_andnot_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(vis + j)), bits));
+	}
+
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(more, _mm_setzero_si128())) != 0xFFFF;
+}
+
+/*
+==============
+OrBits
+
+==============
+*/
+void OrBits(byte* dest, const byte* src)
+{
+	for (int j = 0; j < bitbytes; j += 16)
+	{
+		const __m128i bits = _mm_or_si128(
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(dest + j)),
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + j)));
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + j), bits);
+	}
+}
+
 void CheckStack(leaf_t* leaf, threaddata_t* thread)
 {
 	pstack_t* p;
@@ -399,8 +445,8 @@ void RecursiveLeafFlow(int leafnum, threaddata_t* thread, pstack_t* prevstack)
 	portal_t* p;
 	plane_t backplane;
 	leaf_t* leaf;
-	int i, j;
-	long *test, *might, *vis, more;
+	int i;
+	const byte* test;
 
 	c_chains++;
 
@@ -420,9 +466,6 @@ void RecursiveLeafFlow(int leafnum, threaddata_t* thread, pstack_t* prevstack)
 	stack.leaf = leaf;
 	stack.portal = NULL;
 
-	might = (long*)stack.mightsee;
-	vis = (long*)thread->leafvis;
-
 	// check all portals for flowing into other leafs
 	for (i = 0; i < leaf->numportals; i++)
 	{
@@ -433,6 +476,16 @@ void RecursiveLeafFlow(int leafnum, threaddata_t* thread, pstack_t* prevstack)
 			c_leafskip++;
 			continue; // can't possibly see it
 		}
+
+		if (thread->base->neversee)
+		{
+			const int pnum = p - portals;
+			if (thread->base->neversee[pnum >> 3] & (1 << (pnum & 7)))
+			{
+				c_neverskip++;
+				continue; // base portal is behind it or it is behind the base portal
+			}
+		}
 #if 0
 		const int pnum = p - portals;
 		if ( (thread->fullportal[pnum>>3] & (1<<(pnum&7)) ) )
@@ -445,22 +498,15 @@ void RecursiveLeafFlow(int leafnum, threaddata_t* thread, pstack_t* prevstack)
 		if (p->status == vstatus_t::done)
 		{
 			c_vistest++;
-			test = (long*)p->visbits;
+			test = p->visbits;
 		}
 		else
 		{
 			c_mighttest++;
-			test = (long*)p->mightsee;
-		}
-
-		more = 0;
-		for (j = 0; j < bitlongs; j++)
-		{
-			might[j] = ((long*)prevstack->mightsee)[j] & test[j];
-			more |= (might[j] & ~vis[j]);
+			test = p->mightsee;
 		}
 
-		if (!more)
+		if (!MergeMightSee(stack.mightsee, prevstack->mightsee, test, thread->leafvis))
 		{ // can't see anything new
 			c_portalskip++;
 			continue;
@@ -544,7 +590,6 @@ PortalFlow
 void PortalFlow(portal_t* p)
 {
 	threaddata_t data;
-	int i;
 
 	if (p->status != vstatus_t::working)
 		Error("PortalFlow: reflowed");
@@ -560,8 +605,7 @@ void PortalFlow(portal_t* p)
 	data.pstack_head.portal = p;
 	data.pstack_head.source = p->winding;
 	data.pstack_head.portalplane = p->plane;
-	for (i = 0; i < bitlongs; i++)
-		((long*)data.pstack_head.mightsee)[i] = ((long*)p->mightsee)[i];
+	memcpy(data.pstack_head.mightsee, p->mightsee, bitbytes);
 	RecursiveLeafFlow(p->leaf, &data, &data.pstack_head);
 
 	p->status = vstatus_t::done;
@@ -603,6 +647,11 @@ void SimpleFlood(portal_t* srcportal, int leafnum, byte* portalsee, int* c_leafs
 /*
 ==============
 BasePortalVis
+
+With -clusterflow the portals that can never be seen through from a portal are
+also recorded, so PortalFlow can skip them without clipping windings. A pair is
+only recorded when a winding has a point strictly on the far side of the other
+plane, which is when ChopWinding clips it away instead of keeping it as on.
 ==============
 */
 void BasePortalVis(int /*threadnum*/)
@@ -613,6 +662,7 @@ void BasePortalVis(int /*threadnum*/)
 	winding_t* w;
 	byte portalsee[MAX_PORTALS];
 	int c_leafsee;
+	qboolean behind;
 
 
 	while (1)
@@ -627,30 +677,50 @@ void BasePortalVis(int /*threadnum*/)
 
 		memset(portalsee, 0, numportals * 2);
 
+		if (clusterflow && !fastvis)
+		{
+			p->neversee = reinterpret_cast<byte*>(malloc(portalbytes));
+			memset(p->neversee, 0, portalbytes);
+		}
+
 		for (j = 0, tp = portals; j < numportals * 2; j++, tp++)
 		{
 			if (j == i)
 				continue;
 			w = tp->winding;
+			behind = false;
 			for (k = 0; k < w->numpoints; k++)
 			{
 				d = DotProduct(w->points[k], p->plane.normal) - p->plane.dist;
 				if (d > ON_EPSILON)
 					break;
+				if (d < -ON_EPSILON)
+					behind = true;
 			}
 			if (k == w->numpoints)
+			{
+				if (behind && p->neversee)
+					p->neversee[j >> 3] |= 1 << (j & 7);
 				continue; // no points on front
+			}
 
 
 			w = p->winding;
+			behind = false;
 			for (k = 0; k < w->numpoints; k++)
 			{
 				d = DotProduct(w->points[k], tp->plane.normal) - tp->plane.dist;
 				if (d < -ON_EPSILON)
 					break;
+				if (d > ON_EPSILON)
+					behind = true;
 			}
 			if (k == w->numpoints)
+			{
+				if (behind && p->neversee)
+					p->neversee[j >> 3] |= 1 << (j & 7);
 				continue; // no points on front
+			}
 
 			portalsee[j] = 1;
 		}
@@ -10,11 +10,13 @@
 
 // vis.c
 
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
 #include "vis.h"
 #include "threads.h"
 
-#define MAX_THREADS 4
-
 int numportals;
 int portalleafs;
 
@@ -33,10 +35,17 @@ int originalvismapsize;
 
 byte* uncompressed; // [bitbytes*portalleafs]
 
-int bitbytes; // (portalleafs+63)>>3
+int bitbytes; // ((portalleafs+127)&~127)>>3, a multiple of 16 for the SSE bit operations
 int bitlongs;
+int portalbytes; // (numportals*2+7)>>3
 
 qboolean fastvis;
+qboolean clusterflow;
+
+// -clusterflow hands out the portals leaving a leaf as one unit of work
+std::vector<portal_t*> floworder;
+std::vector<int> flowunits; // start of each unit in floworder, plus the end
+std::atomic<int> nextflowunit;
 
 //=============================================================================
 
@@ -153,6 +162,77 @@ void LeafThread(int /*thread*/)
 	} while (1);
 }
 
+/*
+==============
+SortPortalsByCluster
+
+Groups the portals leaving each leaf together so they are flowed by the same
+thread back to back, sharing the windings and bits of their neighbourhood.
+Units still go from the least complex, ordered by their least complex portal.
+==============
+*/
+void SortPortalsByCluster(void)
+{
+	int i;
+	leaf_t* leaf;
+
+	std::vector<std::vector<portal_t*>> units;
+
+	for (i = 0; i < portalleafs; i++)
+	{
+		leaf = &leafs[i];
+		if (!leaf->numportals)
+			continue;
+
+		auto& unit = units.emplace_back(leaf->portals, leaf->portals + leaf->numportals);
+
+		std::stable_sort(unit.begin(), unit.end(), [](const portal_t* a, const portal_t* b)
+			{ return a->nummightsee < b->nummightsee; });
+	}
+
+	std::stable_sort(units.begin(), units.end(), [](const auto& a, const auto& b)
+		{ return a.front()->nummightsee < b.front()->nummightsee; });
+
+	floworder.clear();
+	flowunits.clear();
+
+	for (const auto& unit : units)
+	{
+		flowunits.push_back(floworder.size());
+		floworder.insert(floworder.end(), unit.begin(), unit.end());
+	}
+
+	flowunits.push_back(floworder.size());
+
+	nextflowunit = 0;
+}
+
+/*
+==============
+ClusterThread
+==============
+*/
+void ClusterThread(int /*thread*/)
+{
+	int i, unit;
+	portal_t* p;
+
+	while (GetThreadWork() != -1) // bump the pacifier
+	{
+		unit = nextflowunit++;
+
+		for (i = flowunits[unit]; i < flowunits[unit + 1]; i++)
+		{
+			p = floworder[i];
+			p->status = vstatus_t::working;
+
+			PortalFlow(p);
+
+			qprintf("portal:%4i  mightsee:%4i  cansee:%4i\n", (int)(p - portals), p->nummightsee, p->numcansee);
+		}
+	}
+}
+
 /*
 ===============
 CompressRow
@@ -218,8 +298,7 @@ void LeafFlow(int leafnum)
 		p = leaf->portals[i];
 		if (p->status != vstatus_t::done)
 			Error("portal not done");
-		for (j = 0; j < bitbytes; j++)
-			outbuffer[j] |= p->visbits[j];
+		OrBits(outbuffer, p->visbits);
 	}
 
 	if (outbuffer[leafnum >> 3] & (1 << (leafnum & 7)))
@@ -277,12 +356,27 @@ void CalcPortalVis(void)
 		return;
 	}
 
-	leafon = 0;
+	if (clusterflow)
+	{
+		SortPortalsByCluster();
+
+		RunThreadsOn((int)flowunits.size() - 1, true, ClusterThread);
+
+		for (i = 0; i < numportals * 2; i++)
+		{
+			free(portals[i].neversee);
+			portals[i].neversee = NULL;
+		}
+	}
+	else
+	{
+		leafon = 0;
 
-	RunThreadsOn(numportals * 2, true, LeafThread);
+		RunThreadsOn(numportals * 2, true, LeafThread);
+	}
 
 	qprintf("portalcheck: %i  portaltest: %i  portalpass: %i\n", c_portalcheck, c_portaltest, c_portalpass);
-	qprintf("c_vistest: %i  c_mighttest: %i\n", c_vistest, c_mighttest);
+	qprintf("c_vistest: %i  c_mighttest: %i  c_neverskip: %i\n", c_vistest, c_mighttest, c_neverskip);
 }
 
 
@@ -347,8 +441,9 @@ void LoadPortals(char* name)
 	printf("%4i portalleafs\n", portalleafs);
 	printf("%4i numportals\n", numportals);
 
-	bitbytes = ((portalleafs + 63) & ~63) >> 3;
+	bitbytes = ((portalleafs + 127) & ~127) >> 3;
 	bitlongs = bitbytes / sizeof(long);
+	portalbytes = (numportals * 2 + 7) >> 3;
 
 	// each file portal is split into two memory portals
 	portals = reinterpret_cast<portal_t*>(malloc(2 * numportals * sizeof(portal_t)));
@@ -455,6 +550,11 @@ int main(int argc, char** argv)
 			printf("fastvis = true\n");
 			fastvis = true;
 		}
+		else if (!strcmp(argv[i], "-clusterflow"))
+		{
+			printf("clusterflow = true\n");
+			clusterflow = true;
+		}
 		else if (!strcmp(argv[i], "-v"))
 		{
 			printf("verbose = true\n");
@@ -467,7 +567,7 @@ int main(int argc, char** argv)
 	}
 
 	if (i != argc - 1)
-		Error("usage: vis [-threads #] [-level 0-4] [-fast] [-v] bspfile");
+		Error("usage: vis [-threads #] [-level 0-4] [-fast] [-clusterflow] [-v] bspfile");
 
 	start = I_FloatTime();
 
@@ -505,6 +605,7 @@ int main(int argc, char** argv)
 
 	end = I_FloatTime();
 	printf("%5.1f seconds elapsed\n", end - start);
+	ThreadPrintPhaseTimes();
 
 	free(uncompressed);
 
@@ -57,6 +57,7 @@ typedef struct
 	vstatus_t status;
 	byte* visbits;
 	byte* mightsee;
+	byte* neversee; // portals that can't be seen through from this one, only with -clusterflow
 	int nummightsee;
 	int numcansee;
 } portal_t;
@@ -126,7 +127,7 @@ extern portal_t* portals;
 extern leaf_t* leafs;
 
 extern int c_portaltest, c_portalpass, c_portalcheck;
-extern int c_portalskip, c_leafskip;
+extern int c_portalskip, c_leafskip, c_neverskip;
 extern int c_vistest, c_mighttest;
 extern int c_chains;
 
@@ -137,6 +138,10 @@ extern qboolean showgetleaf;
 extern byte* uncompressed;
 extern int bitbytes;
 extern int bitlongs;
+extern int portalbytes;
+
+extern qboolean fastvis;
+extern qboolean clusterflow;
 
 
 void LeafFlow(int leafnum);
@@ -144,4 +149,6 @@ void BasePortalVis(int threadnum);
 
 void PortalFlow(portal_t* p);
 
+void OrBits(byte* dest, const byte* src);
+
 void CalcAmbientSounds(void);